@@ -0,0 +1,209 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __CPHD_ANTENNA_PATTERN_EVALUATOR_H__
+#define __CPHD_ANTENNA_PATTERN_EVALUATOR_H__
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <mem/SharedPtr.h>
+#include <six/PolyEvaluator.h>
+#include <cphd/Antenna.h>
+#include <cphd/Channel.h>
+#include <cphd/Metadata.h>
+#include <cphd/PVPBlock.h>
+#include <cphd/Types.h>
+
+namespace cphd
+{
+/*
+ *  \class AntennaPatternEvaluator
+ *
+ *  \brief Evaluates the Antenna polynomials toward scene points
+ *
+ *  For an APC at time t and position P (the TxPos or RcvPos PVP), the
+ *  direction cosines of a point T are
+ *      DCX = unit(T - P) . uX(t)
+ *      DCY = unit(T - P) . uY(t)
+ *  where uX and uY are the ACF axes.  The one-way gain (dB) at frequency f
+ *  is then
+ *      G0 + GainBSPoly(f - f0)
+ *         + Array.GainPoly(d * (DCX - DCX_EB), d * (DCY - DCY_EB))
+ *         + Element.GainPoly(DCX, DCY)
+ *  and the phase (cycles) is the sum of the Array and Element PhasePolys
+ *  at the same points.  The EB steering direction comes from the EB
+ *  polynomials at t and is scaled by f0 / f if EBFreqShift is set; the
+ *  mainlobe dilation d is f / f0 if MLFreqDilation is set and 1 otherwise.
+ *  Optional terms that aren't in the metadata are 0.  Two-way values are
+ *  the sums of the transmit and receive values.
+ *
+ *  The polynomials are flattened once when the evaluator is made.  Each
+ *  vector's frame and steering are evaluated once, and the points are
+ *  processed as contiguous columns so the pattern polynomials run over all
+ *  of them at once.
+ *
+ *  The sampled gain/phase arrays (GainPhaseArray) aren't applied; see
+ *  SupportBlock::getTypedArray() for those.
+ */
+class AntennaPatternEvaluator
+{
+public:
+    /*
+     *  \func AntennaPatternEvaluator
+     *  \brief Flattens the Antenna polynomials of the metadata
+     *
+     *  \param metadata CPHD metadata
+     *  \param numThreads (Optional) Number of threads to evaluate with
+     *
+     *  \throw except::Exception If the metadata has no Antenna, or an
+     *  APC refers to an ACF that doesn't exist
+     */
+    AntennaPatternEvaluator(const Metadata& metadata,
+                            size_t numThreads = 1);
+
+    /*
+     *  \func evaluateOneWay
+     *  \brief Evaluate one antenna pattern
+     *
+     *  \param apcId APC_ID of the antenna
+     *  \param apatId APAT_ID of the pattern
+     *  \param time APC time of each vector
+     *  \param position APC position of each vector
+     *  \param frequency (Optional) Frequency of each vector.  If this is
+     *         nullptr, the pattern's reference frequency is used.
+     *  \param numVectors Number of vectors
+     *  \param points Scene points (ECF)
+     *  \param numPoints Number of points
+     *  \param[out] gain Row-major numVectors x numPoints gains (dB)
+     *  \param[out] phase (Optional) Row-major numVectors x numPoints
+     *         phases (cycles).  May be nullptr.
+     *
+     *  \throw except::Exception If there's no such APC or pattern
+     */
+    void evaluateOneWay(const std::string& apcId,
+                        const std::string& apatId,
+                        const double* time,
+                        const Vector3* position,
+                        const double* frequency,
+                        size_t numVectors,
+                        const Vector3* points,
+                        size_t numPoints,
+                        double* gain,
+                        double* phase) const;
+
+    /*
+     *  \func evaluate
+     *  \brief Evaluate the two-way pattern of a channel from PVP columns
+     *
+     *  Vectors are split across threads.
+     *
+     *  \param channel 0-based channel
+     *  \param txTime TxTime of each vector
+     *  \param txPos TxPos of each vector
+     *  \param rcvTime RcvTime of each vector
+     *  \param rcvPos RcvPos of each vector
+     *  \param frequency (Optional) Frequency of each vector, or nullptr for
+     *         the reference frequencies
+     *  \param numVectors Number of vectors
+     *  \param points Scene points (ECF)
+     *  \param numPoints Number of points
+     *  \param[out] gain Row-major numVectors x numPoints gains (dB)
+     *  \param[out] phase (Optional) Row-major numVectors x numPoints
+     *         phases (cycles).  May be nullptr.
+     *
+     *  \throw except::Exception If the channel doesn't name its antennas
+     */
+    void evaluate(size_t channel,
+                  const double* txTime,
+                  const Vector3* txPos,
+                  const double* rcvTime,
+                  const Vector3* rcvPos,
+                  const double* frequency,
+                  size_t numVectors,
+                  const Vector3* points,
+                  size_t numPoints,
+                  double* gain,
+                  double* phase) const;
+
+    /*
+     *  \func evaluate
+     *  \brief Evaluate the two-way pattern of every vector of every
+     *  channel of a PVPBlock
+     *
+     *  Each vector is evaluated at its center frequency, (FX1 + FX2) / 2.
+     *  Channels are evaluated in parallel.
+     *
+     *  \param pvpBlock PVPs
+     *  \param points Scene points (ECF)
+     *  \param[out] gain Row-major numVectors x numPoints gains (dB) of
+     *         each channel
+     *  \param[out] phase Row-major numVectors x numPoints phases (cycles)
+     *         of each channel
+     */
+    void evaluate(const PVPBlock& pvpBlock,
+                  const std::vector<Vector3>& points,
+                  std::vector<std::vector<double> >& gain,
+                  std::vector<std::vector<double> >& phase) const;
+
+    /*
+     *  The ACF axes, flattened
+     */
+    struct Frame
+    {
+        mem::SharedPtr<const six::PolyXYZEvaluator> xAxis;
+        mem::SharedPtr<const six::PolyXYZEvaluator> yAxis;
+    };
+
+    /*
+     *  An antenna pattern, flattened.  Empty polynomials are left nullptr.
+     */
+    struct Pattern
+    {
+        double freqZero;
+        double gainZero;
+        bool ebFreqShift;
+        bool mlFreqDilation;
+        Poly1D gainBSPoly;
+        Poly1D dcxPoly;
+        Poly1D dcyPoly;
+        mem::SharedPtr<const six::Poly2DEvaluator> arrayGain;
+        mem::SharedPtr<const six::Poly2DEvaluator> arrayPhase;
+        mem::SharedPtr<const six::Poly2DEvaluator> elementGain;
+        mem::SharedPtr<const six::Poly2DEvaluator> elementPhase;
+    };
+
+private:
+    const Frame& getFrame(const std::string& apcId) const;
+
+    const Pattern& getPattern(const std::string& apatId) const;
+
+    const size_t mNumThreads;
+    std::vector<ChannelParameter::Antenna> mChannels;
+    std::map<std::string, Frame> mFrames;       // By ACF_ID
+    std::map<std::string, std::string> mAPCs;   // APC_ID to ACF_ID
+    std::map<std::string, Pattern> mPatterns;   // By APAT_ID
+};
+}
+
+#endif
@@ -0,0 +1,221 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __CPHD_BACKPROJECTOR_H__
+#define __CPHD_BACKPROJECTOR_H__
+
+#include <complex>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <types/RowCol.h>
+#include <six/sicd/ComplexData.h>
+#include <cphd/Metadata.h>
+#include <cphd/PVPBlock.h>
+#include <cphd/Types.h>
+#include <cphd/Wideband.h>
+
+namespace cphd
+{
+/*
+ *  \class Backprojector
+ *
+ *  \brief Reference time-domain backprojection from CPHD to SICD
+ *
+ *  The image is formed on the planar Image Area grid of SceneCoordinates:
+ *  rows run along +IAX and columns along +IAY.  If there's an ImageGrid,
+ *  its extents and spacings are used; otherwise the Image Area rectangle
+ *  is sampled at 1.5 times the spatial frequency bandwidth of the
+ *  collection, with the IARP on a pixel.
+ *
+ *  Each vector's signal is turned into a range profile (FX domain data
+ *  through an oversampled FFT; TOA domain data are used as is) and then,
+ *  for every pixel, the profile is linearly interpolated at the pixel's
+ *  dTOA relative to the SRP
+ *      dTOA = (|TxPos - P| + |RcvPos - P|
+ *              - |TxPos - SRP| - |RcvPos - SRP|) / c
+ *  and phase corrected by exp(-j 2 pi SGN f dTOA), which focuses a
+ *  scatterer whose signal phase is SGN * FX * dTOA cycles.  Pixels outside
+ *  a vector's [TOA1, TOA2] get nothing from it, as do vectors whose Signal
+ *  PVP is 0.  TOA domain data are taken to be baseband about
+ *  (FX1 + FX2) / 2.  No weighting or normalization is applied.
+ *
+ *  Vectors are read from the Wideband in blocks and accumulated into the
+ *  image tile by tile, with tiles split across threads.
+ */
+class Backprojector
+{
+public:
+    /*
+     *  \func Backprojector
+     *  \brief Sets up the output grid
+     *
+     *  \param metadata CPHD metadata
+     *  \param pvpBlock PVPs of every channel
+     *  \param numThreads (Optional) Number of threads to split tiles across
+     *
+     *  \throw except::Exception If the reference surface isn't planar
+     */
+    Backprojector(const Metadata& metadata,
+                  const PVPBlock& pvpBlock,
+                  size_t numThreads = 1);
+
+    //! Set the FFT oversampling of FX domain range profiles.  Default is 4.
+    void setOversample(size_t oversample);
+
+    //! Set the rows and columns of each output tile.  Default is 64.
+    void setTileSize(size_t tileSize);
+
+    //! Set the number of vectors read at once.  Default is 256.
+    void setVectorsPerBlock(size_t vectorsPerBlock);
+
+    size_t getNumRows() const
+    {
+        return mNumRows;
+    }
+
+    size_t getNumCols() const
+    {
+        return mNumCols;
+    }
+
+    //! Row (IAX) sample spacing in meters
+    double getRowSpacing() const
+    {
+        return mRowSpacing;
+    }
+
+    //! Column (IAY) sample spacing in meters
+    double getColSpacing() const
+    {
+        return mColSpacing;
+    }
+
+    //! Pixel nearest the IARP
+    types::RowCol<int> getSCPPixel() const
+    {
+        return mSCPPixel;
+    }
+
+    //! \return ECF position of a pixel
+    Vector3 getPixelPosition(double row, double col) const
+    {
+        return mOrigin + mRowStep * row + mColStep * col;
+    }
+
+    /*
+     *  \func formImage
+     *  \brief Form the image of a channel
+     *
+     *  \param wideband Signal arrays
+     *  \param channel 0-based channel
+     *  \param[out] image Row-major getNumRows() x getNumCols() pixels
+     */
+    void formImage(const Wideband& wideband,
+                   size_t channel,
+                   std::complex<float>* image) const;
+
+    /*
+     *  \func backproject
+     *  \brief Add a block of vectors to an image
+     *
+     *  This is what formImage() does with each block it reads.
+     *
+     *  \param channel 0-based channel
+     *  \param firstVector Index of the first vector in the block
+     *  \param numVectors Number of vectors in the block
+     *  \param signal Row-major numVectors x NumSamples signal, scaled by
+     *         AmpSF
+     *  \param[in,out] image Image to add the vectors to
+     */
+    void backproject(size_t channel,
+                     size_t firstVector,
+                     size_t numVectors,
+                     const std::complex<float>* signal,
+                     std::complex<float>* image) const;
+
+    /*
+     *  \func createComplexData
+     *  \brief Describe the image of a channel as a SICD
+     *
+     *  Grid is a PLANE grid along IAX and IAY whose spatial frequency
+     *  support comes from the vectors' FX1/FX2 and line of sight to the
+     *  IARP.  The ARP polynomial is fit to the midpoints of TxPos and
+     *  RcvPos, the COA time is the middle of the collection, and SCPCOA
+     *  and the image corners are derived from them.
+     *
+     *  \param channel 0-based channel
+     *
+     *  \return SICD metadata of the image formImage() forms
+     */
+    std::auto_ptr<six::sicd::ComplexData>
+    createComplexData(size_t channel) const;
+
+    /*
+     *  \func write
+     *  \brief Form the image of a channel and write it as a SICD
+     *
+     *  \param wideband Signal arrays
+     *  \param channel 0-based channel
+     *  \param pathname SICD to write
+     *  \param schemaPaths (Optional) XML schema paths for validation
+     */
+    void write(const Wideband& wideband,
+               size_t channel,
+               const std::string& pathname,
+               const std::vector<std::string>& schemaPaths =
+                       std::vector<std::string>()) const;
+
+private:
+    void setGrid();
+
+    /*
+     *  Extent of a channel's spatial frequency support along IAX and IAY
+     */
+    void getSupport(size_t channel,
+                    double& minKX,
+                    double& maxKX,
+                    double& minKY,
+                    double& maxKY) const;
+
+    const Metadata mMetadata;
+    const PVPBlock& mPVPBlock;
+    const size_t mNumThreads;
+    size_t mOversample;
+    size_t mTileSize;
+    size_t mVectorsPerBlock;
+
+    Vector3 mUIAX;
+    Vector3 mUIAY;
+    size_t mNumRows;
+    size_t mNumCols;
+    double mRowSpacing;
+    double mColSpacing;
+    types::RowCol<int> mSCPPixel;
+    Vector3 mOrigin;   // Position of pixel (0, 0)
+    Vector3 mRowStep;
+    Vector3 mColStep;
+};
+}
+
+#endif
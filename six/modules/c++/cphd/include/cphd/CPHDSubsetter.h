@@ -0,0 +1,194 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __CPHD_CPHD_SUBSETTER_H__
+#define __CPHD_CPHD_SUBSETTER_H__
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <io/OutputStream.h>
+#include <io/SeekableStreams.h>
+#include <sys/Conf.h>
+#include <cphd/FileHeader.h>
+#include <cphd/Metadata.h>
+#include <cphd/Wideband.h>
+
+namespace cphd
+{
+/*
+ *  \class CPHDSubsetter
+ *
+ *  \brief Writes a subset of a CPHD's channels, vectors, and samples
+ *
+ *  The PVP rows and signal samples are copied as raw big endian bytes, so
+ *  nothing is byte swapped or held in memory beyond a bounded buffer.
+ *  When samples are cropped, each vector's SC0 PVP is moved to the new
+ *  first sample, and FX1/FX2 (FX domain) or TOA1/TOA2 (TOA domain) are
+ *  clipped to the samples that are left.  Support arrays are copied whole.
+ *
+ *  The metadata is rewritten to match: the channel sizes and array
+ *  offsets, the channel parameters of the selected channels and their
+ *  reference vector indices, FxC, FxBW and TOASaved, the Global Timeline,
+ *  FxBand and TOASwath, and the reference geometry, which is derived from
+ *  the PVPs of the new reference vector.  This reads the selected PVPs
+ *  once more.
+ */
+class CPHDSubsetter
+{
+public:
+    /*
+     *  \func CPHDSubsetter
+     *  \brief Reads the header and metadata of a CPHD
+     *
+     *  \param inStream Stream to read the CPHD from
+     *  \param schemaPaths (Optional) XML schema paths for validation
+     *  \param bufferSize (Optional) Size of the copy buffer.  Default is
+     *         4 MB.  It grows to hold one vector if it has to.
+     */
+    CPHDSubsetter(std::shared_ptr<io::SeekableInputStream> inStream,
+                  const std::vector<std::string>& schemaPaths =
+                          std::vector<std::string>(),
+                  size_t bufferSize = 4 * 1024 * 1024);
+
+    CPHDSubsetter(const std::string& pathname,
+                  const std::vector<std::string>& schemaPaths =
+                          std::vector<std::string>(),
+                  size_t bufferSize = 4 * 1024 * 1024);
+
+    /*
+     *  \func addChannel
+     *  \brief Selects a channel, or part of one, for the subset
+     *
+     *  Channels are written in the order they're added.
+     *
+     *  \param channel 0-based channel of the input
+     *  \param firstVector First vector to keep
+     *  \param lastVector Last vector to keep (inclusive).  Use
+     *         Wideband::ALL for the rest of the channel.
+     *  \param firstSample First sample to keep
+     *  \param lastSample Last sample to keep (inclusive).  Use
+     *         Wideband::ALL for the rest of each vector.
+     *
+     *  \throw except::Exception If the ranges are empty or out of bounds,
+     *  the channel was already added, or the signal is compressed and
+     *  only part of the channel was asked for
+     */
+    void addChannel(size_t channel,
+                    size_t firstVector = 0,
+                    size_t lastVector = Wideband::ALL,
+                    size_t firstSample = 0,
+                    size_t lastSample = Wideband::ALL);
+
+    //! Get the metadata of the input
+    const Metadata& getMetadata() const
+    {
+        return *mMetadata;
+    }
+
+    /*
+     *  \func getSubsetMetadata
+     *  \return The metadata that write() writes
+     */
+    Metadata getSubsetMetadata() const;
+
+    /*
+     *  \func write
+     *  \brief Writes the subset
+     *
+     *  \throw except::Exception If no channels were added
+     */
+    void write(io::OutputStream& outStream) const;
+
+    void write(const std::string& pathname) const;
+
+private:
+    struct Selection
+    {
+        size_t channel;
+        size_t firstVector;
+        size_t numVectors;
+        size_t firstSample;
+        size_t numSamples;
+    };
+
+    //! Bounds of the PVPs of a selection
+    struct PVPExtents
+    {
+        PVPExtents();
+
+        void add(const PVPExtents& other);
+
+        double txTime1;
+        double txTime2;
+        double fx1;
+        double fx2;
+        double toa1;
+        double toa2;
+    };
+
+    void initialize(const std::vector<std::string>& schemaPaths);
+
+    /*
+     *  Read the PVP sets of a selection into mBuffer, starting at
+     *  firstVector of the selection, adjusted for the samples that are
+     *  kept.  They're left big endian.
+     *
+     *  \return The number of PVP sets read
+     */
+    size_t readPVP(const Selection& selection, size_t firstVector) const;
+
+    PVPExtents getPVPExtents(const Selection& selection) const;
+
+    /*
+     *  ReferenceGeometry of the reference vector of the subset metadata
+     */
+    ReferenceGeometry
+    computeReferenceGeometry(const Metadata& metadata) const;
+
+    /*
+     *  Copy raw bytes from the input to the output through mBuffer
+     */
+    void copy(sys::Off_T offset,
+              size_t size,
+              io::OutputStream& outStream) const;
+
+    void copyPVP(const Selection& selection,
+                 io::OutputStream& outStream) const;
+
+    void copySignal(const Selection& selection,
+                    io::OutputStream& outStream) const;
+
+    std::shared_ptr<io::SeekableInputStream> mInStream;
+    FileHeader mFileHeader;
+    std::unique_ptr<Metadata> mMetadata;
+    const std::vector<std::string> mSchemaPaths;
+    //! file offsets of each input channel's PVP and signal arrays
+    std::vector<sys::Off_T> mPVPOffsets;
+    std::vector<sys::Off_T> mSignalOffsets;
+    std::vector<Selection> mSelections;
+    mutable std::vector<sys::byte> mBuffer;
+};
+}
+
+#endif
@@ -30,6 +30,7 @@
 #include <io/FileOutputStream.h>
 #include <sys/OS.h>
 #include <sys/Conf.h>
+#include <sys/Mutex.h>
 #include <cphd/FileHeader.h>
 #include <cphd/Metadata.h>
 #include <cphd/PVP.h>
@@ -229,8 +230,14 @@ public:
      *      std::complex<sys::Int16_T>
      *      std::complex<sys::Int8_T>
      *
+     *  If the metadata has a signal compression ID with a codec in the
+     *  SignalCodecFactory and complex samples are passed in, each channel
+     *  is compressed (in parallel) and the compressed signal sizes are
+     *  filled in before anything is written.
+     *
      *  \param pvpBlock The vector based metadata to write.
-     *  \param widebandData .The wideband data to write to disk
+     *  \param widebandData .The wideband data to write to disk, with the
+     *         channels back to back
      *  \param supportData (Optional) The support array data to write to disk.
      */
     template<typename T>
@@ -319,12 +326,111 @@ public:
      *  as complex when computing the size (do not multiply by 2
      *  for correct byte swapping this is done internally).
      *  \param channel For selecting channel of compressed signal block
+     *
+     *  \throw except::Exception If the data is compressed but T isn't
+     *  sys::ubyte
      */
     template <typename T>
     void writeCPHDData(const T* data,
                        size_t numElements,
                        size_t channel = 1);
 
+    /*
+     *  \func startChannelWrites
+     *  \brief Lays out the file so channels can be written in any order
+     *
+     *  The metadata fixes where every channel's PVP and signal arrays go, so
+     *  after this writeChannel() and writeChannelPVP() can be called from
+     *  any thread, in any order, for whole channels or vector ranges.  Each
+     *  call byte swaps on the calling thread and writes straight to the
+     *  final location.  The header, XML, and support arrays are written by
+     *  finishChannelWrites().
+     *
+     *  \throw except::Exception If the signal is compressed, since the
+     *  compressed sizes aren't known up front
+     */
+    void startChannelWrites();
+
+    /*
+     *  \func writeChannel
+     *  \brief Writes a range of vectors of one channel's signal array
+     *
+     *  Thread safe after startChannelWrites().  This only works with the
+     *  complex CPHDWriter data types.
+     *
+     *  \param data numVectors vectors of samples
+     *  \param channel Channel to write
+     *  \param firstVector First vector in data
+     *  \param numVectors Number of vectors in data
+     */
+    template <typename T>
+    void writeChannel(const T* data,
+                      size_t channel,
+                      size_t firstVector,
+                      size_t numVectors);
+
+    /*
+     *  \func writeChannel
+     *  \brief Writes a whole channel's signal array
+     */
+    template <typename T>
+    void writeChannel(const T* data, size_t channel)
+    {
+        writeChannel(data, channel, 0, mMetadata.data.getNumVectors(channel));
+    }
+
+    /*
+     *  \func writeRawChannel
+     *  \brief Same as writeChannel(), for samples that are already in file
+     *  (big endian) byte order
+     */
+    void writeRawChannel(const sys::ubyte* data,
+                         size_t channel,
+                         size_t firstVector,
+                         size_t numVectors);
+
+    /*
+     *  \func writeChannelPVP
+     *  \brief Writes one channel's PVP array
+     *
+     *  Thread safe after startChannelWrites().
+     */
+    void writeChannelPVP(const PVPBlock& pvpBlock, size_t channel);
+
+    /*
+     *  \func writeRawChannelPVP
+     *  \brief Writes a range of a channel's PVP rows that are already
+     *  packed in file byte order
+     *
+     *  Thread safe after startChannelWrites().
+     *
+     *  \param data numVectors rows of data.numBytesPVP bytes
+     *  \param channel Channel to write
+     *  \param firstVector First vector in data
+     *  \param numVectors Number of vectors in data
+     */
+    void writeRawChannelPVP(const sys::ubyte* data,
+                            size_t channel,
+                            size_t firstVector,
+                            size_t numVectors);
+
+    /*
+     *  \func isChannelComplete
+     *  \return Whether all of a channel's vectors and its PVP array have
+     *  been written since startChannelWrites()
+     */
+    bool isChannelComplete(size_t channel) const;
+
+    /*
+     *  \func finishChannelWrites
+     *  \brief Writes the header, XML, and support arrays
+     *
+     *  \param supportData (Optional) The support array data to write
+     *
+     *  \throw except::Exception If any channel isn't complete
+     */
+    void finishChannelWrites(const sys::ubyte* supportData = nullptr);
+
     void close()
     {
         mStream->close();
@@ -335,15 +441,24 @@ private:
      *  Write metadata helper
      */
     void writeMetadata(
+        const Metadata& metadata,
         size_t supportSize, // Optional
         size_t pvpSize,
         size_t cphdSize);
 
     /*
-     *  Write pvp helper
+     *  Write metadata for a PVP block.  write() passes a copy of mMetadata
+     *  with the compressed signal sizes filled in.
+     */
+    void writeMetadata(const Metadata& metadata, const PVPBlock& pvpBlock);
+
+    /*
+     *  Serialize the XML and resolve the header offsets
      */
-    void writePVPData(const sys::ubyte* pvpBlock,
-                      size_t index);
+    std::string setUpHeader(const Metadata& metadata,
+                            size_t supportSize,
+                            size_t pvpSize,
+                            size_t cphdSize);
 
     /*
      *  Implementation of write wideband
@@ -357,6 +472,36 @@ private:
     void writeCompressedCPHDDataImpl(const sys::ubyte* data,
                                      size_t channel);
 
+    /*
+     *  Seek and write under mMutex so writes from different threads don't
+     *  interleave
+     */
+    void writeAt(sys::Off_T offset, const sys::byte* data, size_t size);
+
+    /*
+     *  Throw if a channel write is out of range or too early
+     */
+    void verifyChannelWrite(size_t channel,
+                            size_t firstVector,
+                            size_t numVectors) const;
+
+    /*
+     *  Record that a range of vectors has been written
+     */
+    void markWritten(std::vector<bool>& written,
+                     size_t& numLeft,
+                     size_t firstVector,
+                     size_t numVectors);
+
+    /*
+     *  Implementation of write channel
+     */
+    void writeChannelImpl(const sys::ubyte* data,
+                          size_t channel,
+                          size_t firstVector,
+                          size_t numVectors,
+                          bool byteSwap);
+
     /*
      *  Implementation of write support data
      */
@@ -381,6 +526,24 @@ private:
     const std::vector<std::string> mSchemaPaths;
     //! Output stream contains CPHD file
     std::shared_ptr<io::SeekableOutputStream> mStream;
+
+    // Book-keeping for channel writes
+    //! XML written by finishChannelWrites()
+    std::string mXMLMetadata;
+    //! file offset of each channel's PVP array
+    std::vector<sys::Off_T> mPVPOffsets;
+    //! file offset of each channel's signal array
+    std::vector<sys::Off_T> mSignalOffsets;
+    //! which vectors of each channel have been written
+    std::vector<std::vector<bool> > mVectorsWritten;
+    //! number of vectors of each channel still to write
+    std::vector<size_t> mVectorsLeft;
+    //! which PVP rows of each channel have been written
+    std::vector<std::vector<bool> > mPVPsWritten;
+    //! number of PVP rows of each channel still to write
+    std::vector<size_t> mPVPsLeft;
+    //! guards the stream and the book-keeping
+    mutable sys::Mutex mMutex;
 };
 }
 
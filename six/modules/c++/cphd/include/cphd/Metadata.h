@@ -70,6 +70,7 @@ struct Metadata : MetadataBase
     size_t getNumBytesPerSample() const override;   // 2, 4, or 8 bytes/complex sample
     size_t getCompressedSignalSize(size_t channel) const override;
     bool isCompressed() const override;
+    std::string getCompressionID() const override;
 
     /*!
      * Get domain type
@@ -24,6 +24,7 @@
 #define __CPHD_METADATA_BASE_H__
 
 #include <ostream>
+#include <string>
 #include <six/Init.h>
 #include <cphd/Enums.h>
 
@@ -87,6 +88,20 @@ struct MetadataBase
         return false;
     }
 
+    /*
+     * \func getCompressionID
+     * \brief Get the signal compression ID if applicable
+     *
+     * This function returns default value. Can be overridden
+     * if required (Ex: CPHD::Metadata)
+     *
+     * \return empty string by default
+     */
+    virtual std::string getCompressionID() const
+    {
+        return std::string();
+    }
+
     /*!
      * Get domain type
      * FX for frequency domain,
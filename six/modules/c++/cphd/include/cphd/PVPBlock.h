@@ -257,6 +257,23 @@ struct PVPBlock
     void getPVPdata(size_t channel,
                     void*  data) const;
 
+    /*
+     *  \func getPVPdata
+     *  \brief Same as above but converts ranges of vectors in parallel,
+     *  optionally byte swapping each vector as it goes.
+     *
+     *  \param channel 0 based index
+     *  \param[out] data A preallocated buffer of getPVPsize(channel) bytes.
+     *  Bytes that don't belong to a parameter are zeroed.
+     *  \param byteSwap Whether to byte swap each 8 byte word (e.g. to write
+     *  the big endian file format on a little endian system)
+     *  \param numThreads Number of threads to use
+     */
+    void getPVPdata(size_t channel,
+                    void* data,
+                    bool byteSwap,
+                    size_t numThreads) const;
+
     /*
      *  \func getNumBytesVBP
      *  \brief Number of bytes per PVP seet
@@ -276,6 +293,18 @@ struct PVPBlock
      */
     size_t getPVPsize(size_t channel) const;
 
+    //! Number of channels in the PVPBlock
+    size_t getNumChannels() const
+    {
+        return mData.size();
+    }
+
+    //! Number of vectors in a channel
+    size_t getNumVectors(size_t channel) const
+    {
+        return mData.at(channel).size();
+    }
+
     //! Get optional parameter flags
     bool hasAmpSF() const
     {
@@ -340,6 +369,58 @@ struct PVPBlock
     }
 
 protected:
+    struct PVPSet;
+
+    /*!
+     *  \struct PVPLayout
+     *
+     *  \brief Where each parameter of a PVP set lives
+     *
+     *  Compiled once from the Pvp so whole channels can be converted
+     *  without looking up offsets or comparing formats for every vector.
+     *  Optional parameters that aren't in the Pvp are left out.
+     */
+    struct PVPLayout
+    {
+        enum FieldType
+        {
+            SCALAR,
+            VECTOR3,
+            OPTIONAL,
+            ADDED_FLOAT,
+            ADDED_UNSIGNED,
+            ADDED_SIGNED,
+            ADDED_COMPLEX_INT,
+            ADDED_COMPLEX_FLOAT,
+            ADDED_STRING
+        };
+
+        struct Field
+        {
+            Field(FieldType type, const PVPType& param);
+
+            FieldType type;
+            size_t byteOffset;
+            size_t byteSize;
+            //! Destination, depending on the type
+            double PVPSet::* scalar;
+            Vector3 PVPSet::* vector;
+            mem::ScopedCopyablePtr<double> PVPSet::* optional;
+            std::string name;
+        };
+
+        PVPLayout() :
+            numAdded(0)
+        {
+        }
+
+        explicit PVPLayout(const Pvp& pvp);
+
+        std::vector<Field> fields;
+        //! Number of additional parameters
+        size_t numAdded;
+    };
+
     /*!
      *  \struct PVPSet
      *
@@ -363,27 +444,22 @@ protected:
          *
          *  \brief Writes binary data input into PVP Set
          *
-         *  \param pvpBlock A pvpBlock struct to access optional parameter flags
-         *  \param pvp A filled out pvp sturcture. This will be used for
-         *  information on where to allocate memory and set each
-         *  parameter in a PVP set.
+         *  \param layout Where each parameter is in the input
          *  \param input A pointer to an array of bytes that contains the
          *  parameter data to write into the pvp set
          */
-        void write(const PVPBlock& pvpBlock, const Pvp& pvp, const sys::byte* input);
+        void write(const PVPLayout& layout, const sys::byte* input);
 
         /*
          *  \func read
          *
          *  \brief Read PVP set into binary data output
          *
-         *  \param pvp A filled out pvp sturcture. This will be used for
-         *  information on where to allocate memory and set each
-         *  parameter in a PVP set.
+         *  \param layout Where each parameter goes in the output
          *  \param[out] output A pointer to an array of allocated bytes that
          *  will be written to
          */
-        void read(const Pvp& pvp, sys::ubyte* output) const;
+        void read(const PVPLayout& layout, sys::ubyte* output) const;
 
         //! Equality operators
         bool operator==(const PVPSet& other) const
@@ -447,6 +523,8 @@ private:
     size_t mNumBytesPerVector;
     //! PVP block metadata
     Pvp mPvp;
+    //! mPvp compiled for converting whole channels
+    PVPLayout mLayout;
 
     /*
      *  Optional parameter flags
@@ -459,6 +537,10 @@ private:
     bool mTDIonoSRPEnabled;
     bool mSignalEnabled;
 
+    //! Convert ranges of vectors in parallel
+    class DecodeJob;
+    class EncodeJob;
+
     //! Ostream operator
     friend std::ostream& operator<< (std::ostream& os, const PVPBlock& p);
 };
@@ -0,0 +1,191 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __CPHD_REFERENCE_GEOMETRY_CALCULATOR_H__
+#define __CPHD_REFERENCE_GEOMETRY_CALCULATOR_H__
+
+#include <string>
+#include <vector>
+
+#include <logging/Logger.h>
+#include <cphd/Metadata.h>
+#include <cphd/PVPBlock.h>
+#include <cphd/ReferenceGeometry.h>
+#include <cphd/Types.h>
+
+namespace cphd
+{
+/*
+ *  \class ReferenceGeometryCalculator
+ *
+ *  \brief Derives the ReferenceGeometry parameters from the PVPs
+ *
+ *  Geometry is computed in the Earth Tangent Plane (ETP) at each vector's
+ *  SRPPos.  A monostatic vector's ARP is the midpoint of TxPos and RcvPos
+ *  (ARP velocity likewise); a bistatic vector is pointed along the
+ *  bisector of the unit vectors from the SRP to the transmit and receive
+ *  APCs.  The slant plane holds the pointing vector and its rate of
+ *  change, and the angles follow the SICD SCPCOA definitions.  The
+ *  reference time of a vector is TxTime + |TxPos - SRPPos| / c.  Angles
+ *  are in degrees and rates in degrees per second.
+ *
+ *  SRP.IAC and the SRP COD and dwell times need a planar reference surface;
+ *  otherwise they're left undefined and 0.
+ *
+ *  Bulk computations run over a channel's PVP columns with the vectors
+ *  split across threads.  The ETP frame is only recomputed when SRPPos
+ *  changes, so channels with a fixed SRP pay for it once per thread.
+ */
+class ReferenceGeometryCalculator
+{
+public:
+    /*
+     *  Geometry of each vector of a channel, one column per parameter
+     */
+    struct VectorGeometry
+    {
+        void resize(size_t numVectors);
+
+        size_t size() const
+        {
+            return referenceTime.size();
+        }
+
+        std::vector<double> referenceTime;
+
+        //! |ARP - SRP| if monostatic, the mean of the transmit and
+        //! receive ranges to the SRP if bistatic
+        std::vector<double> slantRange;
+
+        std::vector<double> azimuthAngle;
+        std::vector<double> grazeAngle;
+        std::vector<double> twistAngle;
+        std::vector<double> slopeAngle;
+        std::vector<double> layoverAngle;
+
+        //! 0 if monostatic
+        std::vector<double> bistaticAngle;
+
+        //! scene::TRACK_LEFT or scene::TRACK_RIGHT
+        std::vector<int> sideOfTrack;
+    };
+
+    /*
+     *  Largest absolute difference validate() allows for each kind of
+     *  parameter.  The defaults allow for metadata written with fewer
+     *  digits than a double holds.
+     */
+    struct Tolerances
+    {
+        Tolerances() :
+            time(1e-6),
+            angle(1e-3),
+            angleRate(1e-3),
+            distance(1e-1),
+            speed(1e-3)
+        {
+        }
+
+        //! Seconds: ReferenceTime, SRPCODTime, SRPDwellTime and Time
+        double time;
+
+        //! Degrees: every angle
+        double angle;
+
+        //! Degrees per second: AzimuthAngleRate and BistaticAngleRate
+        double angleRate;
+
+        //! Meters: SRP, ranges and positions
+        double distance;
+
+        //! Meters per second: velocities
+        double speed;
+    };
+
+    /*
+     *  \func ReferenceGeometryCalculator
+     *
+     *  \param metadata CPHD metadata.  CollectionID.CollectType decides
+     *         whether vectors are monostatic or bistatic.
+     *  \param pvpBlock PVPs of every channel
+     *  \param numThreads (Optional) Number of threads to split vectors
+     *         across
+     */
+    ReferenceGeometryCalculator(const Metadata& metadata,
+                                const PVPBlock& pvpBlock,
+                                size_t numThreads = 1);
+
+    //! \return Index of Channel.RefChId
+    size_t getReferenceChannel() const;
+
+    /*
+     *  \func computeVectorGeometry
+     *  \brief Geometry of every vector of a channel
+     *
+     *  \param channel 0-based channel
+     *  \param[out] geometry Geometry, resized to the number of vectors
+     */
+    void computeVectorGeometry(size_t channel,
+                               VectorGeometry& geometry) const;
+
+    /*
+     *  \func computeReferenceGeometry
+     *  \brief ReferenceGeometry as though a vector were the reference
+     *
+     *  \param channel 0-based channel
+     *  \param vector 0-based vector
+     *
+     *  \throw except::Exception If the channel's COD or dwell polynomial
+     *         isn't in the Dwell block
+     */
+    ReferenceGeometry computeReferenceGeometry(size_t channel,
+                                               size_t vector) const;
+
+    //! ReferenceGeometry of RefVectorIndex of Channel.RefChId
+    ReferenceGeometry computeReferenceGeometry() const;
+
+    /*
+     *  \func validate
+     *  \brief Compare a ReferenceGeometry to the one derived from the PVPs
+     *
+     *  Each mismatch is logged as an error.
+     *
+     *  \param given ReferenceGeometry to check, usually the metadata's
+     *  \param log Logger for mismatches
+     *  \param tolerances (Optional) Tolerance of each kind of parameter.
+     *         Vectors are compared by the length of their difference.
+     *
+     *  \return true if everything matches
+     */
+    bool validate(const ReferenceGeometry& given,
+                  logging::Logger& log,
+                  const Tolerances& tolerances = Tolerances()) const;
+
+private:
+    const Metadata mMetadata;
+    const PVPBlock& mPVPBlock;
+    const size_t mNumThreads;
+    const bool mBistatic;
+};
+}
+
+#endif
@@ -0,0 +1,306 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __CPHD_SIGNAL_CODEC_H__
+#define __CPHD_SIGNAL_CODEC_H__
+
+#include <stddef.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <mt/Singleton.h>
+#include <sys/Conf.h>
+#include <sys/Mutex.h>
+#include <cphd/Data.h>
+
+namespace cphd
+{
+/*
+ *  \class SignalCodec
+ *
+ *  \brief Lossless compressor for a block of signal samples
+ *
+ *  Codecs are looked up by Data::signalCompressionID in the
+ *  SignalCodecRegistry.  A channel compressed with a codec is a
+ *  SignalBlockIndex followed by independently compressed blocks of whole
+ *  vectors, so a reader only has to decompress the blocks that overlap the
+ *  vectors it wants.  Samples are always in file (big endian) byte order.
+ */
+class SignalCodec
+{
+public:
+    virtual ~SignalCodec()
+    {
+    }
+
+    /*
+     *  \func compress
+     *  \brief Compress a block of samples
+     *
+     *  \param input Samples to compress
+     *  \param numElements Number of complex samples in input
+     *  \param elementSize Size of each complex sample in bytes
+     *  \param[out] output Compressed bytes are appended to this
+     */
+    virtual void compress(const sys::ubyte* input,
+                          size_t numElements,
+                          size_t elementSize,
+                          std::vector<sys::ubyte>& output) const = 0;
+
+    /*
+     *  \func decompress
+     *  \brief Decompress a block written by compress()
+     *
+     *  \param input Compressed bytes
+     *  \param inputSize Number of compressed bytes
+     *  \param numElements Number of complex samples in the block
+     *  \param elementSize Size of each complex sample in bytes
+     *  \param[out] output numElements * elementSize bytes
+     *
+     *  \throw except::Exception If input is not a valid block
+     */
+    virtual void decompress(const sys::ubyte* input,
+                            size_t inputSize,
+                            size_t numElements,
+                            size_t elementSize,
+                            sys::ubyte* output) const = 0;
+};
+
+/*
+ *  \class LZCodec
+ *
+ *  \brief Built-in LZ77 codec with an optional byte-plane shuffle
+ *
+ *  The shuffle groups byte k of every sample together before compressing.
+ *  The high order bytes of neighboring samples tend to repeat, so this
+ *  usually helps a lot for CI4 and CF8 data.  Blocks that don't compress
+ *  are stored as is.
+ */
+class LZCodec : public SignalCodec
+{
+public:
+    /*
+     *  \param shuffle Whether to shuffle bytes into planes first
+     */
+    explicit LZCodec(bool shuffle);
+
+    virtual void compress(const sys::ubyte* input,
+                          size_t numElements,
+                          size_t elementSize,
+                          std::vector<sys::ubyte>& output) const;
+
+    virtual void decompress(const sys::ubyte* input,
+                            size_t inputSize,
+                            size_t numElements,
+                            size_t elementSize,
+                            sys::ubyte* output) const;
+
+private:
+    const bool mShuffle;
+};
+
+/*
+ *  \struct SignalBlockIndex
+ *
+ *  \brief Index at the start of each codec-compressed channel
+ *
+ *  Stored big endian as an 8 byte magic number, the number of vectors, the
+ *  number of vectors per block, and then getNumBlocks() + 1 byte offsets.
+ *  The offsets are from the start of the channel and the last one is the
+ *  total size of the channel.
+ */
+struct SignalBlockIndex
+{
+    //! Size of the fixed part of the index in bytes
+    static const size_t HEADER_SIZE;
+
+    SignalBlockIndex();
+
+    /*
+     *  \param numVectors Number of vectors in the channel
+     *  \param vectorsPerBlock Number of vectors in each block (the last
+     *  block may have fewer)
+     */
+    SignalBlockIndex(size_t numVectors, size_t vectorsPerBlock);
+
+    size_t getNumBlocks() const;
+
+    //! Index of the block holding a vector
+    size_t getBlock(size_t vector) const
+    {
+        return vector / vectorsPerBlock;
+    }
+
+    //! Number of vectors in a block
+    size_t getNumVectors(size_t block) const;
+
+    //! Total size of the index in bytes
+    size_t getSize() const;
+
+    /*
+     *  \func readHeader
+     *  \brief Parse the fixed part of the index and size blockOffsets
+     *
+     *  \param data HEADER_SIZE bytes from the start of the channel
+     *
+     *  \throw except::Exception If data isn't a block index
+     */
+    void readHeader(const sys::ubyte* data);
+
+    /*
+     *  \func readOffsets
+     *  \brief Parse the block offsets that follow the header
+     *
+     *  \param data getSize() - HEADER_SIZE bytes
+     *
+     *  \throw except::Exception If the offsets aren't increasing
+     */
+    void readOffsets(const sys::ubyte* data);
+
+    //! Write the whole index to getSize() bytes
+    void write(sys::ubyte* data) const;
+
+    size_t numVectors;
+    size_t vectorsPerBlock;
+    std::vector<sys::Uint64_T> blockOffsets;
+};
+
+/*
+ *  \func compressSignalArray
+ *  \brief Compress a channel's signal array with a codec, in parallel
+ *
+ *  \param codec Codec to use
+ *  \param input numVectors * numSamples samples
+ *  \param numVectors Number of vectors in the channel
+ *  \param numSamples Number of samples per vector
+ *  \param elementSize Size of each complex sample in bytes
+ *  \param byteSwap Whether the input is in native byte order and needs to
+ *  be swapped to big endian first
+ *  \param numThreads Number of threads to use
+ *  \param[out] output Index followed by the compressed blocks
+ *  \param vectorsPerBlock (Optional) Number of vectors per block.  By
+ *  default blocks are about 256 KB uncompressed.
+ */
+void compressSignalArray(const SignalCodec& codec,
+                         const sys::ubyte* input,
+                         size_t numVectors,
+                         size_t numSamples,
+                         size_t elementSize,
+                         bool byteSwap,
+                         size_t numThreads,
+                         std::vector<sys::ubyte>& output,
+                         size_t vectorsPerBlock = 0);
+
+/*
+ *  \func compressSignalBlock
+ *  \brief Compress every channel with the codec registered for the signal
+ *  compression ID
+ *
+ *  \param data Data block describing the channels
+ *  \param input The channels' samples, back to back
+ *  \param byteSwap Whether the input is in native byte order and needs to
+ *  be swapped to big endian first
+ *  \param numThreads Number of threads to use
+ *  \param[out] output Each channel's index followed by its compressed
+ *  blocks.  Their sizes are the channels' compressed signal sizes.
+ *
+ *  \throw except::Exception If no codec is registered for the ID
+ */
+void compressSignalBlock(const Data& data,
+                         const sys::ubyte* input,
+                         bool byteSwap,
+                         size_t numThreads,
+                         std::vector<std::vector<sys::ubyte> >& output);
+
+/*
+ *  \func decompressSignalBlocks
+ *  \brief Decompress an AOI out of a range of blocks, in parallel
+ *
+ *  \param codec Codec the channel was compressed with
+ *  \param index Index of the channel
+ *  \param blocks Compressed bytes starting at the first block that holds
+ *  firstVector
+ *  \param numSamples Number of samples per vector in the channel
+ *  \param elementSize Size of each complex sample in bytes
+ *  \param firstVector First vector to decompress (inclusive)
+ *  \param lastVector Last vector to decompress (inclusive)
+ *  \param firstSample First sample to decompress (inclusive)
+ *  \param lastSample Last sample to decompress (inclusive)
+ *  \param numThreads Number of threads to use
+ *  \param[out] output AOI samples in file byte order
+ */
+void decompressSignalBlocks(const SignalCodec& codec,
+                            const SignalBlockIndex& index,
+                            const sys::ubyte* blocks,
+                            size_t numSamples,
+                            size_t elementSize,
+                            size_t firstVector,
+                            size_t lastVector,
+                            size_t firstSample,
+                            size_t lastSample,
+                            size_t numThreads,
+                            sys::ubyte* output);
+
+/*
+ *  \class SignalCodecRegistry
+ *
+ *  \brief Codecs keyed by signal compression ID
+ *
+ *  "SIX_LZ" (LZCodec without the shuffle) and "SIX_SHUFFLE_LZ" (with it)
+ *  are always registered.  Files with any other ID are still readable as
+ *  opaque compressed bytes, but can't be read by vector and sample.
+ */
+class SignalCodecRegistry
+{
+public:
+    //! Registers the built-in codecs
+    SignalCodecRegistry();
+
+    /*
+     *  \func addCodec
+     *  \brief Register a codec, replacing any codec already using the ID
+     */
+    void addCodec(const std::string& compressionID,
+                  std::unique_ptr<SignalCodec> codec);
+
+    /*
+     *  \func getCodec
+     *  \return Codec for the ID, or a null pointer if none is registered
+     */
+    std::shared_ptr<const SignalCodec>
+    getCodec(const std::string& compressionID) const;
+
+private:
+    typedef std::map<std::string, std::shared_ptr<const SignalCodec> >
+            RegistryMap;
+
+    mutable sys::Mutex mMutex;
+    RegistryMap mRegistry;
+};
+
+//! Singleton declaration of our SignalCodecRegistry
+typedef mt::Singleton<SignalCodecRegistry, true> SignalCodecFactory;
+}
+
+#endif
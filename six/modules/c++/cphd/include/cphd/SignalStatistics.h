@@ -0,0 +1,143 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __CPHD_SIGNAL_STATISTICS_H__
+#define __CPHD_SIGNAL_STATISTICS_H__
+
+#include <vector>
+
+#include <cphd/Data.h>
+#include <cphd/PVPBlock.h>
+#include <cphd/Wideband.h>
+
+namespace cphd
+{
+/*
+ *  \struct ChannelStatistics
+ *
+ *  \brief Quicklook power image and statistics of a channel's signal
+ *
+ *  Power is |sample|^2 in stored units, times AmpSF^2 if the AmpSF PVP is
+ *  given.
+ */
+struct ChannelStatistics
+{
+    ChannelStatistics();
+
+    size_t numVectors;
+    size_t numSamples;
+
+    //! Vectors and samples averaged into each quicklook pixel
+    size_t vectorDecimation;
+    size_t sampleDecimation;
+
+    //! Quicklook size.  Edge pixels average whatever is left over.
+    size_t numRows;
+    size_t numCols;
+
+    //! Row-major numRows x numCols mean power
+    std::vector<float> power;
+
+    //! Power histogram in dB.  Bin i counts powers in
+    //! [minDB + i * binWidth, minDB + (i + 1) * binWidth); powers outside
+    //! the range count in the first or last bin.
+    double minDB;
+    double binWidthDB;
+    std::vector<size_t> histogram;
+
+    //! Peak and mean power of each vector
+    std::vector<float> peakPower;
+    std::vector<float> meanPower;
+
+    //! Samples of each vector with a component at the limit of CI2 or CI4.
+    //! Always 0 for CF8.
+    std::vector<size_t> saturated;
+    size_t numSaturated;
+
+    //! Vectors whose Signal PVP is 0
+    std::vector<size_t> dropouts;
+};
+
+/*
+ *  \class SignalStatistics
+ *
+ *  \brief Streaming quicklook of a channel's signal
+ *
+ *  A channel is read once, a block of vectors at a time, in its stored
+ *  sample type: memory is bounded by the block and the quicklook, and
+ *  nothing is promoted to complex<float>.  Each block's vectors are split
+ *  across threads in whole quicklook rows.
+ */
+class SignalStatistics
+{
+public:
+    /*
+     *  \func SignalStatistics
+     *
+     *  \param wideband Signal arrays to read
+     *  \param data Data block describing them
+     *  \param numThreads (Optional) Number of threads to use
+     */
+    SignalStatistics(const Wideband& wideband,
+                     const Data& data,
+                     size_t numThreads = 1);
+
+    //! Set the vectors and samples per quicklook pixel.  Default is 8 x 8.
+    void setDecimation(size_t vectors, size_t samples);
+
+    //! Set the histogram range and bins.  Default is 100 1 dB bins from
+    //! 0 dB.
+    void setHistogram(double minDB, double maxDB, size_t numBins);
+
+    //! Set the number of vectors read at once.  It's rounded up to a whole
+    //! number of quicklook rows.  Default is 256.
+    void setVectorsPerBlock(size_t vectorsPerBlock);
+
+    /*
+     *  \func compute
+     *  \brief Make the quicklook and statistics of a channel
+     *
+     *  \param channel 0-based channel
+     *  \param pvpBlock (Optional) PVPs.  If given, the AmpSF PVP scales
+     *         the power and the Signal PVP flags dropouts.
+     *  \param[out] statistics Quicklook and statistics
+     *
+     *  \throw except::Exception If the channel can't be read
+     */
+    void compute(size_t channel,
+                 const PVPBlock* pvpBlock,
+                 ChannelStatistics& statistics) const;
+
+private:
+    const Wideband& mWideband;
+    const Data& mData;
+    const size_t mNumThreads;
+    size_t mVectorDecimation;
+    size_t mSampleDecimation;
+    double mMinDB;
+    double mMaxDB;
+    size_t mNumBins;
+    size_t mVectorsPerBlock;
+};
+}
+
+#endif
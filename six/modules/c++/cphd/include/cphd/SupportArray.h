@@ -213,6 +213,10 @@ struct SupportArray
     //! Get AGP support array by unique id
     AdditionalSupportArray getAddedSupportArray(const std::string& key) const;
 
+    //! Get the parameters of any type of support array by the identifier
+    //! it has in the Data section
+    SupportArrayParameter getParameter(const std::string& id) const;
+
     //! Vector of IAZ type arrays
     std::vector<SupportArrayParameter> iazArray;
 
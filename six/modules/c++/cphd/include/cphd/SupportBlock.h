@@ -23,6 +23,7 @@
 #define __CPHD_SUPPORT_BLOCK_H__
 
 #include <iostream>
+#include <memory>
 #include <string>
 #include <complex>
 #include <unordered_map>
@@ -33,8 +34,11 @@
 
 #include <mem/ScopedArray.h>
 #include <mem/BufferView.h>
+#include <sys/Mutex.h>
 
 #include <cphd/Data.h>
+#include <cphd/SupportArray.h>
+#include <cphd/TypedSupportArray.h>
 #include <cphd/Utilities.h>
 
 namespace cphd
@@ -142,7 +146,31 @@ public:
     void readAll(size_t numThreads,
                  mem::ScopedArray<sys::ubyte>& data) const;
 
+    /*
+     *  \func getTypedArray
+     *
+     *  \brief Get the specified support array decoded to doubles
+     *
+     *   The array is read and decoded on the first call and kept for
+     *   later ones.  Thread safe.
+     *
+     *  \param id unique identifier of support array
+     *  \param parameter Element format and grid of the support array
+     *   (see SupportArray::getParameter())
+     *  \param numThreads Number of threads the returned array
+     *   interpolates with.  Only used on the first call.
+     *
+     *  \return The decoded array
+     */
+    const TypedSupportArray& getTypedArray(
+            const std::string& id,
+            const SupportArrayParameter& parameter,
+            size_t numThreads = 1) const;
+
 private:
+    //! Read a support array as it is in the file
+    void readBytes(const std::string& id, sys::ubyte* data) const;
+
     //! Initialize mOffsets for each array
     // both for uncompressed and compressed data
     void initialize();
@@ -158,6 +186,12 @@ private:
     const sys::Off_T mSupportOffset;       // offset in bytes to start of SupportBlock
     const size_t mSupportSize;             // total size in bytes of SupportBlock
     std::unordered_map<std::string,sys::Off_T> mOffsets; // Offset to start of each support array
+    //! Support arrays decoded so far
+    mutable std::unordered_map<std::string,
+            std::unique_ptr<const TypedSupportArray> > mTypedArrays;
+    mutable sys::Mutex mMutex;
+    //! Guards the position of mInStream.  Taken after mMutex, never before.
+    mutable sys::Mutex mStreamMutex;
 
     friend std::ostream& operator<< (std::ostream& os, const SupportBlock& d);
 };
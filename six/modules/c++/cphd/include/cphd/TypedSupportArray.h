@@ -0,0 +1,199 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __CPHD_TYPED_SUPPORT_ARRAY_H__
+#define __CPHD_TYPED_SUPPORT_ARRAY_H__
+
+#include <string>
+#include <vector>
+
+#include <sys/Conf.h>
+#include <cphd/SupportArray.h>
+
+namespace cphd
+{
+/*
+ *  \class TypedSupportArray
+ *
+ *  \brief A support array decoded to doubles on its sample grid
+ *
+ *  Element m, n of the array sits at
+ *      X(m) = x0 + m * xSS
+ *      Y(n) = y0 + n * ySS
+ *  Each component of the element format (IAZ, or Gain and Phase of an
+ *  antenna array) is decoded once into its own row-major plane, so
+ *  interpolating one component walks one contiguous array.  Only real
+ *  numeric components (F, U and I formats) can be decoded.
+ *
+ *  Interpolation is bilinear.  Points off the grid, and cells holding a
+ *  NaN (no data), interpolate to NaN.  Batch evaluation is split across
+ *  threads; dense evaluation computes column weights once and runs a
+ *  contiguous inner loop per output row.
+ */
+class TypedSupportArray
+{
+public:
+    /*
+     *  \func TypedSupportArray
+     *  \brief Decodes a support array
+     *
+     *  \param parameter Element format and grid of the array
+     *  \param numRows Number of rows in the array
+     *  \param numCols Number of columns in the array
+     *  \param data numRows * numCols elements as they are in the file
+     *         (big endian, not byte swapped)
+     *  \param numThreads (Optional) Number of threads to interpolate with
+     *
+     *  \throw except::Exception If a component isn't a real number, the
+     *  grid spacing is zero, or the array is empty
+     */
+    TypedSupportArray(const SupportArrayParameter& parameter,
+                      size_t numRows,
+                      size_t numCols,
+                      const sys::ubyte* data,
+                      size_t numThreads = 1);
+
+    size_t getNumRows() const
+    {
+        return mNumRows;
+    }
+
+    size_t getNumCols() const
+    {
+        return mNumCols;
+    }
+
+    const SupportArrayParameter& getParameter() const
+    {
+        return mParameter;
+    }
+
+    /*
+     *  \return Names of the components, in element order.  An unnamed
+     *  format (e.g. "F4") has one component named "".
+     */
+    const std::vector<std::string>& getComponentNames() const
+    {
+        return mNames;
+    }
+
+    /*
+     *  \func getComponentIndex
+     *  \brief Look up a component once so later calls can use its index
+     *
+     *  \throw except::Exception If there's no such component
+     */
+    size_t getComponentIndex(const std::string& name) const;
+
+    //! \return Row-major plane of a component's decoded values
+    const double* getComponent(size_t component) const
+    {
+        return &mPlanes.at(component)[0];
+    }
+
+    //! \return Decoded value of one element
+    double getValue(size_t component, size_t row, size_t col) const
+    {
+        return mPlanes.at(component)[row * mNumCols + col];
+    }
+
+    /*
+     *  \func interpolate
+     *  \brief Interpolate a component at one point
+     *
+     *  \param component Component index
+     *  \param x X coordinate
+     *  \param y Y coordinate
+     *
+     *  \return Interpolated value, or NaN off the grid
+     */
+    double interpolate(size_t component, double x, double y) const;
+
+    /*
+     *  \func interpolate
+     *  \brief Interpolate a component at scattered points
+     *
+     *  \param component Component index
+     *  \param x X coordinates
+     *  \param y Y coordinates
+     *  \param numPoints Number of points
+     *  \param[out] output Interpolated values
+     */
+    void interpolate(size_t component,
+                     const double* x,
+                     const double* y,
+                     size_t numPoints,
+                     double* output) const;
+
+    /*
+     *  \func interpolateGrid
+     *  \brief Interpolate a component on a regular grid where
+     *      x[ii] = x0 + ii * deltaX
+     *      y[jj] = y0 + jj * deltaY
+     *
+     *  \param component Component index
+     *  \param x0 First X coordinate
+     *  \param deltaX X spacing
+     *  \param numX Number of X coordinates
+     *  \param y0 First Y coordinate
+     *  \param deltaY Y spacing
+     *  \param numY Number of Y coordinates
+     *  \param[out] output Row-major numX x numY values
+     */
+    void interpolateGrid(size_t component,
+                         double x0,
+                         double deltaX,
+                         size_t numX,
+                         double y0,
+                         double deltaY,
+                         size_t numY,
+                         double* output) const;
+
+    /*
+     *  Where a coordinate falls along one axis of the array: between
+     *  elements index and index + 1, weight of the second.  Off the axis,
+     *  valid is false.
+     */
+    struct AxisPosition
+    {
+        size_t index;
+        double weight;
+        bool valid;
+    };
+
+    //! \return Position of X coordinate along the rows
+    AxisPosition getRowPosition(double x) const;
+
+    //! \return Position of Y coordinate along the columns
+    AxisPosition getColPosition(double y) const;
+
+private:
+    const SupportArrayParameter mParameter;
+    const size_t mNumRows;
+    const size_t mNumCols;
+    const size_t mNumThreads;
+    std::vector<std::string> mNames;
+    std::vector<std::vector<double> > mPlanes;
+};
+}
+
+#endif
@@ -59,6 +59,20 @@ size_t getNumBytesPerSample(const SignalArrayFormat& signalArrayFormat);
  */
 void validateFormat(const std::string& format);
 
+/*
+ *  \func parseMultipleParams
+ *
+ *  \brief Parse the names and formats of multiple params
+ *
+ *  \param format A format string.
+ *   Valid binary formats are listed in CPHD 1.0 spec table 10.2, page 120
+ *
+ *  \throws except::Exception If format string is not valid binary format
+ *
+ *  \return Returns a vector of param name to param format pairs
+ */
+std::vector<std::pair<std::string,std::string> > parseMultipleParams(const std::string& format);
+
 /*
  *  \func getMultipleParamSizes
  *
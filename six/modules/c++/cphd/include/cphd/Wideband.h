@@ -23,9 +23,11 @@
 #define __CPHD_WIDEBAND_H__
 
 #include <complex>
+#include <memory>
 #include <string>
 
 #include <cphd/MetadataBase.h>
+#include <cphd/SignalCodec.h>
 #include <cphd/Utilities.h>
 
 #include <io/SeekableStreams.h>
@@ -42,6 +44,8 @@ namespace cphd
  */
 //  It contains the cphd::Data structure (for channel and vector sizes).
 //  Provides methods read wideband data from CPHD file/stream
+//  If the signal compression ID has a codec in the SignalCodecFactory,
+//  vector and sample reads of compressed channels are decompressed.
 class Wideband
 {
 public:
@@ -137,6 +141,7 @@ public:
      *   firstSample or lastSample
      *  \throw except::Exception If BufferView memory allocated is insufficient
      *  \throw except::Exception If wideband data is compressed
+     *   and no SignalCodec is registered for its compression ID
      */
     void read(size_t channel,
               size_t firstVector,
@@ -183,6 +188,7 @@ public:
      *  \throw except::Exception If invalid channel, firstVector, lastVector,
      *   firstSample or lastSample
      *  \throw except::Exception If wideband data is compressed
+     *   and no SignalCodec is registered for its compression ID
      */
     // Same as above but allocates the memory
     void read(size_t channel,
@@ -236,6 +242,7 @@ public:
      *  \throw except::Exception If scratch size is not
      * at least the bytes size of one signal array
      *  \throw except::Exception If wideband data is compressed
+     *   and no SignalCodec is registered for its compression ID
      */
     // Same as above but also applies a per-vector scale factor
     void read(size_t channel,
@@ -269,6 +276,7 @@ public:
      *  \throw except::Exception If invalid channel, firstVector, lastVector,
      *   firstSample or lastSample
      *  \throw except::Exception If wideband data is compressed
+     *   and no SignalCodec is registered for its compression ID
      */
     // Same as above but for a raw pointer
     // The pointer needs to be preallocated. Use getBufferDims for this.
@@ -310,6 +318,7 @@ public:
      * \param lastSample 0-based last sample of read request(inclusive)
      * \return Number of bytes in area
      * \throw except::Exception If wideband data is compressed
+     *   and no SignalCodec is registered for its compression ID
      */
     size_t getBytesRequiredForRead(size_t channel,
                                    size_t firstVector,
@@ -382,14 +391,28 @@ private:
     /*
      *  Just performs the read
      *  No allocation, endian swapping or scaling
+     *  Compressed data is decompressed with mCodec
      */
     void readImpl(size_t channel,
                   size_t firstVector,
                   size_t lastVector,
                   size_t firstSample,
                   size_t lastSample,
+                  size_t numThreads,
                   void* data) const;
 
+    /*
+     *  Reads the blocks holding the vectors from a channel compressed
+     *  with mCodec and decompresses the requested samples
+     */
+    void readDecompressedImpl(size_t channel,
+                              size_t firstVector,
+                              size_t lastVector,
+                              size_t firstSample,
+                              size_t lastSample,
+                              size_t numThreads,
+                              void* data) const;
+
     /*
      *  Just performs the read for compressed data
      *  No allocation, endian swapping or scaling
@@ -416,6 +439,8 @@ private:
     const size_t mElementSize;  // element size (bytes / complex sample)
 
     std::vector<sys::Off_T> mOffsets;  // Offset to start of each channel
+    // Codec for the signal compression ID, if one is registered
+    std::shared_ptr<const SignalCodec> mCodec;
 
     friend std::ostream& operator<<(std::ostream& os, const Wideband& d);
 };
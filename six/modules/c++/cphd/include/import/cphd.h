@@ -26,8 +26,11 @@
 #include <import/six.h>
 
 #include "cphd/Antenna.h"
+#include "cphd/AntennaPatternEvaluator.h"
+#include "cphd/Backprojector.h"
 #include "cphd/Channel.h"
 #include "cphd/CPHDReader.h"
+#include "cphd/CPHDSubsetter.h"
 #include "cphd/CPHDWriter.h"
 #include "cphd/CPHDXMLControl.h"
 #include "cphd/CPHDXMLParser.h"
@@ -43,10 +46,14 @@
 #include "cphd/PVP.h"
 #include "cphd/PVPBlock.h"
 #include "cphd/ReferenceGeometry.h"
+#include "cphd/ReferenceGeometryCalculator.h"
 #include "cphd/SceneCoordinates.h"
+#include "cphd/SignalCodec.h"
+#include "cphd/SignalStatistics.h"
 #include "cphd/SupportArray.h"
 #include "cphd/SupportBlock.h"
 #include "cphd/TxRcv.h"
+#include "cphd/TypedSupportArray.h"
 #include "cphd/Types.h"
 #include "cphd/Utilities.h"
 #include "cphd/Wideband.h"
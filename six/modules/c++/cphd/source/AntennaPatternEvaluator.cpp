@@ -0,0 +1,421 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <except/Exception.h>
+#include <scene/RangeRunnable.h>
+#include <six/Init.h>
+#include <cphd/AntennaPatternEvaluator.h>
+
+namespace
+{
+typedef cphd::AntennaPatternEvaluator::Frame Frame;
+typedef cphd::AntennaPatternEvaluator::Pattern Pattern;
+
+mem::SharedPtr<const six::Poly2DEvaluator> flatten(const cphd::Poly2D& poly)
+{
+    mem::SharedPtr<const six::Poly2DEvaluator> evaluator;
+    if (!poly.empty())
+    {
+        evaluator.reset(new six::Poly2DEvaluator(poly));
+    }
+    return evaluator;
+}
+
+double evaluate(const cphd::Poly1D& poly, double x)
+{
+    return poly.empty() ? 0.0 : poly(x);
+}
+
+// Scene points as separate contiguous columns
+struct Points
+{
+    explicit Points(const cphd::Vector3* points, size_t numPoints) :
+        x(numPoints),
+        y(numPoints),
+        z(numPoints)
+    {
+        for (size_t ii = 0; ii < numPoints; ++ii)
+        {
+            x[ii] = points[ii][0];
+            y[ii] = points[ii][1];
+            z[ii] = points[ii][2];
+        }
+    }
+
+    size_t size() const
+    {
+        return x.size();
+    }
+
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> z;
+};
+
+// Add a polynomial's values at the points to output
+void accumulate(const six::Poly2DEvaluator* poly,
+                const std::vector<double>& x,
+                const std::vector<double>& y,
+                std::vector<double>& scratch,
+                double* output)
+{
+    if (poly && !x.empty())
+    {
+        poly->evaluate(&x[0], &y[0], x.size(), &scratch[0]);
+        for (size_t ii = 0; ii < x.size(); ++ii)
+        {
+            output[ii] += scratch[ii];
+        }
+    }
+}
+
+// One antenna over a range of vectors.  If add is set, the values are
+// added to what's already in the outputs (the receive half of two-way).
+struct OneWayJob
+{
+    const Frame* frame;
+    const Pattern* pattern;
+    const double* time;
+    const cphd::Vector3* position;
+    const double* frequency;
+    const Points* points;
+    double* gain;
+    double* phase;
+    bool add;
+
+    void operator()(size_t start, size_t num) const
+    {
+        const size_t numPoints = points->size();
+        std::vector<double> dcx(numPoints);
+        std::vector<double> dcy(numPoints);
+        std::vector<double> steeredX(numPoints);
+        std::vector<double> steeredY(numPoints);
+        std::vector<double> scratch(numPoints);
+
+        for (size_t vector = start; vector < start + num; ++vector)
+        {
+            const double t = time[vector];
+            const cphd::Vector3 uX = (*frame->xAxis)(t).unit();
+            const cphd::Vector3 uY = (*frame->yAxis)(t).unit();
+            const cphd::Vector3& apc = position[vector];
+
+            const double f0 = pattern->freqZero;
+            const double f = frequency ? frequency[vector] : f0;
+            double dcxEB = evaluate(pattern->dcxPoly, t);
+            double dcyEB = evaluate(pattern->dcyPoly, t);
+            if (pattern->ebFreqShift)
+            {
+                dcxEB *= f0 / f;
+                dcyEB *= f0 / f;
+            }
+            const double dilation = pattern->mlFreqDilation ? f / f0 : 1.0;
+
+            for (size_t ii = 0; ii < numPoints; ++ii)
+            {
+                const double dx = points->x[ii] - apc[0];
+                const double dy = points->y[ii] - apc[1];
+                const double dz = points->z[ii] - apc[2];
+                const double scale =
+                        1.0 / std::sqrt(dx * dx + dy * dy + dz * dz);
+                dcx[ii] = (dx * uX[0] + dy * uX[1] + dz * uX[2]) * scale;
+                dcy[ii] = (dx * uY[0] + dy * uY[1] + dz * uY[2]) * scale;
+                steeredX[ii] = dilation * (dcx[ii] - dcxEB);
+                steeredY[ii] = dilation * (dcy[ii] - dcyEB);
+            }
+
+            double* const gainRow = gain + vector * numPoints;
+            const double boresight = pattern->gainZero +
+                    evaluate(pattern->gainBSPoly, f - f0);
+            for (size_t ii = 0; ii < numPoints; ++ii)
+            {
+                gainRow[ii] = add ? gainRow[ii] + boresight : boresight;
+            }
+            accumulate(pattern->arrayGain.get(), steeredX, steeredY,
+                       scratch, gainRow);
+            accumulate(pattern->elementGain.get(), dcx, dcy,
+                       scratch, gainRow);
+
+            if (phase)
+            {
+                double* const phaseRow = phase + vector * numPoints;
+                if (!add)
+                {
+                    std::fill(phaseRow, phaseRow + numPoints, 0.0);
+                }
+                accumulate(pattern->arrayPhase.get(), steeredX, steeredY,
+                           scratch, phaseRow);
+                accumulate(pattern->elementPhase.get(), dcx, dcy,
+                           scratch, phaseRow);
+            }
+        }
+    }
+};
+
+struct TwoWayJob
+{
+    OneWayJob tx;
+    OneWayJob rcv;
+
+    void operator()(size_t start, size_t num) const
+    {
+        tx(start, num);
+        rcv(start, num);
+    }
+};
+
+// The PVP columns a channel needs
+struct ChannelColumns
+{
+    ChannelColumns(const cphd::PVPBlock& pvpBlock, size_t channel) :
+        txTime(pvpBlock.getNumVectors(channel)),
+        txPos(txTime.size()),
+        rcvTime(txTime.size()),
+        rcvPos(txTime.size()),
+        frequency(txTime.size())
+    {
+        for (size_t ii = 0; ii < txTime.size(); ++ii)
+        {
+            txTime[ii] = pvpBlock.getTxTime(channel, ii);
+            txPos[ii] = pvpBlock.getTxPos(channel, ii);
+            rcvTime[ii] = pvpBlock.getRcvTime(channel, ii);
+            rcvPos[ii] = pvpBlock.getRcvPos(channel, ii);
+            frequency[ii] = 0.5 * (pvpBlock.getFx1(channel, ii) +
+                                   pvpBlock.getFx2(channel, ii));
+        }
+    }
+
+    std::vector<double> txTime;
+    std::vector<cphd::Vector3> txPos;
+    std::vector<double> rcvTime;
+    std::vector<cphd::Vector3> rcvPos;
+    std::vector<double> frequency;
+};
+
+// Each channel's transmit and receive frame and pattern
+struct ChannelAntennas
+{
+    const Frame* txFrame;
+    const Pattern* txPattern;
+    const Frame* rcvFrame;
+    const Pattern* rcvPattern;
+};
+
+struct ChannelsJob
+{
+    const std::vector<ChannelAntennas>* antennas;
+    const cphd::PVPBlock* pvpBlock;
+    const Points* points;
+    std::vector<std::vector<double> >* gain;
+    std::vector<std::vector<double> >* phase;
+
+    void operator()(size_t start, size_t num) const
+    {
+        for (size_t channel = start; channel < start + num; ++channel)
+        {
+            const ChannelColumns columns(*pvpBlock, channel);
+            const size_t numVectors = columns.txTime.size();
+            (*gain)[channel].resize(numVectors * points->size());
+            (*phase)[channel].resize(numVectors * points->size());
+            if ((*gain)[channel].empty())
+            {
+                continue;
+            }
+
+            const ChannelAntennas& channelAntennas = (*antennas)[channel];
+            const OneWayJob tx = {
+                    channelAntennas.txFrame, channelAntennas.txPattern,
+                    &columns.txTime[0], &columns.txPos[0],
+                    &columns.frequency[0], points,
+                    &(*gain)[channel][0], &(*phase)[channel][0], false };
+            const OneWayJob rcv = {
+                    channelAntennas.rcvFrame, channelAntennas.rcvPattern,
+                    &columns.rcvTime[0], &columns.rcvPos[0],
+                    &columns.frequency[0], points,
+                    &(*gain)[channel][0], &(*phase)[channel][0], true };
+            const TwoWayJob job = { tx, rcv };
+            job(0, numVectors);
+        }
+    }
+};
+}
+
+namespace cphd
+{
+AntennaPatternEvaluator::AntennaPatternEvaluator(const Metadata& metadata,
+                                                 size_t numThreads) :
+    mNumThreads(numThreads)
+{
+    if (!metadata.antenna.get())
+    {
+        throw except::Exception(Ctxt("The metadata has no Antenna"));
+    }
+    const Antenna& antenna = *metadata.antenna;
+
+    for (size_t ii = 0; ii < antenna.antCoordFrame.size(); ++ii)
+    {
+        const AntCoordFrame& acf = antenna.antCoordFrame[ii];
+        Frame& frame = mFrames[acf.identifier];
+        frame.xAxis.reset(new six::PolyXYZEvaluator(acf.xAxisPoly));
+        frame.yAxis.reset(new six::PolyXYZEvaluator(acf.yAxisPoly));
+    }
+
+    for (size_t ii = 0; ii < antenna.antPhaseCenter.size(); ++ii)
+    {
+        const AntPhaseCenter& apc = antenna.antPhaseCenter[ii];
+        if (mFrames.find(apc.acfId) == mFrames.end())
+        {
+            throw except::Exception(Ctxt("APC " + apc.identifier +
+                                         " refers to unknown ACF " +
+                                         apc.acfId));
+        }
+        mAPCs[apc.identifier] = apc.acfId;
+    }
+
+    for (size_t ii = 0; ii < antenna.antPattern.size(); ++ii)
+    {
+        const AntPattern& apat = antenna.antPattern[ii];
+        Pattern& pattern = mPatterns[apat.identifier];
+        pattern.freqZero = apat.freqZero;
+        pattern.gainZero = six::Init::isUndefined(apat.gainZero) ?
+                0.0 : apat.gainZero;
+        pattern.ebFreqShift = apat.ebFreqShift == six::BooleanType::IS_TRUE;
+        pattern.mlFreqDilation =
+                apat.mlFreqDilation == six::BooleanType::IS_TRUE;
+        pattern.gainBSPoly = apat.gainBSPoly;
+        pattern.dcxPoly = apat.eb.dcxPoly;
+        pattern.dcyPoly = apat.eb.dcyPoly;
+        pattern.arrayGain = flatten(apat.array.gainPoly);
+        pattern.arrayPhase = flatten(apat.array.phasePoly);
+        pattern.elementGain = flatten(apat.element.gainPoly);
+        pattern.elementPhase = flatten(apat.element.phasePoly);
+    }
+
+    mChannels.resize(metadata.channel.parameters.size());
+    for (size_t ii = 0; ii < mChannels.size(); ++ii)
+    {
+        if (metadata.channel.parameters[ii].antenna.get())
+        {
+            mChannels[ii] = *metadata.channel.parameters[ii].antenna;
+        }
+    }
+}
+
+const AntennaPatternEvaluator::Frame&
+AntennaPatternEvaluator::getFrame(const std::string& apcId) const
+{
+    const std::map<std::string, std::string>::const_iterator apc =
+            mAPCs.find(apcId);
+    if (apc == mAPCs.end())
+    {
+        throw except::Exception(Ctxt("No APC with identifier '" +
+                                     apcId + "'"));
+    }
+    return mFrames.find(apc->second)->second;
+}
+
+const AntennaPatternEvaluator::Pattern&
+AntennaPatternEvaluator::getPattern(const std::string& apatId) const
+{
+    const std::map<std::string, Pattern>::const_iterator pattern =
+            mPatterns.find(apatId);
+    if (pattern == mPatterns.end())
+    {
+        throw except::Exception(Ctxt("No antenna pattern with identifier '" +
+                                     apatId + "'"));
+    }
+    return pattern->second;
+}
+
+void AntennaPatternEvaluator::evaluateOneWay(const std::string& apcId,
+                                             const std::string& apatId,
+                                             const double* time,
+                                             const Vector3* position,
+                                             const double* frequency,
+                                             size_t numVectors,
+                                             const Vector3* points,
+                                             size_t numPoints,
+                                             double* gain,
+                                             double* phase) const
+{
+    const Points columns(points, numPoints);
+    const OneWayJob job = { &getFrame(apcId), &getPattern(apatId),
+                            time, position, frequency, &columns,
+                            gain, phase, false };
+    scene::runInParallel(job, numVectors, mNumThreads);
+}
+
+void AntennaPatternEvaluator::evaluate(size_t channel,
+                                       const double* txTime,
+                                       const Vector3* txPos,
+                                       const double* rcvTime,
+                                       const Vector3* rcvPos,
+                                       const double* frequency,
+                                       size_t numVectors,
+                                       const Vector3* points,
+                                       size_t numPoints,
+                                       double* gain,
+                                       double* phase) const
+{
+    const ChannelParameter::Antenna& antenna = mChannels.at(channel);
+    const Points columns(points, numPoints);
+    const OneWayJob tx = { &getFrame(antenna.txAPCId),
+                           &getPattern(antenna.txAPATId),
+                           txTime, txPos, frequency, &columns,
+                           gain, phase, false };
+    const OneWayJob rcv = { &getFrame(antenna.rcvAPCId),
+                            &getPattern(antenna.rcvAPATId),
+                            rcvTime, rcvPos, frequency, &columns,
+                            gain, phase, true };
+    const TwoWayJob job = { tx, rcv };
+    scene::runInParallel(job, numVectors, mNumThreads);
+}
+
+void AntennaPatternEvaluator::evaluate(
+        const PVPBlock& pvpBlock,
+        const std::vector<Vector3>& points,
+        std::vector<std::vector<double> >& gain,
+        std::vector<std::vector<double> >& phase) const
+{
+    // Look everything up first so a bad channel throws here rather than
+    // in a thread
+    const size_t numChannels = pvpBlock.getNumChannels();
+    std::vector<ChannelAntennas> antennas(numChannels);
+    for (size_t ii = 0; ii < numChannels; ++ii)
+    {
+        const ChannelParameter::Antenna& antenna = mChannels.at(ii);
+        antennas[ii].txFrame = &getFrame(antenna.txAPCId);
+        antennas[ii].txPattern = &getPattern(antenna.txAPATId);
+        antennas[ii].rcvFrame = &getFrame(antenna.rcvAPCId);
+        antennas[ii].rcvPattern = &getPattern(antenna.rcvAPATId);
+    }
+
+    const Points columns(points.empty() ? nullptr : &points[0], points.size());
+    gain.resize(numChannels);
+    phase.resize(numChannels);
+    const ChannelsJob job = { &antennas, &pvpBlock, &columns,
+                              &gain, &phase };
+    scene::runInParallel(job, numChannels, mNumThreads);
+}
+}
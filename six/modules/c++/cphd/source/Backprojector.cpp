@@ -0,0 +1,633 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <except/Exception.h>
+#include <math/Constants.h>
+#include <math/linear/Vector.h>
+#include <math/poly/Fit.h>
+#include <scene/RangeRunnable.h>
+#include <scene/Utilities.h>
+#include <six/Container.h>
+#include <six/NITFWriteControl.h>
+#include <six/XMLControlFactory.h>
+#include <six/sicd/ComplexXMLControl.h>
+#include <cphd/Backprojector.h>
+
+namespace
+{
+const double SPEED_OF_LIGHT = math::Constants::SPEED_OF_LIGHT_METERS_PER_SEC;
+
+size_t nextPowerOfTwo(size_t value)
+{
+    size_t result = 1;
+    while (result < value)
+    {
+        result <<= 1;
+    }
+    return result;
+}
+
+// In-place radix-2 FFT of a power of two number of samples, with the given
+// sign in the exponent
+void fft(std::vector<std::complex<double> >& data, int sign)
+{
+    const size_t size = data.size();
+    for (size_t ii = 1, jj = 0; ii < size; ++ii)
+    {
+        size_t bit = size >> 1;
+        for (; jj & bit; bit >>= 1)
+        {
+            jj ^= bit;
+        }
+        jj ^= bit;
+        if (ii < jj)
+        {
+            std::swap(data[ii], data[jj]);
+        }
+    }
+
+    for (size_t length = 2; length <= size; length <<= 1)
+    {
+        const double angle = sign * 2.0 * M_PI / length;
+        const std::complex<double> step(std::cos(angle), std::sin(angle));
+        for (size_t start = 0; start < size; start += length)
+        {
+            std::complex<double> twiddle(1.0, 0.0);
+            for (size_t ii = 0; ii < length / 2; ++ii)
+            {
+                const std::complex<double> even = data[start + ii];
+                const std::complex<double> odd =
+                        data[start + ii + length / 2] * twiddle;
+                data[start + ii] = even + odd;
+                data[start + ii + length / 2] = even - odd;
+                twiddle *= step;
+            }
+        }
+    }
+}
+
+// A vector's range profile and what's needed to backproject it.  The
+// profile sample at dTOA is at (dTOA - origin) * rate.
+struct Profile
+{
+    bool valid;
+    cphd::Vector3 txPos;
+    cphd::Vector3 rcvPos;
+    double srpRange;      // |TxPos - SRP| + |RcvPos - SRP|
+    double toa1;
+    double toa2;
+    double origin;
+    double rate;
+    bool periodic;
+    double carrier;
+    const std::complex<float>* samples;
+    size_t length;
+};
+
+// Make the profiles of a range of vectors of a block
+struct ProfileJob
+{
+    const cphd::PVPBlock* pvpBlock;
+    size_t channel;
+    size_t firstVector;
+    size_t numSamples;
+    bool fxDomain;
+    int sgn;
+    size_t fftSize;
+    const std::complex<float>* signal;
+    std::complex<float>* buffer;
+    Profile* profiles;
+
+    void operator()(size_t start, size_t num) const
+    {
+        std::vector<std::complex<double> > work(fftSize);
+        const size_t center = numSamples / 2;
+        for (size_t ii = start; ii < start + num; ++ii)
+        {
+            const size_t vector = firstVector + ii;
+            Profile& profile = profiles[ii];
+            profile.valid = !pvpBlock->hasSignal() ||
+                    pvpBlock->getSignal(channel, vector) != 0;
+            profile.txPos = pvpBlock->getTxPos(channel, vector);
+            profile.rcvPos = pvpBlock->getRcvPos(channel, vector);
+            const cphd::Vector3 srp = pvpBlock->getSRPPos(channel, vector);
+            profile.srpRange = (profile.txPos - srp).norm() +
+                    (profile.rcvPos - srp).norm();
+            profile.toa1 = pvpBlock->getTOA1(channel, vector);
+            profile.toa2 = pvpBlock->getTOA2(channel, vector);
+
+            const double sc0 = pvpBlock->getSC0(channel, vector);
+            const double scss = pvpBlock->getSCSS(channel, vector);
+            const std::complex<float>* const samples =
+                    signal + ii * numSamples;
+            if (fxDomain)
+            {
+                // Center the band at DC so the profile is smooth enough
+                // to interpolate linearly
+                std::fill(work.begin(), work.end(),
+                          std::complex<double>(0.0, 0.0));
+                for (size_t jj = 0; jj < numSamples; ++jj)
+                {
+                    work[(jj + fftSize - center) % fftSize] =
+                            std::complex<double>(samples[jj]);
+                }
+                fft(work, -sgn);
+
+                std::complex<float>* const out = buffer + ii * fftSize;
+                for (size_t jj = 0; jj < fftSize; ++jj)
+                {
+                    out[jj] = std::complex<float>(work[jj]);
+                }
+                profile.samples = out;
+                profile.length = fftSize;
+                profile.origin = 0.0;
+                profile.rate = fftSize * scss;
+                profile.periodic = true;
+                profile.carrier = sc0 + center * scss;
+            }
+            else
+            {
+                profile.samples = samples;
+                profile.length = numSamples;
+                profile.origin = sc0;
+                profile.rate = 1.0 / scss;
+                profile.periodic = false;
+                profile.carrier = 0.5 * (pvpBlock->getFx1(channel, vector) +
+                                         pvpBlock->getFx2(channel, vector));
+            }
+        }
+    }
+};
+
+// Backproject every profile into a range of tiles
+struct TileJob
+{
+    const cphd::Backprojector* backprojector;
+    const Profile* profiles;
+    size_t numProfiles;
+    int sgn;
+    size_t tileSize;
+    size_t numTileCols;
+    size_t numRows;
+    size_t numCols;
+    std::complex<float>* image;
+
+    void operator()(size_t start, size_t num) const
+    {
+        std::vector<double> x(tileSize);
+        std::vector<double> y(tileSize);
+        std::vector<double> z(tileSize);
+        std::vector<double> dtoa(tileSize);
+
+        const cphd::Vector3 origin = backprojector->getPixelPosition(0, 0);
+        const cphd::Vector3 rowStep =
+                backprojector->getPixelPosition(1, 0) - origin;
+        const cphd::Vector3 colStep =
+                backprojector->getPixelPosition(0, 1) - origin;
+
+        for (size_t tile = start; tile < start + num; ++tile)
+        {
+            const size_t row0 = (tile / numTileCols) * tileSize;
+            const size_t col0 = (tile % numTileCols) * tileSize;
+            const size_t rowEnd = std::min(row0 + tileSize, numRows);
+            const size_t width = std::min(col0 + tileSize, numCols) - col0;
+
+            for (size_t pp = 0; pp < numProfiles; ++pp)
+            {
+                const Profile& profile = profiles[pp];
+                if (!profile.valid)
+                {
+                    continue;
+                }
+                const cphd::Vector3& tx = profile.txPos;
+                const cphd::Vector3& rcv = profile.rcvPos;
+                const double phaseScale =
+                        -2.0 * M_PI * sgn * profile.carrier;
+
+                for (size_t row = row0; row < rowEnd; ++row)
+                {
+                    const cphd::Vector3 first =
+                            origin + rowStep * static_cast<double>(row) +
+                            colStep * static_cast<double>(col0);
+                    for (size_t cc = 0; cc < width; ++cc)
+                    {
+                        x[cc] = first[0] + cc * colStep[0];
+                        y[cc] = first[1] + cc * colStep[1];
+                        z[cc] = first[2] + cc * colStep[2];
+                    }
+                    for (size_t cc = 0; cc < width; ++cc)
+                    {
+                        const double txX = tx[0] - x[cc];
+                        const double txY = tx[1] - y[cc];
+                        const double txZ = tx[2] - z[cc];
+                        const double rcvX = rcv[0] - x[cc];
+                        const double rcvY = rcv[1] - y[cc];
+                        const double rcvZ = rcv[2] - z[cc];
+                        dtoa[cc] = (std::sqrt(txX * txX + txY * txY +
+                                              txZ * txZ) +
+                                    std::sqrt(rcvX * rcvX + rcvY * rcvY +
+                                              rcvZ * rcvZ) -
+                                    profile.srpRange) / SPEED_OF_LIGHT;
+                    }
+
+                    std::complex<float>* const out =
+                            image + row * numCols + col0;
+                    for (size_t cc = 0; cc < width; ++cc)
+                    {
+                        const double dt = dtoa[cc];
+                        if (!(dt >= profile.toa1 && dt <= profile.toa2))
+                        {
+                            continue;
+                        }
+                        double position = (dt - profile.origin) * profile.rate;
+                        if (profile.periodic)
+                        {
+                            position -= std::floor(position / profile.length) *
+                                    profile.length;
+                        }
+                        else if (!(position >= 0.0 &&
+                                   position <= profile.length - 1))
+                        {
+                            continue;
+                        }
+                        size_t index = static_cast<size_t>(position);
+                        if (index >= profile.length)
+                        {
+                            index = profile.length - 1;
+                        }
+                        const size_t next = index + 1 < profile.length ?
+                                index + 1 : (profile.periodic ? 0 : index);
+                        const float weight =
+                                static_cast<float>(position - index);
+                        const std::complex<float> value =
+                                profile.samples[index] + weight *
+                                (profile.samples[next] -
+                                 profile.samples[index]);
+                        const double phase = phaseScale * dt;
+                        out[cc] += value * std::complex<float>(
+                                static_cast<float>(std::cos(phase)),
+                                static_cast<float>(std::sin(phase)));
+                    }
+                }
+            }
+        }
+    }
+};
+
+}
+
+namespace cphd
+{
+Backprojector::Backprojector(const Metadata& metadata,
+                             const PVPBlock& pvpBlock,
+                             size_t numThreads) :
+    mMetadata(metadata),
+    mPVPBlock(pvpBlock),
+    mNumThreads(numThreads),
+    mOversample(4),
+    mTileSize(64),
+    mVectorsPerBlock(256)
+{
+    const ReferenceSurface& surface =
+            mMetadata.sceneCoordinates.referenceSurface;
+    if (!surface.planar.get())
+    {
+        throw except::Exception(Ctxt(
+                "Backprojection needs a planar reference surface"));
+    }
+    mUIAX = surface.planar->uIax.unit();
+    mUIAY = surface.planar->uIay.unit();
+    setGrid();
+}
+
+void Backprojector::setOversample(size_t oversample)
+{
+    mOversample = std::max<size_t>(oversample, 1);
+}
+
+void Backprojector::setTileSize(size_t tileSize)
+{
+    mTileSize = std::max<size_t>(tileSize, 1);
+}
+
+void Backprojector::setVectorsPerBlock(size_t vectorsPerBlock)
+{
+    mVectorsPerBlock = std::max<size_t>(vectorsPerBlock, 1);
+}
+
+void Backprojector::getSupport(size_t channel,
+                               double& minKX,
+                               double& maxKX,
+                               double& minKY,
+                               double& maxKY) const
+{
+    minKX = minKY = std::numeric_limits<double>::max();
+    maxKX = maxKY = -std::numeric_limits<double>::max();
+    const Vector3& iarp = mMetadata.sceneCoordinates.iarp.ecf;
+    for (size_t ii = 0; ii < mPVPBlock.getNumVectors(channel); ++ii)
+    {
+        // Spatial frequency points from the APCs toward the scene, as in
+        // SICD
+        const Vector3 direction =
+                ((iarp - mPVPBlock.getTxPos(channel, ii)).unit() +
+                 (iarp - mPVPBlock.getRcvPos(channel, ii)).unit()) /
+                SPEED_OF_LIGHT;
+        const double dirX = direction.dot(mUIAX);
+        const double dirY = direction.dot(mUIAY);
+        const double fx1 = mPVPBlock.getFx1(channel, ii);
+        const double fx2 = mPVPBlock.getFx2(channel, ii);
+        minKX = std::min(minKX, std::min(fx1 * dirX, fx2 * dirX));
+        maxKX = std::max(maxKX, std::max(fx1 * dirX, fx2 * dirX));
+        minKY = std::min(minKY, std::min(fx1 * dirY, fx2 * dirY));
+        maxKY = std::max(maxKY, std::max(fx1 * dirY, fx2 * dirY));
+    }
+}
+
+void Backprojector::setGrid()
+{
+    const SceneCoordinates& scene = mMetadata.sceneCoordinates;
+    double firstLine;
+    double firstSample;
+    double iarpLine;
+    double iarpSample;
+    if (scene.imageGrid.get())
+    {
+        const ImageGrid& grid = *scene.imageGrid;
+        mRowSpacing = grid.xExtent.lineSpacing;
+        mColSpacing = grid.yExtent.sampleSpacing;
+        mNumRows = grid.xExtent.numLines;
+        mNumCols = grid.yExtent.numSamples;
+        firstLine = grid.xExtent.firstLine;
+        firstSample = grid.yExtent.firstSample;
+        iarpLine = grid.iarpLocation.line;
+        iarpSample = grid.iarpLocation.sample;
+    }
+    else
+    {
+        double bandwidthX = 0.0;
+        double bandwidthY = 0.0;
+        for (size_t ii = 0; ii < mPVPBlock.getNumChannels(); ++ii)
+        {
+            if (mPVPBlock.getNumVectors(ii) == 0)
+            {
+                continue;
+            }
+            double minKX, maxKX, minKY, maxKY;
+            getSupport(ii, minKX, maxKX, minKY, maxKY);
+            bandwidthX = std::max(bandwidthX, maxKX - minKX);
+            bandwidthY = std::max(bandwidthY, maxKY - minKY);
+        }
+        if (bandwidthX <= 0.0 || bandwidthY <= 0.0)
+        {
+            throw except::Exception(Ctxt(
+                    "Can't size the image grid without spatial frequency "
+                    "support in both directions; add an ImageGrid"));
+        }
+        mRowSpacing = 1.0 / (1.5 * bandwidthX);
+        mColSpacing = 1.0 / (1.5 * bandwidthY);
+
+        const AreaType& area = scene.imageArea;
+        firstLine = std::floor(area.x1y1[0] / mRowSpacing);
+        firstSample = std::floor(area.x1y1[1] / mColSpacing);
+        mNumRows = static_cast<size_t>(
+                std::ceil(area.x2y2[0] / mRowSpacing) - firstLine) + 1;
+        mNumCols = static_cast<size_t>(
+                std::ceil(area.x2y2[1] / mColSpacing) - firstSample) + 1;
+        iarpLine = 0.0;
+        iarpSample = 0.0;
+    }
+
+    mRowStep = mUIAX * mRowSpacing;
+    mColStep = mUIAY * mColSpacing;
+    mOrigin = scene.iarp.ecf + mRowStep * (firstLine - iarpLine) +
+            mColStep * (firstSample - iarpSample);
+    mSCPPixel.row = static_cast<int>(std::floor(iarpLine - firstLine + 0.5));
+    mSCPPixel.col = static_cast<int>(
+            std::floor(iarpSample - firstSample + 0.5));
+}
+
+void Backprojector::backproject(size_t channel,
+                                size_t firstVector,
+                                size_t numVectors,
+                                const std::complex<float>* signal,
+                                std::complex<float>* image) const
+{
+    if (numVectors == 0)
+    {
+        return;
+    }
+
+    const size_t numSamples = mMetadata.data.getNumSamples(channel);
+    const bool fxDomain = mMetadata.global.getDomainType() == DomainType::FX;
+    const int sgn = mMetadata.global.sgn == PhaseSGN::PLUS_1 ? 1 : -1;
+    const size_t fftSize = fxDomain ?
+            nextPowerOfTwo(numSamples * mOversample) : 0;
+
+    std::vector<Profile> profiles(numVectors);
+    std::vector<std::complex<float> > buffer(numVectors * fftSize);
+    const ProfileJob profileJob = { &mPVPBlock, channel, firstVector,
+                                    numSamples, fxDomain, sgn, fftSize,
+                                    signal,
+                                    buffer.empty() ? nullptr : &buffer[0],
+                                    &profiles[0] };
+    scene::runInParallel(profileJob, numVectors, mNumThreads);
+
+    const size_t numTileRows = (mNumRows + mTileSize - 1) / mTileSize;
+    const size_t numTileCols = (mNumCols + mTileSize - 1) / mTileSize;
+    const TileJob tileJob = { this, &profiles[0], numVectors, sgn,
+                              mTileSize, numTileCols, mNumRows, mNumCols,
+                              image };
+    scene::runInParallel(tileJob, numTileRows * numTileCols, mNumThreads);
+}
+
+void Backprojector::formImage(const Wideband& wideband,
+                              size_t channel,
+                              std::complex<float>* image) const
+{
+    std::fill(image, image + mNumRows * mNumCols,
+              std::complex<float>(0.0f, 0.0f));
+
+    const size_t numVectors = mMetadata.data.getNumVectors(channel);
+    const size_t numSamples = mMetadata.data.getNumSamples(channel);
+    const size_t blockSize = std::min(mVectorsPerBlock, numVectors);
+    std::vector<std::complex<float> > signal(blockSize * numSamples);
+    std::vector<sys::ubyte> scratch(signal.size() * sizeof(signal[0]));
+
+    for (size_t first = 0; first < numVectors; first += blockSize)
+    {
+        const size_t count = std::min(blockSize, numVectors - first);
+        std::vector<double> scaleFactors(count, 1.0);
+        if (mPVPBlock.hasAmpSF())
+        {
+            for (size_t ii = 0; ii < count; ++ii)
+            {
+                scaleFactors[ii] = mPVPBlock.getAmpSF(channel, first + ii);
+            }
+        }
+        wideband.read(channel, first, first + count - 1, 0, Wideband::ALL,
+                      scaleFactors, mNumThreads,
+                      mem::BufferView<sys::ubyte>(&scratch[0],
+                                                  scratch.size()),
+                      mem::BufferView<std::complex<float> >(&signal[0],
+                                                            signal.size()));
+        backproject(channel, first, count, &signal[0], image);
+    }
+}
+
+std::auto_ptr<six::sicd::ComplexData>
+Backprojector::createComplexData(size_t channel) const
+{
+    const size_t numVectors = mPVPBlock.getNumVectors(channel);
+    if (numVectors < 2)
+    {
+        throw except::Exception(Ctxt(
+                "Need at least two vectors to describe the collection"));
+    }
+
+    std::auto_ptr<six::sicd::ComplexData> data(
+            new six::sicd::ComplexData());
+    *data->collectionInformation = mMetadata.collectionID;
+    data->setPixelType(six::PixelType::RE32F_IM32F);
+    data->setNumRows(mNumRows);
+    data->setNumCols(mNumCols);
+    data->imageData->scpPixel = six::RowColInt(mSCPPixel.row, mSCPPixel.col);
+
+    // Times are relative to the collection start in both
+    math::linear::Vector<double> times(numVectors);
+    math::linear::Vector<double> arpX(numVectors);
+    math::linear::Vector<double> arpY(numVectors);
+    math::linear::Vector<double> arpZ(numVectors);
+    double txTimeMin = std::numeric_limits<double>::max();
+    double txTimeMax = -std::numeric_limits<double>::max();
+    double fxMin = std::numeric_limits<double>::max();
+    double fxMax = -std::numeric_limits<double>::max();
+    for (size_t ii = 0; ii < numVectors; ++ii)
+    {
+        const double txTime = mPVPBlock.getTxTime(channel, ii);
+        times[ii] = 0.5 * (txTime + mPVPBlock.getRcvTime(channel, ii));
+        const Vector3 arp = (mPVPBlock.getTxPos(channel, ii) +
+                             mPVPBlock.getRcvPos(channel, ii)) * 0.5;
+        arpX[ii] = arp[0];
+        arpY[ii] = arp[1];
+        arpZ[ii] = arp[2];
+        txTimeMin = std::min(txTimeMin, txTime);
+        txTimeMax = std::max(txTimeMax, txTime);
+        fxMin = std::min(fxMin, mPVPBlock.getFx1(channel, ii));
+        fxMax = std::max(fxMax, mPVPBlock.getFx2(channel, ii));
+    }
+    data->position->arpPoly = math::poly::fit(
+            times, arpX, arpY, arpZ, std::min<size_t>(5, numVectors - 1));
+
+    data->timeline->collectStart = mMetadata.global.timeline.collectionStart;
+    data->timeline->collectDuration = times[numVectors - 1] - times[0];
+
+    data->radarCollection->txFrequencyMin = mMetadata.global.fxBand.fxMin;
+    data->radarCollection->txFrequencyMax = mMetadata.global.fxBand.fxMax;
+
+    six::sicd::ImageFormation& formation = *data->imageFormation;
+    formation.rcvChannelProcessed.reset(
+            new six::sicd::RcvChannelProcessed());
+    formation.rcvChannelProcessed->numChannelsProcessed = 1;
+    formation.rcvChannelProcessed->prfScaleFactor = 1.0;
+    formation.rcvChannelProcessed->channelIndex.push_back(
+            static_cast<int>(channel + 1));
+    formation.imageFormationAlgorithm = six::ImageFormationType::OTHER;
+    formation.tStartProc = txTimeMin;
+    formation.tEndProc = txTimeMax;
+    formation.txFrequencyProcMin = fxMin;
+    formation.txFrequencyProcMax = fxMax;
+    formation.slowTimeBeamCompensation =
+            six::SlowTimeBeamCompensationType::NO;
+    formation.imageBeamCompensation = six::ImageBeamCompensationType::NO;
+    formation.azimuthAutofocus = six::AutofocusType::NO;
+    formation.rangeAutofocus = six::AutofocusType::NO;
+
+    // A scatterer's pixels go as exp(-j 2 pi SGN K . x), so the DFT that
+    // takes the image back to spatial frequency has the sign of SGN
+    const int sgn = mMetadata.global.sgn == PhaseSGN::PLUS_1 ? 1 : -1;
+    double minKX, maxKX, minKY, maxKY;
+    getSupport(channel, minKX, maxKX, minKY, maxKY);
+
+    six::sicd::Grid& grid = *data->grid;
+    grid.imagePlane = six::ComplexImagePlaneType::OTHER;
+    grid.type = six::ComplexImageGridType::PLANE;
+    grid.timeCOAPoly = six::Poly2D(0, 0);
+    grid.timeCOAPoly[0][0] = 0.5 * (times[0] + times[numVectors - 1]);
+
+    six::sicd::DirectionParameters* const directions[] =
+            { grid.row.get(), grid.col.get() };
+    const Vector3 unitVectors[] = { mUIAX, mUIAY };
+    const double spacings[] = { mRowSpacing, mColSpacing };
+    const double minK[] = { minKX, minKY };
+    const double maxK[] = { maxKX, maxKY };
+    for (size_t ii = 0; ii < 2; ++ii)
+    {
+        const double bandwidth = maxK[ii] - minK[ii];
+        six::sicd::DirectionParameters& direction = *directions[ii];
+        direction.unitVector = unitVectors[ii];
+        direction.sampleSpacing = spacings[ii];
+        direction.sign = six::FFTSign(sgn);
+        direction.impulseResponseBandwidth = bandwidth;
+        direction.impulseResponseWidth = 0.886 / bandwidth;
+        direction.kCenter = 0.5 * (minK[ii] + maxK[ii]);
+        direction.deltaK1 = -0.5 * bandwidth;
+        direction.deltaK2 = 0.5 * bandwidth;
+    }
+
+    data->geoData->earthModel = six::EarthModelType::WGS84;
+    data->geoData->scp.ecf = getPixelPosition(mSCPPixel.row, mSCPPixel.col);
+    data->geoData->scp.llh = scene::Utilities::ecefToLatLon(
+            data->geoData->scp.ecf);
+
+    data->fillDerivedFields(false);
+    return data;
+}
+
+void Backprojector::write(const Wideband& wideband,
+                          size_t channel,
+                          const std::string& pathname,
+                          const std::vector<std::string>& schemaPaths) const
+{
+    std::auto_ptr<six::sicd::ComplexData> data = createComplexData(channel);
+    std::vector<std::complex<float> > image(mNumRows * mNumCols);
+    formImage(wideband, channel, &image[0]);
+
+    six::XMLControlRegistry xmlRegistry;
+    xmlRegistry.addCreator(
+            six::DataType::COMPLEX,
+            new six::XMLControlCreatorT<six::sicd::ComplexXMLControl>());
+
+    mem::SharedPtr<six::Container> container(
+            new six::Container(six::DataType::COMPLEX));
+    container->addData(data.release());
+
+    six::NITFWriteControl writer;
+    writer.setXMLControlRegistry(&xmlRegistry);
+    writer.initialize(container);
+    writer.save(reinterpret_cast<const six::UByte*>(&image[0]), pathname,
+                schemaPaths);
+}
+}
@@ -0,0 +1,541 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string.h>
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+#include <except/Exception.h>
+#include <io/ByteStream.h>
+#include <io/FileInputStream.h>
+#include <io/FileOutputStream.h>
+#include <logging/NullLogger.h>
+#include <sys/Conf.h>
+#include <xml/lite/MinidomParser.h>
+#include <cphd/CPHDSubsetter.h>
+#include <cphd/CPHDXMLControl.h>
+#include <cphd/PVPBlock.h>
+#include <cphd/ReferenceGeometryCalculator.h>
+
+namespace
+{
+// PVPs are always big endian doubles in the file
+double readBigEndian(const sys::byte* data)
+{
+    double value;
+    memcpy(&value, data, sizeof(value));
+    if (!sys::isBigEndianSystem())
+    {
+        sys::byteSwap(&value, sizeof(value), 1);
+    }
+    return value;
+}
+
+void writeBigEndian(double value, sys::byte* data)
+{
+    if (!sys::isBigEndianSystem())
+    {
+        sys::byteSwap(&value, sizeof(value), 1);
+    }
+    memcpy(data, &value, sizeof(value));
+}
+}
+
+namespace cphd
+{
+CPHDSubsetter::PVPExtents::PVPExtents() :
+    txTime1(std::numeric_limits<double>::max()),
+    txTime2(-std::numeric_limits<double>::max()),
+    fx1(std::numeric_limits<double>::max()),
+    fx2(-std::numeric_limits<double>::max()),
+    toa1(std::numeric_limits<double>::max()),
+    toa2(-std::numeric_limits<double>::max())
+{
+}
+
+void CPHDSubsetter::PVPExtents::add(const PVPExtents& other)
+{
+    txTime1 = std::min(txTime1, other.txTime1);
+    txTime2 = std::max(txTime2, other.txTime2);
+    fx1 = std::min(fx1, other.fx1);
+    fx2 = std::max(fx2, other.fx2);
+    toa1 = std::min(toa1, other.toa1);
+    toa2 = std::max(toa2, other.toa2);
+}
+
+CPHDSubsetter::CPHDSubsetter(std::shared_ptr<io::SeekableInputStream> inStream,
+                             const std::vector<std::string>& schemaPaths,
+                             size_t bufferSize) :
+    mInStream(inStream),
+    mSchemaPaths(schemaPaths),
+    mBuffer(std::max<size_t>(bufferSize, 1))
+{
+    initialize(schemaPaths);
+}
+
+CPHDSubsetter::CPHDSubsetter(const std::string& pathname,
+                             const std::vector<std::string>& schemaPaths,
+                             size_t bufferSize) :
+    mInStream(new io::FileInputStream(pathname)),
+    mSchemaPaths(schemaPaths),
+    mBuffer(std::max<size_t>(bufferSize, 1))
+{
+    initialize(schemaPaths);
+}
+
+void CPHDSubsetter::initialize(const std::vector<std::string>& schemaPaths)
+{
+    mFileHeader.read(*mInStream);
+
+    mInStream->seek(mFileHeader.getXMLBlockByteOffset(), io::Seekable::START);
+    xml::lite::MinidomParser xmlParser;
+    xmlParser.preserveCharacterData(true);
+    xmlParser.parse(*mInStream, mFileHeader.getXMLBlockSize());
+
+    logging::NullLogger logger;
+    mMetadata = CPHDXMLControl(&logger, false).fromXML(
+            xmlParser.getDocument(), schemaPaths);
+
+    // Arrays are back to back in channel order, same as the reader
+    const Data& data = mMetadata->data;
+    const size_t numChannels = data.getNumChannels();
+    mPVPOffsets.resize(numChannels);
+    mSignalOffsets.resize(numChannels);
+    sys::Off_T pvpOffset = mFileHeader.getPvpBlockByteOffset();
+    sys::Off_T signalOffset = mFileHeader.getSignalBlockByteOffset();
+    for (size_t ii = 0; ii < numChannels; ++ii)
+    {
+        mPVPOffsets[ii] = pvpOffset;
+        mSignalOffsets[ii] = signalOffset;
+        pvpOffset += static_cast<sys::Off_T>(data.getNumVectors(ii)) *
+                data.getNumBytesPVPSet();
+        signalOffset += data.isCompressed() ?
+                data.getCompressedSignalSize(ii) :
+                data.getSignalSize(ii);
+    }
+}
+
+void CPHDSubsetter::addChannel(size_t channel,
+                               size_t firstVector,
+                               size_t lastVector,
+                               size_t firstSample,
+                               size_t lastSample)
+{
+    const Data& data = mMetadata->data;
+    const size_t numVectors = data.getNumVectors(channel);
+    const size_t numSamples = data.getNumSamples(channel);
+    if (lastVector == Wideband::ALL)
+    {
+        lastVector = numVectors - 1;
+    }
+    if (lastSample == Wideband::ALL)
+    {
+        lastSample = numSamples - 1;
+    }
+
+    std::ostringstream ostr;
+    if (firstVector > lastVector || lastVector >= numVectors)
+    {
+        ostr << "Invalid vector range [" << firstVector << ", "
+             << lastVector << "] for channel " << channel << " with "
+             << numVectors << " vectors";
+    }
+    else if (firstSample > lastSample || lastSample >= numSamples)
+    {
+        ostr << "Invalid sample range [" << firstSample << ", "
+             << lastSample << "] for channel " << channel << " with "
+             << numSamples << " samples";
+    }
+    else if (data.isCompressed() &&
+             (lastVector - firstVector + 1 != numVectors ||
+              lastSample - firstSample + 1 != numSamples))
+    {
+        ostr << "Channel " << channel << " is compressed, so it can only be "
+             << "copied whole";
+    }
+    for (size_t ii = 0; ii < mSelections.size(); ++ii)
+    {
+        if (mSelections[ii].channel == channel)
+        {
+            ostr.str("");
+            ostr << "Channel " << channel << " was already added";
+        }
+    }
+    if (!ostr.str().empty())
+    {
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+
+    Selection selection;
+    selection.channel = channel;
+    selection.firstVector = firstVector;
+    selection.numVectors = lastVector - firstVector + 1;
+    selection.firstSample = firstSample;
+    selection.numSamples = lastSample - firstSample + 1;
+    mSelections.push_back(selection);
+}
+
+Metadata CPHDSubsetter::getSubsetMetadata() const
+{
+    Metadata metadata(*mMetadata);
+    Data& data = metadata.data;
+    data.channels.clear();
+    metadata.channel.parameters.clear();
+
+    size_t pvpOffset = 0;
+    size_t signalOffset = 0;
+    bool hasRefChannel = false;
+    PVPExtents subsetExtents;
+    for (size_t ii = 0; ii < mSelections.size(); ++ii)
+    {
+        const Selection& selection = mSelections[ii];
+        const PVPExtents extents = getPVPExtents(selection);
+        subsetExtents.add(extents);
+
+        Data::Channel channel = mMetadata->data.channels[selection.channel];
+        channel.numVectors = selection.numVectors;
+        channel.numSamples = selection.numSamples;
+        channel.pvpArrayByteOffset = pvpOffset;
+        channel.signalArrayByteOffset = signalOffset;
+        pvpOffset += channel.numVectors * data.getNumBytesPVPSet();
+        signalOffset += data.isCompressed() ?
+                channel.getCompressedSignalSize() :
+                channel.numVectors * channel.numSamples *
+                        data.getNumBytesPerSample();
+        data.channels.push_back(channel);
+        hasRefChannel = hasRefChannel ||
+                channel.identifier == metadata.channel.refChId;
+
+        // Channel parameters are matched up by identifier, falling back
+        // on the channel's position
+        const std::vector<ChannelParameter>& parameters =
+                mMetadata->channel.parameters;
+        size_t index = selection.channel;
+        for (size_t jj = 0; jj < parameters.size(); ++jj)
+        {
+            if (parameters[jj].identifier == channel.identifier)
+            {
+                index = jj;
+                break;
+            }
+        }
+        if (index < parameters.size())
+        {
+            ChannelParameter parameter = parameters[index];
+            if (!six::Init::isUndefined(parameter.refVectorIndex))
+            {
+                // Keep the reference vector if it survived, otherwise use
+                // the closest one that did
+                const size_t lastVector =
+                        selection.firstVector + selection.numVectors - 1;
+                parameter.refVectorIndex = std::min(
+                        std::max(parameter.refVectorIndex,
+                                 selection.firstVector),
+                        lastVector) - selection.firstVector;
+            }
+            parameter.fxC = (extents.fx1 + extents.fx2) / 2;
+            parameter.fxBW = extents.fx2 - extents.fx1;
+            parameter.toaSaved = extents.toa2 - extents.toa1;
+            metadata.channel.parameters.push_back(parameter);
+        }
+    }
+
+    if (!hasRefChannel && !data.channels.empty())
+    {
+        metadata.channel.refChId = data.channels[0].identifier;
+    }
+
+    Global& global = metadata.global;
+    global.timeline.txTime1 = subsetExtents.txTime1;
+    global.timeline.txTime2 = subsetExtents.txTime2;
+    global.fxBand.fxMin = subsetExtents.fx1;
+    global.fxBand.fxMax = subsetExtents.fx2;
+    global.toaSwath.toaMin = subsetExtents.toa1;
+    global.toaSwath.toaMax = subsetExtents.toa2;
+
+    metadata.referenceGeometry = computeReferenceGeometry(metadata);
+    return metadata;
+}
+
+size_t CPHDSubsetter::readPVP(const Selection& selection,
+                              size_t firstVector) const
+{
+    const Data& data = mMetadata->data;
+    const size_t numBytesPVP = data.getNumBytesPVPSet();
+    if (mBuffer.size() < numBytesPVP)
+    {
+        mBuffer.resize(numBytesPVP);
+    }
+    const size_t numVectors = std::min(mBuffer.size() / numBytesPVP,
+                                       selection.numVectors - firstVector);
+    mInStream->seek(mPVPOffsets[selection.channel] +
+                            static_cast<sys::Off_T>(selection.firstVector +
+                                                    firstVector) *
+                                    numBytesPVP,
+                    io::Seekable::START);
+    mInStream->read(&mBuffer[0], numVectors * numBytesPVP);
+    if (selection.numSamples == data.getNumSamples(selection.channel))
+    {
+        return numVectors;
+    }
+
+    // SC0 is the first sample's frequency or time, so it has to move with
+    // the first sample, and the band can't reach past the last one
+    const Pvp& pvp = mMetadata->pvp;
+    const PVPType* lower = nullptr;
+    const PVPType* upper = nullptr;
+    if (mMetadata->global.getDomainType() == DomainType::FX)
+    {
+        lower = &pvp.fx1;
+        upper = &pvp.fx2;
+    }
+    else if (mMetadata->global.getDomainType() == DomainType::TOA)
+    {
+        lower = &pvp.toa1;
+        upper = &pvp.toa2;
+    }
+    for (size_t ii = 0; ii < numVectors; ++ii)
+    {
+        sys::byte* const row = &mBuffer[ii * numBytesPVP];
+        const double scss = readBigEndian(row + pvp.scss.getByteOffset());
+        const double first = readBigEndian(row + pvp.sc0.getByteOffset()) +
+                selection.firstSample * scss;
+        const double last = first + (selection.numSamples - 1) * scss;
+        writeBigEndian(first, row + pvp.sc0.getByteOffset());
+        if (lower)
+        {
+            sys::byte* const lowerValue = row + lower->getByteOffset();
+            sys::byte* const upperValue = row + upper->getByteOffset();
+            writeBigEndian(std::max(readBigEndian(lowerValue),
+                                    std::min(first, last)),
+                           lowerValue);
+            writeBigEndian(std::min(readBigEndian(upperValue),
+                                    std::max(first, last)),
+                           upperValue);
+        }
+    }
+    return numVectors;
+}
+
+CPHDSubsetter::PVPExtents
+CPHDSubsetter::getPVPExtents(const Selection& selection) const
+{
+    const Pvp& pvp = mMetadata->pvp;
+    const size_t numBytesPVP = mMetadata->data.getNumBytesPVPSet();
+    PVPExtents extents;
+    for (size_t ii = 0; ii < selection.numVectors;)
+    {
+        const size_t numVectors = readPVP(selection, ii);
+        for (size_t jj = 0; jj < numVectors; ++jj)
+        {
+            const sys::byte* const row = &mBuffer[jj * numBytesPVP];
+            PVPExtents vector;
+            vector.txTime1 = vector.txTime2 =
+                    readBigEndian(row + pvp.txTime.getByteOffset());
+            vector.fx1 = readBigEndian(row + pvp.fx1.getByteOffset());
+            vector.fx2 = readBigEndian(row + pvp.fx2.getByteOffset());
+            vector.toa1 = readBigEndian(row + pvp.toa1.getByteOffset());
+            vector.toa2 = readBigEndian(row + pvp.toa2.getByteOffset());
+            extents.add(vector);
+        }
+        ii += numVectors;
+    }
+    return extents;
+}
+
+ReferenceGeometry
+CPHDSubsetter::computeReferenceGeometry(const Metadata& metadata) const
+{
+    size_t channel = 0;
+    while (channel < metadata.data.channels.size() &&
+           metadata.data.channels[channel].identifier !=
+                   metadata.channel.refChId)
+    {
+        ++channel;
+    }
+    if (channel >= mSelections.size() ||
+        channel >= metadata.channel.parameters.size() ||
+        six::Init::isUndefined(
+                metadata.channel.parameters[channel].refVectorIndex))
+    {
+        return metadata.referenceGeometry;
+    }
+
+    // A PVP block with one vector per channel up to the reference channel,
+    // each a copy of the reference vector, read and decoded the same way
+    // the reader does
+    const size_t vector = metadata.channel.parameters[channel].refVectorIndex;
+    readPVP(mSelections[channel], vector);
+    Data data(metadata.data);
+    data.channels.resize(channel + 1);
+    io::ByteStream stream;
+    for (size_t ii = 0; ii < data.channels.size(); ++ii)
+    {
+        data.channels[ii].numVectors = 1;
+        stream.write(&mBuffer[0], data.getNumBytesPVPSet());
+    }
+    PVPBlock pvpBlock(metadata.pvp, data);
+    pvpBlock.load(stream, 0,
+                  data.channels.size() * data.getNumBytesPVPSet(), 1);
+
+    return ReferenceGeometryCalculator(metadata, pvpBlock).
+            computeReferenceGeometry(channel, 0);
+}
+
+void CPHDSubsetter::copy(sys::Off_T offset,
+                         size_t size,
+                         io::OutputStream& outStream) const
+{
+    mInStream->seek(offset, io::Seekable::START);
+    while (size > 0)
+    {
+        const size_t chunkSize = std::min(size, mBuffer.size());
+        mInStream->read(&mBuffer[0], chunkSize);
+        outStream.write(&mBuffer[0], chunkSize);
+        size -= chunkSize;
+    }
+}
+
+void CPHDSubsetter::copyPVP(const Selection& selection,
+                            io::OutputStream& outStream) const
+{
+    const size_t numBytesPVP = mMetadata->data.getNumBytesPVPSet();
+    for (size_t ii = 0; ii < selection.numVectors;)
+    {
+        const size_t numVectors = readPVP(selection, ii);
+        outStream.write(&mBuffer[0], numVectors * numBytesPVP);
+        ii += numVectors;
+    }
+}
+
+void CPHDSubsetter::copySignal(const Selection& selection,
+                               io::OutputStream& outStream) const
+{
+    const Data& data = mMetadata->data;
+    if (data.isCompressed())
+    {
+        copy(mSignalOffsets[selection.channel],
+             data.getCompressedSignalSize(selection.channel),
+             outStream);
+        return;
+    }
+
+    const size_t elementSize = data.getNumBytesPerSample();
+    const size_t inVectorSize =
+            data.getNumSamples(selection.channel) * elementSize;
+    const size_t outVectorSize = selection.numSamples * elementSize;
+    const sys::Off_T offset = mSignalOffsets[selection.channel] +
+            static_cast<sys::Off_T>(selection.firstVector) * inVectorSize +
+            selection.firstSample * elementSize;
+    if (outVectorSize == inVectorSize)
+    {
+        // The vectors are contiguous
+        copy(offset, selection.numVectors * inVectorSize, outStream);
+        return;
+    }
+
+    // Gather the sample range of as many vectors as fit in the buffer
+    if (mBuffer.size() < outVectorSize)
+    {
+        mBuffer.resize(outVectorSize);
+    }
+    const size_t vectorsPerChunk = mBuffer.size() / outVectorSize;
+    for (size_t ii = 0; ii < selection.numVectors; ii += vectorsPerChunk)
+    {
+        const size_t numVectors =
+                std::min(vectorsPerChunk, selection.numVectors - ii);
+        for (size_t jj = 0; jj < numVectors; ++jj)
+        {
+            mInStream->seek(offset + static_cast<sys::Off_T>(ii + jj) *
+                                    inVectorSize,
+                            io::Seekable::START);
+            mInStream->read(&mBuffer[jj * outVectorSize], outVectorSize);
+        }
+        outStream.write(&mBuffer[0], numVectors * outVectorSize);
+    }
+}
+
+void CPHDSubsetter::write(io::OutputStream& outStream) const
+{
+    if (mSelections.empty())
+    {
+        throw except::Exception(Ctxt("No channels were added to the subset"));
+    }
+
+    const Metadata metadata = getSubsetMetadata();
+    const std::string xmlMetadata(
+            CPHDXMLControl().toXMLString(metadata, mSchemaPaths));
+
+    size_t pvpSize = 0;
+    size_t signalSize = 0;
+    for (size_t ii = 0; ii < metadata.data.getNumChannels(); ++ii)
+    {
+        pvpSize += metadata.data.getNumVectors(ii) *
+                metadata.data.getNumBytesPVPSet();
+        signalSize += metadata.data.isCompressed() ?
+                metadata.data.getCompressedSignalSize(ii) :
+                metadata.data.getSignalSize(ii);
+    }
+
+    FileHeader header;
+    header.setVersion(metadata.getVersion());
+    header.setClassification(mFileHeader.getClassification());
+    header.setReleaseInfo(mFileHeader.getReleaseInfo());
+    header.set(xmlMetadata.size(),
+               mFileHeader.getSupportBlockSize(),
+               pvpSize,
+               signalSize);
+    outStream.write(header.toString().c_str(), header.size());
+    outStream.write("\f\n", 2);
+    outStream.write(xmlMetadata.c_str(), xmlMetadata.size());
+    outStream.write("\f\n", 2);
+
+    // The support arrays don't depend on the channels
+    if (mFileHeader.getSupportBlockSize() != 0)
+    {
+        copy(mFileHeader.getSupportBlockByteOffset(),
+             mFileHeader.getSupportBlockSize(),
+             outStream);
+    }
+    const std::vector<char> zeros(header.getPvpPadBytes(), 0);
+    if (!zeros.empty())
+    {
+        outStream.write(&zeros[0], zeros.size());
+    }
+
+    for (size_t ii = 0; ii < mSelections.size(); ++ii)
+    {
+        copyPVP(mSelections[ii], outStream);
+    }
+    for (size_t ii = 0; ii < mSelections.size(); ++ii)
+    {
+        copySignal(mSelections[ii], outStream);
+    }
+}
+
+void CPHDSubsetter::write(const std::string& pathname) const
+{
+    io::FileOutputStream outStream(pathname);
+    write(outStream);
+    outStream.close();
+}
+}
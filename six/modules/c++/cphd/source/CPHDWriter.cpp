@@ -19,13 +19,17 @@
  * see <http://www.gnu.org/licenses/>.
  *
  */
+#include <type_traits>
+
 #include <cphd/ByteSwap.h>
 #include <cphd/CPHDWriter.h>
 #include <cphd/CPHDXMLControl.h>
 #include <cphd/FileHeader.h>
+#include <cphd/SignalCodec.h>
 #include <cphd/Utilities.h>
 #include <cphd/Wideband.h>
 #include <except/Exception.h>
+#include <mt/CriticalSection.h>
 
 namespace cphd
 {
@@ -142,24 +146,25 @@ CPHDWriter::CPHDWriter(const Metadata& metadata,
     }
 }
 
-void CPHDWriter::writeMetadata(size_t supportSize,
-                               size_t pvpSize,
-                               size_t cphdSize)
+std::string CPHDWriter::setUpHeader(const Metadata& metadata,
+                                    size_t supportSize,
+                                    size_t pvpSize,
+                                    size_t cphdSize)
 {
-    const std::string xmlMetadata(
-            CPHDXMLControl().toXMLString(mMetadata, mSchemaPaths));
+    std::string xmlMetadata(
+            CPHDXMLControl().toXMLString(metadata, mSchemaPaths));
 
     // update header version, or remains default if unset
-    mHeader.setVersion(mMetadata.getVersion());
+    mHeader.setVersion(metadata.getVersion());
 
     // update classification and release info
     if (!six::Init::isUndefined(
-                mMetadata.collectionID.getClassificationLevel()) &&
-        !six::Init::isUndefined(mMetadata.collectionID.releaseInfo))
+                metadata.collectionID.getClassificationLevel()) &&
+        !six::Init::isUndefined(metadata.collectionID.releaseInfo))
     {
         mHeader.setClassification(
-                mMetadata.collectionID.getClassificationLevel());
-        mHeader.setReleaseInfo(mMetadata.collectionID.releaseInfo);
+                metadata.collectionID.getClassificationLevel());
+        mHeader.setReleaseInfo(metadata.collectionID.releaseInfo);
     }
     else
     {
@@ -168,22 +173,22 @@ void CPHDWriter::writeMetadata(size_t supportSize,
     }
     // set header size, final step before write
     mHeader.set(xmlMetadata.size(), supportSize, pvpSize, cphdSize);
+    return xmlMetadata;
+}
+
+void CPHDWriter::writeMetadata(const Metadata& metadata,
+                               size_t supportSize,
+                               size_t pvpSize,
+                               size_t cphdSize)
+{
+    const std::string xmlMetadata(
+            setUpHeader(metadata, supportSize, pvpSize, cphdSize));
     mStream->write(mHeader.toString().c_str(), mHeader.size());
     mStream->write("\f\n", 2);
     mStream->write(xmlMetadata.c_str(), xmlMetadata.size());
     mStream->write("\f\n", 2);
 }
 
-void CPHDWriter::writePVPData(const sys::ubyte* pvpBlock, size_t channel)
-{
-    const size_t size = (mMetadata.data.getNumVectors(channel) *
-                         mMetadata.data.getNumBytesPVPSet()) /
-            8;
-
-    //! The vector based parameters are always 64 bit
-    (*mDataWriter)(pvpBlock, size, 8);
-}
-
 void CPHDWriter::writeCPHDDataImpl(const sys::ubyte* data, size_t size)
 {
     //! We have to pass in the data as though it was not complex
@@ -211,9 +216,39 @@ void CPHDWriter::write(const PVPBlock& pvpBlock,
                        const T* widebandData,
                        const sys::ubyte* supportData)
 {
+    // Complex samples need to be compressed before the metadata is
+    // written, since it holds the compressed sizes.  Those go in a copy so
+    // the caller's metadata is left alone.
+    std::vector<std::vector<sys::ubyte> > compressed;
+    Metadata compressedMetadata;
+    const Metadata* metadata = &mMetadata;
+    if (mMetadata.data.isCompressed() &&
+        !std::is_same<T, sys::ubyte>::value)
+    {
+        if (mElementSize != sizeof(T))
+        {
+            throw except::Exception(
+                    Ctxt("Incorrect buffer data type used for metadata!"));
+        }
+        compressSignalBlock(mMetadata.data,
+                            reinterpret_cast<const sys::ubyte*>(widebandData),
+                            !sys::isBigEndianSystem(),
+                            mNumThreads == 0 ? sys::OS().getNumCPUs() :
+                                               mNumThreads,
+                            compressed);
+
+        compressedMetadata = mMetadata;
+        for (size_t ii = 0; ii < compressed.size(); ++ii)
+        {
+            compressedMetadata.data.channels[ii].compressedSignalSize =
+                    compressed[ii].size();
+        }
+        metadata = &compressedMetadata;
+    }
+
     // Write File header and metadata to file
     // Padding is added in writeMetadata
-    writeMetadata(pvpBlock);
+    writeMetadata(*metadata, pvpBlock);
 
     // Write optional support array block
     // Padding is added in writeSupportData
@@ -232,12 +267,28 @@ void CPHDWriter::write(const PVPBlock& pvpBlock,
 
     // Doesn't require pading because pvp block is always 8 bytes words
     // Write wideband (or signal) block
+    const sys::ubyte* channelData =
+            reinterpret_cast<const sys::ubyte*>(widebandData);
     for (size_t ii = 0; ii < mMetadata.data.getNumChannels(); ++ii)
     {
-        size_t numElements = mMetadata.data.getNumVectors(ii) *
+        const size_t numElements = mMetadata.data.getNumVectors(ii) *
                 mMetadata.data.getNumSamples(ii);
-        // writeCPHDData handles compressed data as well
-        writeCPHDData<T>(widebandData, numElements, ii);
+        if (!compressed.empty())
+        {
+            // Already big endian
+            (*mDataWriter)(&compressed[ii][0], compressed[ii].size(), 1);
+            channelData += numElements * mElementSize;
+        }
+        else
+        {
+            // writeCPHDData handles compressed data as well
+            writeCPHDData<T>(reinterpret_cast<const T*>(channelData),
+                             numElements,
+                             ii);
+            channelData += mMetadata.data.isCompressed() ?
+                    mMetadata.data.getCompressedSignalSize(ii) :
+                    numElements * mElementSize;
+        }
     }
 }
 
@@ -262,25 +313,31 @@ template void CPHDWriter::write<std::complex<float>>(
         const sys::ubyte* supportData);
 
 void CPHDWriter::writeMetadata(const PVPBlock& pvpBlock)
+{
+    writeMetadata(mMetadata, pvpBlock);
+}
+
+void CPHDWriter::writeMetadata(const Metadata& metadata,
+                               const PVPBlock& pvpBlock)
 {
     // Update the number of bytes per PVP
-    if (mMetadata.data.numBytesPVP != pvpBlock.getNumBytesPVPSet())
+    if (metadata.data.numBytesPVP != pvpBlock.getNumBytesPVPSet())
     {
         std::ostringstream ostr;
         ostr << "Number of pvp block bytes in metadata: "
-             << mMetadata.data.numBytesPVP
+             << metadata.data.numBytesPVP
              << " does not match calculated size of pvp block: "
              << pvpBlock.getNumBytesPVPSet();
         throw except::Exception(ostr.str());
     }
 
-    const size_t numChannels = mMetadata.data.getNumChannels();
+    const size_t numChannels = metadata.data.getNumChannels();
     size_t totalSupportSize = 0;
     size_t totalPVPSize = 0;
     size_t totalCPHDSize = 0;
 
-    for (auto it = mMetadata.data.supportArrayMap.begin();
-         it != mMetadata.data.supportArrayMap.end();
+    for (auto it = metadata.data.supportArrayMap.begin();
+         it != metadata.data.supportArrayMap.end();
          ++it)
     {
         totalSupportSize += it->second.getSize();
@@ -289,11 +346,13 @@ void CPHDWriter::writeMetadata(const PVPBlock& pvpBlock)
     for (size_t ii = 0; ii < numChannels; ++ii)
     {
         totalPVPSize += pvpBlock.getPVPsize(ii);
-        totalCPHDSize += mMetadata.data.getNumVectors(ii) *
-                mMetadata.data.getNumSamples(ii) * mElementSize;
+        totalCPHDSize += metadata.data.isCompressed() ?
+                metadata.data.getCompressedSignalSize(ii) :
+                metadata.data.getNumVectors(ii) *
+                        metadata.data.getNumSamples(ii) * mElementSize;
     }
 
-    writeMetadata(totalSupportSize, totalPVPSize, totalCPHDSize);
+    writeMetadata(metadata, totalSupportSize, totalPVPSize, totalCPHDSize);
 }
 
 void CPHDWriter::writePVPData(const PVPBlock& pvpBlock)
@@ -306,18 +365,27 @@ void CPHDWriter::writePVPData(const PVPBlock& pvpBlock)
     }
 
     // Write each PVP array
+    // Vectors are packed and swapped to big endian in one pass, so they
+    // can go straight to the stream
     const size_t numChannels = mMetadata.data.getNumChannels();
+    const size_t numThreads =
+            mNumThreads == 0 ? sys::OS().getNumCPUs() : mNumThreads;
     std::vector<sys::ubyte> pvpData;
     for (size_t ii = 0; ii < numChannels; ++ii)
     {
-        pvpBlock.getPVPdata(ii, pvpData);
+        pvpData.resize(pvpBlock.getPVPsize(ii));
         if (pvpData.empty())
         {
             std::ostringstream ostr;
             ostr << "PVPBlock of channel " << ii << " is empty";
             throw except::Exception(Ctxt(ostr.str()));
         }
-        writePVPData(&pvpData[0], ii);
+        pvpBlock.getPVPdata(ii,
+                            &pvpData[0],
+                            !sys::isBigEndianSystem(),
+                            numThreads);
+        mStream->write(reinterpret_cast<const sys::byte*>(&pvpData[0]),
+                       pvpData.size());
     }
 }
 
@@ -328,6 +396,12 @@ void CPHDWriter::writeCPHDData(const T* data,
 {
     if (mMetadata.data.isCompressed())
     {
+        if (!std::is_same<T, sys::ubyte>::value)
+        {
+            throw except::Exception(Ctxt(
+                    "Compressed data must be written as bytes. Use write() "
+                    "or compressSignalArray() to compress complex samples."));
+        }
         writeCompressedCPHDDataImpl(reinterpret_cast<const sys::ubyte*>(data),
                                     channel);
     }
@@ -360,4 +434,272 @@ template void CPHDWriter::writeCPHDData<std::complex<sys::Int16_T>>(
 
 template void CPHDWriter::writeCPHDData<std::complex<float>>(
         const std::complex<float>* data, size_t numElements, size_t channel);
+
+void CPHDWriter::startChannelWrites()
+{
+    if (mMetadata.data.isCompressed())
+    {
+        throw except::Exception(Ctxt(
+                "Channels can't be written out of order when the signal is "
+                "compressed. Use write() instead."));
+    }
+
+    const size_t numChannels = mMetadata.data.getNumChannels();
+    size_t totalSupportSize = 0;
+    size_t totalPVPSize = 0;
+    size_t totalCPHDSize = 0;
+    for (auto it = mMetadata.data.supportArrayMap.begin();
+         it != mMetadata.data.supportArrayMap.end();
+         ++it)
+    {
+        totalSupportSize += it->second.getSize();
+    }
+    for (size_t ii = 0; ii < numChannels; ++ii)
+    {
+        totalPVPSize += mMetadata.data.getNumVectors(ii) *
+                mMetadata.data.getNumBytesPVPSet();
+        totalCPHDSize += mMetadata.data.getSignalSize(ii);
+    }
+
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+    mXMLMetadata = setUpHeader(mMetadata, totalSupportSize, totalPVPSize,
+                               totalCPHDSize);
+
+    // Arrays are back to back in channel order, same as write()
+    mPVPOffsets.resize(numChannels);
+    mSignalOffsets.resize(numChannels);
+    mVectorsWritten.resize(numChannels);
+    mVectorsLeft.resize(numChannels);
+    mPVPsWritten.resize(numChannels);
+    mPVPsLeft.resize(numChannels);
+    sys::Off_T pvpOffset = mHeader.getPvpBlockByteOffset();
+    sys::Off_T signalOffset = mHeader.getSignalBlockByteOffset();
+    for (size_t ii = 0; ii < numChannels; ++ii)
+    {
+        const size_t numVectors = mMetadata.data.getNumVectors(ii);
+        mPVPOffsets[ii] = pvpOffset;
+        mSignalOffsets[ii] = signalOffset;
+        mVectorsWritten[ii].assign(numVectors, false);
+        mVectorsLeft[ii] = numVectors;
+        mPVPsWritten[ii].assign(numVectors, false);
+        mPVPsLeft[ii] = numVectors;
+        pvpOffset += numVectors * mMetadata.data.getNumBytesPVPSet();
+        signalOffset += mMetadata.data.getSignalSize(ii);
+    }
+}
+
+void CPHDWriter::writeAt(sys::Off_T offset,
+                         const sys::byte* data,
+                         size_t size)
+{
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+    mStream->seek(offset, io::SeekableOutputStream::START);
+    mStream->write(data, size);
+}
+
+void CPHDWriter::verifyChannelWrite(size_t channel,
+                                    size_t firstVector,
+                                    size_t numVectors) const
+{
+    const size_t numChannelVectors = mMetadata.data.getNumVectors(channel);
+    if (mSignalOffsets.size() != mMetadata.data.getNumChannels())
+    {
+        throw except::Exception(Ctxt("Call startChannelWrites() first"));
+    }
+    if (firstVector + numVectors > numChannelVectors)
+    {
+        std::ostringstream ostr;
+        ostr << "Vectors " << firstVector << " to "
+             << firstVector + numVectors << " are out of range for channel "
+             << channel << " with " << numChannelVectors << " vectors";
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+}
+
+void CPHDWriter::markWritten(std::vector<bool>& written,
+                             size_t& numLeft,
+                             size_t firstVector,
+                             size_t numVectors)
+{
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+    for (size_t ii = firstVector; ii < firstVector + numVectors; ++ii)
+    {
+        if (!written[ii])
+        {
+            written[ii] = true;
+            --numLeft;
+        }
+    }
+}
+
+void CPHDWriter::writeChannelImpl(const sys::ubyte* data,
+                                  size_t channel,
+                                  size_t firstVector,
+                                  size_t numVectors,
+                                  bool byteSwap)
+{
+    verifyChannelWrite(channel, firstVector, numVectors);
+
+    const size_t vectorSize =
+            mMetadata.data.getNumSamples(channel) * mElementSize;
+    sys::Off_T offset = mSignalOffsets[channel] + firstVector * vectorSize;
+    if (!byteSwap)
+    {
+        writeAt(offset,
+                reinterpret_cast<const sys::byte*>(data),
+                numVectors * vectorSize);
+    }
+    else
+    {
+        // Swap whole vectors at a time into scratch space owned by this
+        // call, so only the writes themselves are serialized
+        const size_t vectorsPerChunk =
+                std::max<size_t>(mScratchSpaceSize / vectorSize, 1);
+        std::vector<sys::byte> scratch(
+                std::min(vectorsPerChunk, numVectors) * vectorSize);
+        for (size_t ii = 0; ii < numVectors; ii += vectorsPerChunk)
+        {
+            const size_t chunkSize =
+                    std::min(vectorsPerChunk, numVectors - ii) * vectorSize;
+            memcpy(&scratch[0], data + ii * vectorSize, chunkSize);
+            cphd::byteSwap(&scratch[0],
+                           mElementSize / 2,
+                           chunkSize / (mElementSize / 2),
+                           1);
+            writeAt(offset, &scratch[0], chunkSize);
+            offset += chunkSize;
+        }
+    }
+
+    markWritten(mVectorsWritten[channel], mVectorsLeft[channel],
+                firstVector, numVectors);
+}
+
+template <typename T>
+void CPHDWriter::writeChannel(const T* data,
+                              size_t channel,
+                              size_t firstVector,
+                              size_t numVectors)
+{
+    if (mElementSize != sizeof(T))
+    {
+        throw except::Exception(
+                Ctxt("Incorrect buffer data type used for metadata!"));
+    }
+    writeChannelImpl(reinterpret_cast<const sys::ubyte*>(data),
+                     channel,
+                     firstVector,
+                     numVectors,
+                     !sys::isBigEndianSystem());
+}
+
+template void CPHDWriter::writeChannel<std::complex<sys::Int8_T>>(
+        const std::complex<sys::Int8_T>* data,
+        size_t channel,
+        size_t firstVector,
+        size_t numVectors);
+
+template void CPHDWriter::writeChannel<std::complex<sys::Int16_T>>(
+        const std::complex<sys::Int16_T>* data,
+        size_t channel,
+        size_t firstVector,
+        size_t numVectors);
+
+template void CPHDWriter::writeChannel<std::complex<float>>(
+        const std::complex<float>* data,
+        size_t channel,
+        size_t firstVector,
+        size_t numVectors);
+
+void CPHDWriter::writeRawChannel(const sys::ubyte* data,
+                                 size_t channel,
+                                 size_t firstVector,
+                                 size_t numVectors)
+{
+    writeChannelImpl(data, channel, firstVector, numVectors, false);
+}
+
+void CPHDWriter::writeRawChannelPVP(const sys::ubyte* data,
+                                    size_t channel,
+                                    size_t firstVector,
+                                    size_t numVectors)
+{
+    verifyChannelWrite(channel, firstVector, numVectors);
+    const size_t numBytesPVP = mMetadata.data.getNumBytesPVPSet();
+    writeAt(mPVPOffsets[channel] +
+                    static_cast<sys::Off_T>(firstVector) * numBytesPVP,
+            reinterpret_cast<const sys::byte*>(data),
+            numVectors * numBytesPVP);
+    markWritten(mPVPsWritten[channel], mPVPsLeft[channel],
+                firstVector, numVectors);
+}
+
+void CPHDWriter::writeChannelPVP(const PVPBlock& pvpBlock, size_t channel)
+{
+    const size_t expectedSize = mMetadata.data.getNumVectors(channel) *
+            mMetadata.data.getNumBytesPVPSet();
+    if (pvpBlock.getPVPsize(channel) != expectedSize)
+    {
+        std::ostringstream ostr;
+        ostr << "PVP array of channel " << channel << " has "
+             << pvpBlock.getPVPsize(channel) << " bytes but the metadata "
+             << "expects " << expectedSize;
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+
+    std::vector<sys::ubyte> pvpData(expectedSize);
+    pvpBlock.getPVPdata(channel, &pvpData[0], !sys::isBigEndianSystem(), 1);
+    writeRawChannelPVP(&pvpData[0], channel, 0,
+                       mMetadata.data.getNumVectors(channel));
+}
+
+bool CPHDWriter::isChannelComplete(size_t channel) const
+{
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+    return channel < mVectorsLeft.size() && mVectorsLeft[channel] == 0 &&
+            mPVPsLeft[channel] == 0;
+}
+
+void CPHDWriter::finishChannelWrites(const sys::ubyte* supportData)
+{
+    for (size_t ii = 0; ii < mMetadata.data.getNumChannels(); ++ii)
+    {
+        if (!isChannelComplete(ii))
+        {
+            std::ostringstream ostr;
+            ostr << "Channel " << ii << " hasn't been completely written";
+            throw except::Exception(Ctxt(ostr.str()));
+        }
+    }
+    if (mMetadata.data.getNumSupportArrays() != 0 && supportData == nullptr)
+    {
+        throw except::Exception(Ctxt("SupportData is not provided"));
+    }
+
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+    mStream->seek(0, io::SeekableOutputStream::START);
+    mStream->write(mHeader.toString().c_str(), mHeader.size());
+    mStream->write("\f\n", 2);
+    mStream->write(mXMLMetadata.c_str(), mXMLMetadata.size());
+    mStream->write("\f\n", 2);
+    if (supportData != nullptr)
+    {
+        writeSupportData(supportData);
+    }
+
+    const std::vector<char> zeros(mHeader.getPvpPadBytes(), 0);
+    if (!zeros.empty())
+    {
+        mStream->seek(mHeader.getPvpBlockByteOffset() - zeros.size(),
+                      io::SeekableOutputStream::START);
+        mStream->write(&zeros[0], zeros.size());
+    }
+
+    // Leave the stream at the end of the file
+    mStream->seek(mHeader.getSignalBlockByteOffset() +
+                          mHeader.getSignalBlockSize(),
+                  io::SeekableOutputStream::START);
+    mPVPOffsets.clear();
+    mSignalOffsets.clear();
+}
 }
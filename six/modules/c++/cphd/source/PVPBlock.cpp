@@ -20,11 +20,15 @@
  *
  */
 
+#include <string.h>
+#include <algorithm>
+#include <memory>
 #include <ostream>
 #include <vector>
 #include <stddef.h>
 #include <typeinfo>
 
+#include <scene/RangeRunnable.h>
 #include <six/Init.h>
 #include <sys/Conf.h>
 #include <cphd/Types.h>
@@ -95,195 +99,331 @@ PVPBlock::PVPSet::PVPSet() :
 {
 }
 
-void PVPBlock::PVPSet::write(const PVPBlock& pvpBlock, const Pvp& p, const sys::byte* input)
+PVPBlock::PVPLayout::Field::Field(FieldType type_, const PVPType& param) :
+    type(type_),
+    byteOffset(param.getByteOffset()),
+    byteSize(param.getByteSize()),
+    scalar(nullptr),
+    vector(nullptr),
+    optional(nullptr)
 {
-    ::setData(input + p.txTime.getByteOffset(), txTime);
-    ::setData(input + p.txPos.getByteOffset(), txPos);
-    ::setData(input + p.txVel.getByteOffset(), txVel);
-    ::setData(input + p.rcvTime.getByteOffset(), rcvTime);
-    ::setData(input + p.rcvPos.getByteOffset(), rcvPos);
-    ::setData(input + p.rcvVel.getByteOffset(), rcvVel);
-    ::setData(input + p.srpPos.getByteOffset(), srpPos);
-    ::setData(input + p.aFDOP.getByteOffset(), aFDOP);
-    ::setData(input + p.aFRR1.getByteOffset(), aFRR1);
-    ::setData(input + p.aFRR2.getByteOffset(), aFRR2);
-    ::setData(input + p.fx1.getByteOffset(), fx1);
-    ::setData(input + p.fx2.getByteOffset(), fx2);
-    ::setData(input + p.toa1.getByteOffset(), toa1);
-    ::setData(input + p.toa2.getByteOffset(), toa2);
-    ::setData(input + p.tdTropoSRP.getByteOffset(), tdTropoSRP);
-    ::setData(input + p.sc0.getByteOffset(), sc0);
-    ::setData(input + p.scss.getByteOffset(), scss);
+}
 
-    if (pvpBlock.hasAmpSF())
+PVPBlock::PVPLayout::PVPLayout(const Pvp& p) :
+    numAdded(p.addedPVP.size())
+{
+    const struct
     {
-        ampSF.reset(new double());
-        ::setData(input + p.ampSF.getByteOffset(), *ampSF);
-    }
-    if (pvpBlock.hasFxN1())
+        const PVPType& param;
+        double PVPSet::* member;
+    } scalars[] = {
+        { p.txTime, &PVPSet::txTime },
+        { p.rcvTime, &PVPSet::rcvTime },
+        { p.aFDOP, &PVPSet::aFDOP },
+        { p.aFRR1, &PVPSet::aFRR1 },
+        { p.aFRR2, &PVPSet::aFRR2 },
+        { p.fx1, &PVPSet::fx1 },
+        { p.fx2, &PVPSet::fx2 },
+        { p.toa1, &PVPSet::toa1 },
+        { p.toa2, &PVPSet::toa2 },
+        { p.tdTropoSRP, &PVPSet::tdTropoSRP },
+        { p.sc0, &PVPSet::sc0 },
+        { p.scss, &PVPSet::scss }
+    };
+    for (size_t ii = 0; ii < sizeof(scalars) / sizeof(scalars[0]); ++ii)
     {
-        fxN1.reset(new double());
-        ::setData(input + p.fxN1.getByteOffset(), *fxN1);
+        fields.push_back(Field(SCALAR, scalars[ii].param));
+        fields.back().scalar = scalars[ii].member;
     }
-    if (pvpBlock.hasFxN2())
+
+    const struct
     {
-        fxN2.reset(new double());
-        ::setData(input + p.fxN2.getByteOffset(), *fxN2);
-    }
-    if (pvpBlock.hasToaE1())
+        const PVPType& param;
+        Vector3 PVPSet::* member;
+    } vectors[] = {
+        { p.txPos, &PVPSet::txPos },
+        { p.txVel, &PVPSet::txVel },
+        { p.rcvPos, &PVPSet::rcvPos },
+        { p.rcvVel, &PVPSet::rcvVel },
+        { p.srpPos, &PVPSet::srpPos }
+    };
+    for (size_t ii = 0; ii < sizeof(vectors) / sizeof(vectors[0]); ++ii)
     {
-        toaE1.reset(new double());
-        ::setData(input + p.toaE1.getByteOffset(), *toaE1);
+        fields.push_back(Field(VECTOR3, vectors[ii].param));
+        fields.back().vector = vectors[ii].member;
     }
-    if (pvpBlock.hasToaE2())
+
+    const struct
     {
-        toaE2.reset(new double());
-        ::setData(input + p.toaE2.getByteOffset(), *toaE2);
-    }
-    if (pvpBlock.hasTDIonoSRP())
+        const PVPType& param;
+        mem::ScopedCopyablePtr<double> PVPSet::* member;
+    } optionals[] = {
+        { p.ampSF, &PVPSet::ampSF },
+        { p.fxN1, &PVPSet::fxN1 },
+        { p.fxN2, &PVPSet::fxN2 },
+        { p.toaE1, &PVPSet::toaE1 },
+        { p.toaE2, &PVPSet::toaE2 },
+        { p.tdIonoSRP, &PVPSet::tdIonoSRP },
+        { p.signal, &PVPSet::signal }
+    };
+    for (size_t ii = 0; ii < sizeof(optionals) / sizeof(optionals[0]); ++ii)
     {
-        tdIonoSRP.reset(new double());
-        ::setData(input + p.tdIonoSRP.getByteOffset(), *tdIonoSRP);
+        if (!six::Init::isUndefined<size_t>(optionals[ii].param.getOffset()))
+        {
+            fields.push_back(Field(OPTIONAL, optionals[ii].param));
+            fields.back().optional = optionals[ii].member;
+        }
     }
-    if (pvpBlock.hasSignal())
+
+    for (auto it = p.addedPVP.begin(); it != p.addedPVP.end(); ++it)
     {
-        signal.reset(new double());
-        ::setData(input + p.signal.getByteOffset(), *signal);
+        const std::string format = it->second.getFormat();
+        FieldType type = ADDED_STRING;
+        if (format == "F4" || format == "F8")
+        {
+            type = ADDED_FLOAT;
+        }
+        else if (format == "U1" || format == "U2" ||
+                 format == "U4" || format == "U8")
+        {
+            type = ADDED_UNSIGNED;
+        }
+        else if (format == "I1" || format == "I2" ||
+                 format == "I4" || format == "I8")
+        {
+            type = ADDED_SIGNED;
+        }
+        else if (format == "CI2" || format == "CI4" ||
+                 format == "CI8" || format == "CI16")
+        {
+            type = ADDED_COMPLEX_INT;
+        }
+        else if (format == "CF8" || format == "CF16")
+        {
+            type = ADDED_COMPLEX_FLOAT;
+        }
+        fields.push_back(Field(type, it->second));
+        fields.back().name = it->first;
     }
-    for (auto it = p.addedPVP.begin(); it != p.addedPVP.end(); ++it)
+}
+
+void PVPBlock::PVPSet::write(const PVPLayout& layout, const sys::byte* input)
+{
+    for (size_t ii = 0; ii < layout.fields.size(); ++ii)
     {
-        if (it->second.getFormat() == "F4" || it->second.getFormat() == "F8")
+        const PVPLayout::Field& field = layout.fields[ii];
+        const sys::byte* const data = input + field.byteOffset;
+        switch (field.type)
+        {
+        case PVPLayout::SCALAR:
+            ::setData(data, this->*field.scalar);
+            break;
+        case PVPLayout::VECTOR3:
+            ::setData(data, this->*field.vector);
+            break;
+        case PVPLayout::OPTIONAL:
+        {
+            mem::ScopedCopyablePtr<double>& value = this->*field.optional;
+            value.reset(new double());
+            ::setData(data, *value);
+            break;
+        }
+        case PVPLayout::ADDED_FLOAT:
         {
             double val;
-            ::setData(input + it->second.getByteOffset(), val);
-            addedPVP[it->first] = six::Parameter();
-            addedPVP.find(it->first)->second.setValue(val);
+            ::setData(data, val);
+            addedPVP[field.name].setValue(val);
+            break;
         }
-        else if (it->second.getFormat() == "U1" || it->second.getFormat() == "U2" ||
-                 it->second.getFormat() == "U4" || it->second.getFormat() == "U8")
+        case PVPLayout::ADDED_UNSIGNED:
         {
             unsigned int val;
-            ::setData(input + it->second.getByteOffset(), val);
-            addedPVP[it->first] = six::Parameter();
-            addedPVP.find(it->first)->second.setValue(val);
+            ::setData(data, val);
+            addedPVP[field.name].setValue(val);
+            break;
         }
-        else if (it->second.getFormat() == "I1" || it->second.getFormat() == "I2" ||
-                 it->second.getFormat() == "I4" || it->second.getFormat() == "I8")
+        case PVPLayout::ADDED_SIGNED:
         {
             int val;
-            ::setData(input + it->second.getByteOffset(), val);
-            addedPVP[it->first] = six::Parameter();
-            addedPVP.find(it->first)->second.setValue(val);
+            ::setData(data, val);
+            addedPVP[field.name].setValue(val);
+            break;
         }
-        else if (it->second.getFormat() == "CI2" || it->second.getFormat() == "CI4" ||
-                 it->second.getFormat() == "CI8" || it->second.getFormat() == "CI16")
+        case PVPLayout::ADDED_COMPLEX_INT:
         {
             std::complex<int> val;
-            ::setData(input + it->second.getByteOffset(), val);
-            addedPVP[it->first] = six::Parameter();
-            addedPVP.find(it->first)->second.setValue(val);
+            ::setData(data, val);
+            addedPVP[field.name].setValue(val);
+            break;
         }
-        else if (it->second.getFormat() == "CF8" || it->second.getFormat() == "CF16")
+        case PVPLayout::ADDED_COMPLEX_FLOAT:
         {
             std::complex<double> val;
-            ::setData(input + it->second.getByteOffset(), val);
-            addedPVP[it->first] = six::Parameter();
-            addedPVP.find(it->first)->second.setValue(val);
+            ::setData(data, val);
+            addedPVP[field.name].setValue(val);
+            break;
         }
-        else
+        case PVPLayout::ADDED_STRING:
         {
-            std::string val;
-            val.assign(input + it->second.getByteOffset(), it->second.getByteSize());
-            addedPVP[it->first] = six::Parameter();
-            addedPVP.find(it->first)->second.setValue(val);
+            // Drop the zero padding that read() adds to shorter strings
+            size_t length = field.byteSize;
+            while (length > 0 && data[length - 1] == '\0')
+            {
+                --length;
+            }
+            addedPVP[field.name].setValue(std::string(data, length));
+            break;
+        }
         }
     }
 }
 
-void PVPBlock::PVPSet::read(const Pvp& p, sys::ubyte* dest) const
+void PVPBlock::PVPSet::read(const PVPLayout& layout, sys::ubyte* dest) const
 {
-    ::getData(dest + p.txTime.getByteOffset(), txTime);
-    ::getData(dest + p.txPos.getByteOffset(), txPos);
-    ::getData(dest + p.txVel.getByteOffset(), txVel);
-    ::getData(dest + p.rcvTime.getByteOffset(), rcvTime);
-    ::getData(dest + p.rcvPos.getByteOffset(), rcvPos);
-    ::getData(dest + p.rcvVel.getByteOffset(), rcvVel);
-    ::getData(dest + p.srpPos.getByteOffset(), srpPos);
-    ::getData(dest + p.aFDOP.getByteOffset(), aFDOP);
-    ::getData(dest + p.aFRR1.getByteOffset(), aFRR1);
-    ::getData(dest + p.aFRR2.getByteOffset(), aFRR2);
-    ::getData(dest + p.fx1.getByteOffset(), fx1);
-    ::getData(dest + p.fx2.getByteOffset(), fx2);
-    ::getData(dest + p.toa1.getByteOffset(), toa1);
-    ::getData(dest + p.toa2.getByteOffset(), toa2);
-    ::getData(dest + p.tdTropoSRP.getByteOffset(), tdTropoSRP);
-    ::getData(dest + p.sc0.getByteOffset(), sc0);
-    ::getData(dest + p.scss.getByteOffset(), scss);
-
-    if (ampSF.get())
-    {
-        ::getData(dest + p.ampSF.getByteOffset(), *ampSF);
-    }
-    if (fxN1.get())
-    {
-        ::getData(dest + p.fxN1.getByteOffset(), *fxN1);
-    }
-    if (fxN2.get())
-    {
-        ::getData(dest + p.fxN2.getByteOffset(), *fxN2);
-    }
-    if (toaE1.get())
-    {
-        ::getData(dest + p.toaE1.getByteOffset(), *toaE1);
-    }
-    if (toaE2.get())
-    {
-        ::getData(dest + p.toaE2.getByteOffset(), *toaE2);
-    }
-    if (tdIonoSRP.get())
-    {
-        ::getData(dest + p.tdIonoSRP.getByteOffset(), *tdIonoSRP);
-    }
-    if (signal.get())
-    {
-        ::getData(dest + p.signal.getByteOffset(), *signal);
-    }
-    if (addedPVP.size() != p.addedPVP.size())
+    if (addedPVP.size() != layout.numAdded)
     {
         throw except::Exception(Ctxt(
             "Incorrect number of additional parameters instantiated"));
     }
-    for (auto it = p.addedPVP.begin(); it != p.addedPVP.end(); ++it)
+
+    for (size_t ii = 0; ii < layout.fields.size(); ++ii)
     {
-        if (it->second.getFormat() == "F4" || it->second.getFormat() == "F8")
+        const PVPLayout::Field& field = layout.fields[ii];
+        sys::ubyte* const data = dest + field.byteOffset;
+
+        const six::Parameter* added = nullptr;
+        if (field.type >= PVPLayout::ADDED_FLOAT)
         {
-            ::getData(dest + it->second.getByteOffset(), static_cast<double>(addedPVP.find(it->first)->second));
+            auto iter = addedPVP.find(field.name);
+            if (iter == addedPVP.end())
+            {
+                throw except::Exception(Ctxt(
+                    "Additional parameter " + field.name + " was not set"));
+            }
+            added = &iter->second;
         }
-        else if (it->second.getFormat() == "U1" || it->second.getFormat() == "U2" ||
-                 it->second.getFormat() == "U4" || it->second.getFormat() == "U8")
+
+        switch (field.type)
         {
-            ::getData(dest + it->second.getByteOffset(), static_cast<unsigned int>(addedPVP.find(it->first)->second));
-        }
-        else if (it->second.getFormat() == "I1" || it->second.getFormat() == "I2" ||
-                 it->second.getFormat() == "I4" || it->second.getFormat() == "I8")
+        case PVPLayout::SCALAR:
+            ::getData(data, this->*field.scalar);
+            break;
+        case PVPLayout::VECTOR3:
+            ::getData(data, this->*field.vector);
+            break;
+        case PVPLayout::OPTIONAL:
+            if ((this->*field.optional).get())
+            {
+                ::getData(data, *(this->*field.optional));
+            }
+            break;
+        case PVPLayout::ADDED_FLOAT:
+            ::getData(data, static_cast<double>(*added));
+            break;
+        case PVPLayout::ADDED_UNSIGNED:
+            ::getData(data, static_cast<unsigned int>(*added));
+            break;
+        case PVPLayout::ADDED_SIGNED:
+            ::getData(data, static_cast<int>(*added));
+            break;
+        case PVPLayout::ADDED_COMPLEX_INT:
+            ::getData(data, added->getComplex<int>());
+            break;
+        case PVPLayout::ADDED_COMPLEX_FLOAT:
+            ::getData(data, added->getComplex<double>());
+            break;
+        case PVPLayout::ADDED_STRING:
         {
-            ::getData(dest + it->second.getByteOffset(), static_cast<int>(addedPVP.find(it->first)->second));
+            // Shorter strings are zero padded
+            const std::string val = added->str();
+            const size_t length = std::min(val.size(), field.byteSize);
+            memcpy(data, val.c_str(), length);
+            memset(data + length, 0, field.byteSize - length);
+            break;
         }
-        else if (it->second.getFormat() == "CI2" || it->second.getFormat() == "CI4" ||
-                 it->second.getFormat() == "CI8" || it->second.getFormat() == "CI16")
-        {
-            ::getData(dest + it->second.getByteOffset(), addedPVP.find(it->first)->second.getComplex<int>());
         }
-        else if (it->second.getFormat() == "CF8" || it->second.getFormat() == "CF16")
+    }
+}
+
+class PVPBlock::DecodeJob
+{
+public:
+    DecodeJob(PVPBlock& block,
+              size_t channel,
+              sys::byte* input,
+              size_t stride,
+              bool byteSwap) :
+        mBlock(block),
+        mChannel(channel),
+        mInput(input),
+        mStride(stride),
+        mByteSwap(byteSwap)
+    {
+    }
+
+    void operator()(size_t startVector, size_t numVectors) const
+    {
+        std::vector<PVPSet>& sets = mBlock.mData[mChannel];
+        sys::byte* ptr = mInput + startVector * mStride;
+        for (size_t ii = startVector;
+             ii < startVector + numVectors;
+             ++ii, ptr += mStride)
         {
-            ::getData(dest + it->second.getByteOffset(), addedPVP.find(it->first)->second.getComplex<double>());
+            // Swap while the vector is in cache
+            if (mByteSwap)
+            {
+                sys::byteSwap(ptr, sizeof(double), mStride / sizeof(double));
+            }
+            sets[ii].write(mBlock.mLayout, ptr);
         }
-        else
+    }
+
+private:
+    PVPBlock& mBlock;
+    const size_t mChannel;
+    sys::byte* const mInput;
+    const size_t mStride;
+    const bool mByteSwap;
+};
+
+class PVPBlock::EncodeJob
+{
+public:
+    EncodeJob(const PVPBlock& block,
+              size_t channel,
+              sys::ubyte* output,
+              bool byteSwap) :
+        mBlock(block),
+        mChannel(channel),
+        mOutput(output),
+        mByteSwap(byteSwap)
+    {
+    }
+
+    void operator()(size_t startVector, size_t numVectors) const
+    {
+        const std::vector<PVPSet>& sets = mBlock.mData[mChannel];
+        const size_t stride = mBlock.getNumBytesPVPSet();
+        sys::ubyte* ptr = mOutput + startVector * stride;
+        memset(ptr, 0, numVectors * stride);
+        for (size_t ii = startVector;
+             ii < startVector + numVectors;
+             ++ii, ptr += stride)
         {
-            ::getData(dest + it->second.getByteOffset(), addedPVP.find(it->first)->second.str().c_str(), it->second.getByteSize());
+            sets[ii].read(mBlock.mLayout, ptr);
+            if (mByteSwap)
+            {
+                sys::byteSwap(ptr, sizeof(double), stride / sizeof(double));
+            }
         }
     }
-}
+
+private:
+    const PVPBlock& mBlock;
+    const size_t mChannel;
+    sys::ubyte* const mOutput;
+    const bool mByteSwap;
+};
 
 /*
  * Initialize PVP Array with a data object
@@ -298,6 +438,7 @@ PVPBlock::PVPBlock(const Pvp& p, const Data& d) :
     mSignalEnabled(!six::Init::isUndefined<size_t>(p.signal.getOffset()))
 {
     mPvp = p;
+    mLayout = PVPLayout(mPvp);
     mNumBytesPerVector = d.getNumBytesPVPSet();
     mData.resize(d.getNumChannels());
     for (size_t ii = 0; ii < d.getNumChannels(); ++ii)
@@ -323,6 +464,7 @@ PVPBlock::PVPBlock(size_t numChannels,
                    const Pvp& p) :
     mNumBytesPerVector(0),
     mPvp(p),
+    mLayout(p),
     mAmpSFEnabled(!six::Init::isUndefined<size_t>(p.ampSF.getOffset())),
     mFxN1Enabled(!six::Init::isUndefined<size_t>(p.fxN1.getOffset())),
     mFxN2Enabled(!six::Init::isUndefined<size_t>(p.fxN2.getOffset())),
@@ -369,7 +511,7 @@ PVPBlock::PVPBlock(size_t numChannels,
 
         for (size_t vector = 0; vector < numVectors[channel]; ++vector)
         {
-            mData[channel][vector].write(*this, mPvp, buf);
+            mData[channel][vector].write(mLayout, buf);
             buf += mPvp.sizeInBytes();
         }
     }
@@ -413,16 +555,20 @@ void PVPBlock::getPVPdata(size_t channel,
 void PVPBlock::getPVPdata(size_t channel,
                           void* data) const
 {
-    verifyChannelVector(channel, 0);
-    const size_t numBytes = getNumBytesPVPSet();
-    sys::ubyte* ptr = static_cast<sys::ubyte*>(data);
+    getPVPdata(channel, data, false, 1);
+}
 
-    for (size_t ii = 0;
-         ii < mData[channel].size();
-         ++ii, ptr += numBytes)
-    {
-        mData[channel][ii].read(mPvp, ptr);
-    }
+void PVPBlock::getPVPdata(size_t channel,
+                          void* data,
+                          bool byteSwap,
+                          size_t numThreads) const
+{
+    verifyChannelVector(channel, 0);
+    const EncodeJob job(*this,
+                        channel,
+                        static_cast<sys::ubyte*>(data),
+                        byteSwap);
+    scene::runInParallel(job, mData[channel].size(), numThreads);
 }
 
 sys::Off_T PVPBlock::load(io::SeekableInputStream& inStream,
@@ -472,21 +618,14 @@ sys::Off_T PVPBlock::load(io::SeekableInputStream& inStream,
             }
             totalBytesRead += bytesThisRead;
 
-            // Input CPHD is always Big Endian; swap to Little Endian if
-            // necessary
-            if (swapToLittleEndian)
-            {
-                byteSwap(buf,
-                         sizeof(double),
-                         readBuf.size() / sizeof(double),
-                         numThreads);
-            }
-
-            sys::byte* ptr = buf;
-            for (size_t jj = 0; jj < mData[ii].size(); ++jj, ptr += numBytesPerVector)
-            {
-                mData[ii][jj].write(*this, mPvp, ptr);
-            }
+            // Input CPHD is always Big Endian; each vector is swapped to
+            // Little Endian if necessary right before it's unpacked
+            const DecodeJob job(*this,
+                                ii,
+                                buf,
+                                numBytesPerVector,
+                                swapToLittleEndian);
+            scene::runInParallel(job, mData[ii].size(), numThreads);
         }
     }
     return totalBytesRead;
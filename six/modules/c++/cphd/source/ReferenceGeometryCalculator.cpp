@@ -0,0 +1,599 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <sstream>
+
+#include <except/Exception.h>
+#include <math/Constants.h>
+#include <scene/RangeRunnable.h>
+#include <scene/Utilities.h>
+#include <str/Convert.h>
+#include <six/Init.h>
+#include <cphd/ReferenceGeometryCalculator.h>
+
+namespace
+{
+const double DEGREES = math::Constants::RADIANS_TO_DEGREES;
+
+// Earth Tangent Plane axes at a point, as scene::SceneGeometry has them
+struct TangentPlane
+{
+    explicit TangentPlane(const cphd::Vector3& point) :
+        origin(point)
+    {
+        const scene::LatLonAlt lla = scene::Utilities::ecefToLatLon(point);
+        const double sinLat = std::sin(lla.getLatRadians());
+        const double cosLat = std::cos(lla.getLatRadians());
+        const double sinLon = std::sin(lla.getLonRadians());
+        const double cosLon = std::cos(lla.getLonRadians());
+
+        up[0] = cosLat * cosLon;
+        up[1] = cosLat * sinLon;
+        up[2] = sinLat;
+
+        north[0] = -sinLat * cosLon;
+        north[1] = -sinLat * sinLon;
+        north[2] = cosLat;
+
+        east = math::linear::cross(north, up);
+    }
+
+    double azimuth(const cphd::Vector3& vec) const
+    {
+        return scene::Utilities::remapZeroTo360(
+                std::atan2(east.dot(vec), north.dot(vec)) * DEGREES);
+    }
+
+    cphd::Vector3 origin;
+    cphd::Vector3 up;
+    cphd::Vector3 north;
+    cphd::Vector3 east;
+};
+
+// Unit vector from the SRP to an APC and its rate of change
+struct LineOfSight
+{
+    LineOfSight(const cphd::Vector3& srp,
+                const cphd::Vector3& pos,
+                const cphd::Vector3& vel)
+    {
+        const cphd::Vector3 offset = pos - srp;
+        range = offset.norm();
+        unit = offset / range;
+        rate = (vel - unit * vel.dot(unit)) / range;
+    }
+
+    double range;
+    cphd::Vector3 unit;
+    cphd::Vector3 rate;
+};
+
+// Side of track of a pointing vector and its rate.  The slant plane normal
+// is flipped to point up.
+int sideOfTrack(const cphd::Vector3& pointing,
+                const cphd::Vector3& rate,
+                const TangentPlane& etp,
+                cphd::Vector3& slantPlaneNormal)
+{
+    slantPlaneNormal = math::linear::cross(pointing, rate).unit();
+    if (slantPlaneNormal.dot(etp.up) < 0)
+    {
+        slantPlaneNormal *= -1.0;
+        return scene::TRACK_RIGHT;
+    }
+    return scene::TRACK_LEFT;
+}
+
+// The ImagingType angles of a pointing vector and its rate
+int imagingAngles(const cphd::Vector3& pointing,
+                  const cphd::Vector3& rate,
+                  const TangentPlane& etp,
+                  cphd::ImagingType& angles)
+{
+    cphd::Vector3 spn;
+    const int side = sideOfTrack(pointing, rate, etp, spn);
+    const cphd::Vector3 unit = pointing.unit();
+
+    angles.azimuthAngle = etp.azimuth(unit);
+    angles.grazeAngle = std::asin(unit.dot(etp.up)) * DEGREES;
+    angles.slopeAngle = std::acos(spn.dot(etp.up)) * DEGREES;
+
+    const cphd::Vector3 gpx = (unit - etp.up * unit.dot(etp.up)).unit();
+    const cphd::Vector3 gpy = math::linear::cross(etp.up, gpx);
+    angles.twistAngle = -std::asin(gpy.dot(spn)) * DEGREES;
+
+    // Direction a point above the ETP lays over in it
+    const cphd::Vector3 layover = etp.up - spn / spn.dot(etp.up);
+    angles.layoverAngle = etp.azimuth(layover);
+    return side;
+}
+
+double groundRange(const cphd::Vector3& pos, const cphd::Vector3& srp)
+{
+    return srp.norm() * pos.angle(srp);
+}
+
+double dopplerConeAngle(const cphd::Vector3& vel, const LineOfSight& los)
+{
+    return std::acos(-vel.unit().dot(los.unit)) * DEGREES;
+}
+
+// Everything about one vector that the ReferenceGeometry is built from
+struct VectorSolution
+{
+    VectorSolution(const cphd::PVPBlock& pvpBlock,
+                   size_t channel,
+                   size_t vector,
+                   bool bistatic,
+                   const TangentPlane& etp) :
+        srp(pvpBlock.getSRPPos(channel, vector)),
+        txTime(pvpBlock.getTxTime(channel, vector)),
+        rcvTime(pvpBlock.getRcvTime(channel, vector)),
+        txPos(pvpBlock.getTxPos(channel, vector)),
+        txVel(pvpBlock.getTxVel(channel, vector)),
+        rcvPos(pvpBlock.getRcvPos(channel, vector)),
+        rcvVel(pvpBlock.getRcvVel(channel, vector)),
+        arpPos((txPos + rcvPos) * 0.5),
+        arpVel((txVel + rcvVel) * 0.5),
+        tx(srp, txPos, txVel),
+        rcv(srp, rcvPos, rcvVel),
+        arp(srp, arpPos, arpVel)
+    {
+        referenceTime = txTime +
+                tx.range / math::Constants::SPEED_OF_LIGHT_METERS_PER_SEC;
+        if (bistatic)
+        {
+            pointing = (tx.unit + rcv.unit) * 0.5;
+            pointingRate = (tx.rate + rcv.rate) * 0.5;
+            slantRange = 0.5 * (tx.range + rcv.range);
+            bistaticAngle = std::acos(
+                    std::max(-1.0, std::min(1.0, tx.unit.dot(rcv.unit))));
+        }
+        else
+        {
+            pointing = arp.unit;
+            pointingRate = arp.rate;
+            slantRange = arp.range;
+            bistaticAngle = 0.0;
+        }
+        side = imagingAngles(pointing, pointingRate, etp, angles);
+    }
+
+    cphd::Vector3 srp;
+    double txTime;
+    double rcvTime;
+    cphd::Vector3 txPos;
+    cphd::Vector3 txVel;
+    cphd::Vector3 rcvPos;
+    cphd::Vector3 rcvVel;
+    cphd::Vector3 arpPos;
+    cphd::Vector3 arpVel;
+    LineOfSight tx;
+    LineOfSight rcv;
+    LineOfSight arp;
+
+    double referenceTime;
+    cphd::Vector3 pointing;
+    cphd::Vector3 pointingRate;
+    double slantRange;
+    double bistaticAngle;     // Radians
+    cphd::ImagingType angles;
+    int side;
+};
+
+void setPlatform(const VectorSolution& solution,
+                 const LineOfSight& los,
+                 double time,
+                 const cphd::Vector3& pos,
+                 const cphd::Vector3& vel,
+                 const TangentPlane& etp,
+                 cphd::Bistatic::PlatformParams& platform)
+{
+    cphd::Vector3 spn;
+    platform.sideOfTrack = six::SideOfTrackType(
+            sideOfTrack(los.unit, los.rate, etp, spn));
+    platform.time = time;
+    platform.azimuthAngle = etp.azimuth(los.unit);
+    platform.grazeAngle = std::asin(los.unit.dot(etp.up)) * DEGREES;
+    platform.incidenceAngle = 90.0 - platform.grazeAngle;
+    platform.dopplerConeAngle = dopplerConeAngle(vel, los);
+    platform.groundRange = groundRange(pos, solution.srp);
+    platform.slantRange = los.range;
+    platform.pos = pos;
+    platform.vel = vel;
+}
+
+struct VectorGeometryJob
+{
+    const cphd::PVPBlock* pvpBlock;
+    size_t channel;
+    bool bistatic;
+    cphd::ReferenceGeometryCalculator::VectorGeometry* geometry;
+
+    void operator()(size_t start, size_t num) const
+    {
+        std::auto_ptr<TangentPlane> etp;
+        for (size_t ii = start; ii < start + num; ++ii)
+        {
+            const cphd::Vector3 srp = pvpBlock->getSRPPos(channel, ii);
+            if (!etp.get() || etp->origin != srp)
+            {
+                etp.reset(new TangentPlane(srp));
+            }
+            const VectorSolution solution(*pvpBlock, channel, ii, bistatic,
+                                          *etp);
+            geometry->referenceTime[ii] = solution.referenceTime;
+            geometry->slantRange[ii] = solution.slantRange;
+            geometry->azimuthAngle[ii] = solution.angles.azimuthAngle;
+            geometry->grazeAngle[ii] = solution.angles.grazeAngle;
+            geometry->twistAngle[ii] = solution.angles.twistAngle;
+            geometry->slopeAngle[ii] = solution.angles.slopeAngle;
+            geometry->layoverAngle[ii] = solution.angles.layoverAngle;
+            geometry->bistaticAngle[ii] = solution.bistaticAngle * DEGREES;
+            geometry->sideOfTrack[ii] = solution.side;
+        }
+    }
+};
+
+class Comparer
+{
+public:
+    explicit Comparer(logging::Logger& log) :
+        mLog(log),
+        mValid(true)
+    {
+    }
+
+    void operator()(double given,
+                    double expected,
+                    double tolerance,
+                    const std::string& name)
+    {
+        if (!(std::abs(given - expected) <= tolerance))
+        {
+            error(name, given, expected);
+        }
+    }
+
+    void operator()(const cphd::Vector3& given,
+                    const cphd::Vector3& expected,
+                    double tolerance,
+                    const std::string& name)
+    {
+        if (!((given - expected).norm() <= tolerance))
+        {
+            error(name, given, expected);
+        }
+    }
+
+    void operator()(six::SideOfTrackType given,
+                    six::SideOfTrackType expected,
+                    const std::string& name)
+    {
+        if (given != expected)
+        {
+            error(name, given.toString(), expected.toString());
+        }
+    }
+
+    bool isValid() const
+    {
+        return mValid;
+    }
+
+private:
+    template <typename T>
+    void error(const std::string& name, const T& given, const T& expected)
+    {
+        std::ostringstream message;
+        message << "ReferenceGeometry is inconsistent with the PVPs\n"
+                << "ReferenceGeometry." << name << ": " << given << "\n"
+                << "Derived " << name << ": " << expected << "\n";
+        mLog.error(message.str());
+        mValid = false;
+    }
+
+    logging::Logger& mLog;
+    bool mValid;
+};
+
+void compareImagingType(const cphd::ImagingType& given,
+                        const cphd::ImagingType& expected,
+                        const std::string& prefix,
+                        double tolerance,
+                        Comparer& compare)
+{
+    compare(given.azimuthAngle, expected.azimuthAngle, tolerance,
+            prefix + "AzimuthAngle");
+    compare(given.grazeAngle, expected.grazeAngle, tolerance,
+            prefix + "GrazeAngle");
+    compare(given.twistAngle, expected.twistAngle, tolerance,
+            prefix + "TwistAngle");
+    compare(given.slopeAngle, expected.slopeAngle, tolerance,
+            prefix + "SlopeAngle");
+    compare(given.layoverAngle, expected.layoverAngle, tolerance,
+            prefix + "LayoverAngle");
+}
+
+void comparePlatform(
+        const cphd::Bistatic::PlatformParams& given,
+        const cphd::Bistatic::PlatformParams& expected,
+        const std::string& prefix,
+        const cphd::ReferenceGeometryCalculator::Tolerances& tolerances,
+        Comparer& compare)
+{
+    compare(given.sideOfTrack, expected.sideOfTrack, prefix + "SideOfTrack");
+    compare(given.time, expected.time, tolerances.time, prefix + "Time");
+    compare(given.azimuthAngle, expected.azimuthAngle, tolerances.angle,
+            prefix + "AzimuthAngle");
+    compare(given.grazeAngle, expected.grazeAngle, tolerances.angle,
+            prefix + "GrazeAngle");
+    compare(given.incidenceAngle, expected.incidenceAngle, tolerances.angle,
+            prefix + "IncidenceAngle");
+    compare(given.dopplerConeAngle, expected.dopplerConeAngle,
+            tolerances.angle, prefix + "DopplerConeAngle");
+    compare(given.groundRange, expected.groundRange, tolerances.distance,
+            prefix + "GroundRange");
+    compare(given.slantRange, expected.slantRange, tolerances.distance,
+            prefix + "SlantRange");
+    compare(given.pos, expected.pos, tolerances.distance, prefix + "Pos");
+    compare(given.vel, expected.vel, tolerances.speed, prefix + "Vel");
+}
+}
+
+namespace cphd
+{
+void ReferenceGeometryCalculator::VectorGeometry::resize(size_t numVectors)
+{
+    referenceTime.resize(numVectors);
+    slantRange.resize(numVectors);
+    azimuthAngle.resize(numVectors);
+    grazeAngle.resize(numVectors);
+    twistAngle.resize(numVectors);
+    slopeAngle.resize(numVectors);
+    layoverAngle.resize(numVectors);
+    bistaticAngle.resize(numVectors);
+    sideOfTrack.resize(numVectors);
+}
+
+ReferenceGeometryCalculator::ReferenceGeometryCalculator(
+        const Metadata& metadata,
+        const PVPBlock& pvpBlock,
+        size_t numThreads) :
+    mMetadata(metadata),
+    mPVPBlock(pvpBlock),
+    mNumThreads(numThreads),
+    mBistatic(metadata.collectionID.collectType == six::CollectType::BISTATIC)
+{
+}
+
+size_t ReferenceGeometryCalculator::getReferenceChannel() const
+{
+    for (size_t ii = 0; ii < mMetadata.data.channels.size(); ++ii)
+    {
+        if (mMetadata.data.channels[ii].identifier ==
+            mMetadata.channel.refChId)
+        {
+            return ii;
+        }
+    }
+    throw except::Exception(Ctxt(
+            "Reference channel " + mMetadata.channel.refChId +
+            " isn't in the Data block"));
+}
+
+void ReferenceGeometryCalculator::computeVectorGeometry(
+        size_t channel,
+        VectorGeometry& geometry) const
+{
+    const size_t numVectors = mPVPBlock.getNumVectors(channel);
+    geometry.resize(numVectors);
+    const VectorGeometryJob job = { &mPVPBlock, channel, mBistatic,
+                                    &geometry };
+    scene::runInParallel(job, numVectors, mNumThreads);
+}
+
+ReferenceGeometry
+ReferenceGeometryCalculator::computeReferenceGeometry(size_t channel,
+                                                      size_t vector) const
+{
+    const TangentPlane etp(mPVPBlock.getSRPPos(channel, vector));
+    const VectorSolution solution(mPVPBlock, channel, vector, mBistatic, etp);
+
+    ReferenceGeometry geometry;
+    geometry.referenceTime = solution.referenceTime;
+    geometry.srp.ecf = solution.srp;
+
+    const SceneCoordinates& scene = mMetadata.sceneCoordinates;
+    if (scene.referenceSurface.planar.get())
+    {
+        const Vector3 uIAX = scene.referenceSurface.planar->uIax.unit();
+        const Vector3 uIAY = scene.referenceSurface.planar->uIay.unit();
+        const Vector3 uIAZ = math::linear::cross(uIAX, uIAY);
+        const Vector3 offset = solution.srp - scene.iarp.ecf;
+        geometry.srp.iac[0] = offset.dot(uIAX);
+        geometry.srp.iac[1] = offset.dot(uIAY);
+        geometry.srp.iac[2] = offset.dot(uIAZ);
+
+        if (channel < mMetadata.channel.parameters.size())
+        {
+            const DwellTimes& dwellTimes =
+                    mMetadata.channel.parameters[channel].dwellTimes;
+            const COD* cod = nullptr;
+            for (size_t ii = 0; ii < mMetadata.dwell.cod.size(); ++ii)
+            {
+                if (mMetadata.dwell.cod[ii].identifier == dwellTimes.codId)
+                {
+                    cod = &mMetadata.dwell.cod[ii];
+                }
+            }
+            const DwellTime* dwellTime = nullptr;
+            for (size_t ii = 0; ii < mMetadata.dwell.dtime.size(); ++ii)
+            {
+                if (mMetadata.dwell.dtime[ii].identifier == dwellTimes.dwellId)
+                {
+                    dwellTime = &mMetadata.dwell.dtime[ii];
+                }
+            }
+            if (!cod || !dwellTime)
+            {
+                throw except::Exception(Ctxt(
+                        "Channel " + str::toString(channel) + " refers to "
+                        "a COD or dwell time polynomial that isn't in the "
+                        "Dwell block"));
+            }
+            geometry.srpCODTime = cod->codTimePoly(geometry.srp.iac[0],
+                                                   geometry.srp.iac[1]);
+            geometry.srpDwellTime = dwellTime->dwellTimePoly(
+                    geometry.srp.iac[0], geometry.srp.iac[1]);
+        }
+    }
+
+    if (mBistatic)
+    {
+        geometry.bistatic.reset(new Bistatic());
+        Bistatic& bistatic = *geometry.bistatic;
+        static_cast<ImagingType&>(bistatic) = solution.angles;
+
+        const LineOfSight& tx = solution.tx;
+        const LineOfSight& rcv = solution.rcv;
+        bistatic.bistaticAngle = solution.bistaticAngle * DEGREES;
+        const double sinBeta = std::sin(solution.bistaticAngle);
+        bistatic.bistaticAngleRate = sinBeta == 0.0 ? 0.0 :
+                -(tx.rate.dot(rcv.unit) + tx.unit.dot(rcv.rate)) /
+                sinBeta * DEGREES;
+
+        // d/dt of atan2(east . b, north . b)
+        const double east = etp.east.dot(solution.pointing);
+        const double north = etp.north.dot(solution.pointing);
+        const double eastRate = etp.east.dot(solution.pointingRate);
+        const double northRate = etp.north.dot(solution.pointingRate);
+        bistatic.azimuthAngleRate =
+                (eastRate * north - east * northRate) /
+                (east * east + north * north) * DEGREES;
+
+        setPlatform(solution, tx, solution.txTime, solution.txPos,
+                    solution.txVel, etp, bistatic.txPlatform);
+        setPlatform(solution, rcv, solution.rcvTime, solution.rcvPos,
+                    solution.rcvVel, etp, bistatic.rcvPlatform);
+    }
+    else
+    {
+        geometry.monostatic.reset(new Monostatic());
+        Monostatic& monostatic = *geometry.monostatic;
+        static_cast<ImagingType&>(monostatic) = solution.angles;
+        monostatic.sideOfTrack = six::SideOfTrackType(solution.side);
+        monostatic.slantRange = solution.slantRange;
+        monostatic.groundRange = groundRange(solution.arpPos, solution.srp);
+        monostatic.dopplerConeAngle =
+                dopplerConeAngle(solution.arpVel, solution.arp);
+        monostatic.incidenceAngle = 90.0 - solution.angles.grazeAngle;
+        monostatic.arpPos = solution.arpPos;
+        monostatic.arpVel = solution.arpVel;
+    }
+    return geometry;
+}
+
+ReferenceGeometry ReferenceGeometryCalculator::computeReferenceGeometry() const
+{
+    const size_t channel = getReferenceChannel();
+    if (channel >= mMetadata.channel.parameters.size())
+    {
+        throw except::Exception(Ctxt(
+                "Reference channel has no Channel parameters"));
+    }
+    return computeReferenceGeometry(
+            channel, mMetadata.channel.parameters[channel].refVectorIndex);
+}
+
+bool ReferenceGeometryCalculator::validate(const ReferenceGeometry& given,
+                                           logging::Logger& log,
+                                           const Tolerances& tolerances) const
+{
+    const ReferenceGeometry expected = computeReferenceGeometry();
+    Comparer compare(log);
+
+    compare(given.referenceTime, expected.referenceTime, tolerances.time,
+            "ReferenceTime");
+    compare(given.srp.ecf, expected.srp.ecf, tolerances.distance, "SRP.ECF");
+    if (!six::Init::isUndefined(expected.srp.iac))
+    {
+        compare(given.srp.iac, expected.srp.iac, tolerances.distance,
+                "SRP.IAC");
+        compare(given.srpCODTime, expected.srpCODTime, tolerances.time,
+                "SRPCODTime");
+        compare(given.srpDwellTime, expected.srpDwellTime, tolerances.time,
+                "SRPDwellTime");
+    }
+
+    if (expected.monostatic.get())
+    {
+        if (!given.monostatic.get())
+        {
+            log.error("ReferenceGeometry is missing Monostatic parameters");
+            return false;
+        }
+        const Monostatic& lhs = *given.monostatic;
+        const Monostatic& rhs = *expected.monostatic;
+        compareImagingType(lhs, rhs, "Monostatic.", tolerances.angle,
+                           compare);
+        compare(lhs.sideOfTrack, rhs.sideOfTrack, "Monostatic.SideOfTrack");
+        compare(lhs.slantRange, rhs.slantRange, tolerances.distance,
+                "Monostatic.SlantRange");
+        compare(lhs.groundRange, rhs.groundRange, tolerances.distance,
+                "Monostatic.GroundRange");
+        compare(lhs.dopplerConeAngle, rhs.dopplerConeAngle, tolerances.angle,
+                "Monostatic.DopplerConeAngle");
+        compare(lhs.incidenceAngle, rhs.incidenceAngle, tolerances.angle,
+                "Monostatic.IncidenceAngle");
+        compare(lhs.arpPos, rhs.arpPos, tolerances.distance,
+                "Monostatic.ARPPos");
+        compare(lhs.arpVel, rhs.arpVel, tolerances.speed,
+                "Monostatic.ARPVel");
+    }
+    else
+    {
+        if (!given.bistatic.get())
+        {
+            log.error("ReferenceGeometry is missing Bistatic parameters");
+            return false;
+        }
+        const Bistatic& lhs = *given.bistatic;
+        const Bistatic& rhs = *expected.bistatic;
+        compareImagingType(lhs, rhs, "Bistatic.", tolerances.angle, compare);
+        compare(lhs.azimuthAngleRate, rhs.azimuthAngleRate,
+                tolerances.angleRate, "Bistatic.AzimuthAngleRate");
+        compare(lhs.bistaticAngle, rhs.bistaticAngle, tolerances.angle,
+                "Bistatic.BistaticAngle");
+        compare(lhs.bistaticAngleRate, rhs.bistaticAngleRate,
+                tolerances.angleRate, "Bistatic.BistaticAngleRate");
+        comparePlatform(lhs.txPlatform, rhs.txPlatform,
+                        "Bistatic.TxPlatform.", tolerances, compare);
+        comparePlatform(lhs.rcvPlatform, rhs.rcvPlatform,
+                        "Bistatic.RcvPlatform.", tolerances, compare);
+    }
+    return compare.isValid();
+}
+}
@@ -0,0 +1,708 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string.h>
+#include <algorithm>
+#include <sstream>
+
+#include <cphd/ByteSwap.h>
+#include <cphd/SignalCodec.h>
+#include <except/Exception.h>
+#include <mt/CriticalSection.h>
+#include <scene/RangeRunnable.h>
+
+namespace
+{
+const char INDEX_MAGIC[] = "SIXSCBI1";
+
+// Target uncompressed size of a block when the caller doesn't pick one
+const size_t DEFAULT_BLOCK_BYTES = 256 * 1024;
+
+// First byte of every compressed block
+const sys::ubyte METHOD_STORED = 0;
+const sys::ubyte METHOD_LZ = 1;
+
+const size_t MIN_MATCH = 4;
+const size_t MAX_OFFSET = 65535;
+const size_t HASH_BITS = 14;
+
+void writeUint64(sys::Uint64_T value, sys::ubyte* data)
+{
+    for (size_t ii = 0; ii < 8; ++ii)
+    {
+        data[ii] = static_cast<sys::ubyte>(value >> (56 - 8 * ii));
+    }
+}
+
+sys::Uint64_T readUint64(const sys::ubyte* data)
+{
+    sys::Uint64_T value = 0;
+    for (size_t ii = 0; ii < 8; ++ii)
+    {
+        value = (value << 8) | data[ii];
+    }
+    return value;
+}
+
+inline
+sys::Uint32_T read32(const sys::ubyte* data)
+{
+    sys::Uint32_T value;
+    memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+inline
+size_t hash(sys::Uint32_T value)
+{
+    return (value * 2654435761U) >> (32 - HASH_BITS);
+}
+
+void writeLength(size_t length, std::vector<sys::ubyte>& output)
+{
+    while (length >= 255)
+    {
+        output.push_back(255);
+        length -= 255;
+    }
+    output.push_back(static_cast<sys::ubyte>(length));
+}
+
+// Each sequence is a token (literal count in the high nibble, match length
+// minus MIN_MATCH in the low nibble, 15 meaning more length bytes follow),
+// the literals, and then a two byte offset back to the match.  The last
+// sequence has no match.
+void writeSequence(const sys::ubyte* literals,
+                   size_t numLiterals,
+                   size_t offset,
+                   size_t matchLength,
+                   std::vector<sys::ubyte>& output)
+{
+    const size_t extraMatch = matchLength ? matchLength - MIN_MATCH : 0;
+    output.push_back(static_cast<sys::ubyte>(
+            (std::min<size_t>(numLiterals, 15) << 4) |
+            std::min<size_t>(extraMatch, 15)));
+    if (numLiterals >= 15)
+    {
+        writeLength(numLiterals - 15, output);
+    }
+    output.insert(output.end(), literals, literals + numLiterals);
+
+    if (matchLength)
+    {
+        output.push_back(static_cast<sys::ubyte>(offset & 0xFF));
+        output.push_back(static_cast<sys::ubyte>(offset >> 8));
+        if (extraMatch >= 15)
+        {
+            writeLength(extraMatch - 15, output);
+        }
+    }
+}
+
+void lzCompress(const sys::ubyte* input,
+                size_t size,
+                std::vector<sys::ubyte>& output)
+{
+    const size_t empty = static_cast<size_t>(-1);
+    std::vector<size_t> table(static_cast<size_t>(1) << HASH_BITS, empty);
+
+    size_t anchor = 0;
+    size_t pos = 0;
+    while (pos + MIN_MATCH <= size)
+    {
+        const sys::Uint32_T value = read32(input + pos);
+        size_t& entry = table[hash(value)];
+        const size_t candidate = entry;
+        entry = pos;
+
+        if (candidate == empty || pos - candidate > MAX_OFFSET ||
+            read32(input + candidate) != value)
+        {
+            ++pos;
+            continue;
+        }
+
+        size_t length = MIN_MATCH;
+        while (pos + length < size &&
+               input[candidate + length] == input[pos + length])
+        {
+            ++length;
+        }
+
+        writeSequence(input + anchor, pos - anchor, pos - candidate, length,
+                      output);
+        pos += length;
+        anchor = pos;
+    }
+
+    if (anchor < size)
+    {
+        writeSequence(input + anchor, size - anchor, 0, 0, output);
+    }
+}
+
+void throwCorrupt()
+{
+    throw except::Exception(Ctxt("Compressed signal block is corrupt"));
+}
+
+size_t readLength(const sys::ubyte*& input, const sys::ubyte* end)
+{
+    size_t length = 0;
+    sys::ubyte value;
+    do
+    {
+        if (input == end)
+        {
+            throwCorrupt();
+        }
+        value = *input++;
+        length += value;
+    }
+    while (value == 255);
+    return length;
+}
+
+void lzDecompress(const sys::ubyte* input,
+                  size_t inputSize,
+                  sys::ubyte* output,
+                  size_t outputSize)
+{
+    const sys::ubyte* const end = input + inputSize;
+    sys::ubyte* out = output;
+    sys::ubyte* const outEnd = output + outputSize;
+
+    while (input < end)
+    {
+        const sys::ubyte token = *input++;
+
+        size_t numLiterals = token >> 4;
+        if (numLiterals == 15)
+        {
+            numLiterals += readLength(input, end);
+        }
+        if (numLiterals > static_cast<size_t>(end - input) ||
+            numLiterals > static_cast<size_t>(outEnd - out))
+        {
+            throwCorrupt();
+        }
+        memcpy(out, input, numLiterals);
+        input += numLiterals;
+        out += numLiterals;
+
+        if (input == end)
+        {
+            break;
+        }
+
+        if (end - input < 2)
+        {
+            throwCorrupt();
+        }
+        const size_t offset = input[0] | (static_cast<size_t>(input[1]) << 8);
+        input += 2;
+
+        size_t length = (token & 0x0F) + MIN_MATCH;
+        if ((token & 0x0F) == 15)
+        {
+            length += readLength(input, end);
+        }
+        if (offset == 0 || offset > static_cast<size_t>(out - output) ||
+            length > static_cast<size_t>(outEnd - out))
+        {
+            throwCorrupt();
+        }
+
+        // Matches may overlap the bytes they produce
+        const sys::ubyte* match = out - offset;
+        for (size_t ii = 0; ii < length; ++ii)
+        {
+            out[ii] = match[ii];
+        }
+        out += length;
+    }
+
+    if (out != outEnd)
+    {
+        throwCorrupt();
+    }
+}
+
+void shuffle(const sys::ubyte* input,
+             size_t numElements,
+             size_t elementSize,
+             sys::ubyte* output)
+{
+    for (size_t ii = 0; ii < numElements; ++ii)
+    {
+        const sys::ubyte* const element = input + ii * elementSize;
+        for (size_t plane = 0; plane < elementSize; ++plane)
+        {
+            output[plane * numElements + ii] = element[plane];
+        }
+    }
+}
+
+void unshuffle(const sys::ubyte* input,
+               size_t numElements,
+               size_t elementSize,
+               sys::ubyte* output)
+{
+    for (size_t plane = 0; plane < elementSize; ++plane)
+    {
+        const sys::ubyte* const planeData = input + plane * numElements;
+        for (size_t ii = 0; ii < numElements; ++ii)
+        {
+            output[ii * elementSize + plane] = planeData[ii];
+        }
+    }
+}
+
+class CompressJob
+{
+public:
+    CompressJob(const cphd::SignalCodec& codec,
+                const cphd::SignalBlockIndex& index,
+                const sys::ubyte* input,
+                size_t bytesPerVector,
+                size_t elementSize,
+                bool byteSwap,
+                std::vector<std::vector<sys::ubyte> >& blocks) :
+        mCodec(codec),
+        mIndex(index),
+        mInput(input),
+        mBytesPerVector(bytesPerVector),
+        mElementSize(elementSize),
+        mByteSwap(byteSwap),
+        mBlocks(blocks)
+    {
+    }
+
+    void operator()(size_t startBlock, size_t numBlocks) const
+    {
+        std::vector<sys::ubyte> scratch;
+        for (size_t block = startBlock;
+             block < startBlock + numBlocks;
+             ++block)
+        {
+            const size_t numBytes =
+                    mIndex.getNumVectors(block) * mBytesPerVector;
+            const sys::ubyte* input = mInput +
+                    block * mIndex.vectorsPerBlock * mBytesPerVector;
+
+            if (mByteSwap && mElementSize > 2)
+            {
+                // Samples are complex so each half gets swapped separately
+                scratch.assign(input, input + numBytes);
+                cphd::byteSwap(&scratch[0], mElementSize / 2,
+                               numBytes / (mElementSize / 2), 1);
+                input = &scratch[0];
+            }
+
+            mCodec.compress(input, numBytes / mElementSize, mElementSize,
+                            mBlocks[block]);
+        }
+    }
+
+private:
+    const cphd::SignalCodec& mCodec;
+    const cphd::SignalBlockIndex& mIndex;
+    const sys::ubyte* const mInput;
+    const size_t mBytesPerVector;
+    const size_t mElementSize;
+    const bool mByteSwap;
+    std::vector<std::vector<sys::ubyte> >& mBlocks;
+};
+
+class DecompressJob
+{
+public:
+    DecompressJob(const cphd::SignalCodec& codec,
+                  const cphd::SignalBlockIndex& index,
+                  const sys::ubyte* blocks,
+                  size_t numSamples,
+                  size_t elementSize,
+                  size_t firstVector,
+                  size_t lastVector,
+                  size_t firstSample,
+                  size_t lastSample,
+                  sys::ubyte* output) :
+        mCodec(codec),
+        mIndex(index),
+        mBlocks(blocks),
+        mNumSamples(numSamples),
+        mElementSize(elementSize),
+        mFirstVector(firstVector),
+        mLastVector(lastVector),
+        mFirstSample(firstSample),
+        mLastSample(lastSample),
+        mOutput(output)
+    {
+    }
+
+    // Blocks are numbered from the one holding mFirstVector
+    void operator()(size_t startBlock, size_t numBlocks) const
+    {
+        const size_t bytesPerVector = mNumSamples * mElementSize;
+        const size_t bytesPerVectorAOI =
+                (mLastSample - mFirstSample + 1) * mElementSize;
+        const sys::Uint64_T blocksOffset =
+                mIndex.blockOffsets[mIndex.getBlock(mFirstVector)];
+
+        const size_t firstBlock = mIndex.getBlock(mFirstVector) + startBlock;
+
+        std::vector<sys::ubyte> scratch;
+        for (size_t block = firstBlock;
+             block < firstBlock + numBlocks;
+             ++block)
+        {
+            const size_t numVectors = mIndex.getNumVectors(block);
+            scratch.resize(numVectors * bytesPerVector);
+            mCodec.decompress(
+                    mBlocks + (mIndex.blockOffsets[block] - blocksOffset),
+                    mIndex.blockOffsets[block + 1] -
+                            mIndex.blockOffsets[block],
+                    numVectors * mNumSamples,
+                    mElementSize,
+                    &scratch[0]);
+
+            const size_t blockStart = block * mIndex.vectorsPerBlock;
+            const size_t first = std::max(mFirstVector, blockStart);
+            const size_t last =
+                    std::min(mLastVector, blockStart + numVectors - 1);
+            for (size_t vector = first; vector <= last; ++vector)
+            {
+                memcpy(mOutput + (vector - mFirstVector) * bytesPerVectorAOI,
+                       &scratch[(vector - blockStart) * bytesPerVector +
+                                mFirstSample * mElementSize],
+                       bytesPerVectorAOI);
+            }
+        }
+    }
+
+private:
+    const cphd::SignalCodec& mCodec;
+    const cphd::SignalBlockIndex& mIndex;
+    const sys::ubyte* const mBlocks;
+    const size_t mNumSamples;
+    const size_t mElementSize;
+    const size_t mFirstVector;
+    const size_t mLastVector;
+    const size_t mFirstSample;
+    const size_t mLastSample;
+    sys::ubyte* const mOutput;
+};
+}
+
+namespace cphd
+{
+LZCodec::LZCodec(bool shuffle) :
+    mShuffle(shuffle)
+{
+}
+
+void LZCodec::compress(const sys::ubyte* input,
+                       size_t numElements,
+                       size_t elementSize,
+                       std::vector<sys::ubyte>& output) const
+{
+    const size_t size = numElements * elementSize;
+
+    std::vector<sys::ubyte> shuffled;
+    if (mShuffle && elementSize > 1)
+    {
+        shuffled.resize(size);
+        shuffle(input, numElements, elementSize, &shuffled[0]);
+        input = &shuffled[0];
+    }
+
+    const size_t start = output.size();
+    output.push_back(METHOD_LZ);
+    lzCompress(input, size, output);
+
+    if (output.size() - start - 1 >= size)
+    {
+        output.resize(start);
+        output.push_back(METHOD_STORED);
+        output.insert(output.end(), input, input + size);
+    }
+}
+
+void LZCodec::decompress(const sys::ubyte* input,
+                         size_t inputSize,
+                         size_t numElements,
+                         size_t elementSize,
+                         sys::ubyte* output) const
+{
+    if (inputSize == 0)
+    {
+        throwCorrupt();
+    }
+
+    const size_t size = numElements * elementSize;
+    const bool shuffled = mShuffle && elementSize > 1;
+
+    std::vector<sys::ubyte> scratch;
+    sys::ubyte* planes = output;
+    if (shuffled)
+    {
+        scratch.resize(size);
+        planes = &scratch[0];
+    }
+
+    switch (input[0])
+    {
+    case METHOD_STORED:
+        if (inputSize - 1 != size)
+        {
+            throwCorrupt();
+        }
+        memcpy(planes, input + 1, size);
+        break;
+    case METHOD_LZ:
+        lzDecompress(input + 1, inputSize - 1, planes, size);
+        break;
+    default:
+        throwCorrupt();
+    }
+
+    if (shuffled)
+    {
+        unshuffle(planes, numElements, elementSize, output);
+    }
+}
+
+const size_t SignalBlockIndex::HEADER_SIZE = 24;
+
+SignalBlockIndex::SignalBlockIndex() :
+    numVectors(0),
+    vectorsPerBlock(1)
+{
+}
+
+SignalBlockIndex::SignalBlockIndex(size_t numVectors_,
+                                   size_t vectorsPerBlock_) :
+    numVectors(numVectors_),
+    vectorsPerBlock(vectorsPerBlock_)
+{
+    if (vectorsPerBlock == 0)
+    {
+        throw except::Exception(Ctxt("Blocks must hold at least one vector"));
+    }
+    blockOffsets.resize(getNumBlocks() + 1, getSize());
+}
+
+size_t SignalBlockIndex::getNumBlocks() const
+{
+    return (numVectors + vectorsPerBlock - 1) / vectorsPerBlock;
+}
+
+size_t SignalBlockIndex::getNumVectors(size_t block) const
+{
+    return std::min(vectorsPerBlock, numVectors - block * vectorsPerBlock);
+}
+
+size_t SignalBlockIndex::getSize() const
+{
+    return HEADER_SIZE + (getNumBlocks() + 1) * 8;
+}
+
+void SignalBlockIndex::readHeader(const sys::ubyte* data)
+{
+    if (memcmp(data, INDEX_MAGIC, 8) != 0)
+    {
+        throw except::Exception(Ctxt(
+                "Compressed signal array doesn't start with a block index"));
+    }
+
+    numVectors = static_cast<size_t>(readUint64(data + 8));
+    vectorsPerBlock = static_cast<size_t>(readUint64(data + 16));
+    if (vectorsPerBlock == 0)
+    {
+        throw except::Exception(Ctxt("Invalid vectors per block in index"));
+    }
+    blockOffsets.resize(getNumBlocks() + 1);
+}
+
+void SignalBlockIndex::readOffsets(const sys::ubyte* data)
+{
+    for (size_t ii = 0; ii < blockOffsets.size(); ++ii)
+    {
+        blockOffsets[ii] = readUint64(data + ii * 8);
+    }
+
+    if (blockOffsets[0] != getSize())
+    {
+        throw except::Exception(Ctxt("Invalid first block offset in index"));
+    }
+    for (size_t ii = 1; ii < blockOffsets.size(); ++ii)
+    {
+        if (blockOffsets[ii] < blockOffsets[ii - 1])
+        {
+            throw except::Exception(Ctxt("Block offsets must increase"));
+        }
+    }
+}
+
+void SignalBlockIndex::write(sys::ubyte* data) const
+{
+    memcpy(data, INDEX_MAGIC, 8);
+    writeUint64(numVectors, data + 8);
+    writeUint64(vectorsPerBlock, data + 16);
+    for (size_t ii = 0; ii < blockOffsets.size(); ++ii)
+    {
+        writeUint64(blockOffsets[ii], data + HEADER_SIZE + ii * 8);
+    }
+}
+
+void compressSignalArray(const SignalCodec& codec,
+                         const sys::ubyte* input,
+                         size_t numVectors,
+                         size_t numSamples,
+                         size_t elementSize,
+                         bool byteSwap,
+                         size_t numThreads,
+                         std::vector<sys::ubyte>& output,
+                         size_t vectorsPerBlock)
+{
+    const size_t bytesPerVector = numSamples * elementSize;
+    if (vectorsPerBlock == 0)
+    {
+        vectorsPerBlock = std::max<size_t>(
+                1, DEFAULT_BLOCK_BYTES / std::max<size_t>(bytesPerVector, 1));
+    }
+
+    SignalBlockIndex index(numVectors, vectorsPerBlock);
+    const size_t numBlocks = index.getNumBlocks();
+
+    std::vector<std::vector<sys::ubyte> > blocks(numBlocks);
+    const CompressJob job(codec, index, input, bytesPerVector,
+                          elementSize, byteSwap, blocks);
+    scene::runInParallel(job, numBlocks, numThreads);
+
+    for (size_t block = 0; block < numBlocks; ++block)
+    {
+        index.blockOffsets[block + 1] =
+                index.blockOffsets[block] + blocks[block].size();
+    }
+
+    output.resize(static_cast<size_t>(index.blockOffsets.back()));
+    index.write(&output[0]);
+    for (size_t block = 0; block < numBlocks; ++block)
+    {
+        if (!blocks[block].empty())
+        {
+            memcpy(&output[static_cast<size_t>(index.blockOffsets[block])],
+                   &blocks[block][0],
+                   blocks[block].size());
+        }
+    }
+}
+
+void compressSignalBlock(const Data& data,
+                         const sys::ubyte* input,
+                         bool byteSwap,
+                         size_t numThreads,
+                         std::vector<std::vector<sys::ubyte> >& output)
+{
+    const std::string& compressionID = data.getCompressionID();
+    const std::shared_ptr<const SignalCodec> codec =
+            SignalCodecFactory::getInstance().getCodec(compressionID);
+    if (codec.get() == nullptr)
+    {
+        throw except::Exception(Ctxt(
+                "No signal codec is registered for compression ID " +
+                compressionID + ". Write the compressed bytes instead."));
+    }
+
+    const size_t elementSize = data.getNumBytesPerSample();
+    const size_t numChannels = data.getNumChannels();
+    output.resize(numChannels);
+    for (size_t ii = 0; ii < numChannels; ++ii)
+    {
+        const size_t numVectors = data.getNumVectors(ii);
+        const size_t numSamples = data.getNumSamples(ii);
+        compressSignalArray(*codec,
+                            input,
+                            numVectors,
+                            numSamples,
+                            elementSize,
+                            byteSwap,
+                            numThreads,
+                            output[ii]);
+        input += numVectors * numSamples * elementSize;
+    }
+}
+
+void decompressSignalBlocks(const SignalCodec& codec,
+                            const SignalBlockIndex& index,
+                            const sys::ubyte* blocks,
+                            size_t numSamples,
+                            size_t elementSize,
+                            size_t firstVector,
+                            size_t lastVector,
+                            size_t firstSample,
+                            size_t lastSample,
+                            size_t numThreads,
+                            sys::ubyte* output)
+{
+    if (lastVector < firstVector || lastVector >= index.numVectors ||
+        lastSample < firstSample || lastSample >= numSamples)
+    {
+        throw except::Exception(Ctxt("Invalid range to decompress"));
+    }
+
+    const size_t numBlocks =
+            index.getBlock(lastVector) - index.getBlock(firstVector) + 1;
+    const DecompressJob job(codec, index, blocks, numSamples,
+                            elementSize, firstVector, lastVector,
+                            firstSample, lastSample, output);
+    scene::runInParallel(job, numBlocks, numThreads);
+}
+
+SignalCodecRegistry::SignalCodecRegistry()
+{
+    addCodec("SIX_LZ", std::unique_ptr<SignalCodec>(new LZCodec(false)));
+    addCodec("SIX_SHUFFLE_LZ",
+             std::unique_ptr<SignalCodec>(new LZCodec(true)));
+}
+
+void SignalCodecRegistry::addCodec(const std::string& compressionID,
+                                   std::unique_ptr<SignalCodec> codec)
+{
+    if (codec.get() == nullptr)
+    {
+        throw except::Exception(Ctxt("Null codec for " + compressionID));
+    }
+
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+    mRegistry[compressionID].reset(codec.release());
+}
+
+std::shared_ptr<const SignalCodec>
+SignalCodecRegistry::getCodec(const std::string& compressionID) const
+{
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+    const RegistryMap::const_iterator iter = mRegistry.find(compressionID);
+    return iter == mRegistry.end() ? std::shared_ptr<const SignalCodec>()
+                                   : iter->second;
+}
+}
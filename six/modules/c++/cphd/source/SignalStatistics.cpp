@@ -0,0 +1,345 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+
+#include <sys/Conf.h>
+#include <sys/Mutex.h>
+#include <mt/CriticalSection.h>
+#include <scene/RangeRunnable.h>
+#include <except/Exception.h>
+#include <cphd/SignalStatistics.h>
+
+namespace
+{
+// |sample|^2 * scale of interleaved components
+template <typename T>
+void computePower(const T* components,
+                  size_t numSamples,
+                  float scale,
+                  float* power)
+{
+    for (size_t ii = 0; ii < numSamples; ++ii)
+    {
+        const float real = static_cast<float>(components[2 * ii]);
+        const float imag = static_cast<float>(components[2 * ii + 1]);
+        power[ii] = scale * (real * real + imag * imag);
+    }
+}
+
+// Samples with either component at the limit of an integer type
+template <typename T>
+size_t countSaturated(const T* components, size_t numSamples)
+{
+    if (!std::numeric_limits<T>::is_integer)
+    {
+        return 0;
+    }
+
+    const T low = std::numeric_limits<T>::min();
+    const T high = std::numeric_limits<T>::max();
+    size_t count = 0;
+    for (size_t ii = 0; ii < numSamples; ++ii)
+    {
+        const T real = components[2 * ii];
+        const T imag = components[2 * ii + 1];
+        count += (real == low || real == high ||
+                  imag == low || imag == high) ? 1 : 0;
+    }
+    return count;
+}
+
+// Statistics of whole quicklook rows of a block
+template <typename T>
+struct BlockJob
+{
+    const T* components;
+    size_t firstVector;
+    size_t numVectors;
+    const float* scales;
+    sys::Mutex* mutex;
+    cphd::ChannelStatistics* statistics;
+    double* powerSums;
+
+    void operator()(size_t start, size_t num) const
+    {
+        cphd::ChannelStatistics& stats = *statistics;
+        const size_t numSamples = stats.numSamples;
+        const size_t numBins = stats.histogram.size();
+        std::vector<float> power(numSamples);
+        std::vector<size_t> histogram(numBins, 0);
+
+        const size_t end = std::min((start + num) * stats.vectorDecimation,
+                                    numVectors);
+        for (size_t ii = start * stats.vectorDecimation; ii < end; ++ii)
+        {
+            const size_t vector = firstVector + ii;
+            const T* const vectorComponents =
+                    components + 2 * ii * numSamples;
+            computePower(vectorComponents, numSamples,
+                         scales ? scales[ii] : 1.0f, &power[0]);
+            stats.saturated[vector] =
+                    countSaturated(vectorComponents, numSamples);
+
+            float peak = 0.0f;
+            double sum = 0.0;
+            for (size_t jj = 0; jj < numSamples; ++jj)
+            {
+                peak = std::max(peak, power[jj]);
+                sum += power[jj];
+            }
+            stats.peakPower[vector] = peak;
+            stats.meanPower[vector] = static_cast<float>(sum / numSamples);
+
+            double* const row = powerSums +
+                    (vector / stats.vectorDecimation) * stats.numCols;
+            for (size_t col = 0; col < stats.numCols; ++col)
+            {
+                const size_t sampleEnd = std::min(
+                        (col + 1) * stats.sampleDecimation, numSamples);
+                double cellSum = 0.0;
+                for (size_t jj = col * stats.sampleDecimation;
+                     jj < sampleEnd;
+                     ++jj)
+                {
+                    cellSum += power[jj];
+                }
+                row[col] += cellSum;
+            }
+
+            for (size_t jj = 0; jj < numSamples; ++jj)
+            {
+                size_t bin = 0;
+                if (power[jj] > 0.0f)
+                {
+                    const double position =
+                            (10.0 * std::log10(power[jj]) - stats.minDB) /
+                            stats.binWidthDB;
+                    if (position >= numBins)
+                    {
+                        bin = numBins - 1;
+                    }
+                    else if (position > 0.0)
+                    {
+                        bin = static_cast<size_t>(position);
+                    }
+                }
+                ++histogram[bin];
+            }
+        }
+
+        mt::CriticalSection<sys::Mutex> lock(mutex);
+        for (size_t ii = 0; ii < numBins; ++ii)
+        {
+            stats.histogram[ii] += histogram[ii];
+        }
+    }
+};
+
+template <typename T>
+void processBlock(const sys::ubyte* buffer,
+                  size_t firstVector,
+                  size_t numVectors,
+                  const float* scales,
+                  size_t numThreads,
+                  cphd::ChannelStatistics& statistics,
+                  double* powerSums)
+{
+    sys::Mutex mutex;
+    const BlockJob<T> job = { reinterpret_cast<const T*>(buffer),
+                              firstVector, numVectors, scales, &mutex,
+                              &statistics, powerSums };
+    const size_t numRows = (numVectors + statistics.vectorDecimation - 1) /
+            statistics.vectorDecimation;
+    scene::runInParallel(job, numRows, numThreads);
+}
+}
+
+namespace cphd
+{
+ChannelStatistics::ChannelStatistics() :
+    numVectors(0),
+    numSamples(0),
+    vectorDecimation(1),
+    sampleDecimation(1),
+    numRows(0),
+    numCols(0),
+    minDB(0.0),
+    binWidthDB(1.0),
+    numSaturated(0)
+{
+}
+
+SignalStatistics::SignalStatistics(const Wideband& wideband,
+                                   const Data& data,
+                                   size_t numThreads) :
+    mWideband(wideband),
+    mData(data),
+    mNumThreads(numThreads),
+    mVectorDecimation(8),
+    mSampleDecimation(8),
+    mMinDB(0.0),
+    mMaxDB(100.0),
+    mNumBins(100),
+    mVectorsPerBlock(256)
+{
+}
+
+void SignalStatistics::setDecimation(size_t vectors, size_t samples)
+{
+    mVectorDecimation = std::max<size_t>(vectors, 1);
+    mSampleDecimation = std::max<size_t>(samples, 1);
+}
+
+void SignalStatistics::setHistogram(double minDB,
+                                    double maxDB,
+                                    size_t numBins)
+{
+    if (!(maxDB > minDB) || numBins == 0)
+    {
+        throw except::Exception(Ctxt(
+                "Histogram needs at least one bin over a nonempty range"));
+    }
+    mMinDB = minDB;
+    mMaxDB = maxDB;
+    mNumBins = numBins;
+}
+
+void SignalStatistics::setVectorsPerBlock(size_t vectorsPerBlock)
+{
+    mVectorsPerBlock = std::max<size_t>(vectorsPerBlock, 1);
+}
+
+void SignalStatistics::compute(size_t channel,
+                               const PVPBlock* pvpBlock,
+                               ChannelStatistics& statistics) const
+{
+    const size_t numVectors = mData.getNumVectors(channel);
+    const size_t numSamples = mData.getNumSamples(channel);
+    const size_t elementSize = mData.getNumBytesPerSample();
+
+    statistics.numVectors = numVectors;
+    statistics.numSamples = numSamples;
+    statistics.vectorDecimation = mVectorDecimation;
+    statistics.sampleDecimation = mSampleDecimation;
+    statistics.numRows =
+            (numVectors + mVectorDecimation - 1) / mVectorDecimation;
+    statistics.numCols =
+            (numSamples + mSampleDecimation - 1) / mSampleDecimation;
+    statistics.minDB = mMinDB;
+    statistics.binWidthDB = (mMaxDB - mMinDB) / mNumBins;
+    statistics.histogram.assign(mNumBins, 0);
+    statistics.peakPower.assign(numVectors, 0.0f);
+    statistics.meanPower.assign(numVectors, 0.0f);
+    statistics.saturated.assign(numVectors, 0);
+    statistics.numSaturated = 0;
+    statistics.dropouts.clear();
+    if (pvpBlock && pvpBlock->hasSignal())
+    {
+        for (size_t ii = 0; ii < numVectors; ++ii)
+        {
+            if (pvpBlock->getSignal(channel, ii) == 0)
+            {
+                statistics.dropouts.push_back(ii);
+            }
+        }
+    }
+
+    std::vector<double> powerSums(statistics.numRows * statistics.numCols,
+                                  0.0);
+    if (numVectors == 0 || numSamples == 0)
+    {
+        statistics.power.clear();
+        return;
+    }
+
+    // Blocks hold whole quicklook rows so threads never share one
+    size_t blockSize = std::min(mVectorsPerBlock, numVectors);
+    blockSize = ((blockSize + mVectorDecimation - 1) / mVectorDecimation) *
+            mVectorDecimation;
+    std::vector<sys::ubyte> buffer(blockSize * numSamples * elementSize);
+    std::vector<float> scales;
+    const bool scaled = pvpBlock && pvpBlock->hasAmpSF();
+
+    for (size_t first = 0; first < numVectors; first += blockSize)
+    {
+        const size_t count = std::min(blockSize, numVectors - first);
+        mWideband.read(channel, first, first + count - 1, 0, Wideband::ALL,
+                       mNumThreads,
+                       mem::BufferView<sys::ubyte>(
+                               &buffer[0], count * numSamples * elementSize));
+        if (scaled)
+        {
+            scales.resize(count);
+            for (size_t ii = 0; ii < count; ++ii)
+            {
+                const double ampSF = pvpBlock->getAmpSF(channel, first + ii);
+                scales[ii] = static_cast<float>(ampSF * ampSF);
+            }
+        }
+        const float* const blockScales = scaled ? &scales[0] : nullptr;
+
+        switch (mData.getSampleType())
+        {
+        case SignalArrayFormat::CI2:
+            processBlock<sys::Int8_T>(&buffer[0], first, count, blockScales,
+                                      mNumThreads, statistics,
+                                      &powerSums[0]);
+            break;
+        case SignalArrayFormat::CI4:
+            processBlock<sys::Int16_T>(&buffer[0], first, count, blockScales,
+                                       mNumThreads, statistics,
+                                       &powerSums[0]);
+            break;
+        case SignalArrayFormat::CF8:
+            processBlock<float>(&buffer[0], first, count, blockScales,
+                                mNumThreads, statistics, &powerSums[0]);
+            break;
+        default:
+            throw except::Exception(Ctxt("Invalid SignalArrayFormat"));
+        }
+    }
+
+    statistics.power.resize(powerSums.size());
+    for (size_t row = 0; row < statistics.numRows; ++row)
+    {
+        const size_t rowVectors = std::min(
+                mVectorDecimation, numVectors - row * mVectorDecimation);
+        for (size_t col = 0; col < statistics.numCols; ++col)
+        {
+            const size_t colSamples = std::min(
+                    mSampleDecimation, numSamples - col * mSampleDecimation);
+            const size_t index = row * statistics.numCols + col;
+            statistics.power[index] = static_cast<float>(
+                    powerSums[index] / (rowVectors * colSamples));
+        }
+    }
+
+    for (size_t ii = 0; ii < numVectors; ++ii)
+    {
+        statistics.numSaturated += statistics.saturated[ii];
+    }
+}
+}
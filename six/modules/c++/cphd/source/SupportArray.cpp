@@ -121,6 +121,25 @@ AdditionalSupportArray SupportArray::getAddedSupportArray(const std::string& key
     return addedSupportArray.find(key)->second;
 }
 
+SupportArrayParameter SupportArray::getParameter(const std::string& id) const
+{
+    for (size_t ii = 0; ii < iazArray.size(); ++ii)
+    {
+        if (str::toString(iazArray[ii].getIdentifier()) == id)
+        {
+            return iazArray[ii];
+        }
+    }
+    for (size_t ii = 0; ii < antGainPhase.size(); ++ii)
+    {
+        if (str::toString(antGainPhase[ii].getIdentifier()) == id)
+        {
+            return antGainPhase[ii];
+        }
+    }
+    return getAddedSupportArray(id);
+}
+
 std::ostream& operator<< (std::ostream& os, const SupportArrayParameter& s)
 {
     if (!six::Init::isUndefined(s.getIdentifier()))
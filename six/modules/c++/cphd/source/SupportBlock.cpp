@@ -24,6 +24,7 @@
 #include <sstream>
 
 #include <sys/Conf.h>
+#include <mt/CriticalSection.h>
 #include <mt/ThreadGroup.h>
 #include <mt/ThreadPlanner.h>
 #include <except/Exception.h>
@@ -76,6 +77,19 @@ sys::Off_T SupportBlock::getFileOffset(const std::string& id) const
     return mOffsets.find(id)->second;
 }
 
+void SupportBlock::readBytes(const std::string& id, sys::ubyte* data) const
+{
+    // Compute the byte offset into this SupportArray in the CPHD file
+    sys::Off_T inOffset = getFileOffset(id);
+    sys::byte* dataPtr = reinterpret_cast<sys::byte*>(data);
+    size_t size = mData.getSupportArrayById(id).getSize();
+
+    // The seek and read have to happen together
+    mt::CriticalSection<sys::Mutex> lock(&mStreamMutex);
+    mInStream->seek(inOffset, io::FileInputStream::START);
+    mInStream->read(dataPtr, size);
+}
+
 void SupportBlock::read(const std::string& id,
                         size_t numThreads,
                         const mem::BufferView<sys::ubyte>& data) const
@@ -89,14 +103,7 @@ void SupportBlock::read(const std::string& id,
              << data.size;
         throw except::Exception(Ctxt(ostr.str()));
     }
-    // Perform the read
-    // Compute the byte offset into this SupportArray in the CPHD file
-    // First to the start of the first support array we're going to read
-    sys::Off_T inOffset = getFileOffset(id);
-    sys::byte* dataPtr = reinterpret_cast<sys::byte*>(data.data);
-    mInStream->seek(inOffset, io::FileInputStream::START);
-    size_t size = mData.getSupportArrayById(id).getSize();
-    mInStream->read(dataPtr, size);
+    readBytes(id, data.data);
 
     if (!sys::isBigEndianSystem() && mData.getElementSize(id) > 1)
     {
@@ -127,6 +134,32 @@ void SupportBlock::read(const std::string& id,
     read(id, numThreads, mem::BufferView<sys::ubyte>(data.get(), bufSize));
 }
 
+const TypedSupportArray& SupportBlock::getTypedArray(
+        const std::string& id,
+        const SupportArrayParameter& parameter,
+        size_t numThreads) const
+{
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+    std::unique_ptr<const TypedSupportArray>& typedArray = mTypedArrays[id];
+    if (!typedArray.get())
+    {
+        const Data::SupportArray dataArray = mData.getSupportArrayById(id);
+        if (dataArray.getSize() == 0)
+        {
+            throw except::Exception(Ctxt("Support array " + id +
+                                         " is empty"));
+        }
+        std::vector<sys::ubyte> bytes(dataArray.getSize());
+        readBytes(id, &bytes[0]);
+        typedArray.reset(new TypedSupportArray(parameter,
+                                               dataArray.numRows,
+                                               dataArray.numCols,
+                                               &bytes[0],
+                                               numThreads));
+    }
+    return *typedArray;
+}
+
 std::ostream& operator<< (std::ostream& os, const SupportBlock& d)
 {
     os << "SupportBlock::\n"
@@ -0,0 +1,321 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string.h>
+#include <limits>
+#include <sstream>
+
+#include <except/Exception.h>
+#include <scene/RangeRunnable.h>
+#include <cphd/TypedSupportArray.h>
+#include <cphd/Utilities.h>
+
+namespace
+{
+// Decode one component of every element from big endian
+template <typename T>
+void decode(const sys::ubyte* input,
+            size_t stride,
+            size_t numElements,
+            double* output)
+{
+    const bool swap = !sys::isBigEndianSystem();
+    sys::ubyte bytes[sizeof(T)];
+    for (size_t ii = 0; ii < numElements; ++ii, input += stride)
+    {
+        for (size_t jj = 0; jj < sizeof(T); ++jj)
+        {
+            bytes[jj] = input[swap ? sizeof(T) - 1 - jj : jj];
+        }
+        T value;
+        memcpy(&value, bytes, sizeof(T));
+        output[ii] = static_cast<double>(value);
+    }
+}
+
+void decode(const std::string& name,
+            const std::string& format,
+            const sys::ubyte* input,
+            size_t stride,
+            size_t numElements,
+            double* output)
+{
+    if (format == "F4")
+    {
+        decode<float>(input, stride, numElements, output);
+    }
+    else if (format == "F8")
+    {
+        decode<double>(input, stride, numElements, output);
+    }
+    else if (format == "U1")
+    {
+        decode<sys::Uint8_T>(input, stride, numElements, output);
+    }
+    else if (format == "U2")
+    {
+        decode<sys::Uint16_T>(input, stride, numElements, output);
+    }
+    else if (format == "U4")
+    {
+        decode<sys::Uint32_T>(input, stride, numElements, output);
+    }
+    else if (format == "U8")
+    {
+        decode<sys::Uint64_T>(input, stride, numElements, output);
+    }
+    else if (format == "I1")
+    {
+        decode<sys::Int8_T>(input, stride, numElements, output);
+    }
+    else if (format == "I2")
+    {
+        decode<sys::Int16_T>(input, stride, numElements, output);
+    }
+    else if (format == "I4")
+    {
+        decode<sys::Int32_T>(input, stride, numElements, output);
+    }
+    else if (format == "I8")
+    {
+        decode<sys::Int64_T>(input, stride, numElements, output);
+    }
+    else
+    {
+        std::ostringstream ostr;
+        ostr << "Support array component '" << name << "' has format "
+             << format << ", which isn't a real number";
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+}
+
+cphd::TypedSupportArray::AxisPosition getAxisPosition(double position,
+                                                      size_t numSamples)
+{
+    cphd::TypedSupportArray::AxisPosition result;
+    result.index = 0;
+    result.weight = 0.0;
+    // Written so NaN coordinates fail too
+    result.valid = position >= 0.0 &&
+            position <= static_cast<double>(numSamples - 1);
+    if (result.valid)
+    {
+        result.index = static_cast<size_t>(position);
+        if (result.index + 1 >= numSamples && numSamples > 1)
+        {
+            result.index = numSamples - 2;
+        }
+        result.weight = position - static_cast<double>(result.index);
+    }
+    return result;
+}
+
+// With a single row or column, the "next" element is the same one
+struct Cell
+{
+    const double* plane;
+    size_t numCols;
+    size_t rowStep;
+    size_t colStep;
+
+    double operator()(const cphd::TypedSupportArray::AxisPosition& row,
+                      const cphd::TypedSupportArray::AxisPosition& col) const
+    {
+        if (!row.valid || !col.valid)
+        {
+            return std::numeric_limits<double>::quiet_NaN();
+        }
+        const double* const p = plane + row.index * numCols + col.index;
+        const double top = p[0] + col.weight * (p[colStep] - p[0]);
+        const double bottom = p[rowStep] +
+                col.weight * (p[rowStep + colStep] - p[rowStep]);
+        return top + row.weight * (bottom - top);
+    }
+};
+
+struct PointsJob
+{
+    const cphd::TypedSupportArray* array;
+    Cell cell;
+    const double* x;
+    const double* y;
+    double* output;
+
+    void operator()(size_t start, size_t num) const
+    {
+        for (size_t ii = start; ii < start + num; ++ii)
+        {
+            output[ii] = cell(array->getRowPosition(x[ii]),
+                              array->getColPosition(y[ii]));
+        }
+    }
+};
+
+struct GridJob
+{
+    const cphd::TypedSupportArray* array;
+    Cell cell;
+    const std::vector<cphd::TypedSupportArray::AxisPosition>* cols;
+    double x0;
+    double deltaX;
+    double* output;
+
+    void operator()(size_t start, size_t num) const
+    {
+        const size_t numY = cols->size();
+        for (size_t ii = start; ii < start + num; ++ii)
+        {
+            const cphd::TypedSupportArray::AxisPosition row =
+                    array->getRowPosition(x0 + ii * deltaX);
+            double* const out = output + ii * numY;
+            for (size_t jj = 0; jj < numY; ++jj)
+            {
+                out[jj] = cell(row, (*cols)[jj]);
+            }
+        }
+    }
+};
+}
+
+namespace cphd
+{
+TypedSupportArray::TypedSupportArray(const SupportArrayParameter& parameter,
+                                     size_t numRows,
+                                     size_t numCols,
+                                     const sys::ubyte* data,
+                                     size_t numThreads) :
+    mParameter(parameter),
+    mNumRows(numRows),
+    mNumCols(numCols),
+    mNumThreads(numThreads)
+{
+    if (mParameter.xSS == 0.0 || mParameter.ySS == 0.0)
+    {
+        throw except::Exception(Ctxt(
+                "Support array sample spacing can't be zero"));
+    }
+    if (mNumRows == 0 || mNumCols == 0)
+    {
+        throw except::Exception(Ctxt("Support array can't be empty"));
+    }
+
+    std::vector<std::pair<std::string, std::string> > components;
+    if (isMultipleParam(mParameter.elementFormat))
+    {
+        components = parseMultipleParams(mParameter.elementFormat);
+    }
+    else
+    {
+        components.push_back(std::pair<std::string, std::string>(
+                "", mParameter.elementFormat));
+    }
+
+    size_t elementSize = 0;
+    for (size_t ii = 0; ii < components.size(); ++ii)
+    {
+        elementSize += getFormatSize(components[ii].second);
+    }
+
+    const size_t numElements = mNumRows * mNumCols;
+    mNames.resize(components.size());
+    mPlanes.resize(components.size());
+    size_t offset = 0;
+    for (size_t ii = 0; ii < components.size(); ++ii)
+    {
+        mNames[ii] = components[ii].first;
+        mPlanes[ii].resize(numElements);
+        decode(components[ii].first, components[ii].second,
+               data + offset, elementSize, numElements, &mPlanes[ii][0]);
+        offset += getFormatSize(components[ii].second);
+    }
+}
+
+size_t TypedSupportArray::getComponentIndex(const std::string& name) const
+{
+    for (size_t ii = 0; ii < mNames.size(); ++ii)
+    {
+        if (mNames[ii] == name)
+        {
+            return ii;
+        }
+    }
+    throw except::Exception(Ctxt("No support array component named '" +
+                                 name + "'"));
+}
+
+TypedSupportArray::AxisPosition
+TypedSupportArray::getRowPosition(double x) const
+{
+    return getAxisPosition((x - mParameter.x0) / mParameter.xSS, mNumRows);
+}
+
+TypedSupportArray::AxisPosition
+TypedSupportArray::getColPosition(double y) const
+{
+    return getAxisPosition((y - mParameter.y0) / mParameter.ySS, mNumCols);
+}
+
+double TypedSupportArray::interpolate(size_t component,
+                                      double x,
+                                      double y) const
+{
+    double output;
+    interpolate(component, &x, &y, 1, &output);
+    return output;
+}
+
+void TypedSupportArray::interpolate(size_t component,
+                                    const double* x,
+                                    const double* y,
+                                    size_t numPoints,
+                                    double* output) const
+{
+    const Cell cell = { getComponent(component), mNumCols,
+                        mNumRows > 1 ? mNumCols : 0,
+                        mNumCols > 1 ? 1u : 0u };
+    const PointsJob job = { this, cell, x, y, output };
+    scene::runInParallel(job, numPoints, mNumThreads);
+}
+
+void TypedSupportArray::interpolateGrid(size_t component,
+                                        double x0,
+                                        double deltaX,
+                                        size_t numX,
+                                        double y0,
+                                        double deltaY,
+                                        size_t numY,
+                                        double* output) const
+{
+    // The column positions are the same for every output row
+    std::vector<AxisPosition> cols(numY);
+    for (size_t jj = 0; jj < numY; ++jj)
+    {
+        cols[jj] = getColPosition(y0 + jj * deltaY);
+    }
+
+    const Cell cell = { getComponent(component), mNumCols,
+                        mNumRows > 1 ? mNumCols : 0,
+                        mNumCols > 1 ? 1u : 0u };
+    const GridJob job = { this, cell, &cols, x0, deltaX, output };
+    scene::runInParallel(job, numX, mNumThreads);
+}
+}
@@ -283,9 +283,12 @@ void Wideband::initialize()
         // Signal Array is Compressed
         for (size_t ii = 1; ii < mMetadata.getNumChannels(); ++ii)
         {
-            mOffsets[ii] =
-                    mOffsets[ii - 1] + mMetadata.getCompressedSignalSize(ii);
+            mOffsets[ii] = mOffsets[ii - 1] +
+                    mMetadata.getCompressedSignalSize(ii - 1);
         }
+
+        mCodec = SignalCodecFactory::getInstance().getCodec(
+                mMetadata.getCompressionID());
     }
 }
 
@@ -369,7 +372,8 @@ void Wideband::checkReadInputs(size_t channel,
     dims.row = lastVector - firstVector + 1;
     dims.col = lastSample - firstSample + 1;
 
-    if (isPartialRead(channel, dims) && mMetadata.isCompressed())
+    if (isPartialRead(channel, dims) && mMetadata.isCompressed() &&
+        mCodec.get() == nullptr)
     {
         throw except::Exception(
                 Ctxt("Cannot do partial read of compressed channel"));
@@ -396,12 +400,25 @@ void Wideband::readImpl(size_t channel,
                         size_t lastVector,
                         size_t firstSample,
                         size_t lastSample,
+                        size_t numThreads,
                         void* data) const
 {
     types::RowCol<size_t> dims;
     checkReadInputs(
             channel, firstVector, lastVector, firstSample, lastSample, dims);
 
+    if (mCodec.get())
+    {
+        readDecompressedImpl(channel,
+                             firstVector,
+                             lastVector,
+                             firstSample,
+                             lastSample,
+                             numThreads,
+                             data);
+        return;
+    }
+
     // Compute the byte offset into this channel's wideband in the CPHD file
     // First to the start of the first pulse we're going to read
     sys::Off_T inOffset = getFileOffset(channel, firstVector, firstSample);
@@ -431,6 +448,62 @@ void Wideband::readImpl(size_t channel,
     }
 }
 
+void Wideband::readDecompressedImpl(size_t channel,
+                                    size_t firstVector,
+                                    size_t lastVector,
+                                    size_t firstSample,
+                                    size_t lastSample,
+                                    size_t numThreads,
+                                    void* data) const
+{
+    const sys::Off_T channelOffset = getFileOffset(channel);
+
+    // Read the index to find the blocks holding these vectors
+    SignalBlockIndex index;
+    std::vector<sys::ubyte> buffer(SignalBlockIndex::HEADER_SIZE);
+    mInStream->seek(channelOffset, io::FileInputStream::START);
+    mInStream->read(&buffer[0], buffer.size());
+    index.readHeader(&buffer[0]);
+    if (index.numVectors != mMetadata.getNumVectors(channel))
+    {
+        throw except::Exception(Ctxt(
+                "Block index doesn't match the number of vectors in channel " +
+                str::toString(channel)));
+    }
+
+    buffer.resize(index.getSize() - SignalBlockIndex::HEADER_SIZE);
+    mInStream->read(&buffer[0], buffer.size());
+    index.readOffsets(&buffer[0]);
+
+    const size_t firstBlock = index.getBlock(firstVector);
+    const size_t lastBlock = index.getBlock(lastVector);
+    const sys::Uint64_T blocksOffset = index.blockOffsets[firstBlock];
+    const sys::Uint64_T blocksEnd = index.blockOffsets[lastBlock + 1];
+    if (blocksEnd > mMetadata.getCompressedSignalSize(channel))
+    {
+        throw except::Exception(Ctxt(
+                "Block index extends past the compressed signal size"));
+    }
+
+    // Only the blocks we need are read
+    buffer.resize(static_cast<size_t>(blocksEnd - blocksOffset));
+    mInStream->seek(channelOffset + static_cast<sys::Off_T>(blocksOffset),
+                    io::FileInputStream::START);
+    mInStream->read(&buffer[0], buffer.size());
+
+    decompressSignalBlocks(*mCodec,
+                           index,
+                           &buffer[0],
+                           mMetadata.getNumSamples(channel),
+                           mElementSize,
+                           firstVector,
+                           lastVector,
+                           firstSample,
+                           lastSample,
+                           numThreads,
+                           static_cast<sys::ubyte*>(data));
+}
+
 void Wideband::readImpl(size_t channel, void* data) const
 {
     // Compute the byte offset into this channel's wideband in the CPHD file
@@ -471,6 +544,7 @@ void Wideband::read(size_t channel,
              lastVector,
              firstSample,
              lastSample,
+             numThreads,
              data.data);
 
     // Byte swap to little endian if necessary
@@ -524,7 +598,7 @@ void Wideband::read(size_t channel,
     // Perform the read
     readImpl(channel, data.data);
 
-    if (shouldByteSwap())
+    if (!mMetadata.isCompressed() && shouldByteSwap())
     {
         // TODO: Would be nice to have a way to test this without
         // logging onto Solaris...
@@ -538,7 +612,9 @@ void Wideband::read(size_t channel,
 
 bool Wideband::shouldByteSwap() const
 {
-    return !sys::isBigEndianSystem() && !mMetadata.isCompressed() &&
+    // Decompressed samples are in file byte order too
+    return !sys::isBigEndianSystem() &&
+            (!mMetadata.isCompressed() || mCodec.get() != nullptr) &&
             mElementSize > 2;
 }
 
@@ -645,6 +721,7 @@ void Wideband::read(size_t channel,
                  lastVector,
                  firstSample,
                  lastSample,
+                 numThreads,
                  scratch.data);
 
         // Byte swap to little endian if necessary
@@ -678,6 +755,7 @@ void Wideband::read(size_t channel,
                  lastVector,
                  firstSample,
                  lastSample,
+                 numThreads,
                  scratch.data);
 
         if (!sys::isBigEndianSystem() && mElementSize > 2)
@@ -698,6 +776,7 @@ void Wideband::read(size_t channel,
                  lastVector,
                  firstSample,
                  lastSample,
+                 numThreads,
                  data.data);
 
         // Byte swap to little endian if necessary
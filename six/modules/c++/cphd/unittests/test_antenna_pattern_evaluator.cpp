@@ -0,0 +1,360 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <cphd/AntennaPatternEvaluator.h>
+#include <cphd/Metadata.h>
+#include <cphd/PVPBlock.h>
+#include <cphd/TestDataGenerator.h>
+#include <TestCase.h>
+
+namespace
+{
+constexpr size_t NUM_VECTORS = 5;
+constexpr size_t NUM_POINTS = 6;
+constexpr double F0 = 1.0e9;
+
+cphd::PolyXYZ constantAxis(double x, double y, double z)
+{
+    cphd::PolyXYZ poly(0);
+    poly[0] = cphd::Vector3(0.0);
+    poly[0][0] = x;
+    poly[0][1] = y;
+    poly[0][2] = z;
+    return poly;
+}
+
+// Transmit pattern is at a fixed frequency; receive pattern shifts its
+// steering and dilates its mainlobe with frequency
+cphd::Metadata makeMetadata(size_t numChannels)
+{
+    cphd::Metadata metadata;
+    metadata.antenna.reset(new cphd::Antenna());
+    cphd::Antenna& antenna = *metadata.antenna;
+
+    antenna.antCoordFrame.resize(1);
+    antenna.antCoordFrame[0].identifier = "ACF";
+    antenna.antCoordFrame[0].xAxisPoly = constantAxis(0.0, 2.0, 0.0);
+    antenna.antCoordFrame[0].yAxisPoly = constantAxis(0.0, 0.0, 1.0);
+
+    antenna.antPhaseCenter.resize(1);
+    antenna.antPhaseCenter[0].identifier = "APC";
+    antenna.antPhaseCenter[0].acfId = "ACF";
+
+    antenna.antPattern.resize(2);
+    for (size_t ii = 0; ii < antenna.antPattern.size(); ++ii)
+    {
+        cphd::AntPattern& pattern = antenna.antPattern[ii];
+        pattern.freqZero = F0;
+        pattern.eb.dcxPoly = cphd::Poly1D(0);
+        pattern.eb.dcxPoly[0] = 0.01;
+        pattern.eb.dcyPoly = cphd::Poly1D(0);
+        pattern.eb.dcyPoly[0] = 0.0;
+
+        pattern.array.gainPoly = cphd::Poly2D(2, 2);
+        pattern.array.gainPoly[2][0] = -10.0;
+        pattern.array.gainPoly[0][2] = -20.0;
+        pattern.array.phasePoly = cphd::Poly2D(1, 0);
+        pattern.array.phasePoly[1][0] = 0.5;
+        pattern.element.gainPoly = cphd::Poly2D(0, 1);
+        pattern.element.gainPoly[0][1] = 1.0;
+    }
+    antenna.antPattern[0].identifier = "TX";
+    antenna.antPattern[0].gainZero = 3.0;
+    antenna.antPattern[1].identifier = "RCV";
+    antenna.antPattern[1].ebFreqShift = six::BooleanType::IS_TRUE;
+    antenna.antPattern[1].mlFreqDilation = six::BooleanType::IS_TRUE;
+    antenna.antPattern[1].gainBSPoly = cphd::Poly1D(1);
+    antenna.antPattern[1].gainBSPoly[0] = 0.0;
+    antenna.antPattern[1].gainBSPoly[1] = -1.0e-8;
+
+    metadata.channel.parameters.resize(numChannels);
+    for (size_t ii = 0; ii < numChannels; ++ii)
+    {
+        metadata.channel.parameters[ii].antenna.reset(
+                new cphd::ChannelParameter::Antenna());
+        cphd::ChannelParameter::Antenna& channel =
+                *metadata.channel.parameters[ii].antenna;
+        channel.txAPCId = "APC";
+        channel.txAPATId = "TX";
+        channel.rcvAPCId = "APC";
+        channel.rcvAPATId = "RCV";
+        metadata.data.channels.push_back(
+                cphd::Data::Channel(NUM_VECTORS, 16));
+    }
+    return metadata;
+}
+
+// The one-way pattern written out directly
+void expected(const cphd::AntPattern& pattern,
+              const cphd::Vector3& apc,
+              double frequency,
+              const cphd::Vector3& point,
+              double& gain,
+              double& phase)
+{
+    const cphd::Vector3 los = (point - apc).unit();
+    const double dcx = los[1];
+    const double dcy = los[2];
+
+    double dcxEB = 0.01;
+    double dilation = 1.0;
+    if (pattern.ebFreqShift == six::BooleanType::IS_TRUE)
+    {
+        dcxEB *= F0 / frequency;
+    }
+    if (pattern.mlFreqDilation == six::BooleanType::IS_TRUE)
+    {
+        dilation = frequency / F0;
+    }
+    const double x = dilation * (dcx - dcxEB);
+    const double y = dilation * dcy;
+
+    gain = -10.0 * x * x - 20.0 * y * y + dcy;
+    if (!six::Init::isUndefined(pattern.gainZero))
+    {
+        gain += pattern.gainZero;
+    }
+    if (!pattern.gainBSPoly.empty())
+    {
+        gain += pattern.gainBSPoly(frequency - F0);
+    }
+    phase = 0.5 * x;
+}
+
+struct Geometry
+{
+    Geometry()
+    {
+        for (size_t ii = 0; ii < NUM_VECTORS; ++ii)
+        {
+            txTime.push_back(0.1 * ii);
+            rcvTime.push_back(0.1 * ii + 0.01);
+            cphd::Vector3 pos(0.0);
+            pos[1] = 50.0 * ii;
+            txPos.push_back(pos);
+            pos[2] = 5.0;
+            rcvPos.push_back(pos);
+            frequency.push_back(F0 * (1.0 + 0.05 * ii));
+        }
+        for (size_t ii = 0; ii < NUM_POINTS; ++ii)
+        {
+            cphd::Vector3 point(0.0);
+            point[0] = 10000.0;
+            point[1] = 300.0 * ii - 600.0;
+            point[2] = 100.0 * ii;
+            points.push_back(point);
+        }
+    }
+
+    std::vector<double> txTime;
+    std::vector<double> rcvTime;
+    std::vector<cphd::Vector3> txPos;
+    std::vector<cphd::Vector3> rcvPos;
+    std::vector<double> frequency;
+    std::vector<cphd::Vector3> points;
+};
+
+TEST_CASE(testOneWay)
+{
+    const cphd::Metadata metadata = makeMetadata(1);
+    const cphd::AntennaPatternEvaluator evaluator(metadata);
+    const Geometry geometry;
+
+    for (size_t pattern = 0; pattern < 2; ++pattern)
+    {
+        const cphd::AntPattern& antPattern =
+                metadata.antenna->antPattern[pattern];
+        std::vector<double> gain(NUM_VECTORS * NUM_POINTS);
+        std::vector<double> phase(gain.size());
+        evaluator.evaluateOneWay("APC", antPattern.identifier,
+                                 &geometry.txTime[0], &geometry.txPos[0],
+                                 &geometry.frequency[0], NUM_VECTORS,
+                                 &geometry.points[0], NUM_POINTS,
+                                 &gain[0], &phase[0]);
+
+        for (size_t ii = 0; ii < NUM_VECTORS; ++ii)
+        {
+            for (size_t jj = 0; jj < NUM_POINTS; ++jj)
+            {
+                double expectedGain;
+                double expectedPhase;
+                expected(antPattern, geometry.txPos[ii],
+                         geometry.frequency[ii], geometry.points[jj],
+                         expectedGain, expectedPhase);
+                TEST_ASSERT_ALMOST_EQ(gain[ii * NUM_POINTS + jj],
+                                      expectedGain);
+                TEST_ASSERT_ALMOST_EQ(phase[ii * NUM_POINTS + jj],
+                                      expectedPhase);
+            }
+        }
+    }
+
+    // Without frequencies, the reference frequency is used
+    double gain;
+    double expectedGain;
+    double expectedPhase;
+    evaluator.evaluateOneWay("APC", "RCV", &geometry.txTime[0],
+                             &geometry.txPos[0], nullptr, 1,
+                             &geometry.points[0], 1, &gain, nullptr);
+    expected(metadata.antenna->antPattern[1], geometry.txPos[0], F0,
+             geometry.points[0], expectedGain, expectedPhase);
+    TEST_ASSERT_ALMOST_EQ(gain, expectedGain);
+
+    TEST_EXCEPTION(evaluator.evaluateOneWay("APC", "NONE",
+                                            &geometry.txTime[0],
+                                            &geometry.txPos[0], nullptr, 1,
+                                            &geometry.points[0], 1,
+                                            &gain, nullptr));
+}
+
+TEST_CASE(testTwoWay)
+{
+    const cphd::Metadata metadata = makeMetadata(1);
+    const cphd::AntennaPatternEvaluator evaluator(metadata, 3);
+    const Geometry geometry;
+
+    std::vector<double> gain(NUM_VECTORS * NUM_POINTS);
+    std::vector<double> phase(gain.size());
+    evaluator.evaluate(0, &geometry.txTime[0], &geometry.txPos[0],
+                       &geometry.rcvTime[0], &geometry.rcvPos[0],
+                       &geometry.frequency[0], NUM_VECTORS,
+                       &geometry.points[0], NUM_POINTS,
+                       &gain[0], &phase[0]);
+
+    for (size_t ii = 0; ii < NUM_VECTORS; ++ii)
+    {
+        for (size_t jj = 0; jj < NUM_POINTS; ++jj)
+        {
+            double txGain;
+            double txPhase;
+            double rcvGain;
+            double rcvPhase;
+            expected(metadata.antenna->antPattern[0], geometry.txPos[ii],
+                     geometry.frequency[ii], geometry.points[jj],
+                     txGain, txPhase);
+            expected(metadata.antenna->antPattern[1], geometry.rcvPos[ii],
+                     geometry.frequency[ii], geometry.points[jj],
+                     rcvGain, rcvPhase);
+            TEST_ASSERT_ALMOST_EQ(gain[ii * NUM_POINTS + jj],
+                                  txGain + rcvGain);
+            TEST_ASSERT_ALMOST_EQ(phase[ii * NUM_POINTS + jj],
+                                  txPhase + rcvPhase);
+        }
+    }
+}
+
+TEST_CASE(testPVPBlock)
+{
+    const size_t numChannels = 3;
+    cphd::Metadata metadata = makeMetadata(numChannels);
+    cphd::setPVPXML(metadata.pvp);
+    metadata.data.numBytesPVP = metadata.pvp.getReqSetSize() * sizeof(double);
+    cphd::PVPBlock pvpBlock(metadata.pvp, metadata.data);
+    const Geometry geometry;
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        for (size_t ii = 0; ii < NUM_VECTORS; ++ii)
+        {
+            pvpBlock.setTxTime(geometry.txTime[ii], channel, ii);
+            pvpBlock.setTxPos(geometry.txPos[ii], channel, ii);
+            pvpBlock.setRcvTime(geometry.rcvTime[ii], channel, ii);
+            pvpBlock.setRcvPos(geometry.rcvPos[ii], channel, ii);
+            pvpBlock.setFx1(geometry.frequency[ii] - 1.0e7, channel, ii);
+            pvpBlock.setFx2(geometry.frequency[ii] + 1.0e7, channel, ii);
+        }
+    }
+    TEST_ASSERT_EQ(pvpBlock.getNumChannels(), numChannels);
+    TEST_ASSERT_EQ(pvpBlock.getNumVectors(0), NUM_VECTORS);
+
+    const cphd::AntennaPatternEvaluator evaluator(metadata, 2);
+    std::vector<std::vector<double> > gain;
+    std::vector<std::vector<double> > phase;
+    evaluator.evaluate(pvpBlock, geometry.points, gain, phase);
+    TEST_ASSERT_EQ(gain.size(), numChannels);
+    TEST_ASSERT_EQ(phase.size(), numChannels);
+
+    std::vector<double> expectedGain(NUM_VECTORS * NUM_POINTS);
+    std::vector<double> expectedPhase(expectedGain.size());
+    evaluator.evaluate(0, &geometry.txTime[0], &geometry.txPos[0],
+                       &geometry.rcvTime[0], &geometry.rcvPos[0],
+                       &geometry.frequency[0], NUM_VECTORS,
+                       &geometry.points[0], NUM_POINTS,
+                       &expectedGain[0], &expectedPhase[0]);
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        TEST_ASSERT_EQ(gain[channel].size(), expectedGain.size());
+        for (size_t ii = 0; ii < expectedGain.size(); ++ii)
+        {
+            TEST_ASSERT_ALMOST_EQ(gain[channel][ii], expectedGain[ii]);
+            TEST_ASSERT_ALMOST_EQ(phase[channel][ii], expectedPhase[ii]);
+        }
+    }
+}
+
+TEST_CASE(testMissingAntenna)
+{
+    cphd::Metadata metadata = makeMetadata(1);
+    metadata.channel.parameters[0].antenna.reset();
+    const cphd::AntennaPatternEvaluator evaluator(metadata);
+    const Geometry geometry;
+    double gain;
+    TEST_EXCEPTION(evaluator.evaluate(0, &geometry.txTime[0],
+                                      &geometry.txPos[0],
+                                      &geometry.rcvTime[0],
+                                      &geometry.rcvPos[0], nullptr, 1,
+                                      &geometry.points[0], 1, &gain, nullptr));
+
+    metadata.antenna.reset();
+    TEST_EXCEPTION(cphd::AntennaPatternEvaluator(metadata));
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        TEST_CHECK(testOneWay);
+        TEST_CHECK(testTwoWay);
+        TEST_CHECK(testPVPBlock);
+        TEST_CHECK(testMissingAntenna);
+        return 0;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (...)
+    {
+        std::cerr << "Unknown exception\n";
+        return 1;
+    }
+}
@@ -0,0 +1,335 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cmath>
+#include <complex>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <io/ByteStream.h>
+#include <math/Constants.h>
+#include <cphd/Backprojector.h>
+#include <cphd/ByteSwap.h>
+#include <cphd/Metadata.h>
+#include <cphd/PVPBlock.h>
+#include <cphd/TestDataGenerator.h>
+#include <cphd/Wideband.h>
+#include <TestCase.h>
+
+namespace
+{
+constexpr size_t NUM_VECTORS = 64;
+constexpr size_t NUM_SAMPLES = 128;
+constexpr size_t GRID_SIZE = 41;
+constexpr double SPACING = 0.1;
+constexpr double FX_MIN = 9.5e9;
+constexpr double FX_MAX = 10.5e9;
+const double C = math::Constants::SPEED_OF_LIGHT_METERS_PER_SEC;
+
+// The scene plane is tangent to the equator at the prime meridian, with
+// rows running north along y and columns up along z.  The platform
+// looks at it from 10 km away, sweeping a small arc.
+cphd::Vector3 iarp()
+{
+    cphd::Vector3 iarp(0.0);
+    iarp[0] = 6378137.0;
+    return iarp;
+}
+
+cphd::Vector3 unitVector(size_t axis)
+{
+    cphd::Vector3 vector(0.0);
+    vector[axis] = 1.0;
+    return vector;
+}
+
+cphd::Vector3 platform(size_t vector)
+{
+    const double angle = 0.03 * (2.0 * vector / (NUM_VECTORS - 1) - 1.0);
+    cphd::Vector3 offset(0.0);
+    offset[0] = 6000.0;
+    offset[1] = -8000.0 * std::cos(angle);
+    offset[2] = 8000.0 * std::sin(angle);
+    return iarp() + offset;
+}
+
+cphd::Metadata makeMetadata()
+{
+    cphd::Metadata metadata;
+    metadata.data.channels.push_back(
+            cphd::Data::Channel(NUM_VECTORS, NUM_SAMPLES));
+    metadata.data.signalArrayFormat = cphd::SignalArrayFormat::CF8;
+    cphd::setPVPXML(metadata.pvp);
+    metadata.data.numBytesPVP = metadata.pvp.getReqSetSize() * sizeof(double);
+
+    metadata.global.domainType = cphd::DomainType::FX;
+    metadata.global.sgn = cphd::PhaseSGN::MINUS_1;
+    metadata.global.fxBand.fxMin = FX_MIN;
+    metadata.global.fxBand.fxMax = FX_MAX;
+
+    cphd::SceneCoordinates& scene = metadata.sceneCoordinates;
+    scene.iarp.ecf = iarp();
+    scene.referenceSurface.planar.reset(new cphd::Planar());
+    scene.referenceSurface.planar->uIax = unitVector(1);
+    scene.referenceSurface.planar->uIay = unitVector(2);
+    scene.imageArea.x1y1[0] = -2.0;
+    scene.imageArea.x1y1[1] = -2.0;
+    scene.imageArea.x2y2[0] = 2.0;
+    scene.imageArea.x2y2[1] = 2.0;
+    scene.imageGrid.reset(new cphd::ImageGrid());
+    scene.imageGrid->iarpLocation.line = 20.0;
+    scene.imageGrid->iarpLocation.sample = 20.0;
+    scene.imageGrid->xExtent.lineSpacing = SPACING;
+    scene.imageGrid->xExtent.firstLine = 0;
+    scene.imageGrid->xExtent.numLines = GRID_SIZE;
+    scene.imageGrid->yExtent.sampleSpacing = SPACING;
+    scene.imageGrid->yExtent.firstSample = 0;
+    scene.imageGrid->yExtent.numSamples = GRID_SIZE;
+    return metadata;
+}
+
+void setPVPs(cphd::PVPBlock& pvpBlock)
+{
+    const double scss = (FX_MAX - FX_MIN) / (NUM_SAMPLES - 1);
+    for (size_t ii = 0; ii < NUM_VECTORS; ++ii)
+    {
+        pvpBlock.setTxTime(0.01 * ii, 0, ii);
+        pvpBlock.setTxPos(platform(ii), 0, ii);
+        pvpBlock.setRcvTime(0.01 * ii + 1.0e-4, 0, ii);
+        pvpBlock.setRcvPos(platform(ii), 0, ii);
+        pvpBlock.setSRPPos(iarp(), 0, ii);
+        pvpBlock.setFx1(FX_MIN, 0, ii);
+        pvpBlock.setFx2(FX_MAX, 0, ii);
+        pvpBlock.setSC0(FX_MIN, 0, ii);
+        pvpBlock.setSCSS(scss, 0, ii);
+        pvpBlock.setTOA1(-0.5 / scss, 0, ii);
+        pvpBlock.setTOA2(0.5 / scss, 0, ii);
+    }
+}
+
+// Phase history of a unit scatterer, with SGN = -1
+std::vector<std::complex<float> > makeSignal(const cphd::PVPBlock& pvpBlock,
+                                             const cphd::Vector3& target)
+{
+    std::vector<std::complex<float> > signal(NUM_VECTORS * NUM_SAMPLES);
+    for (size_t ii = 0; ii < NUM_VECTORS; ++ii)
+    {
+        const cphd::Vector3 position = pvpBlock.getTxPos(0, ii);
+        const double dtoa = 2.0 * ((position - target).norm() -
+                                   (position - iarp()).norm()) / C;
+        for (size_t jj = 0; jj < NUM_SAMPLES; ++jj)
+        {
+            const double frequency = pvpBlock.getSC0(0, ii) +
+                    jj * pvpBlock.getSCSS(0, ii);
+            const double phase = -2.0 * M_PI * frequency * dtoa;
+            signal[ii * NUM_SAMPLES + jj] = std::complex<float>(
+                    static_cast<float>(std::cos(phase)),
+                    static_cast<float>(std::sin(phase)));
+        }
+    }
+    return signal;
+}
+
+size_t findPeak(const std::vector<std::complex<float> >& image)
+{
+    size_t peak = 0;
+    for (size_t ii = 1; ii < image.size(); ++ii)
+    {
+        if (std::abs(image[ii]) > std::abs(image[peak]))
+        {
+            peak = ii;
+        }
+    }
+    return peak;
+}
+
+TEST_CASE(testGrid)
+{
+    cphd::Metadata metadata = makeMetadata();
+    cphd::PVPBlock pvpBlock(metadata.pvp, metadata.data);
+    setPVPs(pvpBlock);
+
+    const cphd::Backprojector gridded(metadata, pvpBlock);
+    TEST_ASSERT_EQ(gridded.getNumRows(), GRID_SIZE);
+    TEST_ASSERT_EQ(gridded.getNumCols(), GRID_SIZE);
+    TEST_ASSERT_ALMOST_EQ(gridded.getRowSpacing(), SPACING);
+    TEST_ASSERT_ALMOST_EQ(gridded.getColSpacing(), SPACING);
+    TEST_ASSERT_EQ(gridded.getSCPPixel().row, 20);
+    TEST_ASSERT_EQ(gridded.getSCPPixel().col, 20);
+    const cphd::Vector3 offset = gridded.getPixelPosition(25, 17) - iarp();
+    TEST_ASSERT_ALMOST_EQ(offset[0], 0.0);
+    TEST_ASSERT_ALMOST_EQ(offset[1], 0.5);
+    TEST_ASSERT_ALMOST_EQ(offset[2], -0.3);
+
+    // Without an ImageGrid, the Image Area is sampled at 1.5 times the
+    // bandwidth
+    metadata.sceneCoordinates.imageGrid.reset();
+    const cphd::Backprojector sampled(metadata, pvpBlock);
+    TEST_ASSERT_GREATER(sampled.getRowSpacing(), 0.1);
+    TEST_ASSERT_LESSER(sampled.getRowSpacing(), 0.15);
+    TEST_ASSERT_GREATER(sampled.getColSpacing(), sampled.getRowSpacing());
+    const cphd::Vector3 scp = sampled.getPixelPosition(
+            sampled.getSCPPixel().row, sampled.getSCPPixel().col);
+    TEST_ASSERT_ALMOST_EQ((scp - iarp()).norm(), 0.0);
+    const cphd::Vector3 last = sampled.getPixelPosition(
+            sampled.getNumRows() - 1, sampled.getNumCols() - 1) - iarp();
+    TEST_ASSERT_GREATER_EQ(last[1], 2.0);
+    TEST_ASSERT_GREATER_EQ(last[2], 2.0);
+
+    metadata.sceneCoordinates.referenceSurface.planar.reset();
+    TEST_EXCEPTION(cphd::Backprojector(metadata, pvpBlock));
+}
+
+TEST_CASE(testPointTarget)
+{
+    const cphd::Metadata metadata = makeMetadata();
+    cphd::PVPBlock pvpBlock(metadata.pvp, metadata.data);
+    setPVPs(pvpBlock);
+
+    cphd::Backprojector backprojector(metadata, pvpBlock, 3);
+    backprojector.setTileSize(16);
+    const cphd::Vector3 target = backprojector.getPixelPosition(25, 17);
+    const std::vector<std::complex<float> > signal =
+            makeSignal(pvpBlock, target);
+
+    // Two blocks add up to the whole collection
+    std::vector<std::complex<float> > image(GRID_SIZE * GRID_SIZE);
+    const size_t half = NUM_VECTORS / 2;
+    backprojector.backproject(0, 0, half, &signal[0], &image[0]);
+    backprojector.backproject(0, half, NUM_VECTORS - half,
+                              &signal[half * NUM_SAMPLES], &image[0]);
+
+    const size_t peak = findPeak(image);
+    TEST_ASSERT_EQ(peak / GRID_SIZE, 25);
+    TEST_ASSERT_EQ(peak % GRID_SIZE, 17);
+
+    // Focused, the peak is nearly the coherent sum of every sample
+    const double coherentSum = static_cast<double>(NUM_VECTORS) * NUM_SAMPLES;
+    TEST_ASSERT_GREATER(std::abs(image[peak]), 0.8 * coherentSum);
+    TEST_ASSERT_LESSER(std::abs(image[20 * GRID_SIZE + 20]),
+                       0.1 * coherentSum);
+}
+
+TEST_CASE(testFormImage)
+{
+    cphd::Metadata metadata = makeMetadata();
+    cphd::PVPBlock pvpBlock(metadata.pvp, metadata.data);
+    setPVPs(pvpBlock);
+
+    cphd::Backprojector backprojector(metadata, pvpBlock, 2);
+    backprojector.setVectorsPerBlock(10);
+    const std::vector<std::complex<float> > signal =
+            makeSignal(pvpBlock, backprojector.getPixelPosition(12, 30));
+
+    // CF8 is stored big endian
+    std::vector<std::complex<float> > stored(signal);
+    cphd::byteSwap(&stored[0], sizeof(float), stored.size() * 2, 1);
+    auto input = std::make_shared<io::ByteStream>();
+    input->write(reinterpret_cast<const sys::byte*>(&stored[0]),
+                 stored.size() * sizeof(stored[0]));
+    input->seek(0, io::Seekable::START);
+    const cphd::Wideband wideband(input, metadata, 0,
+                                  stored.size() * sizeof(stored[0]));
+
+    std::vector<std::complex<float> > image(GRID_SIZE * GRID_SIZE,
+                                            std::complex<float>(1.0f));
+    backprojector.formImage(wideband, 0, &image[0]);
+
+    std::vector<std::complex<float> > expected(image.size());
+    backprojector.backproject(0, 0, NUM_VECTORS, &signal[0], &expected[0]);
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        TEST_ASSERT_LESSER(std::abs(image[ii] - expected[ii]),
+                           1.0e-3 * NUM_VECTORS * NUM_SAMPLES);
+    }
+    TEST_ASSERT_EQ(findPeak(image), 12 * GRID_SIZE + 30);
+}
+
+TEST_CASE(testComplexData)
+{
+    const cphd::Metadata metadata = makeMetadata();
+    cphd::PVPBlock pvpBlock(metadata.pvp, metadata.data);
+    setPVPs(pvpBlock);
+
+    const cphd::Backprojector backprojector(metadata, pvpBlock);
+    const std::auto_ptr<six::sicd::ComplexData> data =
+            backprojector.createComplexData(0);
+
+    TEST_ASSERT_EQ(data->getNumRows(), GRID_SIZE);
+    TEST_ASSERT_EQ(data->getNumCols(), GRID_SIZE);
+    TEST_ASSERT_EQ(data->getPixelType(), six::PixelType::RE32F_IM32F);
+    TEST_ASSERT_EQ(data->imageData->scpPixel.row, 20);
+    TEST_ASSERT_EQ(data->imageData->scpPixel.col, 20);
+    TEST_ASSERT_ALMOST_EQ((data->geoData->scp.ecf - iarp()).norm(), 0.0);
+
+    const six::sicd::Grid& grid = *data->grid;
+    TEST_ASSERT_EQ(grid.type, six::ComplexImageGridType::PLANE);
+    TEST_ASSERT_ALMOST_EQ(grid.row->sampleSpacing, SPACING);
+    TEST_ASSERT_ALMOST_EQ(grid.col->sampleSpacing, SPACING);
+    TEST_ASSERT_EQ(grid.row->sign, six::FFTSign::NEG);
+
+    // Rows point away from the platform, so the row spatial frequency is
+    // positive
+    const double rowBandwidth = 2.0 * (FX_MAX - FX_MIN) / C * 0.8;
+    TEST_ASSERT_GREATER(grid.row->kCenter, 0.0);
+    TEST_ASSERT_LESSER(std::abs(grid.row->impulseResponseBandwidth -
+                                rowBandwidth), 0.01 * rowBandwidth);
+    TEST_ASSERT_LESSER(std::abs(grid.col->kCenter), 1.0e-6);
+
+    const cphd::Vector3 arp = data->position->arpPoly(0.01 * 10 + 5.0e-5);
+    TEST_ASSERT_LESSER((arp - platform(10)).norm(), 1.0e-3);
+    TEST_ASSERT_ALMOST_EQ(data->imageFormation->txFrequencyProcMin, FX_MIN);
+    TEST_ASSERT_ALMOST_EQ(data->imageFormation->txFrequencyProcMax, FX_MAX);
+    TEST_ASSERT_EQ(
+            data->imageFormation->rcvChannelProcessed->channelIndex[0], 1);
+    TEST_ASSERT_GREATER(data->scpcoa->slantRange, 9999.0);
+    TEST_ASSERT_LESSER(data->scpcoa->slantRange, 10001.0);
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        TEST_CHECK(testGrid);
+        TEST_CHECK(testPointTarget);
+        TEST_CHECK(testFormImage);
+        TEST_CHECK(testComplexData);
+        return 0;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (...)
+    {
+        std::cerr << "Unknown exception\n";
+        return 1;
+    }
+}
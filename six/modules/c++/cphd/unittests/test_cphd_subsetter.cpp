@@ -0,0 +1,323 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <stdlib.h>
+#include <complex>
+#include <string>
+#include <vector>
+
+#include <cphd/CPHDReader.h>
+#include <cphd/CPHDSubsetter.h>
+#include <cphd/CPHDWriter.h>
+#include <cphd/Metadata.h>
+#include <cphd/PVPBlock.h>
+#include <cphd/ReferenceGeometryCalculator.h>
+#include <cphd/TestDataGenerator.h>
+#include <cphd/Wideband.h>
+#include <io/TempFile.h>
+#include <logging/NullLogger.h>
+#include <scene/Utilities.h>
+#include <sys/Conf.h>
+#include <types/RowCol.h>
+#include "TestCase.h"
+
+namespace
+{
+typedef std::complex<sys::Int16_T> Sample;
+
+const types::RowCol<size_t> DIMS(32, 24);
+const size_t NUM_CHANNELS = 2;
+const double FX0 = 1.0e9;
+const double FXSS = 1.0e6;
+const double TOA = 1.0e-6;
+const double DTOA = 1.0e-8;
+
+cphd::Vector3 vector3(double x, double y, double z)
+{
+    cphd::Vector3 vec;
+    vec[0] = x;
+    vec[1] = y;
+    vec[2] = z;
+    return vec;
+}
+
+cphd::Vector3 getSRP()
+{
+    return scene::Utilities::latLonToECEF(cphd::LatLonAlt(30.0, 40.0, 0.0));
+}
+
+// The platform flies in a straight line from 10 km above the SRP
+cphd::Vector3 getPosition(double time)
+{
+    const cphd::Vector3 srp = getSRP();
+    return srp + srp.unit() * 10000.0 + vector3(100.0, 7000.0, -300.0) * time;
+}
+
+// Every vector saves all but its first and last samples, and the saved
+// TOA swath widens with the vector
+void setCollectParameters(size_t channel, size_t vector,
+                          cphd::PVPBlock& pvpBlock)
+{
+    const double txTime = 0.1 * vector;
+    const double rcvTime = txTime + 1.0e-4;
+    pvpBlock.setTxTime(txTime, channel, vector);
+    pvpBlock.setTxPos(getPosition(txTime), channel, vector);
+    pvpBlock.setTxVel(vector3(100.0, 7000.0, -300.0), channel, vector);
+    pvpBlock.setRcvTime(rcvTime, channel, vector);
+    pvpBlock.setRcvPos(getPosition(rcvTime), channel, vector);
+    pvpBlock.setRcvVel(vector3(100.0, 7000.0, -300.0), channel, vector);
+    pvpBlock.setSRPPos(getSRP(), channel, vector);
+    pvpBlock.setSC0(FX0, channel, vector);
+    pvpBlock.setSCSS(FXSS, channel, vector);
+    pvpBlock.setFx1(FX0 + FXSS, channel, vector);
+    pvpBlock.setFx2(FX0 + (DIMS.col - 2) * FXSS, channel, vector);
+    pvpBlock.setTOA1(-TOA - DTOA * vector, channel, vector);
+    pvpBlock.setTOA2(TOA + DTOA * vector, channel, vector);
+}
+
+std::vector<Sample> generateData()
+{
+    std::vector<Sample> data(DIMS.area() * NUM_CHANNELS);
+    srand(0);
+    for (size_t ii = 0; ii < data.size(); ++ii)
+    {
+        data[ii] = Sample(static_cast<sys::Int16_T>(rand() % 1000),
+                          static_cast<sys::Int16_T>(rand() % 1000));
+    }
+    return data;
+}
+
+void writeCPHD(const std::string& pathname,
+               const std::vector<Sample>& data,
+               cphd::Metadata& metadata)
+{
+    cphd::setUpData(metadata, DIMS, data);
+    metadata.data.channels.push_back(
+            cphd::Data::Channel(DIMS.row, DIMS.col));
+    for (size_t ii = 0; ii < NUM_CHANNELS; ++ii)
+    {
+        metadata.data.channels[ii].identifier = "Channel" + str::toString(ii);
+        cphd::ChannelParameter parameter;
+        parameter.identifier = metadata.data.channels[ii].identifier;
+        parameter.refVectorIndex = 10;
+        parameter.fxFixed = six::BooleanType::IS_TRUE;
+        parameter.toaFixed = six::BooleanType::IS_TRUE;
+        parameter.srpFixed = six::BooleanType::IS_TRUE;
+        parameter.polarization.txPol = cphd::PolarizationType::V;
+        parameter.polarization.rcvPol = cphd::PolarizationType::V;
+        parameter.fxC = 1.0e9;
+        parameter.fxBW = 1.0e8;
+        parameter.toaSaved = 1.0e-6;
+        parameter.dwellTimes.codId = "COD";
+        parameter.dwellTimes.dwellId = "Dwell";
+        metadata.channel.parameters.push_back(parameter);
+    }
+    metadata.channel.refChId = "Channel0";
+    cphd::setPVPXML(metadata.pvp);
+
+    metadata.collectionID.collectType = cphd::CollectType::MONOSTATIC;
+    metadata.global.domainType = cphd::DomainType::FX;
+    metadata.sceneCoordinates.iarp.ecf = getSRP();
+    metadata.sceneCoordinates.referenceSurface.planar.reset(
+            new cphd::Planar());
+    metadata.sceneCoordinates.referenceSurface.planar->uIax =
+            vector3(0.0, 1.0, 0.0);
+    metadata.sceneCoordinates.referenceSurface.planar->uIay =
+            vector3(0.0, 0.0, 1.0);
+    metadata.dwell.cod.resize(1);
+    metadata.dwell.cod[0].identifier = "COD";
+    metadata.dwell.cod[0].codTimePoly = cphd::Poly2D(0, 0);
+    metadata.dwell.cod[0].codTimePoly[0][0] = 1.5;
+    metadata.dwell.dtime.resize(1);
+    metadata.dwell.dtime[0].identifier = "Dwell";
+    metadata.dwell.dtime[0].dwellTimePoly = cphd::Poly2D(0, 0);
+    metadata.dwell.dtime[0].dwellTimePoly[0][0] = 3.0;
+
+    cphd::PVPBlock pvpBlock(metadata.pvp, metadata.data);
+    for (size_t ii = 0; ii < NUM_CHANNELS; ++ii)
+    {
+        for (size_t jj = 0; jj < DIMS.row; ++jj)
+        {
+            cphd::setVectorParameters(ii, jj, pvpBlock);
+            setCollectParameters(ii, jj, pvpBlock);
+        }
+    }
+
+    cphd::CPHDWriter writer(metadata, pathname);
+    writer.write(pvpBlock, data.data());
+}
+
+TEST_CASE(testSubsetChannels)
+{
+    const std::vector<Sample> data = generateData();
+    io::TempFile input;
+    cphd::Metadata metadata;
+    writeCPHD(input.pathname(), data, metadata);
+
+    // Keep part of the second channel, then all of the first, through a
+    // buffer smaller than a vector
+    cphd::CPHDSubsetter subsetter(input.pathname(),
+                                  std::vector<std::string>(), 50);
+    subsetter.addChannel(1, 12, 27, 3, 20);
+    subsetter.addChannel(0);
+    TEST_EXCEPTION(subsetter.addChannel(0, 5, 5));
+    TEST_EXCEPTION(subsetter.addChannel(1, 0, DIMS.row));
+
+    io::TempFile output;
+    subsetter.write(output.pathname());
+
+    const cphd::CPHDReader original(input.pathname(), 1);
+    const cphd::CPHDReader reader(output.pathname(), 1);
+    const cphd::Metadata& subset = reader.getMetadata();
+    TEST_ASSERT_EQ(reader.getNumChannels(), 2);
+    TEST_ASSERT_EQ(reader.getNumVectors(0), 16);
+    TEST_ASSERT_EQ(reader.getNumSamples(0), 18);
+    TEST_ASSERT_EQ(reader.getNumVectors(1), DIMS.row);
+    TEST_ASSERT_EQ(reader.getNumSamples(1), DIMS.col);
+    TEST_ASSERT_EQ(subset.data.channels[0].identifier, "Channel1");
+    TEST_ASSERT_EQ(subset.channel.parameters[0].identifier, "Channel1");
+    TEST_ASSERT_EQ(subset.channel.parameters[0].refVectorIndex, 0);
+    TEST_ASSERT_EQ(subset.channel.parameters[1].refVectorIndex, 10);
+    TEST_ASSERT_EQ(subset.channel.refChId, "Channel0");
+
+    // Signal samples are copied as is
+    for (size_t channel = 0; channel < 2; ++channel)
+    {
+        const size_t inChannel = channel == 0 ? 1 : 0;
+        const size_t firstVector = channel == 0 ? 12 : 0;
+        const size_t firstSample = channel == 0 ? 3 : 0;
+        mem::ScopedArray<sys::ubyte> buffer;
+        reader.getWideband().read(channel, 0, cphd::Wideband::ALL, 0,
+                                  cphd::Wideband::ALL, 1, buffer);
+        const Sample* const samples =
+                reinterpret_cast<const Sample*>(buffer.get());
+        const Sample* const expected = &data[inChannel * DIMS.area()];
+        for (size_t ii = 0, idx = 0; ii < reader.getNumVectors(channel); ++ii)
+        {
+            for (size_t jj = 0; jj < reader.getNumSamples(channel);
+                 ++jj, ++idx)
+            {
+                TEST_ASSERT_EQ(samples[idx],
+                               expected[(firstVector + ii) * DIMS.col +
+                                        firstSample + jj]);
+            }
+        }
+
+        // So are the PVPs, apart from SC0 following the first sample
+        const cphd::PVPBlock& pvps = reader.getPVPBlock();
+        const cphd::PVPBlock& inPVPs = original.getPVPBlock();
+        for (size_t ii = 0; ii < reader.getNumVectors(channel); ++ii)
+        {
+            const size_t inVector = firstVector + ii;
+            TEST_ASSERT_EQ(pvps.getTxTime(channel, ii),
+                           inPVPs.getTxTime(inChannel, inVector));
+            TEST_ASSERT_EQ(pvps.getSCSS(channel, ii),
+                           inPVPs.getSCSS(inChannel, inVector));
+            TEST_ASSERT_ALMOST_EQ(pvps.getSC0(channel, ii),
+                                  inPVPs.getSC0(inChannel, inVector) +
+                                          firstSample *
+                                                  inPVPs.getSCSS(inChannel,
+                                                                 inVector));
+        }
+    }
+}
+
+TEST_CASE(testSubsetMetadata)
+{
+    const std::vector<Sample> data = generateData();
+    io::TempFile input;
+    cphd::Metadata metadata;
+    writeCPHD(input.pathname(), data, metadata);
+
+    // The reference vector of the reference channel is cropped away
+    cphd::CPHDSubsetter subsetter(input.pathname());
+    subsetter.addChannel(1, 12, 27);
+    subsetter.addChannel(0, 4, 9, 3, 20);
+    io::TempFile output;
+    subsetter.write(output.pathname());
+
+    const cphd::CPHDReader reader(output.pathname(), 1);
+    const cphd::Metadata& subset = reader.getMetadata();
+    TEST_ASSERT_EQ(subset.channel.refChId, "Channel0");
+    TEST_ASSERT_EQ(subset.channel.parameters[1].refVectorIndex, 5);
+
+    // The uncropped channel keeps its band, and its TOA swath narrows
+    // with the vectors
+    const cphd::ChannelParameter& whole = subset.channel.parameters[0];
+    TEST_ASSERT_ALMOST_EQ_EPS(whole.fxBW, (DIMS.col - 3) * FXSS, 1e-6);
+    TEST_ASSERT_ALMOST_EQ_EPS(whole.fxC, FX0 + (DIMS.col - 1) * FXSS / 2,
+                              1e-6);
+    TEST_ASSERT_ALMOST_EQ_EPS(whole.toaSaved, 2 * (TOA + 27 * DTOA), 1e-18);
+
+    // The cropped channel's band is clipped to the samples that are left
+    const cphd::ChannelParameter& cropped = subset.channel.parameters[1];
+    TEST_ASSERT_ALMOST_EQ_EPS(cropped.fxBW, 17 * FXSS, 1e-6);
+    TEST_ASSERT_ALMOST_EQ_EPS(cropped.fxC, FX0 + 11.5 * FXSS, 1e-6);
+    TEST_ASSERT_ALMOST_EQ_EPS(cropped.toaSaved, 2 * (TOA + 9 * DTOA), 1e-18);
+    const cphd::PVPBlock& pvps = reader.getPVPBlock();
+    for (size_t ii = 0; ii < reader.getNumVectors(1); ++ii)
+    {
+        TEST_ASSERT_ALMOST_EQ_EPS(pvps.getFx1(1, ii), FX0 + 3 * FXSS, 1e-6);
+        TEST_ASSERT_ALMOST_EQ_EPS(pvps.getFx2(1, ii), FX0 + 20 * FXSS, 1e-6);
+    }
+
+    TEST_ASSERT_ALMOST_EQ(subset.global.timeline.txTime1, 0.4);
+    TEST_ASSERT_ALMOST_EQ(subset.global.timeline.txTime2, 2.7);
+    TEST_ASSERT_ALMOST_EQ_EPS(subset.global.fxBand.fxMin, FX0 + FXSS, 1e-6);
+    TEST_ASSERT_ALMOST_EQ_EPS(subset.global.fxBand.fxMax,
+                              FX0 + (DIMS.col - 2) * FXSS, 1e-6);
+    TEST_ASSERT_ALMOST_EQ_EPS(subset.global.toaSwath.toaMin,
+                              -TOA - 27 * DTOA, 1e-18);
+    TEST_ASSERT_ALMOST_EQ_EPS(subset.global.toaSwath.toaMax,
+                              TOA + 27 * DTOA, 1e-18);
+
+    // The reference geometry describes the new reference vector
+    const cphd::ReferenceGeometryCalculator calculator(subset, pvps);
+    logging::NullLogger log;
+    TEST_ASSERT(calculator.validate(subset.referenceGeometry, log));
+    TEST_ASSERT(subset.referenceGeometry.monostatic.get() != nullptr);
+    TEST_ASSERT_ALMOST_EQ_EPS(
+            subset.referenceGeometry.monostatic->arpPos[1],
+            ((getPosition(0.9) + getPosition(0.9 + 1.0e-4)) * 0.5)[1],
+            1e-6);
+    TEST_ASSERT_ALMOST_EQ(subset.referenceGeometry.srpCODTime, 1.5);
+}
+
+TEST_CASE(testNoChannels)
+{
+    const std::vector<Sample> data = generateData();
+    io::TempFile input;
+    cphd::Metadata metadata;
+    writeCPHD(input.pathname(), data, metadata);
+
+    const cphd::CPHDSubsetter subsetter(input.pathname());
+    io::TempFile output;
+    TEST_EXCEPTION(subsetter.write(output.pathname()));
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testSubsetChannels);
+    TEST_CHECK(testSubsetMetadata);
+    TEST_CHECK(testNoChannels);
+    return 0;
+}
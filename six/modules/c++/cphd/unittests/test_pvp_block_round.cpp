@@ -246,6 +246,58 @@ TEST_CASE(testPVPBlockAdditional)
 
     TEST_ASSERT_TRUE(runTest(scale, writeData, meta, pvpBlock, dims));
 }
+
+TEST_CASE(testPVPBlockParallelEncode)
+{
+    const types::RowCol<size_t> dims(1000, 4);
+    const std::vector<std::complex<sys::Int16_T>> writeData =
+            generateComplexData<sys::Int16_T>(dims.area());
+    cphd::Metadata meta = cphd::Metadata();
+    cphd::setUpData(meta, dims, writeData);
+    cphd::setPVPXML(meta.pvp);
+    meta.pvp.setOffset(27, meta.pvp.fxN1);
+    meta.pvp.setCustomParameter(1, 28, "F8", "param1");
+    meta.pvp.setCustomParameter(1, 29, "I8", "param2");
+    meta.pvp.setCustomParameter(1, 30, "S8", "param3");
+    meta.data.numBytesPVP += 4 * 8;
+    cphd::PVPBlock pvpBlock(meta.pvp, meta.data);
+    setPVPBlock(dims,
+                pvpBlock,
+                false,
+                true,
+                false,
+                false,
+                false,
+                false,
+                std::vector<std::string>(1, "param1"));
+    for (size_t ii = 0; ii < dims.row; ++ii)
+    {
+        pvpBlock.setAddedPVP(static_cast<int>(ii) - 500, 0, ii, "param2");
+        pvpBlock.setAddedPVP(std::string("v") + str::toString(ii),
+                             0, ii, "param3");
+    }
+
+    std::vector<sys::ubyte> serial;
+    pvpBlock.getPVPdata(0, serial);
+
+    // Swapped, parallel conversion is the same bytes swapped
+    std::vector<sys::ubyte> swapped(serial.size());
+    pvpBlock.getPVPdata(0, &swapped[0], true, 3);
+    sys::byteSwap(&swapped[0], 8, swapped.size() / 8);
+    TEST_ASSERT_TRUE(swapped == serial);
+
+    // And converting back gives the same bytes
+    const cphd::PVPBlock copy(1,
+                              std::vector<size_t>(1, dims.row),
+                              meta.pvp,
+                              std::vector<const void*>(1, &serial[0]));
+    std::vector<sys::ubyte> roundTrip;
+    copy.getPVPdata(0, roundTrip);
+    TEST_ASSERT_TRUE(roundTrip == serial);
+    TEST_ASSERT_EQ(copy.getFxN1(0, 99), pvpBlock.getFxN1(0, 99));
+    TEST_ASSERT_EQ(copy.getAddedPVP<int>(0, 7, "param2"), -493);
+    TEST_ASSERT_EQ(copy.getAddedPVP<std::string>(0, 12, "param3"), "v12");
+}
 }
 
 int main(int argc, char** argv)
@@ -255,6 +307,7 @@ int main(int argc, char** argv)
         TEST_CHECK(testPVPBlockSimple);
         TEST_CHECK(testPVPBlockOptional);
         TEST_CHECK(testPVPBlockAdditional);
+        TEST_CHECK(testPVPBlockParallelEncode);
         return 0;
     }
     catch (const std::exception& ex)
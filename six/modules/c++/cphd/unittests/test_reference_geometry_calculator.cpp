@@ -0,0 +1,336 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cmath>
+#include <iostream>
+
+#include <logging/NullLogger.h>
+#include <math/Constants.h>
+#include <scene/SceneGeometry.h>
+#include <scene/Utilities.h>
+#include <cphd/Metadata.h>
+#include <cphd/PVPBlock.h>
+#include <cphd/ReferenceGeometryCalculator.h>
+#include <cphd/TestDataGenerator.h>
+#include <TestCase.h>
+
+namespace
+{
+constexpr size_t NUM_VECTORS = 20;
+constexpr double DT = 0.01;
+const double DEGREES = math::Constants::RADIANS_TO_DEGREES;
+
+cphd::Vector3 srpPosition()
+{
+    return scene::Utilities::latLonToECEF(scene::LatLonAlt(30.0, 40.0, 0.0));
+}
+
+cphd::Vector3 vector3(double x, double y, double z)
+{
+    cphd::Vector3 vec;
+    vec[0] = x;
+    vec[1] = y;
+    vec[2] = z;
+    return vec;
+}
+
+// Platforms flying past the SRP in straight lines.  The receiver is a
+// separate platform when bistatic.
+cphd::Metadata makeMetadata(six::CollectType collectType,
+                            cphd::PVPBlock*& pvpBlock)
+{
+    cphd::Metadata metadata;
+    metadata.collectionID.collectType = collectType;
+    metadata.data.channels.push_back(cphd::Data::Channel(NUM_VECTORS, 8));
+    metadata.data.channels[0].identifier = "Channel";
+    cphd::setPVPXML(metadata.pvp);
+    metadata.data.numBytesPVP = metadata.pvp.getReqSetSize() * sizeof(double);
+
+    metadata.channel.refChId = "Channel";
+    metadata.channel.parameters.resize(1);
+    metadata.channel.parameters[0].refVectorIndex = 7;
+    metadata.channel.parameters[0].dwellTimes.codId = "COD";
+    metadata.channel.parameters[0].dwellTimes.dwellId = "Dwell";
+    metadata.dwell.cod.resize(1);
+    metadata.dwell.cod[0].identifier = "COD";
+    metadata.dwell.cod[0].codTimePoly = cphd::Poly2D(1, 1);
+    metadata.dwell.cod[0].codTimePoly[0][0] = 0.1;
+    metadata.dwell.cod[0].codTimePoly[1][0] = 0.01;
+    metadata.dwell.cod[0].codTimePoly[0][1] = 0.02;
+    metadata.dwell.dtime.resize(1);
+    metadata.dwell.dtime[0].identifier = "Dwell";
+    metadata.dwell.dtime[0].dwellTimePoly = cphd::Poly2D(0, 0);
+    metadata.dwell.dtime[0].dwellTimePoly[0][0] = 0.2;
+
+    const cphd::Vector3 srp = srpPosition();
+    metadata.sceneCoordinates.iarp.ecf = srp + vector3(10.0, -20.0, 5.0);
+    metadata.sceneCoordinates.referenceSurface.planar.reset(
+            new cphd::Planar());
+    metadata.sceneCoordinates.referenceSurface.planar->uIax =
+            vector3(0.0, 0.0, 2.0);
+    metadata.sceneCoordinates.referenceSurface.planar->uIay =
+            vector3(0.0, 1.0, 0.0);
+
+    pvpBlock = new cphd::PVPBlock(metadata.pvp, metadata.data);
+    const cphd::Vector3 txStart = srp * 1.002 + vector3(5000.0, -3000.0, 0);
+    const cphd::Vector3 txVel = vector3(-100.0, 50.0, 200.0);
+    const cphd::Vector3 rcvStart = collectType == six::CollectType::BISTATIC ?
+            srp * 1.001 + vector3(-4000.0, 6000.0, 2000.0) : txStart;
+    const cphd::Vector3 rcvVel = collectType == six::CollectType::BISTATIC ?
+            vector3(80.0, 120.0, -60.0) : txVel;
+    for (size_t ii = 0; ii < NUM_VECTORS; ++ii)
+    {
+        const double time = DT * ii;
+        pvpBlock->setTxTime(time, 0, ii);
+        pvpBlock->setTxPos(txStart + txVel * time, 0, ii);
+        pvpBlock->setTxVel(txVel, 0, ii);
+        pvpBlock->setRcvTime(time, 0, ii);
+        pvpBlock->setRcvPos(rcvStart + rcvVel * time, 0, ii);
+        pvpBlock->setRcvVel(rcvVel, 0, ii);
+        pvpBlock->setSRPPos(srp, 0, ii);
+    }
+    return metadata;
+}
+
+TEST_CASE(testMonostatic)
+{
+    cphd::PVPBlock* pvps;
+    const cphd::Metadata metadata =
+            makeMetadata(six::CollectType::MONOSTATIC, pvps);
+    const std::auto_ptr<cphd::PVPBlock> pvpBlock(pvps);
+    const cphd::ReferenceGeometryCalculator calculator(metadata, *pvpBlock);
+
+    const cphd::ReferenceGeometry geometry =
+            calculator.computeReferenceGeometry();
+    TEST_ASSERT_TRUE(geometry.monostatic.get() != nullptr);
+    TEST_ASSERT_TRUE(geometry.bistatic.get() == nullptr);
+    const cphd::Monostatic& monostatic = *geometry.monostatic;
+
+    const cphd::Vector3 srp = srpPosition();
+    const cphd::Vector3 arpPos = pvpBlock->getTxPos(0, 7);
+    const cphd::Vector3 arpVel = pvpBlock->getTxVel(0, 7);
+    TEST_ASSERT_ALMOST_EQ(geometry.referenceTime,
+                          7 * DT + (arpPos - srp).norm() /
+                          math::Constants::SPEED_OF_LIGHT_METERS_PER_SEC);
+    TEST_ASSERT_EQ(geometry.srp.ecf, srp);
+    TEST_ASSERT_ALMOST_EQ(geometry.srp.iac[0], -5.0);
+    TEST_ASSERT_ALMOST_EQ(geometry.srp.iac[1], 20.0);
+    TEST_ASSERT_ALMOST_EQ(geometry.srp.iac[2], 10.0);
+    TEST_ASSERT_ALMOST_EQ(geometry.srpCODTime, 0.1 - 0.05 + 0.4);
+    TEST_ASSERT_ALMOST_EQ(geometry.srpDwellTime, 0.2);
+    TEST_ASSERT_EQ(monostatic.arpPos, arpPos);
+    TEST_ASSERT_EQ(monostatic.arpVel, arpVel);
+    TEST_ASSERT_ALMOST_EQ(monostatic.slantRange, (arpPos - srp).norm());
+
+    // Same conventions as SICD's SCPCOA
+    const scene::SceneGeometry scene(arpVel, arpPos, srp);
+    TEST_ASSERT_EQ(monostatic.sideOfTrack,
+                   six::SideOfTrackType(scene.getSideOfTrack()));
+    TEST_ASSERT_ALMOST_EQ(monostatic.grazeAngle, scene.getETPGrazingAngle());
+    TEST_ASSERT_ALMOST_EQ(monostatic.incidenceAngle,
+                          90.0 - scene.getETPGrazingAngle());
+    TEST_ASSERT_ALMOST_EQ(monostatic.slopeAngle, scene.getETPSlopeAngle());
+    TEST_ASSERT_ALMOST_EQ(monostatic.azimuthAngle, scene.getAzimuthAngle());
+    TEST_ASSERT_ALMOST_EQ(monostatic.dopplerConeAngle,
+                          scene.getDopplerConeAngle());
+    TEST_ASSERT_ALMOST_EQ(monostatic.groundRange,
+                          srp.norm() * arpPos.angle(srp));
+    const cphd::Vector3 uGPY = math::linear::cross(
+            scene.getGroundPlaneNormal(), -scene.getGroundRange().unit());
+    TEST_ASSERT_ALMOST_EQ(monostatic.twistAngle,
+                          -std::asin(uGPY.dot(scene.getSlantPlaneZ())) *
+                          DEGREES);
+
+    // Points above the ground lay over toward the radar
+    const double layoverOffset = std::abs(std::remainder(
+            monostatic.layoverAngle - monostatic.azimuthAngle, 360.0));
+    TEST_ASSERT_LESSER(layoverOffset, 90.0);
+}
+
+TEST_CASE(testBistatic)
+{
+    cphd::PVPBlock* pvps;
+    const cphd::Metadata metadata =
+            makeMetadata(six::CollectType::BISTATIC, pvps);
+    const std::auto_ptr<cphd::PVPBlock> pvpBlock(pvps);
+    const cphd::ReferenceGeometryCalculator calculator(metadata, *pvpBlock);
+
+    const cphd::ReferenceGeometry geometry =
+            calculator.computeReferenceGeometry(0, 7);
+    TEST_ASSERT_TRUE(geometry.bistatic.get() != nullptr);
+    TEST_ASSERT_TRUE(geometry.monostatic.get() == nullptr);
+    const cphd::Bistatic& bistatic = *geometry.bistatic;
+
+    const cphd::Vector3 srp = srpPosition();
+    const cphd::Vector3 uTx = (pvpBlock->getTxPos(0, 7) - srp).unit();
+    const cphd::Vector3 uRcv = (pvpBlock->getRcvPos(0, 7) - srp).unit();
+    TEST_ASSERT_ALMOST_EQ(bistatic.bistaticAngle,
+                          std::acos(uTx.dot(uRcv)) * DEGREES);
+    TEST_ASSERT_EQ(bistatic.txPlatform.pos, pvpBlock->getTxPos(0, 7));
+    TEST_ASSERT_EQ(bistatic.rcvPlatform.vel, pvpBlock->getRcvVel(0, 7));
+    TEST_ASSERT_ALMOST_EQ(bistatic.rcvPlatform.slantRange,
+                          (pvpBlock->getRcvPos(0, 7) - srp).norm());
+    TEST_ASSERT_ALMOST_EQ(bistatic.txPlatform.incidenceAngle +
+                          bistatic.txPlatform.grazeAngle, 90.0);
+
+    // The rates match the change over a vector
+    const cphd::ReferenceGeometry next =
+            calculator.computeReferenceGeometry(0, 8);
+    TEST_ASSERT_ALMOST_EQ_EPS(
+            (next.bistatic->bistaticAngle - bistatic.bistaticAngle) / DT,
+            bistatic.bistaticAngleRate, 1e-3);
+    TEST_ASSERT_ALMOST_EQ_EPS(
+            (next.bistatic->azimuthAngle - bistatic.azimuthAngle) / DT,
+            bistatic.azimuthAngleRate, 1e-3);
+
+    // Each platform on its own is a monostatic geometry
+    const scene::SceneGeometry txScene(pvpBlock->getTxVel(0, 7),
+                                       pvpBlock->getTxPos(0, 7), srp);
+    TEST_ASSERT_EQ(bistatic.txPlatform.sideOfTrack,
+                   six::SideOfTrackType(txScene.getSideOfTrack()));
+    TEST_ASSERT_ALMOST_EQ(bistatic.txPlatform.azimuthAngle,
+                          txScene.getAzimuthAngle());
+    TEST_ASSERT_ALMOST_EQ(bistatic.txPlatform.dopplerConeAngle,
+                          txScene.getDopplerConeAngle());
+}
+
+TEST_CASE(testVectorGeometry)
+{
+    for (size_t type = 0; type < 2; ++type)
+    {
+        cphd::PVPBlock* pvps;
+        const cphd::Metadata metadata = makeMetadata(
+                type == 0 ? six::CollectType::MONOSTATIC :
+                            six::CollectType::BISTATIC, pvps);
+        const std::auto_ptr<cphd::PVPBlock> pvpBlock(pvps);
+
+        // Move the SRP partway through
+        for (size_t ii = NUM_VECTORS / 2; ii < NUM_VECTORS; ++ii)
+        {
+            pvpBlock->setSRPPos(srpPosition() + vector3(0, 50.0, 20.0), 0, ii);
+        }
+
+        const cphd::ReferenceGeometryCalculator calculator(metadata,
+                                                           *pvpBlock, 3);
+        cphd::ReferenceGeometryCalculator::VectorGeometry geometry;
+        calculator.computeVectorGeometry(0, geometry);
+        TEST_ASSERT_EQ(geometry.size(), NUM_VECTORS);
+
+        for (size_t ii = 0; ii < NUM_VECTORS; ++ii)
+        {
+            const cphd::ReferenceGeometry expected =
+                    calculator.computeReferenceGeometry(0, ii);
+            const cphd::ImagingType& angles = expected.monostatic.get() ?
+                    static_cast<const cphd::ImagingType&>(
+                            *expected.monostatic) :
+                    static_cast<const cphd::ImagingType&>(
+                            *expected.bistatic);
+            TEST_ASSERT_EQ(geometry.referenceTime[ii],
+                           expected.referenceTime);
+            TEST_ASSERT_EQ(geometry.azimuthAngle[ii], angles.azimuthAngle);
+            TEST_ASSERT_EQ(geometry.grazeAngle[ii], angles.grazeAngle);
+            TEST_ASSERT_EQ(geometry.twistAngle[ii], angles.twistAngle);
+            TEST_ASSERT_EQ(geometry.slopeAngle[ii], angles.slopeAngle);
+            TEST_ASSERT_EQ(geometry.layoverAngle[ii], angles.layoverAngle);
+            if (expected.monostatic.get())
+            {
+                TEST_ASSERT_EQ(geometry.slantRange[ii],
+                               expected.monostatic->slantRange);
+                TEST_ASSERT_EQ(geometry.sideOfTrack[ii],
+                               expected.monostatic->sideOfTrack.value);
+                TEST_ASSERT_EQ(geometry.bistaticAngle[ii], 0.0);
+            }
+            else
+            {
+                TEST_ASSERT_EQ(geometry.bistaticAngle[ii],
+                               expected.bistatic->bistaticAngle);
+            }
+        }
+    }
+}
+
+TEST_CASE(testValidate)
+{
+    cphd::PVPBlock* pvps;
+    cphd::Metadata metadata =
+            makeMetadata(six::CollectType::MONOSTATIC, pvps);
+    const std::auto_ptr<cphd::PVPBlock> pvpBlock(pvps);
+    logging::NullLogger log;
+
+    const cphd::ReferenceGeometryCalculator calculator(metadata, *pvpBlock);
+    cphd::ReferenceGeometry geometry = calculator.computeReferenceGeometry();
+    TEST_ASSERT_TRUE(calculator.validate(geometry, log));
+
+    geometry.monostatic->grazeAngle += 0.1;
+    TEST_ASSERT_FALSE(calculator.validate(geometry, log));
+    geometry.monostatic->grazeAngle -= 0.1;
+
+    // Each kind of parameter has its own tolerance
+    geometry.referenceTime += 1e-3;
+    TEST_ASSERT_FALSE(calculator.validate(geometry, log));
+    cphd::ReferenceGeometryCalculator::Tolerances tolerances;
+    tolerances.time = 1e-2;
+    TEST_ASSERT_TRUE(calculator.validate(geometry, log, tolerances));
+    geometry.referenceTime -= 1e-3;
+
+    geometry.monostatic->slantRange += 0.05;
+    TEST_ASSERT_TRUE(calculator.validate(geometry, log));
+    geometry.monostatic->slantRange += 1.0;
+    TEST_ASSERT_FALSE(calculator.validate(geometry, log));
+    geometry.monostatic->slantRange -= 1.05;
+
+    geometry.srpCODTime += 1.0;
+    TEST_ASSERT_FALSE(calculator.validate(geometry, log));
+
+    geometry.monostatic.reset();
+    TEST_ASSERT_FALSE(calculator.validate(geometry, log));
+
+    metadata.channel.refChId = "None";
+    const cphd::ReferenceGeometryCalculator noReference(metadata, *pvpBlock);
+    TEST_EXCEPTION(noReference.computeReferenceGeometry());
+}
+}
+
+int main(int /*argc*/, char** /*argv*/)
+{
+    try
+    {
+        TEST_CHECK(testMonostatic);
+        TEST_CHECK(testBistatic);
+        TEST_CHECK(testVectorGeometry);
+        TEST_CHECK(testValidate);
+        return 0;
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << ex.toString() << std::endl;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+    }
+    catch (...)
+    {
+        std::cerr << "Unknown exception\n";
+    }
+    return 1;
+}
@@ -28,7 +28,9 @@
 #include <memory>
 #include <sys/Conf.h>
 #include <types/RowCol.h>
+#include <io/FileInputStream.h>
 #include <io/TempFile.h>
+#include <mt/ThreadGroup.h>
 #include <cphd/CPHDWriter.h>
 #include <cphd/CPHDReader.h>
 #include <cphd/Wideband.h>
@@ -210,6 +212,119 @@ TEST_CASE(testUnscaledFloat)
     TEST_ASSERT_TRUE(runTest(scale, writeData))
 }
 
+class ChannelRunnable : public sys::Runnable
+{
+public:
+    ChannelRunnable(cphd::CPHDWriter& writer,
+                    const cphd::PVPBlock& pvpBlock,
+                    const std::complex<sys::Int16_T>* data,
+                    size_t channel,
+                    size_t firstVector,
+                    size_t numVectors,
+                    size_t numSamples) :
+        mWriter(writer),
+        mPVPBlock(pvpBlock),
+        mData(data),
+        mChannel(channel),
+        mFirstVector(firstVector),
+        mNumVectors(numVectors),
+        mNumSamples(numSamples)
+    {
+    }
+
+    virtual void run()
+    {
+        mWriter.writeChannel(mData + mFirstVector * mNumSamples,
+                             mChannel, mFirstVector, mNumVectors);
+        if (mFirstVector == 0)
+        {
+            mWriter.writeChannelPVP(mPVPBlock, mChannel);
+        }
+    }
+
+private:
+    cphd::CPHDWriter& mWriter;
+    const cphd::PVPBlock& mPVPBlock;
+    const std::complex<sys::Int16_T>* const mData;
+    const size_t mChannel;
+    const size_t mFirstVector;
+    const size_t mNumVectors;
+    const size_t mNumSamples;
+};
+
+std::string readFile(const std::string& pathname)
+{
+    io::FileInputStream stream(pathname);
+    std::string contents(static_cast<size_t>(stream.available()), '\0');
+    stream.read(&contents[0], contents.size());
+    return contents;
+}
+
+TEST_CASE(testChannelWrites)
+{
+    const types::RowCol<size_t> dims(64, 40);
+    const size_t numChannels = 3;
+    const std::vector<std::complex<sys::Int16_T> > writeData =
+            generateData<sys::Int16_T>(dims.area() * numChannels);
+    cphd::Metadata meta = cphd::Metadata();
+    setUpData(meta, dims, writeData);
+    for (size_t ii = 1; ii < numChannels; ++ii)
+    {
+        meta.data.channels.push_back(cphd::Data::Channel(dims.row, dims.col));
+    }
+    cphd::setPVPXML(meta.pvp);
+    cphd::PVPBlock pvpBlock(meta.pvp, meta.data);
+    for (size_t ii = 0; ii < numChannels; ++ii)
+    {
+        for (size_t jj = 0; jj < dims.row; ++jj)
+        {
+            cphd::setVectorParameters(ii, jj, pvpBlock);
+        }
+    }
+
+    io::TempFile sequential;
+    {
+        cphd::CPHDWriter writer(meta, sequential.pathname());
+        writer.write(pvpBlock, writeData.data());
+    }
+
+    // Write each channel in two halves, last channel first, from separate
+    // threads
+    io::TempFile parallel;
+    {
+        cphd::CPHDWriter writer(meta, parallel.pathname(),
+                                std::vector<std::string>(), 1, 1024);
+        writer.startChannelWrites();
+        TEST_EXCEPTION(writer.finishChannelWrites());
+
+        mt::ThreadGroup threads;
+        const size_t half = dims.row / 2;
+        for (size_t ii = numChannels; ii > 0; --ii)
+        {
+            const std::complex<sys::Int16_T>* const channelData =
+                    &writeData[(ii - 1) * dims.area()];
+            threads.createThread(new ChannelRunnable(
+                    writer, pvpBlock, channelData, ii - 1, half,
+                    dims.row - half, dims.col));
+            threads.createThread(new ChannelRunnable(
+                    writer, pvpBlock, channelData, ii - 1, 0, half,
+                    dims.col));
+        }
+        threads.joinAll();
+
+        for (size_t ii = 0; ii < numChannels; ++ii)
+        {
+            TEST_ASSERT_TRUE(writer.isChannelComplete(ii));
+        }
+        TEST_EXCEPTION(writer.writeChannel(writeData.data(), 0, 1,
+                                           dims.row));
+        writer.finishChannelWrites();
+    }
+
+    TEST_ASSERT_TRUE(readFile(parallel.pathname()) ==
+                     readFile(sequential.pathname()));
+}
+
 TEST_CASE(testScaledFloat)
 {
     const types::RowCol<size_t> dims(128, 128);
@@ -230,6 +345,7 @@ int main(int argc, char** argv)
         TEST_CHECK(testScaledInt16);
         TEST_CHECK(testUnscaledFloat);
         TEST_CHECK(testScaledFloat);
+        TEST_CHECK(testChannelWrites);
         return 0;
     }
     catch (const std::exception& ex)
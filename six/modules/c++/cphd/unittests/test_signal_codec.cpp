@@ -0,0 +1,266 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <stdlib.h>
+#include <complex>
+#include <string>
+#include <vector>
+
+#include <cphd/ByteSwap.h>
+#include <cphd/CPHDReader.h>
+#include <cphd/CPHDWriter.h>
+#include <cphd/Metadata.h>
+#include <cphd/PVPBlock.h>
+#include <cphd/SignalCodec.h>
+#include <cphd/TestDataGenerator.h>
+#include <cphd/Wideband.h>
+#include <io/TempFile.h>
+#include <sys/Conf.h>
+#include <types/RowCol.h>
+#include "TestCase.h"
+
+namespace
+{
+// Smooth enough to compress, with some noise in the low bytes
+std::vector<std::complex<sys::Int16_T> > generateData(size_t length)
+{
+    std::vector<std::complex<sys::Int16_T> > data(length);
+    srand(0);
+    for (size_t ii = 0; ii < data.size(); ++ii)
+    {
+        data[ii] = std::complex<sys::Int16_T>(
+                static_cast<sys::Int16_T>((ii % 64) * 8 + rand() % 4),
+                static_cast<sys::Int16_T>(-static_cast<int>(ii % 32) +
+                                          rand() % 4));
+    }
+    return data;
+}
+
+bool roundTrips(const cphd::SignalCodec& codec,
+                const std::vector<sys::ubyte>& input,
+                size_t elementSize)
+{
+    const size_t numElements = input.size() / elementSize;
+    std::vector<sys::ubyte> compressed;
+    codec.compress(input.data(), numElements, elementSize, compressed);
+
+    std::vector<sys::ubyte> output(input.size());
+    codec.decompress(compressed.data(), compressed.size(), numElements,
+                     elementSize, output.data());
+    return output == input;
+}
+
+TEST_CASE(testCodecRoundTrip)
+{
+    std::vector<sys::ubyte> repetitive(8000);
+    std::vector<sys::ubyte> random(8000);
+    srand(1);
+    for (size_t ii = 0; ii < repetitive.size(); ++ii)
+    {
+        repetitive[ii] = static_cast<sys::ubyte>(ii % 24);
+        random[ii] = static_cast<sys::ubyte>(rand());
+    }
+
+    for (size_t shuffle = 0; shuffle < 2; ++shuffle)
+    {
+        const cphd::LZCodec codec(shuffle != 0);
+        TEST_ASSERT_TRUE(roundTrips(codec, repetitive, 8));
+        TEST_ASSERT_TRUE(roundTrips(codec, random, 4));
+        TEST_ASSERT_TRUE(roundTrips(codec, std::vector<sys::ubyte>(2), 2));
+        TEST_ASSERT_TRUE(roundTrips(codec, std::vector<sys::ubyte>(), 2));
+
+        // Repetitive data should shrink, random data shouldn't grow by more
+        // than the method byte
+        std::vector<sys::ubyte> compressed;
+        codec.compress(repetitive.data(), 1000, 8, compressed);
+        TEST_ASSERT_LESSER(compressed.size(), repetitive.size() / 10);
+        compressed.clear();
+        codec.compress(random.data(), 2000, 4, compressed);
+        TEST_ASSERT_EQ(compressed.size(), random.size() + 1);
+    }
+}
+
+TEST_CASE(testCorruptBlockThrows)
+{
+    const cphd::LZCodec codec(false);
+    std::vector<sys::ubyte> input(4096, 7);
+    std::vector<sys::ubyte> compressed;
+    codec.compress(input.data(), 2048, 2, compressed);
+
+    std::vector<sys::ubyte> output(input.size());
+    TEST_EXCEPTION(codec.decompress(compressed.data(), compressed.size() - 1,
+                                    2048, 2, output.data()));
+    TEST_EXCEPTION(codec.decompress(compressed.data(), compressed.size(),
+                                    2049, 2, output.data()));
+    compressed[0] = 42;
+    TEST_EXCEPTION(codec.decompress(compressed.data(), compressed.size(),
+                                    2048, 2, output.data()));
+}
+
+TEST_CASE(testRegistry)
+{
+    cphd::SignalCodecRegistry& registry =
+            cphd::SignalCodecFactory::getInstance();
+    TEST_ASSERT(registry.getCodec("SIX_LZ").get() != nullptr);
+    TEST_ASSERT(registry.getCodec("SIX_SHUFFLE_LZ").get() != nullptr);
+    TEST_ASSERT(registry.getCodec("Huffman").get() == nullptr);
+
+    registry.addCodec("TEST_LZ",
+                      std::unique_ptr<cphd::SignalCodec>(
+                              new cphd::LZCodec(true)));
+    TEST_ASSERT(registry.getCodec("TEST_LZ").get() != nullptr);
+}
+
+TEST_CASE(testSignalArrayBlocks)
+{
+    const types::RowCol<size_t> dims(37, 50);
+    const std::vector<std::complex<sys::Int16_T> > data =
+            generateData(dims.area());
+    const sys::ubyte* const input =
+            reinterpret_cast<const sys::ubyte*>(data.data());
+    const cphd::LZCodec codec(true);
+
+    std::vector<sys::ubyte> compressed;
+    cphd::compressSignalArray(codec, input, dims.row, dims.col, 4, false, 3,
+                              compressed, 5);
+
+    cphd::SignalBlockIndex index;
+    index.readHeader(compressed.data());
+    TEST_ASSERT_EQ(index.numVectors, dims.row);
+    TEST_ASSERT_EQ(index.vectorsPerBlock, 5);
+    TEST_ASSERT_EQ(index.getNumBlocks(), 8);
+    TEST_ASSERT_EQ(index.getNumVectors(7), 2);
+    index.readOffsets(compressed.data() + cphd::SignalBlockIndex::HEADER_SIZE);
+    TEST_ASSERT_EQ(index.blockOffsets.back(), compressed.size());
+
+    // Decompress an AOI that straddles several blocks
+    const size_t firstVector = 8;
+    const size_t lastVector = 26;
+    const size_t firstSample = 3;
+    const size_t lastSample = 44;
+    const size_t firstBlock = index.getBlock(firstVector);
+    std::vector<std::complex<sys::Int16_T> > aoi(
+            (lastVector - firstVector + 1) * (lastSample - firstSample + 1));
+    cphd::decompressSignalBlocks(
+            codec, index,
+            compressed.data() + index.blockOffsets[firstBlock],
+            dims.col, 4, firstVector, lastVector, firstSample, lastSample, 2,
+            reinterpret_cast<sys::ubyte*>(aoi.data()));
+
+    for (size_t vector = firstVector, idx = 0; vector <= lastVector; ++vector)
+    {
+        for (size_t sample = firstSample; sample <= lastSample;
+             ++sample, ++idx)
+        {
+            TEST_ASSERT_EQ(aoi[idx], data[vector * dims.col + sample]);
+        }
+    }
+
+    TEST_EXCEPTION(cphd::decompressSignalBlocks(
+            codec, index, compressed.data(), dims.col, 4, 0, dims.row, 0, 0,
+            1, reinterpret_cast<sys::ubyte*>(aoi.data())));
+}
+
+TEST_CASE(testWriteAndReadAOI)
+{
+    const types::RowCol<size_t> dims(64, 96);
+    const size_t numChannels = 2;
+    std::vector<std::complex<sys::Int16_T> > data =
+            generateData(dims.area() * numChannels);
+
+    cphd::Metadata metadata;
+    cphd::setUpData(metadata, dims, data);
+    metadata.data.channels.push_back(cphd::Data::Channel(dims.row, dims.col));
+    metadata.data.signalCompressionID = "SIX_SHUFFLE_LZ";
+    cphd::setPVPXML(metadata.pvp);
+    cphd::PVPBlock pvpBlock(metadata.pvp, metadata.data);
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        for (size_t vector = 0; vector < dims.row; ++vector)
+        {
+            cphd::setVectorParameters(channel, vector, pvpBlock);
+        }
+    }
+
+    const size_t unsetSize = metadata.data.channels[0].compressedSignalSize;
+    io::TempFile tempfile;
+    {
+        cphd::CPHDWriter writer(metadata, tempfile.pathname(),
+                                std::vector<std::string>(), 2);
+        writer.write(pvpBlock, data.data());
+    }
+
+    // The sizes only go in the file
+    TEST_ASSERT_EQ(metadata.data.channels[0].compressedSignalSize,
+                   unsetSize);
+
+    const cphd::CPHDReader reader(tempfile.pathname(), 2);
+    const cphd::Data& readData = reader.getMetadata().data;
+    TEST_ASSERT_EQ(readData.getCompressionID(), "SIX_SHUFFLE_LZ");
+    TEST_ASSERT_LESSER(readData.getCompressedSignalSize(0),
+                       dims.area() * 4);
+
+    const cphd::Wideband& wideband = reader.getWideband();
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        const std::complex<sys::Int16_T>* const expected =
+                &data[channel * dims.area()];
+
+        mem::ScopedArray<sys::ubyte> buffer;
+        wideband.read(channel, 10, 40, 5, 70, 2, buffer);
+        const std::complex<sys::Int16_T>* const aoi =
+                reinterpret_cast<const std::complex<sys::Int16_T>*>(
+                        buffer.get());
+        for (size_t vector = 10, idx = 0; vector <= 40; ++vector)
+        {
+            for (size_t sample = 5; sample <= 70; ++sample, ++idx)
+            {
+                TEST_ASSERT_EQ(aoi[idx], expected[vector * dims.col + sample]);
+            }
+        }
+
+        // Promoting reads go through the same path
+        std::vector<std::complex<float> > promoted(dims.area());
+        std::vector<sys::ubyte> scratch(dims.area() * 4);
+        wideband.read(channel, 0, cphd::Wideband::ALL, 0, cphd::Wideband::ALL,
+                      std::vector<double>(dims.row, 1.0), 2,
+                      mem::BufferView<sys::ubyte>(scratch.data(),
+                                                  scratch.size()),
+                      mem::BufferView<std::complex<float> >(promoted.data(),
+                                                            promoted.size()));
+        for (size_t ii = 0; ii < promoted.size(); ++ii)
+        {
+            TEST_ASSERT_EQ(promoted[ii].real(), expected[ii].real());
+            TEST_ASSERT_EQ(promoted[ii].imag(), expected[ii].imag());
+        }
+    }
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testCodecRoundTrip);
+    TEST_CHECK(testCorruptBlockThrows);
+    TEST_CHECK(testRegistry);
+    TEST_CHECK(testSignalArrayBlocks);
+    TEST_CHECK(testWriteAndReadAOI);
+    return 0;
+}
@@ -0,0 +1,278 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdlib.h>
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <io/ByteStream.h>
+#include <sys/Conf.h>
+#include <cphd/ByteSwap.h>
+#include <cphd/Metadata.h>
+#include <cphd/PVPBlock.h>
+#include <cphd/SignalStatistics.h>
+#include <cphd/TestDataGenerator.h>
+#include <cphd/Wideband.h>
+#include <TestCase.h>
+
+namespace
+{
+constexpr size_t NUM_VECTORS = 21;
+constexpr size_t NUM_SAMPLES = 13;
+
+cphd::Metadata makeMetadata(cphd::SignalArrayFormat format)
+{
+    cphd::Metadata metadata;
+    metadata.data.channels.push_back(
+            cphd::Data::Channel(NUM_VECTORS, NUM_SAMPLES));
+    metadata.data.signalArrayFormat = format;
+    cphd::setPVPXML(metadata.pvp);
+    metadata.pvp.append(metadata.pvp.ampSF);
+    metadata.pvp.append(metadata.pvp.signal);
+    metadata.data.numBytesPVP = metadata.pvp.sizeInBytes();
+    return metadata;
+}
+
+// Random components with a few at the limits of the type
+template <typename T>
+std::vector<std::complex<T> > makeSamples(T low, T high)
+{
+    std::vector<std::complex<T> > samples(NUM_VECTORS * NUM_SAMPLES);
+    srand(0);
+    for (size_t ii = 0; ii < samples.size(); ++ii)
+    {
+        samples[ii] = std::complex<T>(static_cast<T>(rand() % 200 - 100),
+                                      static_cast<T>(rand() % 200 - 100));
+    }
+    samples[3] = std::complex<T>(high, 0);
+    samples[40] = std::complex<T>(5, low);
+    samples[41] = std::complex<T>(low, high);
+    samples[NUM_VECTORS * NUM_SAMPLES - 1] = std::complex<T>(0, 0);
+    return samples;
+}
+
+template <typename T>
+std::auto_ptr<cphd::Wideband> makeWideband(
+        const cphd::Metadata& metadata,
+        const std::vector<std::complex<T> >& samples)
+{
+    // Stored big endian
+    std::vector<std::complex<T> > stored(samples);
+    cphd::byteSwap(&stored[0], sizeof(T), stored.size() * 2, 1);
+    std::shared_ptr<io::ByteStream> input(new io::ByteStream());
+    input->write(reinterpret_cast<const sys::byte*>(&stored[0]),
+                 stored.size() * sizeof(stored[0]));
+    input->seek(0, io::Seekable::START);
+    return std::auto_ptr<cphd::Wideband>(new cphd::Wideband(
+            input, metadata, 0, stored.size() * sizeof(stored[0])));
+}
+
+// The statistics computed the slow way
+template <typename T>
+void checkStatistics(const std::string& testName,
+                     const cphd::ChannelStatistics& statistics,
+                     const std::vector<std::complex<T> >& samples,
+                     const std::vector<double>& scales,
+                     T low,
+                     T high)
+{
+    TEST_ASSERT_EQ(statistics.numVectors, NUM_VECTORS);
+    TEST_ASSERT_EQ(statistics.numSamples, NUM_SAMPLES);
+    const size_t numRows = (NUM_VECTORS + statistics.vectorDecimation - 1) /
+            statistics.vectorDecimation;
+    const size_t numCols = (NUM_SAMPLES + statistics.sampleDecimation - 1) /
+            statistics.sampleDecimation;
+    TEST_ASSERT_EQ(statistics.numRows, numRows);
+    TEST_ASSERT_EQ(statistics.numCols, numCols);
+
+    std::vector<double> sums(numRows * numCols, 0.0);
+    std::vector<size_t> counts(sums.size(), 0);
+    std::vector<size_t> histogram(statistics.histogram.size(), 0);
+    size_t numSaturated = 0;
+    for (size_t ii = 0; ii < NUM_VECTORS; ++ii)
+    {
+        double peak = 0.0;
+        double sum = 0.0;
+        size_t saturated = 0;
+        for (size_t jj = 0; jj < NUM_SAMPLES; ++jj)
+        {
+            const std::complex<T> sample = samples[ii * NUM_SAMPLES + jj];
+            const double real = sample.real();
+            const double imag = sample.imag();
+            const double power = scales[ii] * (real * real + imag * imag);
+            peak = std::max(peak, power);
+            sum += power;
+            if (std::numeric_limits<T>::is_integer &&
+                (sample.real() == low || sample.real() == high ||
+                 sample.imag() == low || sample.imag() == high))
+            {
+                ++saturated;
+            }
+
+            const size_t cell =
+                    (ii / statistics.vectorDecimation) * numCols +
+                    jj / statistics.sampleDecimation;
+            sums[cell] += power;
+            ++counts[cell];
+
+            double bin = power > 0 ?
+                    std::floor((10 * std::log10(power) - statistics.minDB) /
+                               statistics.binWidthDB) : 0;
+            bin = std::max(0.0, std::min(bin, histogram.size() - 1.0));
+            ++histogram[static_cast<size_t>(bin)];
+        }
+        TEST_ASSERT_ALMOST_EQ_EPS(statistics.peakPower[ii], peak,
+                                  1e-4 * peak);
+        TEST_ASSERT_ALMOST_EQ_EPS(statistics.meanPower[ii],
+                                  sum / NUM_SAMPLES, 1e-4 * sum);
+        TEST_ASSERT_EQ(statistics.saturated[ii], saturated);
+        numSaturated += saturated;
+    }
+    TEST_ASSERT_EQ(statistics.numSaturated, numSaturated);
+
+    TEST_ASSERT_EQ(statistics.power.size(), sums.size());
+    for (size_t ii = 0; ii < sums.size(); ++ii)
+    {
+        const double expected = sums[ii] / counts[ii];
+        TEST_ASSERT_ALMOST_EQ_EPS(statistics.power[ii], expected,
+                                  1e-4 * expected);
+    }
+    for (size_t ii = 0; ii < histogram.size(); ++ii)
+    {
+        TEST_ASSERT_EQ(statistics.histogram[ii], histogram[ii]);
+    }
+}
+
+TEST_CASE(testCI2)
+{
+    const cphd::Metadata metadata =
+            makeMetadata(cphd::SignalArrayFormat::CI2);
+    const sys::Int8_T low = -128;
+    const sys::Int8_T high = 127;
+    const std::vector<std::complex<sys::Int8_T> > samples =
+            makeSamples(low, high);
+    const std::auto_ptr<cphd::Wideband> wideband =
+            makeWideband(metadata, samples);
+
+    // Uneven edges, and blocks that get rounded up to whole rows
+    cphd::SignalStatistics signalStatistics(*wideband, metadata.data, 3);
+    signalStatistics.setDecimation(4, 5);
+    signalStatistics.setHistogram(10.0, 50.0, 16);
+    signalStatistics.setVectorsPerBlock(6);
+    cphd::ChannelStatistics statistics;
+    signalStatistics.compute(0, nullptr, statistics);
+
+    TEST_ASSERT_EQ(statistics.numRows, 6);
+    TEST_ASSERT_EQ(statistics.numCols, 3);
+    TEST_ASSERT_EQ(statistics.numSaturated, 3);
+    TEST_ASSERT_TRUE(statistics.dropouts.empty());
+    checkStatistics(testName, statistics, samples,
+                    std::vector<double>(NUM_VECTORS, 1.0), low, high);
+}
+
+TEST_CASE(testCI4WithPVPs)
+{
+    const cphd::Metadata metadata =
+            makeMetadata(cphd::SignalArrayFormat::CI4);
+    const sys::Int16_T low = -32768;
+    const sys::Int16_T high = 32767;
+    const std::vector<std::complex<sys::Int16_T> > samples =
+            makeSamples(low, high);
+    const std::auto_ptr<cphd::Wideband> wideband =
+            makeWideband(metadata, samples);
+
+    cphd::PVPBlock pvpBlock(metadata.pvp, metadata.data);
+    std::vector<double> scales(NUM_VECTORS);
+    for (size_t ii = 0; ii < NUM_VECTORS; ++ii)
+    {
+        const double ampSF = 0.5 + 0.1 * ii;
+        pvpBlock.setAmpSF(ampSF, 0, ii);
+        pvpBlock.setSignal(ii == 4 || ii == 17 ? 0 : 1, 0, ii);
+        scales[ii] = ampSF * ampSF;
+    }
+
+    cphd::SignalStatistics signalStatistics(*wideband, metadata.data, 2);
+    signalStatistics.setHistogram(0.0, 100.0, 50);
+    cphd::ChannelStatistics statistics;
+    signalStatistics.compute(0, &pvpBlock, statistics);
+
+    TEST_ASSERT_EQ(statistics.numSaturated, 3);
+    TEST_ASSERT_EQ(statistics.dropouts.size(), 2);
+    TEST_ASSERT_EQ(statistics.dropouts[0], 4);
+    TEST_ASSERT_EQ(statistics.dropouts[1], 17);
+    checkStatistics(testName, statistics, samples, scales, low, high);
+}
+
+TEST_CASE(testCF8)
+{
+    const cphd::Metadata metadata =
+            makeMetadata(cphd::SignalArrayFormat::CF8);
+    const std::vector<std::complex<float> > samples =
+            makeSamples(-1.0e6f, 1.0e6f);
+    const std::auto_ptr<cphd::Wideband> wideband =
+            makeWideband(metadata, samples);
+
+    cphd::SignalStatistics signalStatistics(*wideband, metadata.data);
+    signalStatistics.setDecimation(NUM_VECTORS, 1);
+    cphd::ChannelStatistics statistics;
+    signalStatistics.compute(0, nullptr, statistics);
+
+    TEST_ASSERT_EQ(statistics.numRows, 1);
+    TEST_ASSERT_EQ(statistics.numCols, NUM_SAMPLES);
+    TEST_ASSERT_EQ(statistics.numSaturated, 0);
+    checkStatistics(testName, statistics, samples,
+                    std::vector<double>(NUM_VECTORS, 1.0), -1.0e6f, 1.0e6f);
+
+    TEST_EXCEPTION(signalStatistics.setHistogram(10.0, 10.0, 5));
+    TEST_EXCEPTION(signalStatistics.setHistogram(0.0, 10.0, 0));
+}
+}
+
+int main(int /*argc*/, char** /*argv*/)
+{
+    try
+    {
+        TEST_CHECK(testCI2);
+        TEST_CHECK(testCI4WithPVPs);
+        TEST_CHECK(testCF8);
+        return 0;
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << ex.toString() << std::endl;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+    }
+    catch (...)
+    {
+        std::cerr << "Unknown exception\n";
+    }
+    return 1;
+}
@@ -0,0 +1,253 @@
+/* =========================================================================
+ * This file is part of cphd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * cphd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string.h>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <sys/Conf.h>
+#include <types/RowCol.h>
+#include <io/TempFile.h>
+#include <cphd/CPHDReader.h>
+#include <cphd/CPHDWriter.h>
+#include <cphd/Metadata.h>
+#include <cphd/PVPBlock.h>
+#include <cphd/SupportBlock.h>
+#include <cphd/TestDataGenerator.h>
+#include <cphd/TypedSupportArray.h>
+#include <TestCase.h>
+
+namespace
+{
+constexpr size_t NUM_ROWS = 3;
+constexpr size_t NUM_COLS = 4;
+
+// Append a float to a buffer in big endian
+void appendFloat(float value, std::vector<sys::ubyte>& buffer)
+{
+    sys::ubyte bytes[sizeof(float)];
+    memcpy(bytes, &value, sizeof(float));
+    for (size_t ii = 0; ii < sizeof(float); ++ii)
+    {
+        buffer.push_back(bytes[sys::isBigEndianSystem() ?
+                ii : sizeof(float) - 1 - ii]);
+    }
+}
+
+// Gain is 10 * row + col, Phase is -row
+cphd::TypedSupportArray makeGainPhase(size_t numThreads)
+{
+    std::vector<sys::ubyte> data;
+    for (size_t row = 0; row < NUM_ROWS; ++row)
+    {
+        for (size_t col = 0; col < NUM_COLS; ++col)
+        {
+            appendFloat(static_cast<float>(10 * row + col), data);
+            appendFloat(-static_cast<float>(row), data);
+        }
+    }
+    const cphd::SupportArrayParameter parameter(
+            "Gain=F4;Phase=F4;", 2, -1.0, 2.0, 0.5, 0.25);
+    return cphd::TypedSupportArray(parameter, NUM_ROWS, NUM_COLS,
+                                   &data[0], numThreads);
+}
+
+TEST_CASE(testDecode)
+{
+    const cphd::TypedSupportArray array = makeGainPhase(1);
+    TEST_ASSERT_EQ(array.getComponentNames().size(), 2);
+    TEST_ASSERT_EQ(array.getComponentNames()[0], "Gain");
+    TEST_ASSERT_EQ(array.getComponentNames()[1], "Phase");
+    TEST_ASSERT_EQ(array.getComponentIndex("Phase"), 1);
+    TEST_EXCEPTION(array.getComponentIndex("IAZ"));
+
+    for (size_t row = 0; row < NUM_ROWS; ++row)
+    {
+        for (size_t col = 0; col < NUM_COLS; ++col)
+        {
+            TEST_ASSERT_EQ(array.getValue(0, row, col),
+                           static_cast<double>(10 * row + col));
+            TEST_ASSERT_EQ(array.getValue(1, row, col),
+                           -static_cast<double>(row));
+        }
+    }
+}
+
+TEST_CASE(testInterpolate)
+{
+    const cphd::TypedSupportArray array = makeGainPhase(1);
+
+    // X = -1 + 0.5 * row, Y = 2 + 0.25 * col
+    TEST_ASSERT_ALMOST_EQ(array.interpolate(0, -1.0, 2.0), 0.0);
+    TEST_ASSERT_ALMOST_EQ(array.interpolate(0, -0.75, 2.125), 5.5);
+    TEST_ASSERT_ALMOST_EQ(array.interpolate(1, -0.75, 2.125), -0.5);
+
+    // Last row and column are on the grid
+    TEST_ASSERT_ALMOST_EQ(array.interpolate(0, 0.0, 2.75), 23.0);
+
+    // Off the grid
+    TEST_ASSERT_TRUE(std::isnan(array.interpolate(0, -1.01, 2.0)));
+    TEST_ASSERT_TRUE(std::isnan(array.interpolate(0, 0.0, 2.8)));
+}
+
+TEST_CASE(testInterpolateGrid)
+{
+    const cphd::TypedSupportArray array = makeGainPhase(3);
+
+    const size_t numX = 7;
+    const size_t numY = 9;
+    const double x0 = -1.1;
+    const double deltaX = 0.2;
+    const double y0 = 1.95;
+    const double deltaY = 0.1;
+
+    std::vector<double> x(numX * numY);
+    std::vector<double> y(numX * numY);
+    for (size_t ii = 0; ii < numX; ++ii)
+    {
+        for (size_t jj = 0; jj < numY; ++jj)
+        {
+            x[ii * numY + jj] = x0 + ii * deltaX;
+            y[ii * numY + jj] = y0 + jj * deltaY;
+        }
+    }
+
+    std::vector<double> points(x.size());
+    array.interpolate(0, &x[0], &y[0], x.size(), &points[0]);
+
+    std::vector<double> grid(x.size());
+    array.interpolateGrid(0, x0, deltaX, numX, y0, deltaY, numY, &grid[0]);
+
+    for (size_t ii = 0; ii < grid.size(); ++ii)
+    {
+        if (std::isnan(points[ii]))
+        {
+            TEST_ASSERT_TRUE(std::isnan(grid[ii]));
+        }
+        else
+        {
+            TEST_ASSERT_ALMOST_EQ(grid[ii], points[ii]);
+            TEST_ASSERT_ALMOST_EQ(points[ii],
+                                  20.0 * (x[ii] + 1.0) + 4.0 * (y[ii] - 2.0));
+        }
+    }
+}
+
+TEST_CASE(testComplexFormatThrows)
+{
+    const std::vector<sys::ubyte> data(NUM_ROWS * NUM_COLS * 8);
+    const cphd::SupportArrayParameter parameter("CF8", 1, 0.0, 0.0, 1.0, 1.0);
+    TEST_EXCEPTION(cphd::TypedSupportArray(parameter, NUM_ROWS, NUM_COLS,
+                                           &data[0]));
+}
+
+TEST_CASE(testEmptyArrayThrows)
+{
+    const std::vector<sys::ubyte> data(NUM_ROWS * 4);
+    const cphd::SupportArrayParameter parameter("F4", 1, 0.0, 0.0, 1.0, 1.0);
+    TEST_EXCEPTION(cphd::TypedSupportArray(parameter, 0, NUM_COLS,
+                                           &data[0]));
+    TEST_EXCEPTION(cphd::TypedSupportArray(parameter, NUM_ROWS, 0,
+                                           &data[0]));
+}
+
+TEST_CASE(testReadFromFile)
+{
+    std::vector<float> writeData(NUM_ROWS * NUM_COLS);
+    for (size_t ii = 0; ii < writeData.size(); ++ii)
+    {
+        writeData[ii] = static_cast<float>(ii);
+    }
+
+    cphd::Metadata metadata;
+    cphd::setUpData(metadata, types::RowCol<size_t>(128, 256),
+                    std::vector<std::complex<float> >());
+    cphd::setPVPXML(metadata.pvp);
+    metadata.data.setSupportArray("AddedSupport", NUM_ROWS, NUM_COLS,
+                                  sizeof(float), 0);
+    metadata.supportArray.reset(new cphd::SupportArray());
+    metadata.supportArray->addedSupportArray["AddedSupport"] =
+            cphd::AdditionalSupportArray("F4", "AddedSupport",
+                                         0.0, 0.0, 1.0, 1.0,
+                                         "m", "m", "dB");
+
+    cphd::PVPBlock pvpBlock(metadata.pvp, metadata.data);
+    for (size_t ii = 0; ii < metadata.data.getNumVectors(0); ++ii)
+    {
+        cphd::setVectorParameters(0, ii, pvpBlock);
+    }
+
+    io::TempFile tempfile;
+    {
+        cphd::CPHDWriter writer(metadata, tempfile.pathname());
+        writer.writeMetadata(pvpBlock);
+        writer.writeSupportData(writeData.data());
+        writer.writePVPData(pvpBlock);
+    }
+
+    cphd::CPHDReader reader(tempfile.pathname(), 1);
+    const cphd::SupportBlock& supportBlock = reader.getSupportBlock();
+    const cphd::TypedSupportArray& array = supportBlock.getTypedArray(
+            "AddedSupport",
+            reader.getMetadata().supportArray->getParameter("AddedSupport"));
+    TEST_ASSERT_EQ(array.getNumRows(), NUM_ROWS);
+    TEST_ASSERT_EQ(array.getNumCols(), NUM_COLS);
+    TEST_ASSERT_EQ(array.getValue(0, 2, 3), 11.0);
+    TEST_ASSERT_ALMOST_EQ(array.interpolate(0, 0.5, 0.5), 2.5);
+
+    // Decoded once
+    TEST_ASSERT_EQ(&supportBlock.getTypedArray(
+            "AddedSupport",
+            reader.getMetadata().supportArray->getParameter("AddedSupport")),
+                   &array);
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        TEST_CHECK(testDecode);
+        TEST_CHECK(testInterpolate);
+        TEST_CHECK(testInterpolateGrid);
+        TEST_CHECK(testComplexFormatThrows);
+        TEST_CHECK(testEmptyArrayThrows);
+        TEST_CHECK(testReadFromFile);
+        return 0;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (...)
+    {
+        std::cerr << "Unknown exception\n";
+        return 1;
+    }
+}
@@ -0,0 +1,151 @@
+/* =========================================================================
+ * This file is part of cphd03-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * cphd03-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __CPHD03_CPHD_CONVERTER_H__
+#define __CPHD03_CPHD_CONVERTER_H__
+
+#include <string>
+#include <vector>
+
+#include <cphd/CPHDWriter.h>
+#include <cphd/Metadata.h>
+#include <cphd/PVPBlock.h>
+#include <cphd03/CPHDReader.h>
+
+namespace cphd03
+{
+/*
+ *  \class CPHDConverter
+ *
+ *  \brief Converts a CPHD 0.3 file to CPHD 1.0
+ *
+ *  The metadata and VBM are read up front; the wideband is then copied
+ *  channel by channel as raw big endian bytes through a bounded buffer,
+ *  with each channel's VBM rows converted to PVP rows in blocks of the
+ *  same size.  Channels are converted in parallel, each with its own
+ *  input stream.
+ *
+ *  CPHD 0.3 doesn't carry everything CPHD 1.0 asks for, so some of it is
+ *  derived:
+ *  - TxVel and RcvVel are differenced from the positions and times of
+ *    neighboring vectors
+ *  - aFDOP is (R_dot_xmt + R_dot_rcv) / c about the SRP, aFRR1 is 2 / c,
+ *    and aFRR2 is 0, the first order values for a stationary SRP
+ *  - TDTropoSRP is TropoSRP over c, or 0 without it
+ *  - TOA1/TOA2 of FX domain data come from TOASavedNom, and FX1/FX2 of TOA
+ *    domain data from FxCtrNom and BWSavedNom
+ *  - The reference geometry is computed from the converted PVPs of the
+ *    first channel's middle vector by cphd::ReferenceGeometryCalculator
+ *  The antenna models of the two versions differ and aren't converted.
+ */
+class CPHDConverter
+{
+public:
+    /*
+     *  \func CPHDConverter
+     *  \brief Reads the metadata and VBM of a CPHD 0.3 file
+     *
+     *  \param pathname CPHD 0.3 file to convert
+     *  \param numThreads (Optional) Number of channels to convert at once.
+     *         Default is 1.
+     *  \param bufferSize (Optional) Size of each channel's copy buffer.
+     *         Default is 4 MB.  It grows to hold one vector if it has to.
+     *
+     *  \throw except::Exception If the frequencies are stored as indices
+     *  (RefFreqIndex isn't 0)
+     */
+    CPHDConverter(const std::string& pathname,
+                  size_t numThreads = 1,
+                  size_t bufferSize = 4 * 1024 * 1024);
+
+    //! Get the CPHD 0.3 metadata
+    const Metadata& getMetadata() const
+    {
+        return mReader.getMetadata();
+    }
+
+    //! Get the CPHD 1.0 metadata that write() writes
+    const cphd::Metadata& getConvertedMetadata() const
+    {
+        return mMetadata;
+    }
+
+    /*
+     *  \func write
+     *  \brief Writes the CPHD 1.0 file
+     *
+     *  \param pathname File to write
+     *  \param schemaPaths (Optional) XML schema paths for validation
+     */
+    void write(const std::string& pathname,
+               const std::vector<std::string>& schemaPaths =
+                       std::vector<std::string>()) const;
+
+    /*
+     *  \func convertChannel
+     *  \brief Converts one channel's PVPs and copies its signal array
+     *
+     *  Called from write() for each channel; thread safe.
+     *
+     *  \param channel 0-based channel
+     *  \param writer Writer that startChannelWrites() was called on
+     */
+    void convertChannel(size_t channel, cphd::CPHDWriter& writer) const;
+
+private:
+    void convertMetadata();
+
+    void setSceneCoordinates();
+
+    void setReferenceGeometry();
+
+    /*
+     *  Set one vector's PVPs in a row of a one channel PVPBlock
+     */
+    void convertVector(size_t channel,
+                       size_t vector,
+                       size_t row,
+                       cphd::PVPBlock& pvpBlock) const;
+
+    /*
+     *  Frequency and TOA limits of a vector, as they'll be in the PVPs
+     */
+    void getBounds(size_t channel,
+                   size_t vector,
+                   double& fx1,
+                   double& fx2,
+                   double& toa1,
+                   double& toa2) const;
+
+    cphd::Vector3 getTxVel(size_t channel, size_t vector) const;
+
+    cphd::Vector3 getRcvVel(size_t channel, size_t vector) const;
+
+    const std::string mPathname;
+    const size_t mNumThreads;
+    const size_t mBufferSize;
+    CPHDReader mReader;
+    cphd::Metadata mMetadata;
+};
+}
+
+#endif
@@ -0,0 +1,535 @@
+/* =========================================================================
+ * This file is part of cphd03-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * cphd03-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+#include <except/Exception.h>
+#include <io/FileInputStream.h>
+#include <math/Constants.h>
+#include <scene/LocalCoordinateTransform.h>
+#include <scene/RangeRunnable.h>
+#include <scene/Utilities.h>
+#include <str/Convert.h>
+#include <sys/Conf.h>
+#include <cphd/ReferenceGeometryCalculator.h>
+#include <cphd03/CPHDConverter.h>
+
+namespace
+{
+const double SPEED_OF_LIGHT = math::Constants::SPEED_OF_LIGHT_METERS_PER_SEC;
+
+typedef double (cphd03::VBM::*TimeAccessor)(size_t, size_t) const;
+typedef cphd::Vector3 (cphd03::VBM::*PositionAccessor)(size_t, size_t) const;
+
+cphd::SignalArrayFormat getSignalArrayFormat(cphd::SampleType sampleType)
+{
+    if (sampleType == cphd::SampleType::RE08I_IM08I)
+    {
+        return cphd::SignalArrayFormat::CI2;
+    }
+    if (sampleType == cphd::SampleType::RE16I_IM16I)
+    {
+        return cphd::SignalArrayFormat::CI4;
+    }
+    if (sampleType == cphd::SampleType::RE32F_IM32F)
+    {
+        return cphd::SignalArrayFormat::CF8;
+    }
+    throw except::Exception(Ctxt("Unknown sample type " +
+                                 sampleType.toString()));
+}
+
+// Central difference of the positions of the neighboring vectors, or a one
+// sided difference at either end of the channel
+cphd::Vector3 differenceVelocity(const cphd03::VBM& vbm,
+                                 TimeAccessor getTime,
+                                 PositionAccessor getPosition,
+                                 size_t channel,
+                                 size_t vector,
+                                 size_t numVectors)
+{
+    const size_t before = vector > 0 ? vector - 1 : vector;
+    const size_t after = vector + 1 < numVectors ? vector + 1 : vector;
+    const double dt = (vbm.*getTime)(channel, after) -
+            (vbm.*getTime)(channel, before);
+    if (dt == 0.0)
+    {
+        return cphd::Vector3(0.0);
+    }
+    return ((vbm.*getPosition)(channel, after) -
+            (vbm.*getPosition)(channel, before)) * (1.0 / dt);
+}
+
+struct ConvertChannelsJob
+{
+    const cphd03::CPHDConverter* converter;
+    cphd::CPHDWriter* writer;
+
+    void operator()(size_t startChannel, size_t numChannels) const
+    {
+        for (size_t ii = startChannel; ii < startChannel + numChannels; ++ii)
+        {
+            converter->convertChannel(ii, *writer);
+        }
+    }
+};
+}
+
+namespace cphd03
+{
+CPHDConverter::CPHDConverter(const std::string& pathname,
+                             size_t numThreads,
+                             size_t bufferSize) :
+    mPathname(pathname),
+    mNumThreads(numThreads),
+    mBufferSize(bufferSize),
+    mReader(pathname, numThreads)
+{
+    convertMetadata();
+}
+
+void CPHDConverter::convertMetadata()
+{
+    const Metadata& metadata = mReader.getMetadata();
+    const VBM& vbm = mReader.getVBM();
+    if (metadata.global.refFrequencyIndex != 0)
+    {
+        throw except::Exception(Ctxt(
+                "Frequencies stored as indices (RefFreqIndex != 0) "
+                "can't be converted"));
+    }
+    const size_t numChannels = metadata.getNumChannels();
+    if (metadata.channel.parameters.size() < numChannels)
+    {
+        throw except::Exception(Ctxt(
+                "Every channel needs its channel parameters"));
+    }
+
+    // Collection ID comes across as is.  Older files only carry the
+    // classification and release info in the file header.
+    const FileHeader& fileHeader = mReader.getFileHeader();
+    mMetadata.collectionID = metadata.collectionInformation;
+    if (mMetadata.collectionID.getClassificationLevel().empty())
+    {
+        mMetadata.collectionID.setClassificationLevel(
+                fileHeader.getClassification());
+    }
+    if (mMetadata.collectionID.releaseInfo.empty())
+    {
+        mMetadata.collectionID.releaseInfo = fileHeader.getReleaseInfo();
+    }
+
+    mMetadata.global.domainType = metadata.global.domainType;
+    mMetadata.global.sgn = metadata.global.phaseSGN;
+    mMetadata.global.timeline.collectionStart = metadata.global.collectStart;
+    mMetadata.global.timeline.txTime1 = metadata.global.txTime1;
+    mMetadata.global.timeline.txTime2 = metadata.global.txTime2;
+
+    cphd::Pvp& pvp = mMetadata.pvp;
+    pvp.append(pvp.txTime);
+    pvp.append(pvp.txPos);
+    pvp.append(pvp.txVel);
+    pvp.append(pvp.rcvTime);
+    pvp.append(pvp.rcvPos);
+    pvp.append(pvp.rcvVel);
+    pvp.append(pvp.srpPos);
+    pvp.append(pvp.aFDOP);
+    pvp.append(pvp.aFRR1);
+    pvp.append(pvp.aFRR2);
+    pvp.append(pvp.fx1);
+    pvp.append(pvp.fx2);
+    pvp.append(pvp.toa1);
+    pvp.append(pvp.toa2);
+    pvp.append(pvp.tdTropoSRP);
+    pvp.append(pvp.sc0);
+    pvp.append(pvp.scss);
+    if (vbm.haveAmpSF())
+    {
+        pvp.append(pvp.ampSF);
+    }
+
+    cphd::Data& data = mMetadata.data;
+    data.signalArrayFormat = getSignalArrayFormat(metadata.getSampleType());
+    data.numBytesPVP = pvp.sizeInBytes();
+
+    // The band and swath span every vector; a parameter is fixed if it
+    // doesn't change from vector to vector (and, for the whole CPHD, from
+    // channel to channel)
+    double fxMin = std::numeric_limits<double>::max();
+    double fxMax = -std::numeric_limits<double>::max();
+    double toaMin = std::numeric_limits<double>::max();
+    double toaMax = -std::numeric_limits<double>::max();
+    bool fxFixedCphd = true;
+    bool toaFixedCphd = true;
+    bool srpFixedCphd = true;
+    double cphdFx1(0), cphdFx2(0), cphdToa1(0), cphdToa2(0);
+    cphd::Vector3 cphdSRP(0.0);
+
+    size_t signalOffset = 0;
+    size_t pvpOffset = 0;
+    for (size_t ii = 0; ii < numChannels; ++ii)
+    {
+        const size_t numVectors = metadata.getNumVectors(ii);
+        const size_t numSamples = metadata.getNumSamples(ii);
+        cphd::Data::Channel channel(numVectors, numSamples,
+                                    signalOffset, pvpOffset);
+        channel.identifier = "Channel" + str::toString(ii + 1);
+        data.channels.push_back(channel);
+        signalOffset += numVectors * numSamples * data.getNumBytesPerSample();
+        pvpOffset += numVectors * data.numBytesPVP;
+
+        const ChannelParameters& inParameter = metadata.channel.parameters[ii];
+        cphd::ChannelParameter parameter;
+        parameter.identifier = channel.identifier;
+        parameter.refVectorIndex = numVectors / 2;
+        parameter.polarization.txPol = cphd::PolarizationType::UNSPECIFIED;
+        parameter.polarization.rcvPol = cphd::PolarizationType::UNSPECIFIED;
+        parameter.fxC = inParameter.fxCtrNom;
+        parameter.fxBW = inParameter.bwSavedNom;
+        parameter.toaSaved = inParameter.toaSavedNom;
+        parameter.dwellTimes.codId = "COD";
+        parameter.dwellTimes.dwellId = "Dwell";
+
+        bool fxFixed = true;
+        bool toaFixed = true;
+        bool srpFixed = true;
+        double firstFx1(0), firstFx2(0), firstToa1(0), firstToa2(0);
+        cphd::Vector3 firstSRP(0.0);
+        for (size_t jj = 0; jj < numVectors; ++jj)
+        {
+            double fx1, fx2, toa1, toa2;
+            getBounds(ii, jj, fx1, fx2, toa1, toa2);
+            const cphd::Vector3 srp = vbm.getSRPPos(ii, jj);
+            fxMin = std::min(fxMin, fx1);
+            fxMax = std::max(fxMax, fx2);
+            toaMin = std::min(toaMin, toa1);
+            toaMax = std::max(toaMax, toa2);
+            if (jj == 0)
+            {
+                firstFx1 = fx1;
+                firstFx2 = fx2;
+                firstToa1 = toa1;
+                firstToa2 = toa2;
+                firstSRP = srp;
+                continue;
+            }
+            fxFixed = fxFixed && fx1 == firstFx1 && fx2 == firstFx2;
+            toaFixed = toaFixed && toa1 == firstToa1 && toa2 == firstToa2;
+            srpFixed = srpFixed && srp == firstSRP;
+        }
+        parameter.fxFixed = fxFixed ? six::BooleanType::IS_TRUE :
+                                      six::BooleanType::IS_FALSE;
+        parameter.toaFixed = toaFixed ? six::BooleanType::IS_TRUE :
+                                        six::BooleanType::IS_FALSE;
+        parameter.srpFixed = srpFixed ? six::BooleanType::IS_TRUE :
+                                        six::BooleanType::IS_FALSE;
+        mMetadata.channel.parameters.push_back(parameter);
+
+        if (ii == 0)
+        {
+            cphdFx1 = firstFx1;
+            cphdFx2 = firstFx2;
+            cphdToa1 = firstToa1;
+            cphdToa2 = firstToa2;
+            cphdSRP = firstSRP;
+        }
+        fxFixedCphd = fxFixedCphd && fxFixed &&
+                firstFx1 == cphdFx1 && firstFx2 == cphdFx2;
+        toaFixedCphd = toaFixedCphd && toaFixed &&
+                firstToa1 == cphdToa1 && firstToa2 == cphdToa2;
+        srpFixedCphd = srpFixedCphd && srpFixed && firstSRP == cphdSRP;
+    }
+    mMetadata.channel.refChId = data.channels.empty() ?
+            std::string() : data.channels[0].identifier;
+    mMetadata.channel.fxFixedCphd = fxFixedCphd ?
+            six::BooleanType::IS_TRUE : six::BooleanType::IS_FALSE;
+    mMetadata.channel.toaFixedCphd = toaFixedCphd ?
+            six::BooleanType::IS_TRUE : six::BooleanType::IS_FALSE;
+    mMetadata.channel.srpFixedCphd = srpFixedCphd ?
+            six::BooleanType::IS_TRUE : six::BooleanType::IS_FALSE;
+    mMetadata.global.fxBand.fxMin = fxMin;
+    mMetadata.global.fxBand.fxMax = fxMax;
+    mMetadata.global.toaSwath.toaMin = toaMin;
+    mMetadata.global.toaSwath.toaMax = toaMax;
+
+    // One COD and dwell time polynomial serves every channel.  Without
+    // them, the whole collection is taken to be one dwell.
+    cphd::COD cod;
+    cod.identifier = "COD";
+    cphd::DwellTime dwellTime;
+    dwellTime.identifier = "Dwell";
+    const AreaPlane* const plane = metadata.global.imageArea.plane.get();
+    if (plane && plane->dwellTime.get())
+    {
+        cod.codTimePoly = plane->dwellTime->codTimePoly;
+        dwellTime.dwellTimePoly = plane->dwellTime->dwellTimePoly;
+    }
+    else
+    {
+        cod.codTimePoly = cphd::Poly2D(0, 0);
+        cod.codTimePoly[0][0] =
+                (metadata.global.txTime1 + metadata.global.txTime2) / 2;
+        dwellTime.dwellTimePoly = cphd::Poly2D(0, 0);
+        dwellTime.dwellTimePoly[0][0] =
+                metadata.global.txTime2 - metadata.global.txTime1;
+    }
+    mMetadata.dwell.cod.push_back(cod);
+    mMetadata.dwell.dtime.push_back(dwellTime);
+
+    setSceneCoordinates();
+    setReferenceGeometry();
+}
+
+void CPHDConverter::setSceneCoordinates()
+{
+    const Metadata& metadata = mReader.getMetadata();
+    const AreaPlane* const plane = metadata.global.imageArea.plane.get();
+    cphd::SceneCoordinates& coords = mMetadata.sceneCoordinates;
+    coords.referenceSurface.planar.reset(new cphd::Planar());
+    cphd::Planar& planar = *coords.referenceSurface.planar;
+
+    // Use the image plane if there is one.  Otherwise the IARP is the
+    // first fixed SRP, or the reference vector's SRP, and the plane is
+    // tangent to the ellipsoid there.
+    if (plane)
+    {
+        coords.iarp.ecf = plane->referencePoint.ecef;
+        planar.uIax = plane->xDirection.unitVector;
+        planar.uIay = plane->yDirection.unitVector;
+    }
+    else
+    {
+        if (metadata.srp.srpType == cphd::SRPType::FIXEDPT &&
+            !metadata.srp.srpPT.empty())
+        {
+            coords.iarp.ecf = metadata.srp.srpPT[0];
+        }
+        else if (!mMetadata.channel.parameters.empty())
+        {
+            coords.iarp.ecf = mReader.getVBM().getSRPPos(
+                    0, mMetadata.channel.parameters[0].refVectorIndex);
+        }
+        else
+        {
+            throw except::Exception(Ctxt(
+                    "There's no image plane or SRP to place the IARP at"));
+        }
+        cphd::LatLonAlt iarpLLA = scene::Utilities::ecefToLatLon(
+                coords.iarp.ecf);
+        scene::ENUCoordinateTransform enu(iarpLLA);
+        planar.uIax = enu.getUnitVectorX();
+        planar.uIay = enu.getUnitVectorY();
+    }
+    coords.iarp.llh = scene::Utilities::ecefToLatLon(coords.iarp.ecf);
+
+    // The image area bounds the corners in image area coordinates
+    coords.imageArea.x1y1[0] = std::numeric_limits<double>::max();
+    coords.imageArea.x1y1[1] = std::numeric_limits<double>::max();
+    coords.imageArea.x2y2[0] = -std::numeric_limits<double>::max();
+    coords.imageArea.x2y2[1] = -std::numeric_limits<double>::max();
+    for (size_t ii = 0; ii < cphd::LatLonAltCorners::NUM_CORNERS; ++ii)
+    {
+        const cphd::LatLonAlt& corner =
+                metadata.global.imageArea.acpCorners.getCorner(ii);
+        coords.imageAreaCorners.getCorner(ii).setLat(corner.getLat());
+        coords.imageAreaCorners.getCorner(ii).setLon(corner.getLon());
+
+        const cphd::Vector3 offset =
+                scene::Utilities::latLonToECEF(corner) - coords.iarp.ecf;
+        const double x = offset.dot(planar.uIax);
+        const double y = offset.dot(planar.uIay);
+        coords.imageArea.x1y1[0] = std::min(coords.imageArea.x1y1[0], x);
+        coords.imageArea.x1y1[1] = std::min(coords.imageArea.x1y1[1], y);
+        coords.imageArea.x2y2[0] = std::max(coords.imageArea.x2y2[0], x);
+        coords.imageArea.x2y2[1] = std::max(coords.imageArea.x2y2[1], y);
+    }
+}
+
+void CPHDConverter::setReferenceGeometry()
+{
+    if (mMetadata.channel.parameters.empty())
+    {
+        return;
+    }
+
+    // Convert the reference vector of the reference channel on its own and
+    // derive the geometry from its PVPs
+    const size_t vector = mMetadata.channel.parameters[0].refVectorIndex;
+    cphd::PVPBlock pvpBlock(1, std::vector<size_t>(1, 1), mMetadata.pvp);
+    convertVector(0, vector, 0, pvpBlock);
+
+    const cphd::ReferenceGeometryCalculator calculator(mMetadata, pvpBlock);
+    mMetadata.referenceGeometry = calculator.computeReferenceGeometry(0, 0);
+}
+
+cphd::Vector3 CPHDConverter::getTxVel(size_t channel, size_t vector) const
+{
+    return differenceVelocity(mReader.getVBM(), &VBM::getTxTime,
+                              &VBM::getTxPos, channel, vector,
+                              mReader.getNumVectors(channel));
+}
+
+cphd::Vector3 CPHDConverter::getRcvVel(size_t channel, size_t vector) const
+{
+    return differenceVelocity(mReader.getVBM(), &VBM::getRcvTime,
+                              &VBM::getRcvPos, channel, vector,
+                              mReader.getNumVectors(channel));
+}
+
+void CPHDConverter::getBounds(size_t channel,
+                              size_t vector,
+                              double& fx1,
+                              double& fx2,
+                              double& toa1,
+                              double& toa2) const
+{
+    const VBM& vbm = mReader.getVBM();
+    const ChannelParameters& parameter =
+            mReader.getMetadata().channel.parameters[channel];
+    if (mReader.isFX())
+    {
+        fx1 = vbm.getFx1(channel, vector);
+        fx2 = vbm.getFx2(channel, vector);
+        toa1 = -parameter.toaSavedNom / 2;
+        toa2 = parameter.toaSavedNom / 2;
+    }
+    else
+    {
+        const double toaFirst = vbm.getDeltaTOA0(channel, vector);
+        const double toaLast = toaFirst +
+                (mReader.getNumSamples(channel) - 1) *
+                vbm.getTOASS(channel, vector);
+        toa1 = std::min(toaFirst, toaLast);
+        toa2 = std::max(toaFirst, toaLast);
+        fx1 = parameter.fxCtrNom - parameter.bwSavedNom / 2;
+        fx2 = parameter.fxCtrNom + parameter.bwSavedNom / 2;
+    }
+}
+
+void CPHDConverter::convertVector(size_t channel,
+                                  size_t vector,
+                                  size_t row,
+                                  cphd::PVPBlock& pvpBlock) const
+{
+    const VBM& vbm = mReader.getVBM();
+    const cphd::Vector3 txPos = vbm.getTxPos(channel, vector);
+    const cphd::Vector3 rcvPos = vbm.getRcvPos(channel, vector);
+    const cphd::Vector3 srpPos = vbm.getSRPPos(channel, vector);
+    const cphd::Vector3 txVel = getTxVel(channel, vector);
+    const cphd::Vector3 rcvVel = getRcvVel(channel, vector);
+
+    pvpBlock.setTxTime(vbm.getTxTime(channel, vector), 0, row);
+    pvpBlock.setTxPos(txPos, 0, row);
+    pvpBlock.setTxVel(txVel, 0, row);
+    pvpBlock.setRcvTime(vbm.getRcvTime(channel, vector), 0, row);
+    pvpBlock.setRcvPos(rcvPos, 0, row);
+    pvpBlock.setRcvVel(rcvVel, 0, row);
+    pvpBlock.setSRPPos(srpPos, 0, row);
+
+    // First order micro parameters about the SRP
+    const double txRangeRate = (txPos - srpPos).unit().dot(txVel);
+    const double rcvRangeRate = (rcvPos - srpPos).unit().dot(rcvVel);
+    pvpBlock.setaFDOP((txRangeRate + rcvRangeRate) / SPEED_OF_LIGHT, 0, row);
+    pvpBlock.setaFRR1(2.0 / SPEED_OF_LIGHT, 0, row);
+    pvpBlock.setaFRR2(0.0, 0, row);
+
+    double fx1, fx2, toa1, toa2;
+    getBounds(channel, vector, fx1, fx2, toa1, toa2);
+    pvpBlock.setFx1(fx1, 0, row);
+    pvpBlock.setFx2(fx2, 0, row);
+    pvpBlock.setTOA1(toa1, 0, row);
+    pvpBlock.setTOA2(toa2, 0, row);
+
+    pvpBlock.setTdTropoSRP(vbm.haveTropoSRP() ?
+                                   vbm.getTropoSRP(channel, vector) /
+                                           SPEED_OF_LIGHT :
+                                   0.0,
+                           0, row);
+    if (mReader.isFX())
+    {
+        pvpBlock.setSC0(vbm.getFx0(channel, vector), 0, row);
+        pvpBlock.setSCSS(vbm.getFxSS(channel, vector), 0, row);
+    }
+    else
+    {
+        pvpBlock.setSC0(vbm.getDeltaTOA0(channel, vector), 0, row);
+        pvpBlock.setSCSS(vbm.getTOASS(channel, vector), 0, row);
+    }
+    if (vbm.haveAmpSF())
+    {
+        pvpBlock.setAmpSF(vbm.getAmpSF(channel, vector), 0, row);
+    }
+}
+
+void CPHDConverter::convertChannel(size_t channel,
+                                   cphd::CPHDWriter& writer) const
+{
+    const size_t numVectors = mMetadata.data.getNumVectors(channel);
+    const size_t vectorSize = mMetadata.data.getNumSamples(channel) *
+            mMetadata.data.getNumBytesPerSample();
+    const size_t rowSize = std::max(vectorSize,
+                                    mMetadata.data.getNumBytesPVPSet());
+    const size_t vectorsPerBlock =
+            std::max<size_t>(1, mBufferSize / std::max<size_t>(rowSize, 1));
+
+    // The signal array samples are big endian in both versions, so they
+    // can go across untouched
+    io::FileInputStream inStream(mPathname);
+    inStream.seek(mReader.getFileOffset(channel, 0, 0), io::Seekable::START);
+    std::vector<sys::ubyte> buffer(vectorsPerBlock * rowSize);
+    for (size_t firstVector = 0; firstVector < numVectors;
+         firstVector += vectorsPerBlock)
+    {
+        const size_t blockVectors =
+                std::min(vectorsPerBlock, numVectors - firstVector);
+        inStream.read(reinterpret_cast<sys::byte*>(&buffer[0]),
+                      blockVectors * vectorSize);
+        writer.writeRawChannel(&buffer[0], channel, firstVector,
+                               blockVectors);
+
+        cphd::PVPBlock pvpBlock(1, std::vector<size_t>(1, blockVectors),
+                                mMetadata.pvp);
+        for (size_t ii = 0; ii < blockVectors; ++ii)
+        {
+            convertVector(channel, firstVector + ii, ii, pvpBlock);
+        }
+        pvpBlock.getPVPdata(0, &buffer[0], !sys::isBigEndianSystem(), 1);
+        writer.writeRawChannelPVP(&buffer[0], channel, firstVector,
+                                  blockVectors);
+    }
+}
+
+void CPHDConverter::write(const std::string& pathname,
+                          const std::vector<std::string>& schemaPaths) const
+{
+    cphd::CPHDWriter writer(mMetadata, pathname, schemaPaths, 1);
+    writer.startChannelWrites();
+
+    const size_t numChannels = mMetadata.data.getNumChannels();
+    const ConvertChannelsJob job = { this, &writer };
+    scene::runInParallel(job, numChannels, mNumThreads);
+
+    writer.finishChannelWrites();
+}
+}
@@ -0,0 +1,283 @@
+/* =========================================================================
+ * This file is part of cphd03-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * cphd03-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <complex>
+#include <string>
+#include <vector>
+
+#include <cphd/CPHDReader.h>
+#include <cphd/PVPBlock.h>
+#include <cphd/ReferenceGeometryCalculator.h>
+#include <cphd/Wideband.h>
+#include <cphd03/CPHDConverter.h>
+#include <cphd03/CPHDWriter.h>
+#include <io/TempFile.h>
+#include <logging/NullLogger.h>
+#include <math/Constants.h>
+#include <scene/Utilities.h>
+#include "TestCase.h"
+
+namespace
+{
+typedef std::complex<float> Sample;
+
+const size_t NUM_CHANNELS = 2;
+const size_t NUM_SAMPLES = 16;
+const size_t NUM_VECTORS[NUM_CHANNELS] = {20, 15};
+const double FX0 = 9.95e9;
+const double FXSS = 1.0e8 / NUM_SAMPLES;
+
+cphd::Vector3 getSRP()
+{
+    return scene::Utilities::latLonToECEF(cphd::LatLonAlt(40.0, -105.0, 0.0));
+}
+
+cphd::Vector3 getVelocity()
+{
+    cphd::Vector3 velocity;
+    velocity[0] = 100.0;
+    velocity[1] = 7000.0;
+    velocity[2] = -300.0;
+    return velocity;
+}
+
+// The platform flies in a straight line from 10 km above the SRP
+cphd::Vector3 getPosition(double time)
+{
+    const cphd::Vector3 srp = getSRP();
+    return srp + srp.unit() * 10000.0 + getVelocity() * time;
+}
+
+void buildMetadata(cphd03::Metadata& metadata, cphd03::VBM& vbm)
+{
+    metadata.collectionInformation.collectorName = "Collector";
+    metadata.collectionInformation.coreName = "Core";
+    metadata.collectionInformation.collectType =
+            cphd::CollectType::MONOSTATIC;
+    metadata.collectionInformation.radarMode = cphd::RadarModeType::SPOTLIGHT;
+    metadata.collectionInformation.setClassificationLevel("UNCLASSIFIED");
+
+    metadata.data.sampleType = cphd::SampleType::RE32F_IM32F;
+    metadata.data.numCPHDChannels = NUM_CHANNELS;
+    for (size_t ii = 0; ii < NUM_CHANNELS; ++ii)
+    {
+        metadata.data.arraySize.push_back(
+                cphd03::ArraySize(NUM_VECTORS[ii], NUM_SAMPLES));
+
+        cphd03::ChannelParameters parameter;
+        parameter.srpIndex = 0;
+        parameter.nomTOARateSF = 1.0;
+        parameter.fxCtrNom = 1.0e10;
+        parameter.bwSavedNom = 1.0e8;
+        parameter.toaSavedNom = 1.0e-6;
+        parameter.txAntIndex = 0;
+        parameter.rcvAntIndex = 0;
+        parameter.twAntIndex = 0;
+        metadata.channel.parameters.push_back(parameter);
+    }
+
+    metadata.global.domainType = cphd::DomainType::FX;
+    metadata.global.phaseSGN = cphd::PhaseSGN::MINUS_1;
+    metadata.global.refFrequencyIndex = 0;
+    metadata.global.collectStart = cphd::DateTime(1000.0);
+    metadata.global.collectDuration = 2.0;
+    metadata.global.txTime1 = 0.0;
+    metadata.global.txTime2 = 2.0;
+    for (size_t ii = 0; ii < cphd::LatLonAltCorners::NUM_CORNERS; ++ii)
+    {
+        cphd::LatLonAlt& corner =
+                metadata.global.imageArea.acpCorners.getCorner(ii);
+        corner.setLat(ii < 2 ? 40.01 : 39.99);
+        corner.setLon(ii == 0 || ii == 3 ? -105.01 : -104.99);
+        corner.setAlt(0.0);
+    }
+
+    metadata.srp.srpType = cphd::SRPType::FIXEDPT;
+    metadata.srp.numSRPs = 1;
+    metadata.srp.srpPT.push_back(getSRP());
+    metadata.antenna.reset(new cphd03::Antenna());
+
+    vbm = cphd03::VBM(NUM_CHANNELS,
+                      std::vector<size_t>(NUM_VECTORS,
+                                          NUM_VECTORS + NUM_CHANNELS),
+                      false, true, true, cphd::DomainType::FX);
+    vbm.updateVectorParameters(metadata.vectorParameters);
+    for (size_t ii = 0; ii < NUM_CHANNELS; ++ii)
+    {
+        for (size_t jj = 0; jj < NUM_VECTORS[ii]; ++jj)
+        {
+            const double txTime = 0.1 * jj;
+            const double rcvTime = txTime + 1.0e-4;
+            vbm.setTxTime(txTime, ii, jj);
+            vbm.setTxPos(getPosition(txTime), ii, jj);
+            vbm.setRcvTime(rcvTime, ii, jj);
+            vbm.setRcvPos(getPosition(rcvTime), ii, jj);
+            vbm.setSRPPos(getSRP(), ii, jj);
+            vbm.setTropoSRP(2.0, ii, jj);
+            vbm.setAmpSF(1.0 + 0.01 * jj, ii, jj);
+            vbm.setFx0(FX0, ii, jj);
+            vbm.setFxSS(FXSS, ii, jj);
+            vbm.setFx1(FX0, ii, jj);
+            vbm.setFx2(FX0 + FXSS * (NUM_SAMPLES - 1), ii, jj);
+        }
+    }
+}
+
+std::vector<Sample> writeCPHD03(const std::string& pathname,
+                                cphd03::Metadata& metadata)
+{
+    cphd03::VBM vbm;
+    buildMetadata(metadata, vbm);
+
+    std::vector<Sample> data;
+    for (size_t ii = 0; ii < NUM_CHANNELS; ++ii)
+    {
+        for (size_t jj = 0; jj < NUM_VECTORS[ii] * NUM_SAMPLES; ++jj)
+        {
+            data.push_back(Sample(static_cast<float>(ii * 1000 + jj),
+                                  -static_cast<float>(jj)));
+        }
+    }
+
+    cphd03::CPHDWriter writer(metadata, pathname);
+    writer.writeMetadata(vbm, "UNCLASSIFIED", "UNRESTRICTED");
+    writer.writeCPHDData(&data[0], NUM_VECTORS[0] * NUM_SAMPLES);
+    writer.writeCPHDData(&data[NUM_VECTORS[0] * NUM_SAMPLES],
+                         NUM_VECTORS[1] * NUM_SAMPLES);
+    return data;
+}
+
+TEST_CASE(testConvert)
+{
+    io::TempFile input;
+    cphd03::Metadata inMetadata;
+    const std::vector<Sample> data =
+            writeCPHD03(input.pathname(), inMetadata);
+
+    // Two vectors per block, with the channels on separate threads
+    const cphd03::CPHDConverter converter(input.pathname(), 2, 300);
+    io::TempFile output;
+    converter.write(output.pathname());
+
+    const cphd::CPHDReader reader(output.pathname(), 1);
+    const cphd::Metadata& metadata = reader.getMetadata();
+    TEST_ASSERT_EQ(reader.getNumChannels(), NUM_CHANNELS);
+    TEST_ASSERT_EQ(metadata.global.getDomainType(), cphd::DomainType::FX);
+    TEST_ASSERT_EQ(metadata.data.signalArrayFormat,
+                   cphd::SignalArrayFormat::CF8);
+    TEST_ASSERT_EQ(metadata.channel.refChId, "Channel1");
+    TEST_ASSERT_EQ(metadata.channel.fxFixedCphd, six::BooleanType::IS_TRUE);
+    TEST_ASSERT_EQ(metadata.channel.srpFixedCphd, six::BooleanType::IS_TRUE);
+    TEST_ASSERT_EQ(metadata.global.fxBand.fxMin, FX0);
+    TEST_ASSERT_EQ(metadata.channel.parameters[1].refVectorIndex, 7);
+    TEST_ASSERT_EQ(metadata.channel.parameters[1].fxC, 1.0e10);
+    TEST_ASSERT_LESSER(metadata.sceneCoordinates.imageArea.x1y1[0], 0.0);
+    TEST_ASSERT_GREATER(metadata.sceneCoordinates.imageArea.x2y2[1], 0.0);
+    TEST_ASSERT(metadata.referenceGeometry.monostatic.get() != nullptr);
+
+    // The reference vector is in the middle of the first channel
+    const cphd::Vector3 arpPos =
+            (getPosition(1.0) + getPosition(1.0 + 1.0e-4)) * 0.5;
+    TEST_ASSERT_ALMOST_EQ_EPS(metadata.referenceGeometry.monostatic->slantRange,
+                              (arpPos - getSRP()).norm(), 1e-6);
+    const double c = math::Constants::SPEED_OF_LIGHT_METERS_PER_SEC;
+    TEST_ASSERT_ALMOST_EQ_EPS(metadata.referenceGeometry.referenceTime,
+                              1.0 + (getPosition(1.0) - getSRP()).norm() / c,
+                              1e-12);
+
+    // The angles come from the converted PVPs, and agree with them
+    const cphd::Monostatic& monostatic =
+            *metadata.referenceGeometry.monostatic;
+    TEST_ASSERT_GREATER(monostatic.grazeAngle, 0.0);
+    TEST_ASSERT_GREATER(monostatic.dopplerConeAngle, 0.0);
+    TEST_ASSERT_GREATER(monostatic.slopeAngle, 0.0);
+    TEST_ASSERT_ALMOST_EQ_EPS(monostatic.incidenceAngle,
+                              90.0 - monostatic.grazeAngle, 1e-12);
+
+    const cphd::PVPBlock& pvps = reader.getPVPBlock();
+    const cphd::ReferenceGeometryCalculator calculator(metadata, pvps);
+    logging::NullLogger log;
+    TEST_ASSERT(calculator.validate(metadata.referenceGeometry, log));
+    for (size_t ii = 0, offset = 0; ii < NUM_CHANNELS; ++ii)
+    {
+        TEST_ASSERT_EQ(reader.getNumVectors(ii), NUM_VECTORS[ii]);
+        TEST_ASSERT_EQ(reader.getNumSamples(ii), NUM_SAMPLES);
+
+        // Signal samples are copied as is
+        mem::ScopedArray<sys::ubyte> buffer;
+        reader.getWideband().read(ii, 0, cphd::Wideband::ALL, 0,
+                                  cphd::Wideband::ALL, 1, buffer);
+        const Sample* const samples =
+                reinterpret_cast<const Sample*>(buffer.get());
+        for (size_t jj = 0; jj < NUM_VECTORS[ii] * NUM_SAMPLES; ++jj)
+        {
+            TEST_ASSERT_EQ(samples[jj], data[offset + jj]);
+        }
+        offset += NUM_VECTORS[ii] * NUM_SAMPLES;
+
+        for (size_t jj = 0; jj < NUM_VECTORS[ii]; ++jj)
+        {
+            TEST_ASSERT_EQ(pvps.getTxTime(ii, jj), 0.1 * jj);
+            TEST_ASSERT_EQ(pvps.getSC0(ii, jj), FX0);
+            TEST_ASSERT_EQ(pvps.getSCSS(ii, jj), FXSS);
+            TEST_ASSERT_EQ(pvps.getTOA1(ii, jj), -0.5e-6);
+            TEST_ASSERT_EQ(pvps.getTdTropoSRP(ii, jj), 2.0 / c);
+            TEST_ASSERT_EQ(pvps.getAmpSF(ii, jj), 1.0 + 0.01 * jj);
+
+            // The platform's velocity is constant, so the differences
+            // recover it
+            const cphd::Vector3 txVel = pvps.getTxVel(ii, jj);
+            const cphd::Vector3 rcvVel = pvps.getRcvVel(ii, jj);
+            for (size_t kk = 0; kk < 3; ++kk)
+            {
+                TEST_ASSERT_ALMOST_EQ_EPS(txVel[kk], getVelocity()[kk], 1e-3);
+                TEST_ASSERT_ALMOST_EQ_EPS(rcvVel[kk], getVelocity()[kk], 1e-3);
+            }
+        }
+    }
+}
+
+TEST_CASE(testIndexedFrequenciesThrow)
+{
+    cphd03::Metadata metadata;
+    cphd03::VBM vbm;
+    buildMetadata(metadata, vbm);
+    metadata.global.refFrequencyIndex = 1;
+
+    io::TempFile input;
+    {
+        cphd03::CPHDWriter writer(metadata, input.pathname());
+        writer.writeMetadata(vbm, "UNCLASSIFIED", "UNRESTRICTED");
+        const std::vector<Sample> data(NUM_VECTORS[0] * NUM_SAMPLES);
+        writer.writeCPHDData(&data[0], NUM_VECTORS[0] * NUM_SAMPLES);
+        writer.writeCPHDData(&data[0], NUM_VECTORS[1] * NUM_SAMPLES);
+    }
+    TEST_EXCEPTION(cphd03::CPHDConverter(input.pathname()));
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testConvert);
+    TEST_CHECK(testIndexedFrequenciesThrow);
+    return 0;
+}
@@ -221,20 +221,15 @@ int main(int argc, char** argv)
             }
             else
             {
-                region.setNumRows(1);
-                const size_t nbpr = nbpp * numCols;
-
-                // allocate this so we can reuse it for each row
-                const mem::ScopedArray<six::UByte> workBuffer(new six::UByte[nbpr]);
-                region.setBuffer(workBuffer.get());
+                // Read bands of rows in the background while writing
+                region.setNumRows(numRows);
+                six::RowBandIterator bands(*reader, ii, region);
 
-                for (size_t jj = startRow;
-                     jj < numRows + startRow;
-                     ++jj)
+                six::ImageView band;
+                while (bands.next(band))
                 {
-                    region.setStartRow(jj);
-                    six::UByte* line = reader->interleaved(region, ii);
-                    outputStream.write((const sys::byte*) line, nbpr);
+                    outputStream.write((const sys::byte*) band.data,
+                                       band.numRows * band.rowStride);
                 }
             }
             outputStream.close();
@@ -23,37 +23,14 @@
 #include <iostream>
 #include <cli/ArgumentParser.h>
 #include <except/Exception.h>
-#include <six/Data.h>
-#include <six/NITFWriteControl.h>
+#include <six/Container.h>
+#include <six/MetadataRewriter.h>
 #include <six/sicd/ComplexData.h>
 #include <six/sicd/ComplexXMLControl.h>
 #include <six/sicd/SICDVersionUpdater.h>
 #include <six/sicd/Utilities.h>
 #include <logging/Logger.h>
 
-namespace
-{
-void writeSicd(std::auto_ptr<six::Data> complexData,
-               const std::vector<std::complex<float>>& widebandData,
-               const std::vector<std::string>& schemaPaths,
-               const std::string& pathname)
-{
-    six::XMLControlFactory::getInstance().addCreator(
-            six::DataType::COMPLEX,
-            new six::XMLControlCreatorT<six::sicd::ComplexXMLControl>());
-
-    mem::SharedPtr<six::Container> container(new six::Container(
-            six::DataType::COMPLEX));
-    container->addData(complexData);
-
-    six::NITFWriteControl writer(container);
-
-    six::BufferList buffers;
-    buffers.push_back(reinterpret_cast<const six::UByte*>(widebandData.data()));
-    writer.save(buffers, pathname, schemaPaths);
-}
-}
-
 int main(int argc, char **argv)
 {
     try
@@ -84,17 +61,21 @@ int main(int argc, char **argv)
             schemaPaths.push_back(options->get<std::string>("schema"));
         }
 
-        std::auto_ptr<six::sicd::ComplexData> complexData;
-        std::vector<std::complex<float>> widebandData;
-        six::sicd::Utilities::readSicd(pathname, schemaPaths,
-                                       complexData, widebandData);
+        // Only the metadata changes, so the pixels are never read
+        std::auto_ptr<six::sicd::ComplexData> complexData =
+                six::sicd::Utilities::getComplexData(pathname, schemaPaths);
 
         logging::DefaultLogger log("SICD Update");
         six::sicd::SICDVersionUpdater(*complexData, version, log).update();
 
-        std::auto_ptr<six::Data> data(complexData.release());
-        writeSicd(data, widebandData, schemaPaths,
-                  options->get<std::string>("output"));
+        six::XMLControlFactory::getInstance().addCreator(
+                six::DataType::COMPLEX,
+                new six::XMLControlCreatorT<six::sicd::ComplexXMLControl>());
+
+        six::Container container(six::DataType::COMPLEX);
+        container.addData(std::auto_ptr<six::Data>(complexData.release()));
+        six::rewriteMetadata(pathname, container, schemaPaths,
+                             options->get<std::string>("output"));
         return 0;
     }
     catch (const except::Exception& ex)
@@ -51,11 +51,61 @@ public:
     /**
      * This function transforms an Vector3 to an LatLonAlt.
      *
+     * The conversion is closed-form (Vermeille, 2002) and accurate to well
+     * under a millimeter.  Only points within about 43 km of the center of
+     * the earth, where the closed form breaks down, fall back to iterating.
+     *
      * @param ecef  The ecef coordinate to transform
      * @return      A LatLonAlt
      */
     LatLonAlt transform(const Vector3& ecef) const;
 
+    /**
+     * This function transforms an array of Vector3's to LatLonAlt's.
+     *
+     * @param ecef       The ecef coordinates to transform
+     * @param numPoints  The number of coordinates in 'ecef' and 'lla'
+     * @param lla        The transformed coordinates
+     * @param numThreads The number of threads to split the points across
+     */
+    void transform(const Vector3* ecef,
+                   size_t numPoints,
+                   LatLonAlt* lla,
+                   size_t numThreads = 1) const;
+
+    /**
+     * This function transforms separate arrays of ECEF X, Y and Z
+     * coordinates to separate arrays of latitude, longitude (both in
+     * degrees) and altitude.
+     *
+     * @param x          The ECEF X coordinates
+     * @param y          The ECEF Y coordinates
+     * @param z          The ECEF Z coordinates
+     * @param numPoints  The number of points in each array
+     * @param lat        The output latitudes in degrees
+     * @param lon        The output longitudes in degrees
+     * @param alt        The output altitudes in meters
+     * @param numThreads The number of threads to split the points across
+     */
+    void transform(const double* x,
+                   const double* y,
+                   const double* z,
+                   size_t numPoints,
+                   double* lat,
+                   double* lon,
+                   double* alt,
+                   size_t numThreads = 1) const;
+
+    /**
+     * This function transforms an Vector3 to an LatLonAlt by iterating on
+     * the reduced latitude.  It's much slower than transform(); it's the
+     * fallback near the center of the earth and a reference for testing.
+     *
+     * @param ecef  The ecef coordinate to transform
+     * @return      A LatLonAlt
+     */
+    LatLonAlt transformIteratively(const Vector3& ecef) const;
+
 private:
     static double computeLongitude(const Vector3& ecef);
     double computeAltitude(const Vector3& ecef, double latitude) const;
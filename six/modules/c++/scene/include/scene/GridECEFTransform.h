@@ -58,6 +58,20 @@ public:
         return rowColToECEF(types::RowCol<double>(row, col));
     }
 
+    /*
+     * Converts an array of row/col pixels to lat/lon/alt.  The pixels are
+     * converted to ECEF and then to lat/lon/alt in a single batch.
+     * \param pixels row/col pixels
+     * \param numPixels Number of pixels in 'pixels' and 'lla'
+     * \param lla Corresponding lat/lon/alt points
+     * \param numThreads Number of threads to use for the ECEF to LLA
+     * conversion
+     */
+    void rowColToLLA(const types::RowCol<double>* pixels,
+                     size_t numPixels,
+                     LatLonAlt* lla,
+                     size_t numThreads = 1) const;
+
     /*
      * Converts from ECEF space to row/col pixel
      * \param p3 ECEF point
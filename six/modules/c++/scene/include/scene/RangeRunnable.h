@@ -0,0 +1,100 @@
+/* =========================================================================
+ * This file is part of scene-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * scene-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SCENE_RANGE_RUNNABLE_H__
+#define __SCENE_RANGE_RUNNABLE_H__
+
+#include <stddef.h>
+#include <memory>
+
+#include <sys/Runnable.h>
+#include <mt/ThreadGroup.h>
+#include <mt/ThreadPlanner.h>
+
+namespace scene
+{
+/*!
+ *  \class RangeRunnable
+ *  \brief Runs a copy of a job over one contiguous range of elements
+ *
+ *  JobT must be copyable and provide
+ *  void operator()(size_t start, size_t num) const
+ */
+template <typename JobT>
+class RangeRunnable : public sys::Runnable
+{
+public:
+    RangeRunnable(const JobT& job, size_t start, size_t num) :
+        mJob(job),
+        mStart(start),
+        mNum(num)
+    {
+    }
+
+    virtual void run()
+    {
+        mJob(mStart, mNum);
+    }
+
+private:
+    const JobT mJob;
+    const size_t mStart;
+    const size_t mNum;
+};
+
+/*!
+ *  Split [0, numElements) into contiguous ranges with mt::ThreadPlanner
+ *  and run job over each range on its own thread.  With one thread or
+ *  one element, the job runs once over the whole range on the calling
+ *  thread.
+ *
+ *  \param job Functor called as job(start, num)
+ *  \param numElements Number of elements to process
+ *  \param numThreads Number of threads to use
+ */
+template <typename JobT>
+void runInParallel(const JobT& job, size_t numElements, size_t numThreads)
+{
+    if (numThreads <= 1 || numElements <= 1)
+    {
+        job(0, numElements);
+        return;
+    }
+
+    mt::ThreadGroup threads;
+    const mt::ThreadPlanner planner(numElements, numThreads);
+
+    size_t threadNum(0);
+    size_t startElement(0);
+    size_t numElementsThisThread(0);
+    while (planner.getThreadInfo(threadNum++,
+                                 startElement,
+                                 numElementsThisThread))
+    {
+        std::auto_ptr<sys::Runnable> runnable(new RangeRunnable<JobT>(
+                job, startElement, numElementsThisThread));
+        threads.createThread(runnable);
+    }
+    threads.joinAll();
+}
+}
+
+#endif
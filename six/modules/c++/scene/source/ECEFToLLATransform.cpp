@@ -19,8 +19,95 @@
  * see <http://www.gnu.org/licenses/>.
  *
  */
-#include "scene/ECEFToLLATransform.h"
+#include <cmath>
+
 #include <math/Utilities.h>
+#include "scene/ECEFToLLATransform.h"
+#include "scene/RangeRunnable.h"
+
+namespace
+{
+// Vermeille, H., "Direct transformation from geocentric coordinates to
+// geodetic coordinates", Journal of Geodesy (2002) 76:451-454
+class ClosedFormECEFToLLA
+{
+public:
+    ClosedFormECEFToLLA(const scene::EllipsoidModel& model) :
+        mA(model.getEquatorialRadius()),
+        mE2(1.0 - math::square(1.0 - model.calculateFlattening())),
+        mE4(mE2 * mE2),
+        mInvA2(1.0 / (mA * mA))
+    {
+    }
+
+    // Returns false for points too close to the center of the earth for
+    // the closed form to apply (r <= 0)
+    bool operator()(double x, double y, double z,
+                    double& latRad, double& lonRad, double& alt) const
+    {
+        const double rho2 = x * x + y * y;
+        const double p = rho2 * mInvA2;
+        const double q = (1.0 - mE2) * mInvA2 * z * z;
+        const double r = (p + q - mE4) / 6.0;
+        if (!(r > 0.0))
+        {
+            return false;
+        }
+
+        const double s = mE4 * p * q / (4.0 * r * r * r);
+        const double t = std::cbrt(1.0 + s + std::sqrt(s * (2.0 + s)));
+        const double u = r * (1.0 + t + 1.0 / t);
+        const double v = std::sqrt(u * u + mE4 * q);
+        const double uv = u + v;
+        const double w = mE2 * (uv - q) / (2.0 * v);
+
+        // Same as sqrt(uv + w^2) - w, without the cancellation
+        const double k = uv / (std::sqrt(uv + w * w) + w);
+        const double d = k * std::sqrt(rho2) / (k + mE2);
+        const double dz = std::sqrt(d * d + z * z);
+
+        latRad = 2.0 * std::atan2(z, dz + d);
+        lonRad = std::atan2(y, x);
+        alt = (k + mE2 - 1.0) / k * dz;
+        return true;
+    }
+
+private:
+    const double mA;
+    const double mE2;
+    const double mE4;
+    const double mInvA2;
+};
+
+struct VectorJob
+{
+    const scene::ECEFToLLATransform* transform;
+    const scene::Vector3* ecef;
+    scene::LatLonAlt* lla;
+
+    void operator()(size_t start, size_t num) const
+    {
+        transform->transform(ecef + start, num, lla + start, 1);
+    }
+};
+
+struct ComponentJob
+{
+    const scene::ECEFToLLATransform* transform;
+    const double* x;
+    const double* y;
+    const double* z;
+    double* lat;
+    double* lon;
+    double* alt;
+
+    void operator()(size_t start, size_t num) const
+    {
+        transform->transform(x + start, y + start, z + start, num,
+                             lat + start, lon + start, alt + start, 1);
+    }
+};
+}
 
 scene::ECEFToLLATransform::ECEFToLLATransform()
  : CoordinateTransform()
@@ -41,6 +128,95 @@ scene::ECEFToLLATransform* scene::ECEFToLLATransform::clone() const
 
 scene::LatLonAlt
 scene::ECEFToLLATransform::transform(const Vector3& ecef) const
+{
+    const ClosedFormECEFToLLA toLLA(*model);
+    double latRad;
+    double lonRad;
+    double alt;
+    if (!toLLA(ecef[0], ecef[1], ecef[2], latRad, lonRad, alt))
+    {
+        return transformIteratively(ecef);
+    }
+
+    LatLonAlt lla;
+    lla.setLatRadians(latRad);
+    lla.setLonRadians(lonRad);
+    lla.setAlt(alt);
+    return lla;
+}
+
+void scene::ECEFToLLATransform::transform(const Vector3* ecef,
+                                          size_t numPoints,
+                                          LatLonAlt* lla,
+                                          size_t numThreads) const
+{
+    if (numThreads > 1 && numPoints > 1)
+    {
+        const VectorJob job = { this, ecef, lla };
+        scene::runInParallel(job, numPoints, numThreads);
+        return;
+    }
+
+    const ClosedFormECEFToLLA toLLA(*model);
+    for (size_t ii = 0; ii < numPoints; ++ii)
+    {
+        const Vector3& point(ecef[ii]);
+        double latRad;
+        double lonRad;
+        double alt;
+        if (toLLA(point[0], point[1], point[2], latRad, lonRad, alt))
+        {
+            lla[ii].setLatRadians(latRad);
+            lla[ii].setLonRadians(lonRad);
+            lla[ii].setAlt(alt);
+        }
+        else
+        {
+            lla[ii] = transformIteratively(point);
+        }
+    }
+}
+
+void scene::ECEFToLLATransform::transform(const double* x,
+                                          const double* y,
+                                          const double* z,
+                                          size_t numPoints,
+                                          double* lat,
+                                          double* lon,
+                                          double* alt,
+                                          size_t numThreads) const
+{
+    if (numThreads > 1 && numPoints > 1)
+    {
+        const ComponentJob job = { this, x, y, z, lat, lon, alt };
+        scene::runInParallel(job, numPoints, numThreads);
+        return;
+    }
+
+    const ClosedFormECEFToLLA toLLA(*model);
+    for (size_t ii = 0; ii < numPoints; ++ii)
+    {
+        if (toLLA(x[ii], y[ii], z[ii], lat[ii], lon[ii], alt[ii]))
+        {
+            lat[ii] *= math::Constants::RADIANS_TO_DEGREES;
+            lon[ii] *= math::Constants::RADIANS_TO_DEGREES;
+        }
+        else
+        {
+            Vector3 point;
+            point[0] = x[ii];
+            point[1] = y[ii];
+            point[2] = z[ii];
+            const LatLonAlt lla = transformIteratively(point);
+            lat[ii] = lla.getLat();
+            lon[ii] = lla.getLon();
+            alt[ii] = lla.getAlt();
+        }
+    }
+}
+
+scene::LatLonAlt
+scene::ECEFToLLATransform::transformIteratively(const Vector3& ecef) const
 {
    LatLonAlt lla;
 
@@ -20,9 +20,12 @@
  *
  */
 
+#include <vector>
+
 #include <sys/Conf.h>
 #include <except/Exception.h>
 #include <scene/Utilities.h>
+#include <scene/ECEFToLLATransform.h>
 #include <scene/GridECEFTransform.h>
 
 namespace scene
@@ -31,6 +34,26 @@ GridECEFTransform::~GridECEFTransform()
 {
 }
 
+void GridECEFTransform::rowColToLLA(const types::RowCol<double>* pixels,
+                                    size_t numPixels,
+                                    LatLonAlt* lla,
+                                    size_t numThreads) const
+{
+    if (numPixels == 0)
+    {
+        return;
+    }
+
+    std::vector<Vector3> ecef(numPixels);
+    for (size_t ii = 0; ii < numPixels; ++ii)
+    {
+        ecef[ii] = rowColToECEF(pixels[ii]);
+    }
+
+    const ECEFToLLATransform toLLA;
+    toLLA.transform(&ecef[0], numPixels, lla, numThreads);
+}
+
 PlanarGridECEFTransform::PlanarGridECEFTransform(
         const types::RowCol<double>& sampleSpacing,
         const types::RowCol<double>& sceneCenter,
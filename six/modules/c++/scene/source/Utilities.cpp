@@ -43,7 +43,9 @@ Vector3 Utilities::latLonToECEF(LatLon latLon)
 
 LatLonAlt Utilities::ecefToLatLon(Vector3 vec)
 {
-    scene::ECEFToLLATransform toLLA;
+    // This is called per-pixel in places, so don't allocate a new
+    // ellipsoid model every time.  transform() is const and thread-safe.
+    static const scene::ECEFToLLATransform toLLA;
     return toLLA.transform(vec);
 }
 
@@ -0,0 +1,191 @@
+/* =========================================================================
+ * This file is part of scene-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * scene-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <stdlib.h>
+#include <cmath>
+#include <vector>
+
+#include "TestCase.h"
+#include <scene/ECEFToLLATransform.h>
+#include <scene/LLAToECEFTransform.h>
+#include <scene/Utilities.h>
+
+namespace
+{
+// Degrees and meters
+const double ANGLE_TOLERANCE = 1e-9;
+const double ALTITUDE_TOLERANCE = 1e-4;
+
+// Latitudes include the poles and points just off them, where the
+// iterative solution is least accurate
+const double LATITUDES[] = { -90.0, -89.9999, -60.0, -0.5, 0.0, 0.5,
+                             33.3, 89.9999, 90.0 };
+const double LONGITUDES[] = { -180.0, -95.5, 0.0, 45.0, 179.9 };
+// From below the ellipsoid to geosynchronous orbit
+const double ALTITUDES[] = { -500.0, 0.0, 10000.0, 800000.0, 35786000.0 };
+
+#define NUM_ELEMENTS(A) (sizeof(A) / sizeof(A[0]))
+
+std::vector<scene::LatLonAlt> getTestPoints()
+{
+    std::vector<scene::LatLonAlt> points;
+    for (size_t ii = 0; ii < NUM_ELEMENTS(LATITUDES); ++ii)
+    {
+        for (size_t jj = 0; jj < NUM_ELEMENTS(LONGITUDES); ++jj)
+        {
+            for (size_t kk = 0; kk < NUM_ELEMENTS(ALTITUDES); ++kk)
+            {
+                points.push_back(scene::LatLonAlt(
+                        LATITUDES[ii], LONGITUDES[jj], ALTITUDES[kk]));
+            }
+        }
+    }
+    return points;
+}
+
+double getRandom()
+{
+    return 2.0 * rand() / RAND_MAX - 1.0;
+}
+
+bool isPole(double latitude)
+{
+    return std::abs(latitude) == 90.0;
+}
+
+TEST_CASE(testRoundTrip)
+{
+    scene::LLAToECEFTransform toECEF;
+    const scene::ECEFToLLATransform toLLA;
+    const std::vector<scene::LatLonAlt> points = getTestPoints();
+    for (size_t ii = 0; ii < points.size(); ++ii)
+    {
+        const scene::LatLonAlt lla = toLLA.transform(
+                toECEF.transform(points[ii]));
+        TEST_ASSERT_ALMOST_EQ_EPS(lla.getLat(), points[ii].getLat(),
+                                  ANGLE_TOLERANCE);
+        TEST_ASSERT_ALMOST_EQ_EPS(lla.getAlt(), points[ii].getAlt(),
+                                  ALTITUDE_TOLERANCE);
+
+        // Longitude is meaningless at the poles
+        if (!isPole(points[ii].getLat()))
+        {
+            // -180 and 180 are the same longitude
+            const double lon = (lla.getLon() - points[ii].getLon() > 180.0) ?
+                    lla.getLon() - 360.0 : lla.getLon();
+            TEST_ASSERT_ALMOST_EQ_EPS(lon, points[ii].getLon(),
+                                      ANGLE_TOLERANCE);
+        }
+    }
+}
+
+TEST_CASE(testMatchesIterative)
+{
+    scene::LLAToECEFTransform toECEF;
+    const scene::ECEFToLLATransform toLLA;
+    const std::vector<scene::LatLonAlt> points = getTestPoints();
+    for (size_t ii = 0; ii < points.size(); ++ii)
+    {
+        // Longitude is meaningless at the poles
+        if (isPole(points[ii].getLat()))
+        {
+            continue;
+        }
+
+        const scene::Vector3 ecef = toECEF.transform(points[ii]);
+        const scene::LatLonAlt closedForm = toLLA.transform(ecef);
+        const scene::LatLonAlt iterative = toLLA.transformIteratively(ecef);
+        TEST_ASSERT_ALMOST_EQ_EPS(closedForm.getLat(), iterative.getLat(),
+                                  ANGLE_TOLERANCE);
+        TEST_ASSERT_ALMOST_EQ_EPS(closedForm.getLon(), iterative.getLon(),
+                                  ANGLE_TOLERANCE);
+        TEST_ASSERT_ALMOST_EQ_EPS(closedForm.getAlt(), iterative.getAlt(),
+                                  ALTITUDE_TOLERANCE);
+    }
+}
+
+TEST_CASE(testNearCenterOfEarth)
+{
+    // The closed form falls back to iterating here
+    const scene::ECEFToLLATransform toLLA;
+    const scene::Vector3 ecef = scene::Utilities::latLonToECEF(
+            scene::LatLonAlt(10.0, 20.0, -6350000.0));
+    const scene::LatLonAlt closedForm = toLLA.transform(ecef);
+    const scene::LatLonAlt iterative = toLLA.transformIteratively(ecef);
+    TEST_ASSERT_EQ(closedForm.getLat(), iterative.getLat());
+    TEST_ASSERT_EQ(closedForm.getLon(), iterative.getLon());
+    TEST_ASSERT_EQ(closedForm.getAlt(), iterative.getAlt());
+}
+
+TEST_CASE(testBatchMatchesPerPoint)
+{
+    const scene::ECEFToLLATransform toLLA;
+    const size_t numPoints = 1001;
+    std::vector<scene::Vector3> ecef(numPoints);
+    std::vector<double> x(numPoints);
+    std::vector<double> y(numPoints);
+    std::vector<double> z(numPoints);
+    std::vector<scene::LatLonAlt> expected(numPoints);
+    for (size_t ii = 0; ii < numPoints; ++ii)
+    {
+        ecef[ii] = scene::Utilities::latLonToECEF(scene::LatLonAlt(
+                90.0 * getRandom(),
+                180.0 * getRandom(),
+                50000.0 * getRandom()));
+        x[ii] = ecef[ii][0];
+        y[ii] = ecef[ii][1];
+        z[ii] = ecef[ii][2];
+        expected[ii] = toLLA.transform(ecef[ii]);
+    }
+
+    const size_t threadCounts[] = { 1, 4 };
+    for (size_t tt = 0; tt < NUM_ELEMENTS(threadCounts); ++tt)
+    {
+        std::vector<scene::LatLonAlt> lla(numPoints);
+        toLLA.transform(&ecef[0], numPoints, &lla[0], threadCounts[tt]);
+
+        std::vector<double> lat(numPoints);
+        std::vector<double> lon(numPoints);
+        std::vector<double> alt(numPoints);
+        toLLA.transform(&x[0], &y[0], &z[0], numPoints,
+                        &lat[0], &lon[0], &alt[0], threadCounts[tt]);
+
+        for (size_t ii = 0; ii < numPoints; ++ii)
+        {
+            TEST_ASSERT_EQ(lla[ii].getLat(), expected[ii].getLat());
+            TEST_ASSERT_EQ(lla[ii].getLon(), expected[ii].getLon());
+            TEST_ASSERT_EQ(lla[ii].getAlt(), expected[ii].getAlt());
+            TEST_ASSERT_EQ(lat[ii], expected[ii].getLat());
+            TEST_ASSERT_EQ(lon[ii], expected[ii].getLon());
+            TEST_ASSERT_EQ(alt[ii], expected[ii].getAlt());
+        }
+    }
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testRoundTrip);
+    TEST_CHECK(testMatchesIterative);
+    TEST_CHECK(testNearCenterOfEarth);
+    TEST_CHECK(testBatchMatchesPerPoint);
+    return 0;
+}
@@ -84,6 +84,11 @@ UByte* ConvertingReadControl::interleaved(Region& region, size_t imageNumber)
         throw except::Exception(Ctxt("Please load ConvertingReadControl "
                 "before calling interleaved()"));
     }
+    if (region.isDecimated())
+    {
+        throw except::NotImplementedException(Ctxt(
+                "Decimated reads are not supported for converted data"));
+    }
     const Data* data = mContainer->getData(imageNumber);
     if (region.getNumRows() == -1)
     {
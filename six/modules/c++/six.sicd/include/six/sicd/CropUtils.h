@@ -37,7 +37,9 @@ namespace sicd
 {
 /*
  * Reads in an AOI from a SICD and creates a cropped SICD, updating the
- * metadata as appropriate to reflect this
+ * metadata as appropriate to reflect this.  The pixels are copied as-is
+ * (no byte swapping) a band of rows at a time, so memory use doesn't
+ * depend on the size of the AOI.
  *
  * \param inPathname Input SICD pathname
  * \param schemaPaths Schema paths to use for reading and writing
@@ -0,0 +1,238 @@
+/* =========================================================================
+ * This file is part of six.sicd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six.sicd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __SIX_SICD_GEO_LOCATION_GRID_H__
+#define __SIX_SICD_GEO_LOCATION_GRID_H__
+
+#include <stddef.h>
+#include <vector>
+
+#include <sys/OS.h>
+#include <types/RowCol.h>
+#include <six/Types.h>
+#include <six/sicd/GeoLocator.h>
+#include <six/sicd/SlantPlanePixelTransformer.h>
+
+namespace six
+{
+namespace sicd
+{
+/*!
+ * \class GeoLocationModel
+ * \brief Exact pixel to lat/lon/alt model that a GeoLocationGrid samples
+ *
+ * When the grid is built with more than one thread, toLLA() is called
+ * concurrently, so implementations must not modify shared state.
+ */
+class GeoLocationModel
+{
+public:
+    virtual ~GeoLocationModel();
+
+    /*!
+     * \param pixel Pixel location in the image
+     * \return Exact location of the pixel
+     */
+    virtual LatLonAlt toLLA(const RowColDouble& pixel) const = 0;
+};
+
+/*!
+ * \class GeoLocatorModel
+ * \brief Samples GeoLocator::geolocate() (output plane projection)
+ */
+class GeoLocatorModel : public GeoLocationModel
+{
+public:
+    /*!
+     * \param locator Locator to sample.  Stored by reference.
+     */
+    GeoLocatorModel(const GeoLocator& locator);
+
+    virtual LatLonAlt toLLA(const RowColDouble& pixel) const;
+
+private:
+    const GeoLocator& mLocator;
+};
+
+/*!
+ * \class SlantPlaneGeoLocationModel
+ * \brief Samples SlantPlanePixelTransformer::toLLA() (ground projection)
+ */
+class SlantPlaneGeoLocationModel : public GeoLocationModel
+{
+public:
+    /*!
+     * \param transformer Transformer to sample.  Stored by reference.
+     */
+    SlantPlaneGeoLocationModel(const SlantPlanePixelTransformer& transformer);
+
+    virtual LatLonAlt toLLA(const RowColDouble& pixel) const;
+
+private:
+    const SlantPlanePixelTransformer& mTransformer;
+};
+
+/*!
+ * \class GeoLocationGrid
+ * \brief Fast geolocation of every pixel in an image
+ *
+ * The exact model is evaluated on a sparse lattice of row and column knots
+ * covering the image.  The interpolated lattice is then checked against the
+ * exact model at the middle of every cell and every cell edge; row or
+ * column intervals whose error exceeds the tolerance are split and the
+ * check is repeated.  Once built, any pixel or tile is geolocated by
+ * interpolating the lattice, which is orders of magnitude cheaper than
+ * running the full projection per pixel.
+ */
+class GeoLocationGrid
+{
+public:
+    enum InterpolationType
+    {
+        BILINEAR,
+        BICUBIC
+    };
+
+    /*!
+     * Build the lattice and refine it until the interpolation error is
+     * within tolerance (or the knots are a pixel apart)
+     *
+     * \param model Exact model.  Only used during construction.
+     * \param dims Number of rows and columns in the image
+     * \param toleranceMeters Maximum allowed distance, in meters, between
+     *        the interpolated and exact locations
+     * \param interpolation Interpolation used both for refinement and for
+     *        all subsequent queries
+     * \param initialSpacing Initial knot spacing in pixels
+     * \param numThreads Number of threads to use when evaluating the model
+     *        and when geolocating tiles
+     */
+    GeoLocationGrid(const GeoLocationModel& model,
+                    const types::RowCol<size_t>& dims,
+                    double toleranceMeters,
+                    InterpolationType interpolation = BICUBIC,
+                    size_t initialSpacing = 64,
+                    size_t numThreads = sys::OS().getNumCPUsAvailable());
+
+    /*!
+     * Geolocate a single pixel
+     * \param rowCol Pixel location in the image
+     * \return Interpolated location
+     */
+    LatLonAlt geolocate(const RowColDouble& rowCol) const;
+
+    /*!
+     * Geolocate every pixel in a tile.  Outputs are stored in row-major
+     * order and must each be dims.area() long.
+     *
+     * \param offset Upper-left pixel of the tile
+     * \param dims Number of rows and columns in the tile
+     * \param lat Output latitudes in degrees
+     * \param lon Output longitudes in degrees, in [-180, 180)
+     * \param alt Output altitudes in meters.  May be NULL.
+     */
+    void geolocate(const types::RowCol<size_t>& offset,
+                   const types::RowCol<size_t>& dims,
+                   double* lat,
+                   double* lon,
+                   double* alt) const;
+
+    //! \return Row positions (in pixels) where the exact model was sampled
+    const std::vector<double>& getRowKnots() const
+    {
+        return mRowKnots;
+    }
+
+    //! \return Column positions (in pixels) where the model was sampled
+    const std::vector<double>& getColKnots() const
+    {
+        return mColKnots;
+    }
+
+    /*!
+     * \return Largest interpolation error, in meters, found at the check
+     *         points of the final lattice
+     */
+    double getMaxError() const
+    {
+        return mMaxError;
+    }
+
+    //! \return Whether the final lattice met the requested tolerance
+    bool isWithinTolerance() const
+    {
+        return mMaxError <= mTolerance;
+    }
+
+    //! \return Number of interpolation taps along each axis
+    size_t getNumTaps() const
+    {
+        return mNumTaps;
+    }
+
+    /*!
+     * Interpolation weights along one axis.  Sample ii uses knots
+     * start[ii] ... start[ii] + taps - 1 with weights
+     * weights[ii * taps] ... weights[ii * taps + taps - 1].
+     */
+    struct AxisWeights
+    {
+        size_t taps;
+        std::vector<size_t> start;
+        std::vector<double> weights;
+    };
+
+private:
+    void evaluateLattice(const GeoLocationModel& model,
+                         const std::vector<double>& oldRowKnots,
+                         const std::vector<double>& oldColKnots);
+
+    // Measure the error and, if allowed, split the failing intervals.
+    // Returns true if the lattice changed.
+    bool refine(const GeoLocationModel& model, bool allowSplit);
+
+    void computeWeights(const std::vector<double>& knots,
+                        const double* positions,
+                        size_t numPositions,
+                        AxisWeights& weights) const;
+
+    const types::RowCol<size_t> mDims;
+    const double mTolerance;
+    const size_t mNumTaps;
+    const size_t mNumThreads;
+
+    std::vector<double> mRowKnots;
+    std::vector<double> mColKnots;
+
+    // Lattice values are stored row-major by knot as separate planes.
+    // Longitudes are unwrapped relative to the first knot so interpolation
+    // across the antimeridian is continuous.
+    std::vector<double> mLat;
+    std::vector<double> mLon;
+    std::vector<double> mAlt;
+
+    double mMaxError;
+};
+}
+}
+
+#endif
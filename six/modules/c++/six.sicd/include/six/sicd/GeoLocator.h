@@ -52,6 +52,19 @@ public:
      */
     LatLonAlt geolocate(const RowColDouble& rowCol) const;
 
+    /*!
+     * Find the locations of many SICD pixels in the output plane
+     * \param rowCols Pixel locations in SICD
+     * \param numPixels Number of pixels in 'rowCols' and 'lla'
+     * \param lla Corresponding locations in output plane
+     * \param numThreads Number of threads to use for the ECEF to LLA
+     *        conversion
+     */
+    void geolocate(const RowColDouble* rowCols,
+                   size_t numPixels,
+                   LatLonAlt* lla,
+                   size_t numThreads = 1) const;
+
 private:
     scene::PlanarGridECEFTransform buildTransformer(
             const ComplexData& complexData, bool shadowsDown) const;
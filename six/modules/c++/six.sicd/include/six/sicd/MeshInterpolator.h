@@ -0,0 +1,220 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_SICD_MESH_INTERPOLATOR_H__
+#define __SIX_SICD_MESH_INTERPOLATOR_H__
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+#include <types/RowCol.h>
+#include <six/sicd/ComplexData.h>
+#include <six/sicd/SICDMesh.h>
+
+namespace six
+{
+namespace sicd
+{
+/*!
+ * \class MeshInterpolator
+ * \brief Interpolates the fields of a NoiseMesh or ScalarMesh
+ *
+ * SICD meshes are stored as flattened X/Y coordinates (distance in meters
+ * from the SCP row and column) with one value per coordinate for each
+ * field.  At construction, the mesh is checked to be a rectilinear grid,
+ * the row and column knots are pulled out, and each field is copied into
+ * its own contiguous plane indexed by number rather than by name.
+ *
+ * Dense evaluation is separable: interpolation weights are computed once
+ * per output row and column, each output row collapses the mesh rows into
+ * a single row of knots, and that row is interpolated across all output
+ * columns.  Output rows are split across threads.  Points outside of the
+ * mesh are extrapolated from the outermost cells.
+ */
+class MeshInterpolator
+{
+public:
+    enum InterpolationType
+    {
+        BILINEAR,
+        BICUBIC
+    };
+
+    /*!
+     * Interpolate the main beam, azimuth ambiguity, and combined noise
+     * fields, in that order.  The field names are the ones
+     * NoiseMesh::getFields() reports.
+     *
+     * \param mesh Noise mesh.  Its values are copied.
+     * \param interpolation Interpolation to use
+     * \param numThreads Number of threads to use for dense evaluation
+     *
+     * \throws except::Exception if the mesh isn't a rectilinear grid with
+     * at least two knots along each axis
+     */
+    MeshInterpolator(const NoiseMesh& mesh,
+                     InterpolationType interpolation = BILINEAR,
+                     size_t numThreads = 1);
+
+    /*!
+     * Interpolate every scalar, in name order
+     *
+     * \param mesh Scalar mesh.  Its values are copied.
+     * \param interpolation Interpolation to use
+     * \param numThreads Number of threads to use for dense evaluation
+     *
+     * \throws except::Exception if the mesh isn't a rectilinear grid with
+     * at least two knots along each axis
+     */
+    MeshInterpolator(const ScalarMesh& mesh,
+                     InterpolationType interpolation = BILINEAR,
+                     size_t numThreads = 1);
+
+    //! \return Names of the fields, in field index order
+    const std::vector<std::string>& getFieldNames() const
+    {
+        return mFieldNames;
+    }
+
+    /*!
+     * Look up a field once so later calls can use its index
+     *
+     * \param name Field name
+     *
+     * \return Index of the field
+     *
+     * \throws except::Exception if there's no such field
+     */
+    size_t getFieldIndex(const std::string& name) const;
+
+    //! \return Mesh X (row) knots, in increasing order
+    const std::vector<double>& getXKnots() const
+    {
+        return mXKnots;
+    }
+
+    //! \return Mesh Y (column) knots, in increasing order
+    const std::vector<double>& getYKnots() const
+    {
+        return mYKnots;
+    }
+
+    /*!
+     * Interpolate at a single point
+     *
+     * \param field Field index
+     * \param x X coordinate (meters from the SCP row)
+     * \param y Y coordinate (meters from the SCP column)
+     *
+     * \return Interpolated value
+     */
+    double interpolate(size_t field, double x, double y) const;
+
+    /*!
+     * Interpolate at scattered points
+     *
+     * \param field Field index
+     * \param x X coordinates
+     * \param y Y coordinates
+     * \param numPoints Number of points
+     * \param[out] output Interpolated values
+     */
+    void interpolate(size_t field,
+                     const double* x,
+                     const double* y,
+                     size_t numPoints,
+                     double* output) const;
+
+    /*!
+     * Interpolate on a regular grid where
+     *     x[ii] = x0 + ii * deltaX
+     *     y[jj] = y0 + jj * deltaY
+     *
+     * \param field Field index
+     * \param x0 First X coordinate
+     * \param deltaX X spacing
+     * \param numX Number of X coordinates
+     * \param y0 First Y coordinate
+     * \param deltaY Y spacing
+     * \param numY Number of Y coordinates
+     * \param[out] output Row-major numX x numY values
+     */
+    void interpolateGrid(size_t field,
+                         double x0,
+                         double deltaX,
+                         size_t numX,
+                         double y0,
+                         double deltaY,
+                         size_t numY,
+                         double* output) const;
+
+    /*!
+     * Interpolate at every pixel of a tile of a SICD
+     *
+     * \param field Field index
+     * \param data SICD metadata.  Its SCP pixel and sample spacing map
+     *        pixels to mesh coordinates.
+     * \param offset First row and column of the tile within the image
+     * \param dims Number of rows and columns in the tile
+     * \param[out] output Row-major dims.area() values
+     */
+    void interpolateTile(size_t field,
+                         const ComplexData& data,
+                         const types::RowCol<size_t>& offset,
+                         const types::RowCol<size_t>& dims,
+                         double* output) const;
+
+    /*!
+     * Interpolation weights along one axis.  Sample ii uses knots
+     * start[ii] ... start[ii] + taps - 1 with weights
+     * weights[ii * taps] ... weights[ii * taps + taps - 1].
+     */
+    struct AxisWeights
+    {
+        size_t taps;
+        std::vector<size_t> start;
+        std::vector<double> weights;
+    };
+
+private:
+    void initialize(const PlanarCoordinateMesh& mesh,
+                    const std::vector<const std::vector<double>*>& fields);
+
+    void computeWeights(const std::vector<double>& knots,
+                        const double* positions,
+                        size_t numPositions,
+                        AxisWeights& weights) const;
+
+    const size_t mNumTaps;
+    const size_t mNumThreads;
+
+    std::vector<std::string> mFieldNames;
+    std::vector<double> mXKnots;
+    std::vector<double> mYKnots;
+
+    // One row-major plane per field, ordered to match the sorted knots
+    std::vector<std::vector<double> > mFields;
+};
+}
+}
+
+#endif
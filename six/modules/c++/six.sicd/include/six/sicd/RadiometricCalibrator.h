@@ -0,0 +1,156 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_SICD_RADIOMETRIC_CALIBRATOR_H__
+#define __SIX_SICD_RADIOMETRIC_CALIBRATOR_H__
+
+#include <stddef.h>
+#include <vector>
+
+#include <mem/SharedPtr.h>
+#include <types/RowCol.h>
+#include <six/PolyEvaluator.h>
+#include <six/Types.h>
+#include <six/sicd/ComplexData.h>
+
+namespace six
+{
+namespace sicd
+{
+/*!
+ * \class RadiometricCalibrator
+ * \brief Applies a SICD's radiometric scale factors to its pixels
+ *
+ * The Radiometric polynomials are functions of the row and column distance
+ * in meters from the SCP, so over a tile they're evaluated on a regular
+ * grid with Poly2DEvaluator (which collapses each row to a 1-D polynomial
+ * and evaluates it across the columns at once).
+ *
+ * Calibrated power is
+ *     (|pixel|^2 - noise) * scaleFactor
+ * where the noise term is only included if requested.  Tiles are split
+ * into bands of rows that are calibrated in parallel.
+ */
+class RadiometricCalibrator
+{
+public:
+    //! Which scale factor polynomial to apply
+    enum CalibrationType
+    {
+        RCS,
+        SIGMA_ZERO,
+        BETA_ZERO,
+        GAMMA_ZERO
+    };
+
+    //! Form of the calibrated output
+    enum OutputType
+    {
+        POWER,
+        POWER_DB,
+        AMPLITUDE
+    };
+
+    /*!
+     * \param data SICD metadata.  The pixel type, SCP pixel, sample
+     *        spacing, amplitude table, and radiometric polynomials are
+     *        copied out of it.
+     * \param calibrationType Scale factor to apply
+     * \param outputType Form of the output
+     * \param subtractNoise Whether to subtract the noise power before
+     *        scaling.  When this is set, negative power is clamped to zero
+     *        for the dB and amplitude outputs (so noise-only pixels are
+     *        -inf dB).
+     *
+     * \throws except::Exception if the data has no radiometric
+     * parameters, the requested polynomial is empty, or noise subtraction
+     * is requested without an absolute noise polynomial
+     */
+    RadiometricCalibrator(const ComplexData& data,
+                          CalibrationType calibrationType,
+                          OutputType outputType = POWER,
+                          bool subtractNoise = false);
+
+    /*!
+     * Calibrate a tile
+     *
+     * \param pixels Row-major tile of pixels in the SICD's pixel type and
+     *        native byte order (as NITFReadControl::interleaved() returns
+     *        them)
+     * \param offset Row and column of the first pixel of the tile within
+     *        the image
+     * \param dims Number of rows and columns in the tile
+     * \param[out] output Row-major calibrated values, dims.area() of them
+     * \param numThreads Number of threads to split the rows across
+     */
+    void calibrate(const UByte* pixels,
+                   const types::RowCol<size_t>& offset,
+                   const types::RowCol<size_t>& dims,
+                   float* output,
+                   size_t numThreads = 1) const;
+
+    /*!
+     * Calibrate a single pixel.  This is much slower than calibrating a
+     * tile; it's mostly useful for spot checks.
+     *
+     * \param power Pixel power (|pixel|^2)
+     * \param row Row of the pixel within the image
+     * \param col Column of the pixel within the image
+     *
+     * \return Calibrated value
+     */
+    double calibrate(double power, double row, double col) const;
+
+    /*!
+     * Calibrate a band of rows of a tile.  This is what each thread of
+     * calibrate() runs.
+     *
+     * \param pixels First pixel of the band
+     * \param offset Row and column of the first pixel within the image
+     * \param dims Number of rows and columns in the band
+     * \param[out] output Calibrated values for the band
+     */
+    void calibrateBand(const UByte* pixels,
+                       const types::RowCol<size_t>& offset,
+                       const types::RowCol<size_t>& dims,
+                       float* output) const;
+
+private:
+    void computePower(const UByte* pixels,
+                      size_t numPixels,
+                      double* power) const;
+
+    void finish(const double* power, size_t numPixels, float* output) const;
+
+private:
+    PixelType mPixelType;
+    size_t mNumBytesPerPixel;
+    OutputType mOutputType;
+    types::RowCol<double> mSCPPixel;
+    types::RowCol<double> mSampleSpacing;
+    std::vector<double> mAmplitudePower;
+    mem::SharedPtr<const Poly2DEvaluator> mScaleFactor;
+    mem::SharedPtr<const Poly2DEvaluator> mNoise;
+};
+}
+}
+
+#endif
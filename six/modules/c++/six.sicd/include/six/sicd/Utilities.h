@@ -32,6 +32,7 @@
 #include <six/sicd/ComplexData.h>
 #include <six/sicd/SICDMesh.h>
 #include <six/NITFReadControl.h>
+#include <six/ValidDataMask.h>
 #include <six/sicd/AreaPlaneUtility.h>
 
 namespace six
@@ -94,6 +95,16 @@ public:
             const scene::ProjectionModel& projection,
             std::vector<types::RowCol<double> >& validData);
 
+    /*
+     * Rasterize the SICD's valid data polygon.  If there isn't one, the
+     * whole image is valid.
+     *
+     * \param sicdData SICD metadata
+     *
+     * \return Valid columns of every row of the image
+     */
+    static ValidDataMask getValidDataMask(const ComplexData& sicdData);
+
     /*
      * Given a SICD path name and a list of schema, this function reads
      * and parses the SICD in order to provide the wideband data as well
@@ -941,7 +941,7 @@ void ComplexXMLParser::parseImageDataFromXML(
             xml::lite::Attributes atts = ampXML->getAttributes();
             if (atts.contains("index"))
             {
-                int index = str::toType<int>(atts.getValue("index"));
+                int index = six::toNumber<int>(atts.getValue("index"));
                 if (index < 0 || index > 255)
                 {
                     log()->warn(Ctxt(
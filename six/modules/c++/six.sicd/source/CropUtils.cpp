@@ -26,9 +26,10 @@
 #include <sys/Conf.h>
 #include <except/Exception.h>
 #include <str/Convert.h>
-#include <mem/ScopedArray.h>
-#include <six/NITFWriteControl.h>
+#include <io/FileOutputStream.h>
+#include <six/StreamingCrop.h>
 #include <six/sicd/CropUtils.h>
+#include <six/sicd/SICDByteProvider.h>
 #include <six/sicd/Utilities.h>
 #include <six/sicd/SlantPlanePixelTransformer.h>
 
@@ -106,31 +107,17 @@ void cropSICD(six::NITFReadControl& reader,
         throw except::Exception(Ctxt("AOI must be non-empty"));
     }
 
-    // Read in the AOI
-    const size_t numBytesPerPixel(data.getNumBytesPerPixel());
-    const size_t numBytes(origDims.row * origDims.col * numBytesPerPixel);
-    const mem::ScopedArray<sys::ubyte> buffer(new sys::ubyte[numBytes]);
-
-    six::Region region;
-    region.setStartRow(aoiOffset.row);
-    region.setStartCol(aoiOffset.col);
-    region.setNumRows(aoiDims.row);
-    region.setNumCols(aoiDims.col);
-    region.setBuffer(buffer.get());
-    reader.interleaved(region, 0);
-
     six::sicd::ComplexData* const aoiData = updateMetadata(
             data, geom,  projection,
             aoiOffset, aoiDims);
-    std::auto_ptr<six::Data> scopedData(aoiData);
-
-    // Write the AOI SICD out
-    mem::SharedPtr<six::Container> container(new six::Container(
-            six::DataType::COMPLEX));
-    container->addData(scopedData);
-    six::NITFWriteControl writer(container);
-    six::BufferList images(1, buffer.get());
-    writer.save(images, outPathname, schemaPaths);
+    const std::auto_ptr<const six::sicd::ComplexData> scopedData(aoiData);
+
+    // Copy the AOI into the cropped SICD a band of rows at a time
+    const six::sicd::SICDByteProvider byteProvider(*aoiData, schemaPaths);
+    io::FileOutputStream outStream(outPathname);
+    six::streamCrop(reader, 0, aoiOffset, *aoiData, byteProvider, false,
+                    outStream);
+    outStream.close();
 }
 
 }
@@ -0,0 +1,662 @@
+/* =========================================================================
+ * This file is part of six.sicd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six.sicd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+
+#include <except/Exception.h>
+#include <scene/RangeRunnable.h>
+#include <scene/Utilities.h>
+#include <six/sicd/GeoLocationGrid.h>
+
+namespace
+{
+const size_t NOT_FOUND = static_cast<size_t>(-1);
+
+// Don't bother refining forever if the model is badly behaved
+const size_t MAX_REFINEMENT_PASSES = 16;
+
+double unwrapLongitude(double lon, double reference)
+{
+    return lon + 360.0 * std::floor((reference - lon) / 360.0 + 0.5);
+}
+
+double wrapLongitude(double lon)
+{
+    return lon - 360.0 * std::floor((lon + 180.0) / 360.0);
+}
+
+double distanceMeters(double lat0, double lon0, double alt0,
+                      const six::LatLonAlt& exact)
+{
+    const scene::Vector3 p0 = scene::Utilities::latLonToECEF(
+            six::LatLonAlt(lat0, lon0, alt0));
+    const scene::Vector3 p1 = scene::Utilities::latLonToECEF(exact);
+    return (p0 - p1).norm();
+}
+
+std::vector<double> makeKnots(size_t numPixels, size_t spacing)
+{
+    // Always have at least two knots so that each axis can be interpolated
+    const double last = static_cast<double>(std::max<size_t>(numPixels, 2) - 1);
+    std::vector<double> knots;
+    for (double pos = 0; pos < last; pos += static_cast<double>(spacing))
+    {
+        knots.push_back(pos);
+    }
+    knots.push_back(last);
+    return knots;
+}
+
+// For each entry in 'knots', the index of the same knot in 'oldKnots'
+std::vector<size_t> mapKnots(const std::vector<double>& knots,
+                             const std::vector<double>& oldKnots)
+{
+    std::vector<size_t> mapping(knots.size(), NOT_FOUND);
+    for (size_t ii = 0, jj = 0; ii < knots.size(); ++ii)
+    {
+        while (jj < oldKnots.size() && oldKnots[jj] < knots[ii])
+        {
+            ++jj;
+        }
+        if (jj < oldKnots.size() && oldKnots[jj] == knots[ii])
+        {
+            mapping[ii] = jj;
+        }
+    }
+    return mapping;
+}
+
+// Evaluates the exact model at lattice knots that aren't already known
+class EvaluateLatticeJob
+{
+public:
+    struct Args
+    {
+        const six::sicd::GeoLocationModel* model;
+        const std::vector<double>* rowKnots;
+        const std::vector<double>* colKnots;
+        const std::vector<size_t>* oldRows;
+        const std::vector<size_t>* oldCols;
+        size_t oldNumCols;
+        const double* oldLat;
+        const double* oldLon;
+        const double* oldAlt;
+        double* lat;
+        double* lon;
+        double* alt;
+    };
+
+    explicit EvaluateLatticeJob(const Args& args) :
+        mArgs(args)
+    {
+    }
+
+    void operator()(size_t startRow, size_t numRows) const
+    {
+        const size_t numCols = mArgs.colKnots->size();
+        for (size_t row = startRow; row < startRow + numRows; ++row)
+        {
+            const size_t oldRow = (*mArgs.oldRows)[row];
+            for (size_t col = 0; col < numCols; ++col)
+            {
+                const size_t idx = row * numCols + col;
+                const size_t oldCol = (*mArgs.oldCols)[col];
+                if (oldRow != NOT_FOUND && oldCol != NOT_FOUND)
+                {
+                    const size_t oldIdx = oldRow * mArgs.oldNumCols + oldCol;
+                    mArgs.lat[idx] = mArgs.oldLat[oldIdx];
+                    mArgs.lon[idx] = mArgs.oldLon[oldIdx];
+                    mArgs.alt[idx] = mArgs.oldAlt[oldIdx];
+                }
+                else
+                {
+                    const six::LatLonAlt lla = mArgs.model->toLLA(
+                            six::RowColDouble((*mArgs.rowKnots)[row],
+                                              (*mArgs.colKnots)[col]));
+                    mArgs.lat[idx] = lla.getLat();
+                    mArgs.lon[idx] = lla.getLon();
+                    mArgs.alt[idx] = lla.getAlt();
+                }
+            }
+        }
+    }
+
+private:
+    const Args mArgs;
+};
+
+// Compares the lattice against the exact model in the middle of each cell
+// and of its top and left edges, plus the bottom edges of the last row of
+// cells and the right edges of the last column
+class CheckCellsJob
+{
+public:
+    struct Args
+    {
+        const six::sicd::GeoLocationModel* model;
+        const six::sicd::GeoLocationGrid* grid;
+        const std::vector<double>* rowKnots;
+        const std::vector<double>* colKnots;
+        double tolerance;
+        // Per cell, bit 0 = split the row interval, bit 1 = split the
+        // column interval
+        unsigned char* splits;
+        // Per row of cells
+        double* maxErrors;
+    };
+
+    explicit CheckCellsJob(const Args& args) :
+        mArgs(args)
+    {
+    }
+
+    void operator()(size_t startRow, size_t numRows) const
+    {
+        const std::vector<double>& rowKnots(*mArgs.rowKnots);
+        const std::vector<double>& colKnots(*mArgs.colKnots);
+        const size_t numCells = colKnots.size() - 1;
+        const size_t lastRow = rowKnots.size() - 2;
+
+        for (size_t row = startRow; row < startRow + numRows; ++row)
+        {
+            const double top = rowKnots[row];
+            const double bottom = rowKnots[row + 1];
+            const double midRow = 0.5 * (top + bottom);
+            double maxError = 0.0;
+
+            for (size_t col = 0; col < numCells; ++col)
+            {
+                const double left = colKnots[col];
+                const double right = colKnots[col + 1];
+                const double midCol = 0.5 * (left + right);
+
+                // Along the top edge, only the column interpolation matters
+                // and along the left edge, only the row interpolation does.
+                // Every other edge is the top or left edge of another cell.
+                double topError = check(top, midCol);
+                if (row == lastRow)
+                {
+                    topError = std::max(topError, check(bottom, midCol));
+                }
+                double leftError = check(midRow, left);
+                if (col == numCells - 1)
+                {
+                    leftError = std::max(leftError, check(midRow, right));
+                }
+                const double centerError = check(midRow, midCol);
+
+                unsigned char split = 0;
+                if (leftError > mArgs.tolerance)
+                {
+                    split |= 1;
+                }
+                if (topError > mArgs.tolerance)
+                {
+                    split |= 2;
+                }
+                if (split == 0 && centerError > mArgs.tolerance)
+                {
+                    split = 3;
+                }
+                mArgs.splits[row * numCells + col] = split;
+
+                maxError = std::max(maxError,
+                        std::max(centerError, std::max(topError, leftError)));
+            }
+            mArgs.maxErrors[row] = maxError;
+        }
+    }
+
+private:
+    double check(double row, double col) const
+    {
+        const six::RowColDouble pixel(row, col);
+        const six::LatLonAlt interpolated = mArgs.grid->geolocate(pixel);
+        const six::LatLonAlt exact = mArgs.model->toLLA(pixel);
+        return distanceMeters(interpolated.getLat(),
+                              interpolated.getLon(),
+                              interpolated.getAlt(),
+                              exact);
+    }
+
+    const Args mArgs;
+};
+
+// Interpolates a block of tile rows
+class InterpolateTileJob
+{
+public:
+    struct Args
+    {
+        const six::sicd::GeoLocationGrid::AxisWeights* rowWeights;
+        const six::sicd::GeoLocationGrid::AxisWeights* colWeights;
+        size_t latticeCols;
+        const double* lat;
+        const double* lon;
+        const double* alt;
+        size_t tileCols;
+        double* outLat;
+        double* outLon;
+        double* outAlt;
+    };
+
+    explicit InterpolateTileJob(const Args& args) :
+        mArgs(args)
+    {
+    }
+
+    void operator()(size_t startRow, size_t numRows) const
+    {
+        const six::sicd::GeoLocationGrid::AxisWeights& rowW(
+                *mArgs.rowWeights);
+        const six::sicd::GeoLocationGrid::AxisWeights& colW(
+                *mArgs.colWeights);
+        const size_t numCols = mArgs.tileCols;
+        const size_t colTaps = colW.taps;
+        const size_t rowTaps = rowW.taps;
+
+        // Only the lattice columns this tile touches need to be collapsed
+        const size_t firstKnot = colW.start.front();
+        const size_t numKnots = colW.start.back() + colTaps - firstKnot;
+
+        // Start indices relative to the first knot, so the inner loop is a
+        // simple gather from the collapsed row
+        std::vector<size_t> colStart(numCols);
+        for (size_t col = 0; col < numCols; ++col)
+        {
+            colStart[col] = colW.start[col] - firstKnot;
+        }
+        const double* const colWeights = &colW.weights[0];
+
+        std::vector<double> latRow(numKnots);
+        std::vector<double> lonRow(numKnots);
+        std::vector<double> altRow(numKnots);
+
+        for (size_t row = startRow; row < startRow + numRows; ++row)
+        {
+            const double* const weights = &rowW.weights[row * rowTaps];
+            const size_t offset =
+                    rowW.start[row] * mArgs.latticeCols + firstKnot;
+
+            // Collapse the lattice rows into one row of knots
+            std::fill(latRow.begin(), latRow.end(), 0.0);
+            std::fill(lonRow.begin(), lonRow.end(), 0.0);
+            std::fill(altRow.begin(), altRow.end(), 0.0);
+            for (size_t tap = 0; tap < rowTaps; ++tap)
+            {
+                const double weight = weights[tap];
+                const size_t base = offset + tap * mArgs.latticeCols;
+                const double* const lat = mArgs.lat + base;
+                const double* const lon = mArgs.lon + base;
+                const double* const alt = mArgs.alt + base;
+                for (size_t knot = 0; knot < numKnots; ++knot)
+                {
+                    latRow[knot] += weight * lat[knot];
+                    lonRow[knot] += weight * lon[knot];
+                    altRow[knot] += weight * alt[knot];
+                }
+            }
+
+            // Then interpolate along the row
+            const size_t outOffset = row * numCols;
+            double* const outLat = mArgs.outLat + outOffset;
+            double* const outLon = mArgs.outLon + outOffset;
+            double* const outAlt = mArgs.outAlt ?
+                    mArgs.outAlt + outOffset : NULL;
+            for (size_t col = 0; col < numCols; ++col)
+            {
+                const double* const w = colWeights + col * colTaps;
+                const size_t start = colStart[col];
+                double latSum = 0.0;
+                double lonSum = 0.0;
+                for (size_t tap = 0; tap < colTaps; ++tap)
+                {
+                    latSum += w[tap] * latRow[start + tap];
+                    lonSum += w[tap] * lonRow[start + tap];
+                }
+                outLat[col] = latSum;
+                outLon[col] = wrapLongitude(lonSum);
+            }
+            if (outAlt)
+            {
+                for (size_t col = 0; col < numCols; ++col)
+                {
+                    const double* const w = colWeights + col * colTaps;
+                    const size_t start = colStart[col];
+                    double altSum = 0.0;
+                    for (size_t tap = 0; tap < colTaps; ++tap)
+                    {
+                        altSum += w[tap] * altRow[start + tap];
+                    }
+                    outAlt[col] = altSum;
+                }
+            }
+        }
+    }
+
+private:
+    const Args mArgs;
+};
+}
+
+namespace six
+{
+namespace sicd
+{
+GeoLocationModel::~GeoLocationModel()
+{
+}
+
+GeoLocatorModel::GeoLocatorModel(const GeoLocator& locator) :
+    mLocator(locator)
+{
+}
+
+LatLonAlt GeoLocatorModel::toLLA(const RowColDouble& pixel) const
+{
+    return mLocator.geolocate(pixel);
+}
+
+SlantPlaneGeoLocationModel::SlantPlaneGeoLocationModel(
+        const SlantPlanePixelTransformer& transformer) :
+    mTransformer(transformer)
+{
+}
+
+LatLonAlt SlantPlaneGeoLocationModel::toLLA(const RowColDouble& pixel) const
+{
+    return mTransformer.toLLA(pixel);
+}
+
+GeoLocationGrid::GeoLocationGrid(const GeoLocationModel& model,
+                                 const types::RowCol<size_t>& dims,
+                                 double toleranceMeters,
+                                 InterpolationType interpolation,
+                                 size_t initialSpacing,
+                                 size_t numThreads) :
+    mDims(dims),
+    mTolerance(toleranceMeters),
+    mNumTaps(interpolation == BICUBIC ? 4 : 2),
+    mNumThreads(numThreads),
+    mMaxError(std::numeric_limits<double>::infinity())
+{
+    if (dims.row == 0 || dims.col == 0)
+    {
+        throw except::Exception(Ctxt("Image must have non-zero dimensions"));
+    }
+    if (initialSpacing == 0)
+    {
+        throw except::Exception(Ctxt("Knot spacing must be positive"));
+    }
+    if (!(toleranceMeters > 0))
+    {
+        throw except::Exception(Ctxt("Tolerance must be positive"));
+    }
+
+    mRowKnots = makeKnots(dims.row, initialSpacing);
+    mColKnots = makeKnots(dims.col, initialSpacing);
+    evaluateLattice(model, std::vector<double>(), std::vector<double>());
+
+    // The last pass only measures the error
+    for (size_t pass = 1; refine(model, pass < MAX_REFINEMENT_PASSES); ++pass)
+    {
+    }
+}
+
+void GeoLocationGrid::evaluateLattice(const GeoLocationModel& model,
+                                      const std::vector<double>& oldRowKnots,
+                                      const std::vector<double>& oldColKnots)
+{
+    const std::vector<size_t> oldRows = mapKnots(mRowKnots, oldRowKnots);
+    const std::vector<size_t> oldCols = mapKnots(mColKnots, oldColKnots);
+    const size_t numKnots = mRowKnots.size() * mColKnots.size();
+
+    std::vector<double> lat(numKnots);
+    std::vector<double> lon(numKnots);
+    std::vector<double> alt(numKnots);
+
+    EvaluateLatticeJob::Args args;
+    args.model = &model;
+    args.rowKnots = &mRowKnots;
+    args.colKnots = &mColKnots;
+    args.oldRows = &oldRows;
+    args.oldCols = &oldCols;
+    args.oldNumCols = oldColKnots.size();
+    args.oldLat = mLat.empty() ? NULL : &mLat[0];
+    args.oldLon = mLon.empty() ? NULL : &mLon[0];
+    args.oldAlt = mAlt.empty() ? NULL : &mAlt[0];
+    args.lat = &lat[0];
+    args.lon = &lon[0];
+    args.alt = &alt[0];
+    scene::runInParallel(EvaluateLatticeJob(args), mRowKnots.size(),
+                         mNumThreads);
+
+    // Copied knots are already unwrapped, and unwrapping is idempotent
+    for (size_t ii = 0; ii < numKnots; ++ii)
+    {
+        lon[ii] = unwrapLongitude(lon[ii], lon[0]);
+    }
+
+    mLat.swap(lat);
+    mLon.swap(lon);
+    mAlt.swap(alt);
+}
+
+bool GeoLocationGrid::refine(const GeoLocationModel& model, bool allowSplit)
+{
+    const size_t numRowCells = mRowKnots.size() - 1;
+    const size_t numColCells = mColKnots.size() - 1;
+    std::vector<unsigned char> splits(numRowCells * numColCells);
+    std::vector<double> maxErrors(numRowCells);
+
+    CheckCellsJob::Args args;
+    args.model = &model;
+    args.grid = this;
+    args.rowKnots = &mRowKnots;
+    args.colKnots = &mColKnots;
+    args.tolerance = mTolerance;
+    args.splits = &splits[0];
+    args.maxErrors = &maxErrors[0];
+    scene::runInParallel(CheckCellsJob(args), numRowCells, mNumThreads);
+
+    mMaxError = *std::max_element(maxErrors.begin(), maxErrors.end());
+    if (mMaxError <= mTolerance || !allowSplit)
+    {
+        return false;
+    }
+
+    std::vector<bool> splitRow(numRowCells, false);
+    std::vector<bool> splitCol(numColCells, false);
+    for (size_t row = 0; row < numRowCells; ++row)
+    {
+        for (size_t col = 0; col < numColCells; ++col)
+        {
+            const unsigned char split = splits[row * numColCells + col];
+            if (split & 1)
+            {
+                splitRow[row] = true;
+            }
+            if (split & 2)
+            {
+                splitCol[col] = true;
+            }
+        }
+    }
+
+    // Knots stay on whole pixels, so intervals a pixel wide are final
+    bool refined = false;
+    std::vector<double> rowKnots;
+    for (size_t row = 0; row < numRowCells; ++row)
+    {
+        rowKnots.push_back(mRowKnots[row]);
+        const double mid = std::floor(0.5 * (mRowKnots[row] +
+                                             mRowKnots[row + 1]));
+        if (splitRow[row] && mid > mRowKnots[row])
+        {
+            rowKnots.push_back(mid);
+            refined = true;
+        }
+    }
+    rowKnots.push_back(mRowKnots.back());
+
+    std::vector<double> colKnots;
+    for (size_t col = 0; col < numColCells; ++col)
+    {
+        colKnots.push_back(mColKnots[col]);
+        const double mid = std::floor(0.5 * (mColKnots[col] +
+                                             mColKnots[col + 1]));
+        if (splitCol[col] && mid > mColKnots[col])
+        {
+            colKnots.push_back(mid);
+            refined = true;
+        }
+    }
+    colKnots.push_back(mColKnots.back());
+
+    if (!refined)
+    {
+        return false;
+    }
+
+    rowKnots.swap(mRowKnots);
+    colKnots.swap(mColKnots);
+    evaluateLattice(model, rowKnots, colKnots);
+    return true;
+}
+
+void GeoLocationGrid::computeWeights(const std::vector<double>& knots,
+                                     const double* positions,
+                                     size_t numPositions,
+                                     AxisWeights& weights) const
+{
+    const size_t numKnots = knots.size();
+    const size_t taps = std::min(mNumTaps, numKnots);
+    weights.taps = taps;
+    weights.start.resize(numPositions);
+    weights.weights.resize(numPositions * taps);
+
+    for (size_t ii = 0; ii < numPositions; ++ii)
+    {
+        const double x = positions[ii];
+
+        // Find the cell containing x, clamping so that positions outside
+        // the lattice extrapolate from the outermost cell
+        size_t cell = std::upper_bound(knots.begin(), knots.end(), x) -
+                knots.begin();
+        cell = (cell == 0) ? 0 : std::min(cell - 1, numKnots - 2);
+
+        // Center the stencil on the cell, shifting it at the edges
+        size_t start = (cell + 1 >= taps / 2) ? cell + 1 - taps / 2 : 0;
+        start = std::min(start, numKnots - taps);
+        weights.start[ii] = start;
+
+        // Lagrange weights handle the non-uniform knot spacing
+        double* const w = &weights.weights[ii * taps];
+        for (size_t tap = 0; tap < taps; ++tap)
+        {
+            double weight = 1.0;
+            const double knot = knots[start + tap];
+            for (size_t other = 0; other < taps; ++other)
+            {
+                if (other != tap)
+                {
+                    const double otherKnot = knots[start + other];
+                    weight *= (x - otherKnot) / (knot - otherKnot);
+                }
+            }
+            w[tap] = weight;
+        }
+    }
+}
+
+LatLonAlt GeoLocationGrid::geolocate(const RowColDouble& rowCol) const
+{
+    AxisWeights rowWeights;
+    AxisWeights colWeights;
+    computeWeights(mRowKnots, &rowCol.row, 1, rowWeights);
+    computeWeights(mColKnots, &rowCol.col, 1, colWeights);
+
+    const size_t numCols = mColKnots.size();
+    double lat = 0.0;
+    double lon = 0.0;
+    double alt = 0.0;
+    for (size_t rr = 0; rr < rowWeights.taps; ++rr)
+    {
+        const size_t rowOffset = (rowWeights.start[0] + rr) * numCols;
+        for (size_t cc = 0; cc < colWeights.taps; ++cc)
+        {
+            const size_t idx = rowOffset + colWeights.start[0] + cc;
+            const double weight =
+                    rowWeights.weights[rr] * colWeights.weights[cc];
+            lat += weight * mLat[idx];
+            lon += weight * mLon[idx];
+            alt += weight * mAlt[idx];
+        }
+    }
+
+    return LatLonAlt(lat, wrapLongitude(lon), alt);
+}
+
+void GeoLocationGrid::geolocate(const types::RowCol<size_t>& offset,
+                                const types::RowCol<size_t>& dims,
+                                double* lat,
+                                double* lon,
+                                double* alt) const
+{
+    if (dims.row == 0 || dims.col == 0)
+    {
+        return;
+    }
+
+    std::vector<double> positions(std::max(dims.row, dims.col));
+    AxisWeights rowWeights;
+    for (size_t row = 0; row < dims.row; ++row)
+    {
+        positions[row] = static_cast<double>(offset.row + row);
+    }
+    computeWeights(mRowKnots, &positions[0], dims.row, rowWeights);
+
+    AxisWeights colWeights;
+    for (size_t col = 0; col < dims.col; ++col)
+    {
+        positions[col] = static_cast<double>(offset.col + col);
+    }
+    computeWeights(mColKnots, &positions[0], dims.col, colWeights);
+
+    InterpolateTileJob::Args args;
+    args.rowWeights = &rowWeights;
+    args.colWeights = &colWeights;
+    args.latticeCols = mColKnots.size();
+    args.lat = &mLat[0];
+    args.lon = &mLon[0];
+    args.alt = &mAlt[0];
+    args.tileCols = dims.col;
+    args.outLat = lat;
+    args.outLon = lon;
+    args.outAlt = alt;
+    scene::runInParallel(InterpolateTileJob(args), dims.row, mNumThreads);
+}
+}
+}
@@ -37,6 +37,14 @@ LatLonAlt GeoLocator::geolocate(const RowColDouble& rowCol) const
     return mEcefToLla.transform(mRowColToEcef.rowColToECEF(rowCol));
 }
 
+void GeoLocator::geolocate(const RowColDouble* rowCols,
+                           size_t numPixels,
+                           LatLonAlt* lla,
+                           size_t numThreads) const
+{
+    mRowColToEcef.rowColToLLA(rowCols, numPixels, lla, numThreads);
+}
+
 scene::PlanarGridECEFTransform
 GeoLocator::buildTransformer(const ComplexData& complexData, bool shadowsDown) const
 {
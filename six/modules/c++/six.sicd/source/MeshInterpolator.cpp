@@ -0,0 +1,433 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <cmath>
+
+#include <except/Exception.h>
+#include <scene/RangeRunnable.h>
+#include <str/Convert.h>
+#include <six/sicd/MeshInterpolator.h>
+
+namespace
+{
+// Pulls the knots along one axis out of the flattened coordinates,
+// checking that the coordinate is constant along the other axis.  'stride'
+// steps between knots and 'otherStride' along the other axis.
+void getKnots(const std::vector<double>& coords,
+              size_t numKnots,
+              size_t stride,
+              size_t numOther,
+              size_t otherStride,
+              std::vector<double>& knots)
+{
+    knots.resize(numKnots);
+    for (size_t ii = 0; ii < numKnots; ++ii)
+    {
+        knots[ii] = coords[ii * stride];
+    }
+
+    const double tolerance = 1e-9 * std::max(
+            1.0, std::abs(knots.back() - knots.front()));
+    for (size_t ii = 0; ii < numKnots; ++ii)
+    {
+        for (size_t jj = 1; jj < numOther; ++jj)
+        {
+            if (std::abs(coords[ii * stride + jj * otherStride] - knots[ii]) >
+                tolerance)
+            {
+                throw except::Exception(Ctxt(
+                        "Mesh is not a rectilinear grid"));
+            }
+        }
+    }
+}
+
+// Returns true if the knots are decreasing (and reverses them).  Throws if
+// they aren't strictly monotonic.
+bool sortKnots(std::vector<double>& knots)
+{
+    const bool reversed = knots.back() < knots.front();
+    if (reversed)
+    {
+        std::reverse(knots.begin(), knots.end());
+    }
+
+    for (size_t ii = 1; ii < knots.size(); ++ii)
+    {
+        if (!(knots[ii] > knots[ii - 1]))
+        {
+            throw except::Exception(Ctxt(
+                    "Mesh coordinates must be strictly monotonic"));
+        }
+    }
+    return reversed;
+}
+
+// Interpolates a block of output rows
+class InterpolateGridJob
+{
+public:
+    struct Args
+    {
+        const six::sicd::MeshInterpolator::AxisWeights* rowWeights;
+        const six::sicd::MeshInterpolator::AxisWeights* colWeights;
+        size_t meshCols;
+        const double* values;
+        size_t numCols;
+        double* output;
+    };
+
+    explicit InterpolateGridJob(const Args& args) :
+        mArgs(args)
+    {
+    }
+
+    void operator()(size_t startRow, size_t numRows) const
+    {
+        const six::sicd::MeshInterpolator::AxisWeights& rowW(
+                *mArgs.rowWeights);
+        const six::sicd::MeshInterpolator::AxisWeights& colW(
+                *mArgs.colWeights);
+        const size_t numCols = mArgs.numCols;
+        const size_t colTaps = colW.taps;
+        const size_t rowTaps = rowW.taps;
+
+        // Only the mesh columns the output touches need to be collapsed.
+        // The columns may be in either direction.
+        const size_t firstKnot =
+                *std::min_element(colW.start.begin(), colW.start.end());
+        const size_t numKnots = *std::max_element(colW.start.begin(),
+                                                  colW.start.end()) +
+                colTaps - firstKnot;
+
+        std::vector<size_t> colStart(numCols);
+        for (size_t col = 0; col < numCols; ++col)
+        {
+            colStart[col] = colW.start[col] - firstKnot;
+        }
+        const double* const colWeights = &colW.weights[0];
+
+        std::vector<double> collapsed(numKnots);
+        for (size_t row = startRow; row < startRow + numRows; ++row)
+        {
+            const double* const weights = &rowW.weights[row * rowTaps];
+            const double* const values = mArgs.values +
+                    rowW.start[row] * mArgs.meshCols + firstKnot;
+
+            // Collapse the mesh rows into one row of knots
+            std::fill(collapsed.begin(), collapsed.end(), 0.0);
+            for (size_t tap = 0; tap < rowTaps; ++tap)
+            {
+                const double weight = weights[tap];
+                const double* const meshRow = values + tap * mArgs.meshCols;
+                for (size_t knot = 0; knot < numKnots; ++knot)
+                {
+                    collapsed[knot] += weight * meshRow[knot];
+                }
+            }
+
+            // Then interpolate along the row
+            double* const output = mArgs.output + row * numCols;
+            for (size_t col = 0; col < numCols; ++col)
+            {
+                const double* const w = colWeights + col * colTaps;
+                const double* const knots = &collapsed[colStart[col]];
+                double sum = 0.0;
+                for (size_t tap = 0; tap < colTaps; ++tap)
+                {
+                    sum += w[tap] * knots[tap];
+                }
+                output[col] = sum;
+            }
+        }
+    }
+
+private:
+    const Args mArgs;
+};
+}
+
+namespace six
+{
+namespace sicd
+{
+MeshInterpolator::MeshInterpolator(const NoiseMesh& mesh,
+                                   InterpolationType interpolation,
+                                   size_t numThreads) :
+    mNumTaps(interpolation == BICUBIC ? 4 : 2),
+    mNumThreads(numThreads)
+{
+    std::vector<const std::vector<double>*> fields;
+    fields.push_back(&mesh.getMainBeamNoise());
+    fields.push_back(&mesh.getAzimuthAmbiguityNoise());
+    fields.push_back(&mesh.getCombinedNoise());
+    initialize(mesh, fields);
+}
+
+MeshInterpolator::MeshInterpolator(const ScalarMesh& mesh,
+                                   InterpolationType interpolation,
+                                   size_t numThreads) :
+    mNumTaps(interpolation == BICUBIC ? 4 : 2),
+    mNumThreads(numThreads)
+{
+    const std::map<std::string, std::vector<double> >& scalars =
+            mesh.getScalars();
+    std::vector<const std::vector<double>*> fields;
+    for (std::map<std::string, std::vector<double> >::const_iterator iter =
+                 scalars.begin();
+         iter != scalars.end();
+         ++iter)
+    {
+        fields.push_back(&iter->second);
+    }
+    initialize(mesh, fields);
+}
+
+void MeshInterpolator::initialize(
+        const PlanarCoordinateMesh& mesh,
+        const std::vector<const std::vector<double>*>& fields)
+{
+    const types::RowCol<size_t> meshDims = mesh.getMeshDims();
+    if (meshDims.row < 2 || meshDims.col < 2)
+    {
+        throw except::Exception(Ctxt(
+                "Mesh needs at least two knots along each axis"));
+    }
+
+    const size_t numPoints = meshDims.area();
+    if (mesh.getX().size() != numPoints || mesh.getY().size() != numPoints)
+    {
+        throw except::Exception(Ctxt(
+                "Mesh coordinates don't match its dimensions"));
+    }
+
+    // The field names follow the X and Y coordinates
+    const std::vector<Mesh::Field> meshFields = mesh.getFields();
+    const size_t numCoordFields =
+            mesh.PlanarCoordinateMesh::getFields().size();
+    for (size_t ii = numCoordFields; ii < meshFields.size(); ++ii)
+    {
+        mFieldNames.push_back(meshFields[ii].name);
+    }
+
+    getKnots(mesh.getX(), meshDims.row, meshDims.col, meshDims.col, 1,
+             mXKnots);
+    getKnots(mesh.getY(), meshDims.col, 1, meshDims.row, meshDims.col,
+             mYKnots);
+    const bool reverseRows = sortKnots(mXKnots);
+    const bool reverseCols = sortKnots(mYKnots);
+
+    mFields.resize(fields.size());
+    for (size_t field = 0; field < fields.size(); ++field)
+    {
+        const std::vector<double>& values = *fields[field];
+        if (values.size() != numPoints)
+        {
+            throw except::Exception(Ctxt(
+                    "Mesh field " + mFieldNames[field] + " has " +
+                    str::toString(values.size()) + " values instead of " +
+                    str::toString(numPoints)));
+        }
+
+        std::vector<double>& plane = mFields[field];
+        plane.resize(numPoints);
+        for (size_t row = 0; row < meshDims.row; ++row)
+        {
+            const size_t srcRow = reverseRows ? meshDims.row - 1 - row : row;
+            for (size_t col = 0; col < meshDims.col; ++col)
+            {
+                const size_t srcCol =
+                        reverseCols ? meshDims.col - 1 - col : col;
+                plane[row * meshDims.col + col] =
+                        values[srcRow * meshDims.col + srcCol];
+            }
+        }
+    }
+}
+
+size_t MeshInterpolator::getFieldIndex(const std::string& name) const
+{
+    const std::vector<std::string>::const_iterator iter =
+            std::find(mFieldNames.begin(), mFieldNames.end(), name);
+    if (iter == mFieldNames.end())
+    {
+        throw except::Exception(Ctxt("Mesh has no field named " + name));
+    }
+    return iter - mFieldNames.begin();
+}
+
+void MeshInterpolator::computeWeights(const std::vector<double>& knots,
+                                      const double* positions,
+                                      size_t numPositions,
+                                      AxisWeights& weights) const
+{
+    const size_t numKnots = knots.size();
+    const size_t taps = std::min(mNumTaps, numKnots);
+    weights.taps = taps;
+    weights.start.resize(numPositions);
+    weights.weights.resize(numPositions * taps);
+
+    for (size_t ii = 0; ii < numPositions; ++ii)
+    {
+        const double x = positions[ii];
+
+        // Find the cell containing x, clamping so that positions outside
+        // the mesh extrapolate from the outermost cell
+        size_t cell = std::upper_bound(knots.begin(), knots.end(), x) -
+                knots.begin();
+        cell = (cell == 0) ? 0 : std::min(cell - 1, numKnots - 2);
+
+        // Center the stencil on the cell, shifting it at the edges
+        size_t start = (cell + 1 >= taps / 2) ? cell + 1 - taps / 2 : 0;
+        start = std::min(start, numKnots - taps);
+        weights.start[ii] = start;
+
+        // Lagrange weights handle non-uniform knot spacing
+        double* const w = &weights.weights[ii * taps];
+        for (size_t tap = 0; tap < taps; ++tap)
+        {
+            double weight = 1.0;
+            const double knot = knots[start + tap];
+            for (size_t other = 0; other < taps; ++other)
+            {
+                if (other != tap)
+                {
+                    const double otherKnot = knots[start + other];
+                    weight *= (x - otherKnot) / (knot - otherKnot);
+                }
+            }
+            w[tap] = weight;
+        }
+    }
+}
+
+double MeshInterpolator::interpolate(size_t field, double x, double y) const
+{
+    double output;
+    interpolate(field, &x, &y, 1, &output);
+    return output;
+}
+
+void MeshInterpolator::interpolate(size_t field,
+                                   const double* x,
+                                   const double* y,
+                                   size_t numPoints,
+                                   double* output) const
+{
+    if (numPoints == 0)
+    {
+        return;
+    }
+
+    AxisWeights rowWeights;
+    AxisWeights colWeights;
+    computeWeights(mXKnots, x, numPoints, rowWeights);
+    computeWeights(mYKnots, y, numPoints, colWeights);
+
+    const double* const values = &mFields.at(field)[0];
+    const size_t meshCols = mYKnots.size();
+    for (size_t ii = 0; ii < numPoints; ++ii)
+    {
+        const double* const rowW = &rowWeights.weights[ii * rowWeights.taps];
+        const double* const colW = &colWeights.weights[ii * colWeights.taps];
+        double sum = 0.0;
+        for (size_t rr = 0; rr < rowWeights.taps; ++rr)
+        {
+            const double* const meshRow = values +
+                    (rowWeights.start[ii] + rr) * meshCols +
+                    colWeights.start[ii];
+            double rowSum = 0.0;
+            for (size_t cc = 0; cc < colWeights.taps; ++cc)
+            {
+                rowSum += colW[cc] * meshRow[cc];
+            }
+            sum += rowW[rr] * rowSum;
+        }
+        output[ii] = sum;
+    }
+}
+
+void MeshInterpolator::interpolateGrid(size_t field,
+                                       double x0,
+                                       double deltaX,
+                                       size_t numX,
+                                       double y0,
+                                       double deltaY,
+                                       size_t numY,
+                                       double* output) const
+{
+    if (numX == 0 || numY == 0)
+    {
+        return;
+    }
+
+    std::vector<double> positions(std::max(numX, numY));
+    AxisWeights rowWeights;
+    for (size_t ii = 0; ii < numX; ++ii)
+    {
+        positions[ii] = x0 + ii * deltaX;
+    }
+    computeWeights(mXKnots, &positions[0], numX, rowWeights);
+
+    AxisWeights colWeights;
+    for (size_t jj = 0; jj < numY; ++jj)
+    {
+        positions[jj] = y0 + jj * deltaY;
+    }
+    computeWeights(mYKnots, &positions[0], numY, colWeights);
+
+    InterpolateGridJob::Args args;
+    args.rowWeights = &rowWeights;
+    args.colWeights = &colWeights;
+    args.meshCols = mYKnots.size();
+    args.values = &mFields.at(field)[0];
+    args.numCols = numY;
+    args.output = output;
+
+    scene::runInParallel(InterpolateGridJob(args), numX, mNumThreads);
+}
+
+void MeshInterpolator::interpolateTile(size_t field,
+                                       const ComplexData& data,
+                                       const types::RowCol<size_t>& offset,
+                                       const types::RowCol<size_t>& dims,
+                                       double* output) const
+{
+    const types::RowCol<double> scpPixel(
+            data.imageData->scpPixel.row -
+                    static_cast<double>(data.imageData->firstRow),
+            data.imageData->scpPixel.col -
+                    static_cast<double>(data.imageData->firstCol));
+    const types::RowCol<double> sampleSpacing(data.grid->row->sampleSpacing,
+                                              data.grid->col->sampleSpacing);
+
+    interpolateGrid(field,
+                    (offset.row - scpPixel.row) * sampleSpacing.row,
+                    sampleSpacing.row,
+                    dims.row,
+                    (offset.col - scpPixel.col) * sampleSpacing.col,
+                    sampleSpacing.col,
+                    dims.col,
+                    output);
+}
+}
+}
@@ -0,0 +1,290 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <cmath>
+
+#include <except/Exception.h>
+#include <scene/RangeRunnable.h>
+#include <sys/Conf.h>
+#include <six/sicd/RadiometricCalibrator.h>
+
+namespace
+{
+struct CalibrateJob
+{
+    const six::sicd::RadiometricCalibrator* calibrator;
+    const six::UByte* pixels;
+    types::RowCol<size_t> offset;
+    size_t numCols;
+    size_t bytesPerRow;
+    float* output;
+
+    void operator()(size_t startRow, size_t numRows) const
+    {
+        calibrator->calibrateBand(
+                pixels + startRow * bytesPerRow,
+                types::RowCol<size_t>(offset.row + startRow, offset.col),
+                types::RowCol<size_t>(numRows, numCols),
+                output + startRow * numCols);
+    }
+};
+
+const six::Poly2D& getScaleFactorPoly(
+        const six::Radiometric& radiometric,
+        six::sicd::RadiometricCalibrator::CalibrationType calibrationType)
+{
+    switch (calibrationType)
+    {
+    case six::sicd::RadiometricCalibrator::RCS:
+        return radiometric.rcsSFPoly;
+    case six::sicd::RadiometricCalibrator::SIGMA_ZERO:
+        return radiometric.sigmaZeroSFPoly;
+    case six::sicd::RadiometricCalibrator::BETA_ZERO:
+        return radiometric.betaZeroSFPoly;
+    case six::sicd::RadiometricCalibrator::GAMMA_ZERO:
+        return radiometric.gammaZeroSFPoly;
+    default:
+        throw except::Exception(Ctxt("Invalid calibration type"));
+    }
+}
+}
+
+namespace six
+{
+namespace sicd
+{
+RadiometricCalibrator::RadiometricCalibrator(const ComplexData& data,
+                                             CalibrationType calibrationType,
+                                             OutputType outputType,
+                                             bool subtractNoise) :
+    mPixelType(data.getPixelType()),
+    mNumBytesPerPixel(data.getNumBytesPerPixel()),
+    mOutputType(outputType),
+    mSCPPixel(data.imageData->scpPixel.row -
+                      static_cast<double>(data.imageData->firstRow),
+              data.imageData->scpPixel.col -
+                      static_cast<double>(data.imageData->firstCol)),
+    mSampleSpacing(data.grid->row->sampleSpacing,
+                   data.grid->col->sampleSpacing)
+{
+    if (data.radiometric.get() == NULL)
+    {
+        throw except::Exception(Ctxt("SICD has no radiometric parameters"));
+    }
+
+    const Poly2D& scaleFactorPoly =
+            getScaleFactorPoly(*data.radiometric, calibrationType);
+    if (scaleFactorPoly.empty())
+    {
+        throw except::Exception(Ctxt(
+                "SICD doesn't have the requested scale factor polynomial"));
+    }
+    mScaleFactor.reset(new Poly2DEvaluator(scaleFactorPoly));
+
+    if (subtractNoise)
+    {
+        const NoiseLevel& noiseLevel = data.radiometric->noiseLevel;
+        if (noiseLevel.noiseType != Radiometric::NL_ABSOLUTE ||
+            noiseLevel.noisePoly.empty())
+        {
+            throw except::Exception(Ctxt(
+                    "Noise can only be subtracted with an absolute noise "
+                    "polynomial"));
+        }
+        mNoise.reset(new Poly2DEvaluator(noiseLevel.noisePoly));
+    }
+
+    switch (mPixelType)
+    {
+    case PixelType::RE32F_IM32F:
+    case PixelType::RE16I_IM16I:
+        break;
+    case PixelType::AMP8I_PHS8I:
+    {
+        // Only the amplitude matters for power, so turn it into a table
+        // of powers
+        const AmplitudeTable* const ampTable =
+                data.imageData->amplitudeTable.get();
+        mAmplitudePower.resize(256);
+        for (size_t ii = 0; ii < mAmplitudePower.size(); ++ii)
+        {
+            const double amplitude = ampTable ?
+                    *reinterpret_cast<const double*>((*ampTable)[ii]) :
+                    static_cast<double>(ii);
+            mAmplitudePower[ii] = amplitude * amplitude;
+        }
+        break;
+    }
+    default:
+        throw except::Exception(Ctxt(
+                "Can't calibrate pixel type " + mPixelType.toString()));
+    }
+}
+
+void RadiometricCalibrator::computePower(const UByte* pixels,
+                                         size_t numPixels,
+                                         double* power) const
+{
+    switch (mPixelType)
+    {
+    case PixelType::RE32F_IM32F:
+    {
+        const float* const values = reinterpret_cast<const float*>(pixels);
+        for (size_t ii = 0; ii < numPixels; ++ii)
+        {
+            const double real = values[2 * ii];
+            const double imag = values[2 * ii + 1];
+            power[ii] = real * real + imag * imag;
+        }
+        break;
+    }
+    case PixelType::RE16I_IM16I:
+    {
+        const sys::Int16_T* const values =
+                reinterpret_cast<const sys::Int16_T*>(pixels);
+        for (size_t ii = 0; ii < numPixels; ++ii)
+        {
+            const double real = values[2 * ii];
+            const double imag = values[2 * ii + 1];
+            power[ii] = real * real + imag * imag;
+        }
+        break;
+    }
+    default:
+    {
+        const double* const table = &mAmplitudePower[0];
+        for (size_t ii = 0; ii < numPixels; ++ii)
+        {
+            power[ii] = table[pixels[2 * ii]];
+        }
+        break;
+    }
+    }
+}
+
+void RadiometricCalibrator::finish(const double* power,
+                                   size_t numPixels,
+                                   float* output) const
+{
+    switch (mOutputType)
+    {
+    case POWER:
+        for (size_t ii = 0; ii < numPixels; ++ii)
+        {
+            output[ii] = static_cast<float>(power[ii]);
+        }
+        break;
+    case POWER_DB:
+        for (size_t ii = 0; ii < numPixels; ++ii)
+        {
+            output[ii] = static_cast<float>(
+                    10.0 * std::log10(std::max(power[ii], 0.0)));
+        }
+        break;
+    case AMPLITUDE:
+        for (size_t ii = 0; ii < numPixels; ++ii)
+        {
+            output[ii] = static_cast<float>(
+                    std::sqrt(std::max(power[ii], 0.0)));
+        }
+        break;
+    default:
+        throw except::Exception(Ctxt("Invalid output type"));
+    }
+}
+
+void RadiometricCalibrator::calibrateBand(const UByte* pixels,
+                                          const types::RowCol<size_t>& offset,
+                                          const types::RowCol<size_t>& dims,
+                                          float* output) const
+{
+    if (dims.row == 0 || dims.col == 0)
+    {
+        return;
+    }
+
+    const size_t bytesPerRow = dims.col * mNumBytesPerPixel;
+
+    std::vector<double> y(dims.col);
+    for (size_t col = 0; col < dims.col; ++col)
+    {
+        y[col] = (offset.col + col - mSCPPixel.col) * mSampleSpacing.col;
+    }
+
+    // One row at a time keeps the scratch space small and in cache
+    std::vector<double> scaleFactor(dims.col);
+    std::vector<double> noise(mNoise.get() ? dims.col : 0);
+    std::vector<double> power(dims.col);
+    for (size_t row = 0; row < dims.row; ++row)
+    {
+        const double x =
+                (offset.row + row - mSCPPixel.row) * mSampleSpacing.row;
+        mScaleFactor->evaluateGrid(&x, 1, &y[0], dims.col, &scaleFactor[0]);
+        computePower(pixels + row * bytesPerRow, dims.col, &power[0]);
+
+        if (mNoise.get())
+        {
+            mNoise->evaluateGrid(&x, 1, &y[0], dims.col, &noise[0]);
+            for (size_t col = 0; col < dims.col; ++col)
+            {
+                power[col] -= std::pow(10.0, noise[col] / 10.0);
+            }
+        }
+
+        for (size_t col = 0; col < dims.col; ++col)
+        {
+            power[col] *= scaleFactor[col];
+        }
+
+        finish(&power[0], dims.col, output + row * dims.col);
+    }
+}
+
+void RadiometricCalibrator::calibrate(const UByte* pixels,
+                                      const types::RowCol<size_t>& offset,
+                                      const types::RowCol<size_t>& dims,
+                                      float* output,
+                                      size_t numThreads) const
+{
+    const CalibrateJob job = { this, pixels, offset, dims.col,
+                               dims.col * mNumBytesPerPixel, output };
+    scene::runInParallel(job, dims.row, numThreads);
+}
+
+double RadiometricCalibrator::calibrate(double power,
+                                        double row,
+                                        double col) const
+{
+    const double x = (row - mSCPPixel.row) * mSampleSpacing.row;
+    const double y = (col - mSCPPixel.col) * mSampleSpacing.col;
+    if (mNoise.get())
+    {
+        power -= std::pow(10.0, (*mNoise)(x, y) / 10.0);
+    }
+    power *= (*mScaleFactor)(x, y);
+
+    float output;
+    finish(&power, 1, &output);
+    return output;
+}
+}
+}
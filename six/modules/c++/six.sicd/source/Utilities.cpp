@@ -461,6 +461,18 @@ void Utilities::getValidDataPolygon(
     //       isn't going to tell us anything new...
 }
 
+ValidDataMask Utilities::getValidDataMask(const ComplexData& sicdData)
+{
+    const types::RowCol<size_t> dims(sicdData.getNumRows(),
+                                     sicdData.getNumCols());
+    const std::vector<RowColInt>& validData = sicdData.imageData->validData;
+    if (validData.empty())
+    {
+        return ValidDataMask(dims);
+    }
+    return ValidDataMask(validData, dims);
+}
+
 void Utilities::readSicd(const std::string& sicdPathname,
                          const std::vector<std::string>& schemaPaths,
                          std::auto_ptr<ComplexData>& complexData,
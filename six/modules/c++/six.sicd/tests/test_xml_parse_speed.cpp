@@ -0,0 +1,222 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <sys/Path.h>
+#include <sys/StopWatch.h>
+#include <except/Exception.h>
+#include <io/StringStream.h>
+#include <logging/NullLogger.h>
+#include <str/Convert.h>
+#include <xml/lite/MinidomParser.h>
+#include <six/NumberParser.h>
+#include <six/sicd/ComplexXMLControl.h>
+
+namespace
+{
+// Skips schema validation so only the conversion to ComplexData is timed
+class ParseOnlyXMLControl : public six::sicd::ComplexXMLControl
+{
+public:
+    ParseOnlyXMLControl(logging::Logger* log) :
+        six::sicd::ComplexXMLControl(log)
+    {
+    }
+
+    six::Data* parse(const xml::lite::Document* doc)
+    {
+        return fromXMLImpl(doc);
+    }
+};
+
+void getLeafText(const xml::lite::Element& element,
+                 std::vector<std::string>& text)
+{
+    const std::vector<xml::lite::Element*>& children = element.getChildren();
+    if (children.empty())
+    {
+        text.push_back(element.getCharacterData());
+    }
+    for (size_t ii = 0; ii < children.size(); ++ii)
+    {
+        getLeafText(*children[ii], text);
+    }
+}
+
+// Times str::toType() against six::toNumber() on every numeric value in the
+// document and makes sure they agree
+bool compareNumbers(const xml::lite::Element& root, size_t numIterations)
+{
+    std::vector<std::string> leafText;
+    getLeafText(root, leafText);
+
+    std::vector<std::string> numbers;
+    for (size_t ii = 0; ii < leafText.size(); ++ii)
+    {
+        try
+        {
+            str::toType<double>(leafText[ii]);
+            numbers.push_back(leafText[ii]);
+        }
+        catch (const except::BadCastException&)
+        {
+        }
+    }
+
+    double sum = 0.0;
+    sys::RealTimeStopWatch sw;
+    sw.start();
+    for (size_t iter = 0; iter < numIterations; ++iter)
+    {
+        for (size_t ii = 0; ii < numbers.size(); ++ii)
+        {
+            sum += str::toType<double>(numbers[ii]);
+        }
+    }
+    const double toTypeMS = sw.stop();
+
+    sw.clear();
+    sw.start();
+    for (size_t iter = 0; iter < numIterations; ++iter)
+    {
+        for (size_t ii = 0; ii < numbers.size(); ++ii)
+        {
+            sum -= six::toNumber<double>(numbers[ii]);
+        }
+    }
+    const double toNumberMS = sw.stop();
+
+    size_t numMismatches = 0;
+    size_t numFast = 0;
+    for (size_t ii = 0; ii < numbers.size(); ++ii)
+    {
+        double value;
+        if (six::parseDoubleFast(numbers[ii].c_str(), numbers[ii].length(),
+                                 value))
+        {
+            ++numFast;
+        }
+        if (six::toNumber<double>(numbers[ii]) !=
+            str::toType<double>(numbers[ii]))
+        {
+            std::cerr << "Mismatch parsing " << numbers[ii] << "\n";
+            ++numMismatches;
+        }
+    }
+
+    std::cout << "    " << numbers.size() << " numbers, " << numFast
+              << " on the fast path\n"
+              << "    str::toType:    "
+              << toTypeMS / numIterations << " ms\n"
+              << "    six::toNumber:  "
+              << toNumberMS / numIterations << " ms\n";
+
+    // Keep the loops from being optimized away
+    return numMismatches == 0 && sum == sum;
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        const std::string progname(argv[0]);
+        if (argc < 2)
+        {
+            std::cerr << "Usage: " << sys::Path::basename(progname)
+                      << " <SICD XML pathname> [<SICD XML pathname> ...]\n\n"
+                      << "Times parsing SICD XML (e.g. the files in "
+                      << "six.sicd/tests/sample_xml) into ComplexData\n";
+            return 1;
+        }
+
+        const size_t numIterations = 100;
+        logging::NullLogger logger;
+        bool success = true;
+
+        for (int arg = 1; arg < argc; ++arg)
+        {
+            std::ifstream input(argv[arg]);
+            if (!input)
+            {
+                throw except::Exception(Ctxt(
+                        std::string("Unable to open ") + argv[arg]));
+            }
+            std::stringstream buffer;
+            buffer << input.rdbuf();
+            const std::string xml = buffer.str();
+
+            std::auto_ptr<xml::lite::MinidomParser> domParser;
+            sys::RealTimeStopWatch sw;
+            sw.start();
+            for (size_t iter = 0; iter < numIterations; ++iter)
+            {
+                io::StringStream stream;
+                stream.write(xml.c_str(), xml.length());
+                domParser.reset(new xml::lite::MinidomParser());
+                domParser->parse(stream);
+            }
+            const double domMS = sw.stop();
+
+            ParseOnlyXMLControl control(&logger);
+            sw.clear();
+            sw.start();
+            for (size_t iter = 0; iter < numIterations; ++iter)
+            {
+                std::auto_ptr<six::Data> data(control.parse(
+                        domParser->getDocument()));
+            }
+            const double fromXMLMS = sw.stop();
+
+            std::cout << sys::Path::basename(argv[arg]) << "\n"
+                      << "    DOM parse:      "
+                      << domMS / numIterations << " ms\n"
+                      << "    fromXML:        "
+                      << fromXMLMS / numIterations << " ms\n";
+
+            success &= compareNumbers(
+                    *domParser->getDocument()->getRootElement(),
+                    numIterations);
+        }
+
+        return success ? 0 : 1;
+    }
+    catch (const except::Exception& e)
+    {
+        std::cerr << e.getMessage() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    catch (...)
+    {
+        std::cerr << "Unknown exception" << std::endl;
+        return 1;
+    }
+}
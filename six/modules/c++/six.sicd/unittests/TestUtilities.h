@@ -0,0 +1,103 @@
+/* =========================================================================
+ * This file is part of six.sicd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six.sicd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __SIX_SICD_UNITTEST_UTILITIES_H__
+#define __SIX_SICD_UNITTEST_UTILITIES_H__
+
+#include <stdlib.h>
+#include <complex>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <mem/SharedPtr.h>
+#include <types/RowCol.h>
+#include <six/Container.h>
+#include <six/NITFHeaderCreator.h>
+#include <six/NITFWriteControl.h>
+#include <six/Options.h>
+#include <six/XMLControlFactory.h>
+#include <six/sicd/ComplexXMLControl.h>
+#include <six/sicd/Utilities.h>
+#include "../../six/unittests/TestUtilities.h"
+
+// Fake SICD metadata for a complex float image
+inline std::auto_ptr<six::sicd::ComplexData>
+createComplexFloatData(const types::RowCol<size_t>& dims)
+{
+    std::auto_ptr<six::sicd::ComplexData> data(
+            six::sicd::Utilities::createFakeComplexData());
+    data->setPixelType(six::PixelType::RE32F_IM32F);
+    data->setNumRows(dims.row);
+    data->setNumCols(dims.col);
+    return data;
+}
+
+// Writes a SICD in image segments of at most 'maxProductSize' bytes.
+// 'data' must describe complex float pixels.
+inline void writeSICD(const std::string& pathname,
+                      std::auto_ptr<six::sicd::ComplexData> data,
+                      const std::complex<float>* pixels,
+                      size_t maxProductSize)
+{
+    six::XMLControlFactory::getInstance().addCreator(
+            six::DataType::COMPLEX,
+            new six::XMLControlCreatorT<six::sicd::ComplexXMLControl>());
+
+    mem::SharedPtr<six::Container> container(
+            new six::Container(six::DataType::COMPLEX));
+    container->addData(data.release());
+
+    six::Options options;
+    options.setParameter(
+            six::NITFHeaderCreator::OPT_MAX_PRODUCT_SIZE, maxProductSize);
+    six::NITFWriteControl writer(options, container);
+    writer.save(reinterpret_cast<const six::UByte*>(pixels), pathname);
+}
+
+// Writes a random complex float SICD in image segments of about 40 rows
+// and returns its pixels
+inline std::vector<std::complex<float> >
+writeRandomSICD(const std::string& pathname,
+                const types::RowCol<size_t>& dims,
+                const std::string& coreName = "")
+{
+    std::auto_ptr<six::sicd::ComplexData> data = createComplexFloatData(dims);
+    if (!coreName.empty())
+    {
+        data->setName(coreName);
+    }
+
+    std::vector<std::complex<float> > image(dims.area());
+    for (size_t ii = 0; ii < image.size(); ++ii)
+    {
+        image[ii] = std::complex<float>(
+                static_cast<float>(rand() % 1000),
+                static_cast<float>(rand() % 1000) - 500.0f);
+    }
+
+    writeSICD(pathname, data, &image[0],
+              40 * dims.col * sizeof(std::complex<float>));
+    return image;
+}
+
+#endif
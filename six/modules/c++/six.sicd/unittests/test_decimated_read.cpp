@@ -0,0 +1,164 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <vector>
+
+#include <io/TempFile.h>
+#include <import/six/sicd.h>
+#include "TestCase.h"
+#include "TestUtilities.h"
+
+namespace
+{
+const size_t NUM_ROWS = 123;
+const size_t NUM_COLS = 45;
+const types::RowCol<size_t> DIMS(NUM_ROWS, NUM_COLS);
+
+typedef std::complex<float> ComplexT;
+
+std::vector<ComplexT> read(six::NITFReadControl& reader,
+                           size_t startRow,
+                           size_t startCol,
+                           size_t rowSkip,
+                           size_t colSkip,
+                           six::DecimationMethod method)
+{
+    six::Region region;
+    region.setStartRow(startRow);
+    region.setNumRows(NUM_ROWS - startRow);
+    region.setStartCol(startCol);
+    region.setNumCols(NUM_COLS - startCol);
+    region.setSkip(rowSkip, colSkip);
+    region.setDecimationMethod(method);
+
+    std::vector<ComplexT> output(region.getNumDecimatedRows() *
+                                 region.getNumDecimatedCols());
+    region.setBuffer(reinterpret_cast<six::UByte*>(&output[0]));
+    reader.interleaved(region, 0);
+    return output;
+}
+
+std::vector<ComplexT> skipPixels(const std::vector<ComplexT>& image,
+                                 size_t startRow,
+                                 size_t startCol,
+                                 size_t rowSkip,
+                                 size_t colSkip)
+{
+    std::vector<ComplexT> expected;
+    for (size_t row = startRow; row < NUM_ROWS; row += rowSkip)
+    {
+        for (size_t col = startCol; col < NUM_COLS; col += colSkip)
+        {
+            expected.push_back(image[row * NUM_COLS + col]);
+        }
+    }
+    return expected;
+}
+
+std::vector<ComplexT> brightestPixels(const std::vector<ComplexT>& image,
+                                      size_t rowSkip,
+                                      size_t colSkip)
+{
+    std::vector<ComplexT> expected;
+    for (size_t row = 0; row < NUM_ROWS; row += rowSkip)
+    {
+        for (size_t col = 0; col < NUM_COLS; col += colSkip)
+        {
+            ComplexT brightest(-1.0f, 0.0f);
+            float maxMagnitude = -1.0f;
+            for (size_t ii = row; ii < std::min(row + rowSkip, NUM_ROWS); ++ii)
+            {
+                for (size_t jj = col;
+                     jj < std::min(col + colSkip, NUM_COLS);
+                     ++jj)
+                {
+                    const ComplexT pixel = image[ii * NUM_COLS + jj];
+                    if (std::norm(pixel) > maxMagnitude)
+                    {
+                        maxMagnitude = std::norm(pixel);
+                        brightest = pixel;
+                    }
+                }
+            }
+            expected.push_back(brightest);
+        }
+    }
+    return expected;
+}
+
+TEST_CASE(testZeroSkip)
+{
+    six::Region region;
+    TEST_EXCEPTION(region.setSkip(0, 1));
+    TEST_EXCEPTION(region.setSkip(1, 0));
+    TEST_ASSERT_EQ(region.getRowSkip(), static_cast<size_t>(1));
+    TEST_ASSERT_EQ(region.getColSkip(), static_cast<size_t>(1));
+}
+
+TEST_CASE(testPixelSkip)
+{
+    io::TempFile temp;
+    const std::vector<ComplexT> image = writeRandomSICD(temp.pathname(), DIMS);
+
+    six::NITFReadControl reader;
+    reader.load(temp.pathname());
+
+    const six::DecimationMethod nearest(
+            six::DecimationMethod::NEAREST_NEIGHBOR);
+    TEST_ASSERT(read(reader, 0, 0, 4, 4, nearest) ==
+                skipPixels(image, 0, 0, 4, 4));
+    TEST_ASSERT(read(reader, 7, 3, 3, 5, nearest) ==
+                skipPixels(image, 7, 3, 3, 5));
+    TEST_ASSERT(read(reader, 0, 0, 1, 2, nearest) ==
+                skipPixels(image, 0, 0, 1, 2));
+
+    // Skips larger than an image segment
+    TEST_ASSERT(read(reader, 2, 0, 50, 1, nearest) ==
+                skipPixels(image, 2, 0, 50, 1));
+}
+
+TEST_CASE(testBrightestPixel)
+{
+    io::TempFile temp;
+    const std::vector<ComplexT> image = writeRandomSICD(temp.pathname(), DIMS);
+
+    six::NITFReadControl reader;
+    reader.load(temp.pathname());
+
+    const six::DecimationMethod brightest(
+            six::DecimationMethod::BRIGHTEST_PIXEL);
+    TEST_ASSERT(read(reader, 0, 0, 4, 4, brightest) ==
+                brightestPixels(image, 4, 4));
+    TEST_ASSERT(read(reader, 0, 0, 16, 7, brightest) ==
+                brightestPixels(image, 16, 7));
+
+    TEST_EXCEPTION(read(reader, 0, 0, 2, 2,
+                        six::DecimationMethod::BILINEAR));
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testZeroSkip);
+    TEST_CHECK(testPixelSkip);
+    TEST_CHECK(testBrightestPixel);
+    return 0;
+}
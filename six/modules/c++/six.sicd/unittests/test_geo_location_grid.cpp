@@ -0,0 +1,216 @@
+/* =========================================================================
+ * This file is part of six.sicd-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six.sicd-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cmath>
+#include <vector>
+
+#include <scene/Utilities.h>
+#include <six/sicd/GeoLocationGrid.h>
+#include "TestCase.h"
+
+namespace
+{
+// Smooth, mildly non-linear stand-in for a real projection
+class FakeModel : public six::sicd::GeoLocationModel
+{
+public:
+    FakeModel(double lon0) :
+        mLon0(lon0)
+    {
+    }
+
+    virtual six::LatLonAlt toLLA(const six::RowColDouble& pixel) const
+    {
+        const double lat = 35.0 + 1e-5 * pixel.row +
+                2e-3 * std::sin(pixel.col / 700.0);
+        const double lon = mLon0 + 1.5e-5 * pixel.col +
+                1e-10 * pixel.row * pixel.col;
+        const double alt = 100.0 + 20.0 * std::cos(pixel.row / 500.0);
+        return six::LatLonAlt(lat, lon > 180 ? lon - 360 : lon, alt);
+    }
+
+private:
+    const double mLon0;
+};
+
+// Flat except for bumps along the bottom and right borders of the image.
+// The bumps vanish on every knot of a lattice spaced 'spacing' apart, and
+// everywhere except within a few pixels of the last row and column.
+class BorderBumpModel : public six::sicd::GeoLocationModel
+{
+public:
+    BorderBumpModel(const types::RowCol<size_t>& dims, double spacing) :
+        mLast(dims.row - 1.0, dims.col - 1.0),
+        mSpacing(spacing)
+    {
+    }
+
+    virtual six::LatLonAlt toLLA(const six::RowColDouble& pixel) const
+    {
+        const double alt = 50.0 *
+                (ramp(pixel.row - mLast.row) * bump(pixel.col) +
+                 ramp(pixel.col - mLast.col) * bump(pixel.row));
+        return six::LatLonAlt(35.0 + 1e-5 * pixel.row,
+                              -77.0 + 1.5e-5 * pixel.col,
+                              alt);
+    }
+
+private:
+    static double ramp(double fromLast)
+    {
+        return std::max(0.0, 1.0 + fromLast / 8.0);
+    }
+
+    double bump(double pos) const
+    {
+        const double value = std::sin(M_PI * pos / mSpacing);
+        return value * value;
+    }
+
+    const six::RowColDouble mLast;
+    const double mSpacing;
+};
+
+double distance(const six::LatLonAlt& lhs, const six::LatLonAlt& rhs)
+{
+    return (scene::Utilities::latLonToECEF(lhs) -
+            scene::Utilities::latLonToECEF(rhs)).norm();
+}
+
+TEST_CASE(testWithinTolerance)
+{
+    const FakeModel model(-77.0);
+    const types::RowCol<size_t> dims(3000, 2500);
+    const double tolerance = 0.01;
+
+    const six::sicd::GeoLocationGrid grid(
+            model, dims, tolerance,
+            six::sicd::GeoLocationGrid::BICUBIC, 256, 2);
+    TEST_ASSERT(grid.isWithinTolerance());
+    TEST_ASSERT_EQ(grid.getRowKnots().front(), 0);
+    TEST_ASSERT_EQ(grid.getRowKnots().back(), dims.row - 1);
+    TEST_ASSERT_EQ(grid.getColKnots().back(), dims.col - 1);
+
+    for (size_t row = 0; row < dims.row; row += 97)
+    {
+        for (size_t col = 0; col < dims.col; col += 89)
+        {
+            const six::RowColDouble pixel(row, col);
+            TEST_ASSERT(distance(grid.geolocate(pixel),
+                                 model.toLLA(pixel)) < 5 * tolerance);
+        }
+    }
+}
+
+TEST_CASE(testLastEdgesChecked)
+{
+    const types::RowCol<size_t> dims(1025, 1025);
+    const double spacing = 512.0;
+    const BorderBumpModel model(dims, spacing);
+    const double tolerance = 0.5;
+
+    const six::sicd::GeoLocationGrid grid(
+            model, dims, tolerance, six::sicd::GeoLocationGrid::BICUBIC,
+            static_cast<size_t>(spacing), 2);
+    TEST_ASSERT(grid.isWithinTolerance());
+
+    for (double pos = 128.0; pos < 1024.0; pos += 256.0)
+    {
+        const six::RowColDouble bottom(dims.row - 1.0, pos);
+        const six::RowColDouble right(pos, dims.col - 1.0);
+        TEST_ASSERT(distance(grid.geolocate(bottom),
+                             model.toLLA(bottom)) < 5 * tolerance);
+        TEST_ASSERT(distance(grid.geolocate(right),
+                             model.toLLA(right)) < 5 * tolerance);
+    }
+}
+
+TEST_CASE(testBilinearRefines)
+{
+    const FakeModel model(-77.0);
+    const types::RowCol<size_t> dims(2000, 2000);
+
+    const six::sicd::GeoLocationGrid coarse(
+            model, dims, 100.0, six::sicd::GeoLocationGrid::BILINEAR, 512, 1);
+    const six::sicd::GeoLocationGrid fine(
+            model, dims, 0.05, six::sicd::GeoLocationGrid::BILINEAR, 512, 1);
+
+    TEST_ASSERT(fine.isWithinTolerance());
+    TEST_ASSERT(fine.getColKnots().size() > coarse.getColKnots().size());
+    TEST_ASSERT(fine.getMaxError() <= 0.05);
+}
+
+TEST_CASE(testTileMatchesSinglePixel)
+{
+    const FakeModel model(-77.0);
+    const types::RowCol<size_t> dims(1000, 800);
+    const six::sicd::GeoLocationGrid grid(
+            model, dims, 0.01, six::sicd::GeoLocationGrid::BICUBIC, 128, 3);
+
+    const types::RowCol<size_t> offset(123, 45);
+    const types::RowCol<size_t> tile(37, 301);
+    std::vector<double> lat(tile.area());
+    std::vector<double> lon(tile.area());
+    std::vector<double> alt(tile.area());
+    grid.geolocate(offset, tile, &lat[0], &lon[0], &alt[0]);
+
+    for (size_t row = 0, idx = 0; row < tile.row; ++row)
+    {
+        for (size_t col = 0; col < tile.col; ++col, ++idx)
+        {
+            const six::LatLonAlt expected = grid.geolocate(
+                    six::RowColDouble(offset.row + row, offset.col + col));
+            TEST_ASSERT_ALMOST_EQ_EPS(lat[idx], expected.getLat(), 1e-9);
+            TEST_ASSERT_ALMOST_EQ_EPS(lon[idx], expected.getLon(), 1e-9);
+            TEST_ASSERT_ALMOST_EQ_EPS(alt[idx], expected.getAlt(), 1e-6);
+        }
+    }
+
+    // Altitude is optional
+    grid.geolocate(offset, tile, &lat[0], &lon[0], NULL);
+}
+
+TEST_CASE(testAntimeridian)
+{
+    // Longitudes run from 179.99 through 180 and wrap to -180
+    const FakeModel model(179.99);
+    const types::RowCol<size_t> dims(500, 2000);
+    const six::sicd::GeoLocationGrid grid(
+            model, dims, 0.01, six::sicd::GeoLocationGrid::BICUBIC, 64, 2);
+    TEST_ASSERT(grid.isWithinTolerance());
+
+    const six::RowColDouble pixel(250.5, 1900.25);
+    const six::LatLonAlt lla = grid.geolocate(pixel);
+    TEST_ASSERT(lla.getLon() < 0);
+    TEST_ASSERT(distance(lla, model.toLLA(pixel)) < 0.05);
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testWithinTolerance);
+    TEST_CHECK(testLastEdgesChecked);
+    TEST_CHECK(testBilinearRefines);
+    TEST_CHECK(testTileMatchesSinglePixel);
+    TEST_CHECK(testAntimeridian);
+    return 0;
+}
@@ -0,0 +1,175 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string.h>
+#include <vector>
+
+#include <io/TempFile.h>
+#include <import/six/sicd.h>
+#include "TestCase.h"
+#include "TestUtilities.h"
+
+namespace
+{
+const size_t NUM_ROWS = 123;
+const size_t NUM_COLS = 45;
+
+// Writes a SICD with complex float pixels, split into several image
+// segments if 'maxProductSize' is small enough, and returns its bytes
+std::vector<six::UByte> writeRampSICD(const std::string& pathname,
+                                      size_t maxProductSize)
+{
+    std::vector<std::complex<float> > pixels(NUM_ROWS * NUM_COLS);
+    for (size_t ii = 0; ii < pixels.size(); ++ii)
+    {
+        pixels[ii] = std::complex<float>(static_cast<float>(ii),
+                                         static_cast<float>(ii) + 0.5f);
+    }
+    writeSICD(pathname,
+              createComplexFloatData(types::RowCol<size_t>(NUM_ROWS,
+                                                           NUM_COLS)),
+              &pixels[0],
+              maxProductSize);
+
+    const six::UByte* const bytes =
+            reinterpret_cast<const six::UByte*>(&pixels[0]);
+    return std::vector<six::UByte>(
+            bytes, bytes + pixels.size() * sizeof(pixels[0]));
+}
+
+// Reads the region through getImageViews(), swapping to native byte order
+std::vector<six::UByte> readViews(const std::string& testName,
+                                  six::NITFReadControl& reader,
+                                  six::Region& region)
+{
+    const std::vector<six::ImageView> views =
+            reader.getImageViews(region, 0);
+
+    std::vector<six::UByte> output;
+    size_t expectedRow = region.getStartRow();
+    for (size_t ii = 0; ii < views.size(); ++ii)
+    {
+        const six::ImageView& view = views[ii];
+        TEST_ASSERT_EQ(view.startRow, expectedRow);
+        expectedRow += view.numRows;
+
+        for (size_t row = 0; row < view.numRows; ++row)
+        {
+            const six::UByte* const rowData = view.getRow(row);
+            const size_t rowBytes = view.numCols * view.numBytesPerPixel;
+            const size_t offset = output.size();
+            output.insert(output.end(), rowData, rowData + rowBytes);
+            if (view.needsByteSwap())
+            {
+                sys::byteSwap(&output[offset],
+                              static_cast<unsigned short>(view.elementSize),
+                              rowBytes / view.elementSize);
+            }
+        }
+    }
+    TEST_ASSERT_EQ(expectedRow, region.getStartRow() + region.getNumRows());
+    return output;
+}
+
+std::vector<six::UByte> expectedRegion(const std::vector<six::UByte>& image,
+                                       const six::Region& region)
+{
+    const size_t numBytesPerPixel = image.size() / (NUM_ROWS * NUM_COLS);
+    std::vector<six::UByte> expected;
+    for (size_t row = 0; row < static_cast<size_t>(region.getNumRows());
+         ++row)
+    {
+        const six::UByte* const start = &image[
+                ((region.getStartRow() + row) * NUM_COLS +
+                 region.getStartCol()) * numBytesPerPixel];
+        expected.insert(expected.end(), start,
+                        start + region.getNumCols() * numBytesPerPixel);
+    }
+    return expected;
+}
+
+six::Region makeRegion(size_t startRow,
+                       size_t numRows,
+                       size_t startCol,
+                       size_t numCols)
+{
+    six::Region region;
+    region.setStartRow(startRow);
+    region.setNumRows(numRows);
+    region.setStartCol(startCol);
+    region.setNumCols(numCols);
+    return region;
+}
+
+TEST_CASE(testMappedSegments)
+{
+    // Roughly 40 rows per segment
+    io::TempFile temp;
+    const std::vector<six::UByte> image =
+            writeRampSICD(temp.pathname(), 40 * NUM_COLS * 8);
+
+    six::NITFReadControl reader;
+    reader.enableMemoryMap();
+    reader.load(temp.pathname());
+    TEST_ASSERT(reader.isMemoryMapped(0));
+
+    six::Region full;
+    const std::vector<six::ImageView> views = reader.getImageViews(full, 0);
+    TEST_ASSERT(views.size() > 1);
+    TEST_ASSERT(views[0].isMapped());
+    TEST_ASSERT_EQ(full.getNumRows(), NUM_ROWS);
+    TEST_ASSERT_EQ(full.getNumCols(), NUM_COLS);
+    TEST_ASSERT(readViews(testName, reader, full) == image);
+
+    six::Region aoi = makeRegion(30, 50, 7, 20);
+    TEST_ASSERT(readViews(testName, reader, aoi) == expectedRegion(image, aoi));
+
+    six::Region tooBig = makeRegion(100, 50, 0, NUM_COLS);
+    TEST_EXCEPTION(reader.getImageViews(tooBig, 0));
+}
+
+TEST_CASE(testFallback)
+{
+    io::TempFile temp;
+    const std::vector<six::UByte> image =
+            writeRampSICD(temp.pathname(), 1 << 30);
+
+    // Without mapping, views are read through NITRO
+    six::NITFReadControl reader;
+    reader.load(temp.pathname());
+    TEST_ASSERT(!reader.isMemoryMapped(0));
+
+    six::Region aoi = makeRegion(10, 20, 5, 15);
+    const std::vector<six::ImageView> views = reader.getImageViews(aoi, 0);
+    TEST_ASSERT_EQ(views.size(), 1);
+    TEST_ASSERT(!views[0].isMapped());
+    TEST_ASSERT(!views[0].needsByteSwap());
+    TEST_ASSERT(aoi.getBuffer() == NULL);
+    TEST_ASSERT(readViews(testName, reader, aoi) == expectedRegion(image, aoi));
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testMappedSegments);
+    TEST_CHECK(testFallback);
+    return 0;
+}
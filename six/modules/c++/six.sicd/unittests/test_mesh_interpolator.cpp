@@ -0,0 +1,230 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <cmath>
+#include <map>
+#include <vector>
+
+#include <import/six/sicd.h>
+#include <six/sicd/MeshInterpolator.h>
+#include "TestCase.h"
+#include "TestUtilities.h"
+
+namespace
+{
+const double TOLERANCE = 1e-9;
+
+const types::RowCol<size_t> MESH_DIMS(6, 5);
+
+// Non-uniform increasing X knots and decreasing Y knots
+const double X_KNOTS[] = { -100.0, -60.0, -10.0, 5.0, 50.0, 120.0 };
+const double Y_KNOTS[] = { 80.0, 30.0, 0.0, -45.0, -90.0 };
+
+double bilinear(double x, double y)
+{
+    return 3.0 + 0.5 * x - 0.25 * y + 1e-3 * x * y;
+}
+
+double bicubic(double x, double y)
+{
+    return bilinear(x, y) + 1e-6 * x * x * x - 2e-6 * y * y * y +
+            1e-8 * x * x * y * y;
+}
+
+void getCoordinates(std::vector<double>& x, std::vector<double>& y)
+{
+    for (size_t row = 0; row < MESH_DIMS.row; ++row)
+    {
+        for (size_t col = 0; col < MESH_DIMS.col; ++col)
+        {
+            x.push_back(X_KNOTS[row]);
+            y.push_back(Y_KNOTS[col]);
+        }
+    }
+}
+
+std::vector<double> sample(double (*func)(double, double))
+{
+    std::vector<double> values;
+    for (size_t row = 0; row < MESH_DIMS.row; ++row)
+    {
+        for (size_t col = 0; col < MESH_DIMS.col; ++col)
+        {
+            values.push_back(func(X_KNOTS[row], Y_KNOTS[col]));
+        }
+    }
+    return values;
+}
+
+six::sicd::ScalarMesh createScalarMesh()
+{
+    std::vector<double> x;
+    std::vector<double> y;
+    getCoordinates(x, y);
+
+    std::map<std::string, std::vector<double> > scalars;
+    scalars["linear"] = sample(bilinear);
+    scalars["cubic"] = sample(bicubic);
+    return six::sicd::ScalarMesh("Scalars", MESH_DIMS, x, y,
+                                 scalars.size(), scalars);
+}
+
+TEST_CASE(testBilinear)
+{
+    const six::sicd::MeshInterpolator interpolator(createScalarMesh());
+    TEST_ASSERT_EQ(interpolator.getFieldNames().size(), 2);
+    const size_t field = interpolator.getFieldIndex("linear");
+    TEST_ASSERT_EQ(interpolator.getXKnots().front(), -100.0);
+    TEST_ASSERT_EQ(interpolator.getYKnots().front(), -90.0);
+
+    // Exact for a bilinear function, including extrapolation
+    for (double x = -130.0; x <= 150.0; x += 7.3)
+    {
+        for (double y = -100.0; y <= 95.0; y += 4.1)
+        {
+            TEST_ASSERT(almostEqual(interpolator.interpolate(field, x, y),
+                                    bilinear(x, y), TOLERANCE));
+        }
+    }
+}
+
+TEST_CASE(testBicubicGrid)
+{
+    const size_t numX = 37;
+    const size_t numY = 23;
+    const double x0 = -95.0;
+    const double dx = 5.5;
+    const double y0 = 75.0;
+    const double dy = -7.25;
+
+    for (size_t numThreads = 1; numThreads <= 4; numThreads += 3)
+    {
+        const six::sicd::MeshInterpolator interpolator(
+                createScalarMesh(),
+                six::sicd::MeshInterpolator::BICUBIC,
+                numThreads);
+        const size_t field = interpolator.getFieldIndex("cubic");
+
+        std::vector<double> grid(numX * numY);
+        interpolator.interpolateGrid(field, x0, dx, numX, y0, dy, numY,
+                                     &grid[0]);
+
+        std::vector<double> x;
+        std::vector<double> y;
+        for (size_t ii = 0; ii < numX; ++ii)
+        {
+            for (size_t jj = 0; jj < numY; ++jj)
+            {
+                x.push_back(x0 + ii * dx);
+                y.push_back(y0 + jj * dy);
+            }
+        }
+        std::vector<double> scattered(x.size());
+        interpolator.interpolate(field, &x[0], &y[0], x.size(),
+                                 &scattered[0]);
+
+        for (size_t ii = 0; ii < grid.size(); ++ii)
+        {
+            // Four-point Lagrange interpolation is exact for cubics in
+            // each variable
+            TEST_ASSERT(almostEqual(grid[ii], bicubic(x[ii], y[ii]),
+                                    TOLERANCE));
+            TEST_ASSERT(almostEqual(scattered[ii], grid[ii], TOLERANCE));
+        }
+    }
+}
+
+TEST_CASE(testNoiseMeshTile)
+{
+    std::vector<double> x;
+    std::vector<double> y;
+    getCoordinates(x, y);
+    const std::vector<double> linear = sample(bilinear);
+    const six::sicd::NoiseMesh mesh("Noise", MESH_DIMS, x, y,
+                                    linear, linear, linear);
+
+    const six::sicd::MeshInterpolator interpolator(mesh);
+    TEST_ASSERT_EQ(interpolator.getFieldNames().size(), 3);
+    const size_t field = interpolator.getFieldIndex("Combined noise");
+    TEST_ASSERT_EQ(field, 2);
+
+    std::auto_ptr<six::sicd::ComplexData> data(
+            six::sicd::Utilities::createFakeComplexData());
+    data->imageData->scpPixel = six::RowColInt(100, 80);
+    data->imageData->firstRow = 10;
+    data->imageData->firstCol = 20;
+    data->grid->row->sampleSpacing = 0.8;
+    data->grid->col->sampleSpacing = 1.1;
+
+    const types::RowCol<size_t> offset(40, 15);
+    const types::RowCol<size_t> dims(9, 13);
+    std::vector<double> tile(dims.area());
+    interpolator.interpolateTile(field, *data, offset, dims, &tile[0]);
+
+    for (size_t row = 0, idx = 0; row < dims.row; ++row)
+    {
+        for (size_t col = 0; col < dims.col; ++col, ++idx)
+        {
+            const double xm = (offset.row + row - 90.0) * 0.8;
+            const double ym = (offset.col + col - 60.0) * 1.1;
+            TEST_ASSERT(almostEqual(tile[idx], bilinear(xm, ym), TOLERANCE));
+        }
+    }
+}
+
+TEST_CASE(testInvalidMesh)
+{
+    std::vector<double> x;
+    std::vector<double> y;
+    getCoordinates(x, y);
+    std::map<std::string, std::vector<double> > scalars;
+    scalars["linear"] = sample(bilinear);
+
+    // Not rectilinear
+    std::vector<double> skewed(x);
+    skewed[7] += 1.0;
+    TEST_EXCEPTION(six::sicd::MeshInterpolator(six::sicd::ScalarMesh(
+            "Bad", MESH_DIMS, skewed, y, 1, scalars)));
+
+    // Not monotonic
+    std::vector<double> unsorted(y);
+    for (size_t row = 0; row < MESH_DIMS.row; ++row)
+    {
+        std::swap(unsorted[row * MESH_DIMS.col + 1],
+                  unsorted[row * MESH_DIMS.col + 2]);
+    }
+    TEST_EXCEPTION(six::sicd::MeshInterpolator(six::sicd::ScalarMesh(
+            "Bad", MESH_DIMS, x, unsorted, 1, scalars)));
+
+    const six::sicd::MeshInterpolator interpolator(six::sicd::ScalarMesh(
+            "Good", MESH_DIMS, x, y, 1, scalars));
+    TEST_EXCEPTION(interpolator.getFieldIndex("missing"));
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testBilinear);
+    TEST_CHECK(testBicubicGrid);
+    TEST_CHECK(testNoiseMeshTile);
+    TEST_CHECK(testInvalidMesh);
+    return 0;
+}
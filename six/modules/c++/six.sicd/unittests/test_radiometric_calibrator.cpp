@@ -0,0 +1,229 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <stdlib.h>
+#include <cmath>
+#include <complex>
+#include <vector>
+
+#include <import/six/sicd.h>
+#include <six/sicd/RadiometricCalibrator.h>
+#include "TestCase.h"
+#include "TestUtilities.h"
+
+namespace
+{
+const double TOLERANCE = 1e-5;
+
+const types::RowCol<size_t> OFFSET(7, 12);
+const types::RowCol<size_t> DIMS(25, 19);
+
+six::Poly2D getPoly(double constant)
+{
+    six::Poly2D poly(2, 1);
+    poly[0][0] = constant;
+    poly[1][0] = 1e-3;
+    poly[0][1] = -2e-3;
+    poly[1][1] = 1e-5;
+    poly[2][0] = 3e-6;
+    poly[2][1] = -1e-7;
+    return poly;
+}
+
+std::auto_ptr<six::sicd::ComplexData> createData(six::PixelType pixelType)
+{
+    std::auto_ptr<six::sicd::ComplexData> data(
+            six::sicd::Utilities::createFakeComplexData());
+    data->setPixelType(pixelType);
+    data->imageData->scpPixel = six::RowColInt(40, 30);
+    data->imageData->firstRow = 5;
+    data->imageData->firstCol = 3;
+    data->grid->row->sampleSpacing = 0.5;
+    data->grid->col->sampleSpacing = 0.75;
+
+    data->radiometric.reset(new six::Radiometric());
+    data->radiometric->sigmaZeroSFPoly = getPoly(2.0);
+    data->radiometric->rcsSFPoly = getPoly(5.0);
+    data->radiometric->noiseLevel.noiseType = six::Radiometric::NL_ABSOLUTE;
+    data->radiometric->noiseLevel.noisePoly = getPoly(-3.0);
+    return data;
+}
+
+// Meters from the SCP of a pixel in the image
+double getX(const six::sicd::ComplexData& data, size_t row)
+{
+    return (static_cast<double>(row) - (data.imageData->scpPixel.row -
+                                        data.imageData->firstRow)) *
+            data.grid->row->sampleSpacing;
+}
+
+double getY(const six::sicd::ComplexData& data, size_t col)
+{
+    return (static_cast<double>(col) - (data.imageData->scpPixel.col -
+                                        data.imageData->firstCol)) *
+            data.grid->col->sampleSpacing;
+}
+
+TEST_CASE(testFloatPixels)
+{
+    std::auto_ptr<six::sicd::ComplexData> data =
+            createData(six::PixelType::RE32F_IM32F);
+
+    std::vector<std::complex<float> > pixels(DIMS.area());
+    for (size_t ii = 0; ii < pixels.size(); ++ii)
+    {
+        pixels[ii] = std::complex<float>(rand() % 100 - 50.0f,
+                                         rand() % 100 - 50.0f);
+    }
+
+    const six::sicd::RadiometricCalibrator calibrator(
+            *data, six::sicd::RadiometricCalibrator::SIGMA_ZERO);
+
+    for (size_t numThreads = 1; numThreads <= 4; numThreads += 3)
+    {
+        std::vector<float> output(DIMS.area());
+        calibrator.calibrate(reinterpret_cast<six::UByte*>(&pixels[0]),
+                             OFFSET, DIMS, &output[0], numThreads);
+
+        for (size_t row = 0, idx = 0; row < DIMS.row; ++row)
+        {
+            for (size_t col = 0; col < DIMS.col; ++col, ++idx)
+            {
+                const double expected = std::norm(pixels[idx]) *
+                        data->radiometric->sigmaZeroSFPoly(
+                                getX(*data, OFFSET.row + row),
+                                getY(*data, OFFSET.col + col));
+                TEST_ASSERT(almostEqual(output[idx], expected, TOLERANCE));
+                TEST_ASSERT(almostEqual(
+                        calibrator.calibrate(std::norm(pixels[idx]),
+                                             OFFSET.row + row,
+                                             OFFSET.col + col),
+                        expected, TOLERANCE));
+            }
+        }
+    }
+}
+
+TEST_CASE(testIntegerPixels)
+{
+    std::auto_ptr<six::sicd::ComplexData> data =
+            createData(six::PixelType::RE16I_IM16I);
+
+    std::vector<std::complex<short> > pixels(DIMS.area());
+    for (size_t ii = 0; ii < pixels.size(); ++ii)
+    {
+        pixels[ii] = std::complex<short>(static_cast<short>(rand() % 2000),
+                                         static_cast<short>(-rand() % 2000));
+    }
+
+    const six::sicd::RadiometricCalibrator calibrator(
+            *data, six::sicd::RadiometricCalibrator::RCS,
+            six::sicd::RadiometricCalibrator::AMPLITUDE);
+
+    std::vector<float> output(DIMS.area());
+    calibrator.calibrate(reinterpret_cast<six::UByte*>(&pixels[0]),
+                         OFFSET, DIMS, &output[0], 2);
+
+    for (size_t row = 0, idx = 0; row < DIMS.row; ++row)
+    {
+        for (size_t col = 0; col < DIMS.col; ++col, ++idx)
+        {
+            const double real = pixels[idx].real();
+            const double imag = pixels[idx].imag();
+            const double expected = std::sqrt(
+                    (real * real + imag * imag) *
+                    data->radiometric->rcsSFPoly(
+                            getX(*data, OFFSET.row + row),
+                            getY(*data, OFFSET.col + col)));
+            TEST_ASSERT(almostEqual(output[idx], expected, TOLERANCE));
+        }
+    }
+}
+
+TEST_CASE(testAmplitudeTable)
+{
+    std::auto_ptr<six::sicd::ComplexData> data =
+            createData(six::PixelType::AMP8I_PHS8I);
+    data->imageData->amplitudeTable.reset(new six::AmplitudeTable());
+    for (size_t ii = 0; ii < 256; ++ii)
+    {
+        *reinterpret_cast<double*>((*data->imageData->amplitudeTable)[ii]) =
+                ii * 0.25 + 1.0;
+    }
+
+    std::vector<six::UByte> pixels(DIMS.area() * 2);
+    for (size_t ii = 0; ii < pixels.size(); ++ii)
+    {
+        pixels[ii] = static_cast<six::UByte>(rand() % 256);
+    }
+
+    const six::sicd::RadiometricCalibrator calibrator(
+            *data, six::sicd::RadiometricCalibrator::SIGMA_ZERO,
+            six::sicd::RadiometricCalibrator::POWER_DB, true);
+
+    std::vector<float> output(DIMS.area());
+    calibrator.calibrate(&pixels[0], OFFSET, DIMS, &output[0]);
+
+    for (size_t row = 0, idx = 0; row < DIMS.row; ++row)
+    {
+        for (size_t col = 0; col < DIMS.col; ++col, ++idx)
+        {
+            const double amplitude = pixels[2 * idx] * 0.25 + 1.0;
+            const double x = getX(*data, OFFSET.row + row);
+            const double y = getY(*data, OFFSET.col + col);
+            const double noise = std::pow(
+                    10.0, data->radiometric->noiseLevel.noisePoly(x, y) / 10.0);
+            const double power = std::max(amplitude * amplitude - noise, 0.0);
+            const double expected = 10.0 * std::log10(
+                    power * data->radiometric->sigmaZeroSFPoly(x, y));
+            TEST_ASSERT(almostEqual(output[idx], expected, TOLERANCE));
+        }
+    }
+}
+
+TEST_CASE(testInvalidMetadata)
+{
+    std::auto_ptr<six::sicd::ComplexData> data =
+            createData(six::PixelType::RE32F_IM32F);
+
+    // Not populated
+    TEST_EXCEPTION(six::sicd::RadiometricCalibrator(
+            *data, six::sicd::RadiometricCalibrator::GAMMA_ZERO));
+
+    data->radiometric->noiseLevel.noiseType = six::Radiometric::NL_RELATIVE;
+    TEST_EXCEPTION(six::sicd::RadiometricCalibrator(
+            *data, six::sicd::RadiometricCalibrator::RCS,
+            six::sicd::RadiometricCalibrator::POWER, true));
+
+    data->radiometric.reset();
+    TEST_EXCEPTION(six::sicd::RadiometricCalibrator(
+            *data, six::sicd::RadiometricCalibrator::RCS));
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testFloatPixels);
+    TEST_CHECK(testIntegerPixels);
+    TEST_CHECK(testAmplitudeTable);
+    TEST_CHECK(testInvalidMetadata);
+    return 0;
+}
@@ -0,0 +1,170 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string>
+#include <vector>
+
+#include <io/TempFile.h>
+#include <sys/OS.h>
+#include <sys/Path.h>
+#include <import/six/sicd.h>
+#include <six/MetadataRewriter.h>
+#include "TestCase.h"
+#include "TestUtilities.h"
+
+namespace
+{
+const size_t NUM_ROWS = 87;
+const size_t NUM_COLS = 31;
+const types::RowCol<size_t> DIMS(NUM_ROWS, NUM_COLS);
+const char ORIGINAL_NAME[] = "Original core name";
+
+typedef std::complex<float> ComplexT;
+
+std::auto_ptr<six::sicd::ComplexData> readSICD(const std::string& pathname,
+                                               std::vector<ComplexT>& image)
+{
+    six::NITFReadControl reader;
+    reader.load(pathname);
+    std::auto_ptr<six::sicd::ComplexData> data(
+            six::sicd::Utilities::getComplexData(reader));
+
+    image.resize(data->getNumRows() * data->getNumCols());
+    six::Region region;
+    region.setBuffer(reinterpret_cast<six::UByte*>(&image[0]));
+    reader.interleaved(region, 0);
+    return data;
+}
+
+six::Container getContainer(const std::string& pathname,
+                             const std::string& coreName)
+{
+    std::auto_ptr<six::sicd::ComplexData> data(
+            six::sicd::Utilities::getComplexData(
+                    pathname, std::vector<std::string>()));
+    data->setName(coreName);
+
+    six::Container container(six::DataType::COMPLEX);
+    container.addData(std::auto_ptr<six::Data>(data.release()));
+    return container;
+}
+
+TEST_CASE(testRewrite)
+{
+    io::TempFile input;
+    io::TempFile output;
+    const std::vector<ComplexT> image =
+            writeRandomSICD(input.pathname(), DIMS, ORIGINAL_NAME);
+
+    const std::string coreName(200, 'x');
+    six::rewriteMetadata(input.pathname(),
+                         getContainer(input.pathname(), coreName),
+                         std::vector<std::string>(),
+                         output.pathname());
+
+    std::vector<ComplexT> rewritten;
+    TEST_ASSERT_EQ(readSICD(output.pathname(), rewritten)->getName(),
+                   coreName);
+    TEST_ASSERT(rewritten == image);
+}
+
+TEST_CASE(testRewriteSameFile)
+{
+    io::TempFile temp;
+    const std::vector<ComplexT> image =
+            writeRandomSICD(temp.pathname(), DIMS, ORIGINAL_NAME);
+
+    // Spelled differently, but the same file
+    const std::pair<std::string, std::string> parts =
+            sys::Path::splitPath(temp.pathname());
+    const std::string alias = sys::Path::joinPaths(
+            sys::Path::joinPaths(parts.first, "."), parts.second);
+
+    six::rewriteMetadata(temp.pathname(),
+                         getContainer(temp.pathname(), "Same"),
+                         std::vector<std::string>(),
+                         alias);
+
+    std::vector<ComplexT> rewritten;
+    TEST_ASSERT_EQ(readSICD(temp.pathname(), rewritten)->getName(), "Same");
+    TEST_ASSERT(rewritten == image);
+}
+
+TEST_CASE(testRewriteInPlaceShorter)
+{
+    io::TempFile temp;
+    const std::vector<ComplexT> image =
+            writeRandomSICD(temp.pathname(), DIMS, ORIGINAL_NAME);
+    const sys::Off_T fileSize = sys::OS().getSize(temp.pathname());
+
+    six::rewriteMetadataInPlace(temp.pathname(),
+                                getContainer(temp.pathname(), "Short"),
+                                std::vector<std::string>());
+
+    // The XML is padded, so nothing moves
+    TEST_ASSERT_EQ(sys::OS().getSize(temp.pathname()), fileSize);
+
+    std::vector<ComplexT> rewritten;
+    TEST_ASSERT_EQ(readSICD(temp.pathname(), rewritten)->getName(), "Short");
+    TEST_ASSERT(rewritten == image);
+}
+
+TEST_CASE(testRewriteInPlaceLonger)
+{
+    io::TempFile temp;
+    const std::vector<ComplexT> image =
+            writeRandomSICD(temp.pathname(), DIMS, ORIGINAL_NAME);
+    const sys::Off_T fileSize = sys::OS().getSize(temp.pathname());
+
+    const std::string coreName(500, 'y');
+    six::rewriteMetadataInPlace(temp.pathname(),
+                                getContainer(temp.pathname(), coreName),
+                                std::vector<std::string>());
+    TEST_ASSERT_GREATER(sys::OS().getSize(temp.pathname()), fileSize);
+
+    std::vector<ComplexT> rewritten;
+    TEST_ASSERT_EQ(readSICD(temp.pathname(), rewritten)->getName(),
+                   coreName);
+    TEST_ASSERT(rewritten == image);
+}
+
+TEST_CASE(testMismatchedContainer)
+{
+    io::TempFile temp;
+    writeRandomSICD(temp.pathname(), DIMS, ORIGINAL_NAME);
+
+    six::Container container = getContainer(temp.pathname(), "Name");
+    container.addData(std::auto_ptr<six::Data>(
+            container.getData(0)->clone()));
+    TEST_EXCEPTION(six::rewriteMetadataInPlace(temp.pathname(), container,
+                                               std::vector<std::string>()));
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testRewrite);
+    TEST_CHECK(testRewriteSameFile);
+    TEST_CHECK(testRewriteInPlaceShorter);
+    TEST_CHECK(testRewriteInPlaceLonger);
+    TEST_CHECK(testMismatchedContainer);
+    return 0;
+}
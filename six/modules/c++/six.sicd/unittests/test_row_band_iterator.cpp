@@ -0,0 +1,207 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <vector>
+
+#include <import/six.h>
+#include <import/six/sicd.h>
+#include "TestCase.h"
+#include "TestUtilities.h"
+
+namespace
+{
+const size_t NUM_ROWS = 103;
+const size_t NUM_COLS = 17;
+
+// Serves pixels whose bytes encode their position, and can be told to fail
+class MockReadControl : public six::ReadControl
+{
+public:
+    MockReadControl() :
+        mFailAtRow(NUM_ROWS),
+        mNumReads(0)
+    {
+        std::auto_ptr<six::sicd::ComplexData> data = createComplexFloatData(
+                types::RowCol<size_t>(NUM_ROWS, NUM_COLS));
+
+        mContainer.reset(new six::Container(six::DataType::COMPLEX));
+        mContainer->addData(data.release());
+    }
+
+    virtual six::DataType getDataType(const std::string& ) const
+    {
+        return six::DataType::COMPLEX;
+    }
+
+    virtual void load(const std::string& , const std::vector<std::string>& )
+    {
+    }
+
+    virtual six::UByte* interleaved(six::Region& region, size_t )
+    {
+        ++mNumReads;
+        if (static_cast<size_t>(region.getStartRow() + region.getNumRows()) >
+            mFailAtRow)
+        {
+            throw except::Exception(Ctxt("Read failed"));
+        }
+
+        six::UByte* const buffer = region.getBuffer();
+        for (sys::SSize_T row = 0; row < region.getNumRows(); ++row)
+        {
+            for (sys::SSize_T col = 0; col < region.getNumCols(); ++col)
+            {
+                for (size_t byte = 0; byte < 8; ++byte)
+                {
+                    buffer[(row * region.getNumCols() + col) * 8 + byte] =
+                            pixelByte(region.getStartRow() + row,
+                                      region.getStartCol() + col,
+                                      byte);
+                }
+            }
+        }
+        return buffer;
+    }
+
+    virtual std::string getFileType() const
+    {
+        return "Mock";
+    }
+
+    static
+    six::UByte pixelByte(size_t row, size_t col, size_t byte)
+    {
+        return static_cast<six::UByte>(row * 31 + col * 7 + byte);
+    }
+
+    size_t mFailAtRow;
+    size_t mNumReads;
+};
+
+bool bandMatches(const six::ImageView& band)
+{
+    for (size_t row = 0; row < band.numRows; ++row)
+    {
+        const six::UByte* const rowData = band.getRow(row);
+        for (size_t col = 0; col < band.numCols; ++col)
+        {
+            for (size_t byte = 0; byte < 8; ++byte)
+            {
+                if (rowData[col * 8 + byte] !=
+                    MockReadControl::pixelByte(band.startRow + row,
+                                               band.startCol + col,
+                                               byte))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+TEST_CASE(testWholeImage)
+{
+    for (size_t readAhead = 1; readAhead <= 4; readAhead += 3)
+    {
+        MockReadControl reader;
+        six::RowBandIterator bands(reader, 0, six::Region(), 10, readAhead);
+        TEST_ASSERT_EQ(bands.getNumBands(), 11);
+
+        six::ImageView band;
+        size_t nextRow = 0;
+        while (bands.next(band))
+        {
+            TEST_ASSERT_EQ(band.startRow, nextRow);
+            TEST_ASSERT_EQ(band.numCols, NUM_COLS);
+            TEST_ASSERT_EQ(band.numBytesPerPixel, 8);
+            TEST_ASSERT_EQ(band.elementSize, 4);
+            TEST_ASSERT(!band.needsByteSwap());
+            TEST_ASSERT(bandMatches(band));
+            nextRow += band.numRows;
+        }
+        TEST_ASSERT_EQ(nextRow, NUM_ROWS);
+        TEST_ASSERT_EQ(reader.mNumReads, 11);
+        TEST_ASSERT(!bands.next(band));
+    }
+}
+
+TEST_CASE(testRegion)
+{
+    MockReadControl reader;
+    six::Region region;
+    region.setStartRow(5);
+    region.setNumRows(30);
+    region.setStartCol(3);
+
+    six::RowBandIterator bands(reader, 0, region, 8);
+    TEST_ASSERT_EQ(bands.getNumBands(), 4);
+
+    six::ImageView band;
+    size_t numRows = 0;
+    while (bands.next(band))
+    {
+        TEST_ASSERT_EQ(band.startRow, 5 + numRows);
+        TEST_ASSERT_EQ(band.startCol, 3);
+        TEST_ASSERT_EQ(band.numCols, NUM_COLS - 3);
+        TEST_ASSERT(bandMatches(band));
+        numRows += band.numRows;
+    }
+    TEST_ASSERT_EQ(numRows, 30);
+
+    region.setNumRows(NUM_ROWS);
+    TEST_EXCEPTION(six::RowBandIterator(reader, 0, region));
+    TEST_EXCEPTION(six::RowBandIterator(reader, 1));
+}
+
+TEST_CASE(testReadFailure)
+{
+    MockReadControl reader;
+    reader.mFailAtRow = 25;
+    six::RowBandIterator bands(reader, 0, six::Region(), 10);
+
+    six::ImageView band;
+    TEST_ASSERT(bands.next(band));
+    TEST_ASSERT(bands.next(band));
+    TEST_EXCEPTION(bands.next(band));
+    TEST_EXCEPTION(bands.next(band));
+}
+
+TEST_CASE(testStopEarly)
+{
+    MockReadControl reader;
+    {
+        six::RowBandIterator bands(reader, 0, six::Region(), 1, 3);
+        six::ImageView band;
+        TEST_ASSERT(bands.next(band));
+    }
+    TEST_ASSERT(reader.mNumReads < NUM_ROWS);
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testWholeImage);
+    TEST_CHECK(testRegion);
+    TEST_CHECK(testReadFailure);
+    TEST_CHECK(testStopEarly);
+    return 0;
+}
@@ -0,0 +1,185 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <vector>
+
+#include <io/FileOutputStream.h>
+#include <io/TempFile.h>
+#include <import/six/sicd.h>
+#include <six/StreamingCrop.h>
+#include <six/sicd/SICDByteProvider.h>
+#include "TestCase.h"
+#include "TestUtilities.h"
+
+namespace
+{
+const size_t NUM_ROWS = 123;
+const size_t NUM_COLS = 45;
+const types::RowCol<size_t> DIMS(NUM_ROWS, NUM_COLS);
+
+typedef std::complex<float> ComplexT;
+
+std::vector<ComplexT> getAOI(const std::vector<ComplexT>& image,
+                             const types::RowCol<size_t>& aoiOffset,
+                             const types::RowCol<size_t>& aoiDims)
+{
+    std::vector<ComplexT> aoi;
+    for (size_t row = 0; row < aoiDims.row; ++row)
+    {
+        for (size_t col = 0; col < aoiDims.col; ++col)
+        {
+            aoi.push_back(image[(aoiOffset.row + row) * NUM_COLS +
+                                aoiOffset.col + col]);
+        }
+    }
+    return aoi;
+}
+
+std::vector<ComplexT> readSICD(const std::string& pathname,
+                               types::RowCol<size_t>& dims)
+{
+    six::NITFReadControl reader;
+    reader.load(pathname);
+    const six::Data* const data = reader.getContainer()->getData(0);
+    dims.row = data->getNumRows();
+    dims.col = data->getNumCols();
+
+    std::vector<ComplexT> image(dims.row * dims.col);
+    six::Region region;
+    region.setBuffer(reinterpret_cast<six::UByte*>(&image[0]));
+    reader.interleaved(region, 0);
+    return image;
+}
+
+TEST_CASE(testReadRaw)
+{
+    io::TempFile temp;
+    const std::vector<ComplexT> image = writeRandomSICD(temp.pathname(), DIMS);
+
+    six::NITFReadControl reader;
+    reader.load(temp.pathname());
+
+    // Crosses two segment boundaries and doesn't start at column 0
+    const types::RowCol<size_t> aoiOffset(30, 7);
+    const types::RowCol<size_t> aoiDims(60, 20);
+    std::vector<ComplexT> raw(aoiDims.area());
+    six::Region region;
+    region.setStartRow(aoiOffset.row);
+    region.setNumRows(aoiDims.row);
+    region.setStartCol(aoiOffset.col);
+    region.setNumCols(aoiDims.col);
+    region.setBuffer(reinterpret_cast<six::UByte*>(&raw[0]));
+    reader.readRaw(region, 0);
+
+    if (!sys::isBigEndianSystem())
+    {
+        sys::byteSwap(&raw[0], sizeof(float), raw.size() * 2);
+    }
+    TEST_ASSERT(raw == getAOI(image, aoiOffset, aoiDims));
+
+    // Full width reads go through the contiguous path
+    std::vector<ComplexT> fullWidth(NUM_ROWS * NUM_COLS);
+    six::Region fullRegion;
+    fullRegion.setBuffer(reinterpret_cast<six::UByte*>(&fullWidth[0]));
+    reader.readRaw(fullRegion, 0);
+    TEST_ASSERT_EQ(fullRegion.getNumRows(), NUM_ROWS);
+    TEST_ASSERT_EQ(fullRegion.getNumCols(), NUM_COLS);
+    if (!sys::isBigEndianSystem())
+    {
+        sys::byteSwap(&fullWidth[0], sizeof(float), fullWidth.size() * 2);
+    }
+    TEST_ASSERT(fullWidth == image);
+
+    six::Region decimated;
+    decimated.setSkip(2, 2);
+    TEST_EXCEPTION(reader.readRaw(decimated, 0));
+}
+
+TEST_CASE(testCropSICD)
+{
+    io::TempFile input;
+    const std::vector<ComplexT> image =
+            writeRandomSICD(input.pathname(), DIMS);
+
+    const types::RowCol<size_t> aoiOffset(15, 10);
+    const types::RowCol<size_t> aoiDims(90, 30);
+    io::TempFile output;
+    six::sicd::cropSICD(input.pathname(), std::vector<std::string>(),
+                        aoiOffset, aoiDims, output.pathname());
+
+    types::RowCol<size_t> dims;
+    const std::vector<ComplexT> cropped = readSICD(output.pathname(), dims);
+    TEST_ASSERT_EQ(dims.row, aoiDims.row);
+    TEST_ASSERT_EQ(dims.col, aoiDims.col);
+    TEST_ASSERT(cropped == getAOI(image, aoiOffset, aoiDims));
+
+    TEST_EXCEPTION(six::sicd::cropSICD(
+            input.pathname(), std::vector<std::string>(),
+            types::RowCol<size_t>(100, 0), aoiDims, output.pathname()));
+}
+
+TEST_CASE(testSmallBands)
+{
+    io::TempFile input;
+    const std::vector<ComplexT> image =
+            writeRandomSICD(input.pathname(), DIMS);
+
+    six::NITFReadControl reader;
+    reader.load(input.pathname());
+
+    const types::RowCol<size_t> aoiOffset(3, 0);
+    const types::RowCol<size_t> aoiDims(110, NUM_COLS);
+    const std::auto_ptr<six::sicd::ComplexData> aoiData(
+            six::sicd::cropMetaData(
+                    *static_cast<const six::sicd::ComplexData*>(
+                            reader.getContainer()->getData(0)),
+                    aoiOffset, aoiDims));
+
+    // Output segments of about 25 rows, written 7 rows at a time
+    const six::sicd::SICDByteProvider byteProvider(
+            *aoiData, std::vector<std::string>(),
+            25 * NUM_COLS * sizeof(ComplexT));
+    io::TempFile output;
+    {
+        io::FileOutputStream outStream(output.pathname());
+        six::streamCrop(reader, 0, aoiOffset, *aoiData, byteProvider, false,
+                        outStream, 7 * NUM_COLS * sizeof(ComplexT));
+        outStream.close();
+    }
+
+    six::NITFReadControl croppedReader;
+    croppedReader.load(output.pathname());
+    TEST_ASSERT(croppedReader.getRecord().getNumImages() > 1);
+
+    types::RowCol<size_t> dims;
+    const std::vector<ComplexT> cropped = readSICD(output.pathname(), dims);
+    TEST_ASSERT_EQ(dims.row, aoiDims.row);
+    TEST_ASSERT(cropped == getAOI(image, aoiOffset, aoiDims));
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testReadRaw);
+    TEST_CHECK(testCropSICD);
+    TEST_CHECK(testSmallBands);
+    return 0;
+}
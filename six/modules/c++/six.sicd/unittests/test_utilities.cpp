@@ -20,6 +20,11 @@
 *
 */
 
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <io/StringStream.h>
 #include <import/six/sicd.h>
 #include "TestCase.h"
 
@@ -45,10 +50,31 @@ TEST_CASE(testCounterClockwiseTriangle)
     TEST_ASSERT(six::sicd::Utilities::isClockwise(vertices));
 }
 
+TEST_CASE(testToXMLString)
+{
+    // The text that's validated and returned is what printing the DOM
+    // writes
+    const std::auto_ptr<six::sicd::ComplexData> data(
+            six::sicd::Utilities::createFakeComplexData());
+    data->setPixelType(six::PixelType::RE32F_IM32F);
+    six::sicd::ComplexXMLControl xmlControl;
+    const std::vector<std::string> schemaPaths;
+    const std::auto_ptr<xml::lite::Document> doc(
+            xmlControl.toXML(data.get(), schemaPaths));
+    io::StringStream expected;
+    doc->getRootElement()->print(expected);
+
+    TEST_ASSERT_EQ(xmlControl.toXMLString(data.get(), schemaPaths),
+                   expected.stream().str());
+    TEST_ASSERT_EQ(six::sicd::Utilities::toXMLString(*data),
+                   expected.stream().str());
+}
+
 int main(int, char**)
 {
     TEST_CHECK(testClockwiseBox);
     TEST_CHECK(testCounterClockwiseTriangle);
+    TEST_CHECK(testToXMLString);
     return 0;
 }
 
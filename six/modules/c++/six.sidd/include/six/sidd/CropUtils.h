@@ -34,7 +34,9 @@ namespace sidd
 {
 /*
  * Reads in an AOI from a SIDD and creates a cropped SIDD, updating the
- * metadata as appropriate to reflect this
+ * metadata as appropriate to reflect this.  A SIDD with a single product
+ * is copied as-is (no byte swapping, same blocking) a band of rows at a
+ * time, so memory use doesn't depend on the size of the AOI.
  *
  * TODO: The SIDD standard supports more complicated chipping than this -
  * you can translate, rotate, and/or scale.
@@ -24,12 +24,15 @@
 
 #include <sys/Conf.h>
 #include <except/Exception.h>
+#include <io/FileOutputStream.h>
 #include <mem/ScopedArray.h>
 #include <six/NITFReadControl.h>
 #include <six/NITFWriteControl.h>
+#include <six/StreamingCrop.h>
 #include <six/sidd/Utilities.h>
 #include <six/sidd/CropUtils.h>
 #include <six/sidd/DerivedData.h>
+#include <six/sidd/SIDDByteProvider.h>
 
 namespace
 {
@@ -139,13 +142,23 @@ void cropSIDD(const std::string& inPathname,
     // Make sure it's a SIDD
     six::NITFReadControl reader;
     reader.load(inPathname, schemaPaths);
-    mem::SharedPtr<six::Container> container(reader.getContainer());
+
+    // Update a copy of the metadata so the reader still sees the full image
+    mem::SharedPtr<six::Container> container(
+            new six::Container(*reader.getContainer()));
 
     if (container->getDataType() != six::DataType::DERIVED)
     {
         throw except::Exception(Ctxt(inPathname + " is not a SIDD"));
     }
 
+    // A SIDD with a single product (and nothing else to carry over) is
+    // copied from the input a band of rows at a time, keeping its blocking.
+    // Otherwise every AOI is read in and the SIDD is written all at once.
+    const bool streamOutput = container->getNumData() == 1 &&
+            container->getLegend(0) == NULL &&
+            container->getDESSources().empty();
+
     Buffers buffers;
     for (size_t ii = 0, imageNum = 0; ii < container->getNumData(); ++ii)
     {
@@ -171,18 +184,21 @@ void cropSIDD(const std::string& inPathname,
             }
 
             // Read in the AOI
-            const size_t numBytesPerPixel(data->getNumBytesPerPixel());
-            const size_t numBytes =
-                    origDims.row * origDims.col * numBytesPerPixel;
-            sys::ubyte* const buffer = buffers.add(numBytes);
-
-            six::Region region;
-            region.setStartRow(aoiOffset.row);
-            region.setStartCol(aoiOffset.col);
-            region.setNumRows(aoiDims.row);
-            region.setNumCols(aoiDims.col);
-            region.setBuffer(buffer);
-            reader.interleaved(region, imageNum++);
+            if (!streamOutput)
+            {
+                const size_t numBytesPerPixel(data->getNumBytesPerPixel());
+                const size_t numBytes =
+                        aoiDims.row * aoiDims.col * numBytesPerPixel;
+                sys::ubyte* const buffer = buffers.add(numBytes);
+
+                six::Region region;
+                region.setStartRow(aoiOffset.row);
+                region.setStartCol(aoiOffset.col);
+                region.setNumRows(aoiDims.row);
+                region.setNumCols(aoiDims.col);
+                region.setBuffer(buffer);
+                reader.interleaved(region, imageNum++);
+            }
 
             // Update to reflect the AOI in the SIX metadata
             // Construct the pixel --> lat/lon functor first so updating this
@@ -236,6 +252,42 @@ void cropSIDD(const std::string& inPathname,
         }
     }
 
+    if (streamOutput)
+    {
+        const six::sidd::DerivedData& data =
+                *reinterpret_cast<const six::sidd::DerivedData*>(
+                        container->getData(0));
+
+        nitf::ImageSegment segment = reader.getRecord().getImages()[0];
+        nitf::ImageSubheader subheader = segment.getSubheader();
+        size_t numRowsPerBlock = 0;
+        size_t numColsPerBlock = 0;
+        if (static_cast<nitf::Uint32>(subheader.getNumBlocksPerRow()) > 1 ||
+            static_cast<nitf::Uint32>(subheader.getNumBlocksPerCol()) > 1)
+        {
+            numRowsPerBlock = static_cast<nitf::Uint32>(
+                    subheader.getNumPixelsPerVertBlock());
+            numColsPerBlock = static_cast<nitf::Uint32>(
+                    subheader.getNumPixelsPerHorizBlock());
+            if (numRowsPerBlock == 0)
+            {
+                numRowsPerBlock = aoiDims.row;
+            }
+            if (numColsPerBlock == 0)
+            {
+                numColsPerBlock = aoiDims.col;
+            }
+        }
+
+        const SIDDByteProvider byteProvider(data, schemaPaths,
+                                            numRowsPerBlock, numColsPerBlock);
+        io::FileOutputStream outStream(outPathname);
+        six::streamCrop(reader, 0, aoiOffset, data, byteProvider,
+                        numRowsPerBlock != 0, outStream);
+        outStream.close();
+        return;
+    }
+
     // Write the AOI SIDD out
     six::NITFWriteControl writer(container);
     writer.save(buffers.get(), outPathname, schemaPaths);
@@ -96,7 +96,7 @@ void DerivedXMLParser::getAttributeIfExists(
 {
     if (attributes.contains(attributeName))
     {
-        value = str::toType<sys::SSize_T>(attributes.getValue(attributeName));
+        value = six::toNumber<sys::SSize_T>(attributes.getValue(attributeName));
     }
     else
     {
@@ -111,7 +111,7 @@ void DerivedXMLParser::getAttributeIfExists(
 {
     if (attributes.contains(attributeName))
     {
-        value = str::toType<size_t>(attributes.getValue(attributeName));
+        value = six::toNumber<size_t>(attributes.getValue(attributeName));
     }
     else
     {
@@ -390,7 +390,7 @@ Remap* DerivedXMLParser::parseRemapChoiceFromXML(
             XMLElem remapLUTElem = getFirstAndOnly(colorRemapElem, "RemapLUT");
 
             //get size attribute
-            int size = str::toType<int>(remapLUTElem->attribute("size"));
+            int size = six::toNumber<int>(remapLUTElem->attribute("size"));
 
             // xs:list is space delimited
             std::string lutStr = remapLUTElem->getCharacterData();
@@ -404,7 +404,7 @@ Remap* DerivedXMLParser::parseRemapChoiceFromXML(
                 std::vector<std::string> rgb = str::split(lutVals[i], ",");
                 for (size_t j = 0; j < rgb.size(); j++)
                 {
-                    size_t intermediateVal = str::toType<size_t>(rgb[j]);
+                    size_t intermediateVal = six::toNumber<size_t>(rgb[j]);
                     if (intermediateVal > 255)
                     {
                         throw except::Exception(Ctxt(
@@ -461,7 +461,7 @@ Remap* DerivedXMLParser::parseRemapChoiceFromXML(
 std::auto_ptr<LUT> DerivedXMLParser::parseSingleLUT(const XMLElem elem) const
 {
     //get size attribute
-    int size = str::toType<int>(elem->attribute("size"));
+    int size = six::toNumber<int>(elem->attribute("size"));
 
     std::string lutStr = "";
     parseString(elem, lutStr);
@@ -470,7 +470,7 @@ std::auto_ptr<LUT> DerivedXMLParser::parseSingleLUT(const XMLElem elem) const
 
     for (size_t ii = 0; ii < lutVals.size(); ++ii)
     {
-        const short lutVal = str::toType<short>(lutVals[ii]);
+        const short lutVal = six::toNumber<short>(lutVals[ii]);
         ::memcpy(&(lut->table[ii * lut->elementSize]),
                  &lutVal, sizeof(short));
     }
@@ -2081,7 +2081,7 @@ std::auto_ptr<LUT> DerivedXMLParser200::parseSingleLUT(const XMLElem elem,
 
     for (size_t ii = 0; ii < lutVals.size(); ++ii)
     {
-        const short lutVal = str::toType<short>(lutVals[ii]);
+        const short lutVal = six::toNumber<short>(lutVals[ii]);
         ::memcpy(&(lut->table[ii * lut->elementSize]),
             &lutVal, sizeof(short));
     }
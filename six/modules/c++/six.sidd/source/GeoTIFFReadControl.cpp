@@ -204,6 +204,11 @@ six::UByte* six::sidd::GeoTIFFReadControl::interleaved(six::Region& region,
         throw except::IndexOutOfRangeException(Ctxt(
                 "Invalid index: " + str::toString(imIndex)));
     }
+    if (region.isDecimated())
+    {
+        throw except::NotImplementedException(Ctxt(
+                "Decimated reads are not supported for GeoTIFF"));
+    }
 
     tiff::ImageReader *imReader = mReader[imIndex];
     tiff::IFD *ifd = imReader->getIFD();
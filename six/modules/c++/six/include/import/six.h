@@ -31,7 +31,9 @@
 #include "six/MatchInformation.h"
 #include "six/GeoDataBase.h"
 #include "six/GeoInfo.h"
+#include "six/ImageView.h"
 #include "six/Mesh.h"
+#include "six/MetadataRewriter.h"
 #include "six/NITFImageInfo.h"
 #include "six/NITFImageInputStream.h"
 #include "six/NITFSegmentInfo.h"
@@ -42,11 +44,15 @@
 #include "six/Types.h"
 #include "six/Utilities.h"
 #include "six/Parameter.h"
+#include "six/PolyEvaluator.h"
 #include "six/Radiometric.h"
 #include "six/Region.h"
+#include "six/RowBandIterator.h"
 #include "six/ReadControl.h"
 #include "six/ReadControlFactory.h"
 #include "six/Serialize.h"
+#include "six/StreamingCrop.h"
+#include "six/ValidDataMask.h"
 #include "six/WriteControl.h"
 #include "six/XMLControl.h"
 #include "six/XMLControlFactory.h"
@@ -0,0 +1,118 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_IMAGE_VIEW_H__
+#define __SIX_IMAGE_VIEW_H__
+
+#include <stddef.h>
+#include <vector>
+
+#include <mem/SharedPtr.h>
+#include <sys/Conf.h>
+#include <six/MemoryMappedFile.h>
+#include <six/Types.h>
+
+namespace six
+{
+/*!
+ *  \struct ImageView
+ *  \brief Read-only window onto pixel data that may live in a memory
+ *  mapped file
+ *
+ *  Rows are 'rowStride' bytes apart and each row holds 'numCols'
+ *  pixel-interleaved pixels of 'numBytesPerPixel' bytes.  Pixels that come
+ *  straight out of a mapped NITF are in the file's (big-endian) byte order;
+ *  each band sample is 'elementSize' bytes, so needsByteSwap() tells the
+ *  caller whether samples of that size have to be swapped before use.
+ *
+ *  Views from NITFReadControl::getImageViews() keep whatever they point
+ *  into alive, so they remain valid even after the ReadControl is reset or
+ *  destroyed.  Views from a RowBandIterator point into its reusable
+ *  buffers instead.
+ */
+struct ImageView
+{
+    ImageView() :
+        startRow(0),
+        startCol(0),
+        numRows(0),
+        numCols(0),
+        numBytesPerPixel(0),
+        elementSize(0),
+        rowStride(0),
+        isBigEndian(false),
+        data(NULL)
+    {
+    }
+
+    //! Global row of the image that the first row of the view corresponds to
+    size_t startRow;
+
+    //! Global column of the image that the first column corresponds to
+    size_t startCol;
+
+    size_t numRows;
+    size_t numCols;
+    size_t numBytesPerPixel;
+
+    //! Number of bytes in each band of a pixel
+    size_t elementSize;
+
+    //! Number of bytes from the start of one row to the start of the next
+    size_t rowStride;
+
+    //! Whether the samples are stored big-endian
+    bool isBigEndian;
+
+    //! First pixel of the view
+    const UByte* data;
+
+    //! \return Whether the pixels point directly into a mapped file
+    bool isMapped() const
+    {
+        return mappedFile.get() != NULL;
+    }
+
+    //! \return Whether samples must be byte swapped on this system
+    bool needsByteSwap() const
+    {
+        return elementSize > 1 && isBigEndian != sys::isBigEndianSystem();
+    }
+
+    /*!
+     * \param row Row of the view (not of the image)
+     *
+     * \return First pixel in 'row'
+     */
+    const UByte* getRow(size_t row) const
+    {
+        return data + row * rowStride;
+    }
+
+    //! Set when 'data' points into a mapped file
+    mem::SharedPtr<const MemoryMappedFile> mappedFile;
+
+    //! Set when the pixels had to be read into memory
+    mem::SharedPtr<const std::vector<UByte> > buffer;
+};
+}
+
+#endif
@@ -0,0 +1,84 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_MEMORY_MAPPED_FILE_H__
+#define __SIX_MEMORY_MAPPED_FILE_H__
+
+#include <stddef.h>
+#include <string>
+
+#include <sys/Conf.h>
+#include <six/Types.h>
+
+namespace six
+{
+/*!
+ *  \class MemoryMappedFile
+ *  \brief Read-only memory mapping of an entire file
+ *
+ *  The mapping stays valid until the object is destroyed.  Pages are only
+ *  read from disk as they're touched, so files much larger than physical
+ *  memory can be mapped on 64-bit systems.
+ *
+ *  This class is not copyable.
+ */
+class MemoryMappedFile
+{
+public:
+    /*!
+     * \param pathname File to map
+     *
+     * \throws except::Exception if the file can't be opened or mapped
+     */
+    explicit MemoryMappedFile(const std::string& pathname);
+
+    ~MemoryMappedFile();
+
+    //! \return Start of the file's contents
+    const UByte* data() const
+    {
+        return mData;
+    }
+
+    //! \return Size of the file in bytes
+    sys::Uint64_T size() const
+    {
+        return mSize;
+    }
+
+private:
+    // Unimplemented - MemoryMappedFile is not copyable
+    MemoryMappedFile(const MemoryMappedFile& other);
+    MemoryMappedFile& operator=(const MemoryMappedFile& other);
+
+private:
+    const UByte* mData;
+    sys::Uint64_T mSize;
+#if defined(WIN32) || defined(_WIN32)
+    void* mFile;
+    void* mMapping;
+#else
+    int mFile;
+#endif
+};
+}
+
+#endif
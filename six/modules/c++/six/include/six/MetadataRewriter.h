@@ -0,0 +1,85 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_METADATA_REWRITER_H__
+#define __SIX_METADATA_REWRITER_H__
+
+#include <string>
+#include <vector>
+
+#include <six/Container.h>
+#include <six/XMLControlFactory.h>
+
+namespace six
+{
+/*!
+ * Copies a SICD/SIDD NITF, replacing its XML metadata with 'container'.
+ * Only the NITF file header (for the new lengths) and the XML DESs are
+ * regenerated; the image segments and every other DES are copied as-is in
+ * large chunks, so this never decodes or holds the pixel data.  Fields of
+ * the DES user-defined subheader that describe the XML (version, creation
+ * time, corners) are refreshed from the new metadata.  This is
+ * meant for metadata corrections and version updates; anything that
+ * changes the image segments (size, pixel type, etc.) needs a full write.
+ *
+ * \param inPathname Input SICD/SIDD pathname
+ * \param container Metadata to write.  There must be one Data per XML
+ * DES, in the same order as the file (i.e. as NITFReadControl loads them).
+ * \param schemaPaths Schema paths to validate the new XML against
+ * \param outPathname Output pathname.  If it's the input file, this is the
+ * same as rewriteMetadataInPlace().
+ * \param xmlRegistry XML registry to use.  If NULL, the XMLControlFactory
+ * is used.
+ *
+ * \throws except::Exception if the container doesn't match the file or the
+ * NITF has labels or reserved extensions
+ */
+void rewriteMetadata(const std::string& inPathname,
+                     const Container& container,
+                     const std::vector<std::string>& schemaPaths,
+                     const std::string& outPathname,
+                     const XMLControlRegistry* xmlRegistry = NULL);
+
+/*!
+ * Same as rewriteMetadata(), but modifies the file in place.  XML that's
+ * no longer than what it replaces is padded with trailing whitespace, so
+ * only the XML DESs are overwritten.  Longer XML moves the DESs after it
+ * (which are read into memory first) and updates the file header; the
+ * image segments are never touched.
+ *
+ * \param pathname SICD/SIDD pathname
+ * \param container Metadata to write
+ * \param schemaPaths Schema paths to validate the new XML against
+ * \param xmlRegistry XML registry to use.  If NULL, the XMLControlFactory
+ * is used.
+ *
+ * \throws except::Exception if the container doesn't match the file, the
+ * NITF has labels or reserved extensions, or the regenerated file header
+ * wouldn't be the same size as the original.  The file is not modified in
+ * these cases.
+ */
+void rewriteMetadataInPlace(const std::string& pathname,
+                            const Container& container,
+                            const std::vector<std::string>& schemaPaths,
+                            const XMLControlRegistry* xmlRegistry = NULL);
+}
+
+#endif
@@ -23,7 +23,10 @@
 #define __SIX_NITF_READ_CONTROL_H__
 
 #include <map>
+#include <vector>
 
+#include "six/ImageView.h"
+#include "six/MemoryMappedFile.h"
 #include "six/NITFImageInfo.h"
 #include "six/ReadControl.h"
 #include "six/ReadControlFactory.h"
@@ -144,7 +147,10 @@ public:
      * of rows and/or number of columns is set to -1, this indicates to read
      * the entirety of the image in that dimension.  In this case, this
      * parameter will be updated with the actual number of rows and/or
-     * columns that were read.
+     * columns that were read.  If the region has skip factors,
+     * NEAREST_NEIGHBOR decimation only decodes the rows and columns that
+     * are kept, and BRIGHTEST_PIXEL keeps the largest magnitude pixel of
+     * each box.
      * \param imageNumber Index of the image to read
      *
      * \return Buffer of image data.  This is simply a pointer to the buffer
@@ -154,6 +160,62 @@ public:
      */
     virtual UByte* interleaved(Region& region, size_t imageNumber);
 
+    /*!
+     * Read section of image data exactly as it's stored in the file: pixels
+     * are big-endian and nothing is converted.  Uncompressed segments are
+     * read straight from the file a row (or, for full-width unblocked
+     * regions, a whole segment) at a time, undoing any blocking.  Anything
+     * else is read through interleaved() and byte swapped back.
+     *
+     * \param region Rows and columns of the image to read.  A number of rows
+     * and/or columns of -1 means the entire image in that dimension, in
+     * which case it's updated with the actual size.  Skip factors aren't
+     * supported.
+     * \param imageNumber Index of the image to read
+     *
+     * \return Buffer of image data, allocated as in interleaved() if the
+     * region's buffer is NULL
+     */
+    UByte* readRaw(Region& region, size_t imageNumber);
+
+    /*!
+     * When enabled, load(fromFile, ...) memory maps the file so that
+     * uncompressed, unblocked (or row-blocked) image segments can be
+     * accessed through getImageViews() without reading or copying them.
+     * This must be set before calling load().
+     *
+     * \param enable Whether to memory map files
+     */
+    void enableMemoryMap(bool enable = true)
+    {
+        mUseMemoryMap = enable;
+    }
+
+    /*!
+     * \param imageNumber Index of the image
+     *
+     * \return Whether getImageViews() points directly into the mapped file
+     * for this image
+     */
+    bool isMemoryMapped(size_t imageNumber) const;
+
+    /*!
+     * Get read-only views of a section of image data.  If the image is
+     * memory mapped, there is one view per image segment that the region
+     * overlaps and the views point directly into the file (so pixels are
+     * big-endian).  Otherwise, this falls back to interleaved() and returns
+     * a single view of a buffer in native byte order.
+     *
+     * \param region Rows and columns of the image to view.  A number of rows
+     * and/or columns of -1 means the entire image in that dimension, in
+     * which case it's updated with the actual size.  The region's buffer is
+     * ignored.
+     * \param imageNumber Index of the image
+     *
+     * \return Views of the region, in row order
+     */
+    std::vector<ImageView> getImageViews(Region& region, size_t imageNumber);
+
     virtual std::string getFileType() const
     {
         return "NITF";
@@ -233,6 +295,51 @@ private:
                              size_t imageSeg,
                              Legend& legend);
 
+    // Decimated reads for interleaved().  'buffer' is the output buffer.
+    void readSkippedPixels(const Region& region,
+                           size_t imageNumber,
+                           UByte* buffer);
+
+    void readBrightestPixels(const Region& region,
+                             size_t imageNumber,
+                             UByte* buffer);
+
+    // Where one uncompressed image segment's blocks live in the file.
+    // Unblocked segments are a single block.
+    struct RawSegmentLayout
+    {
+        sys::Uint64_T offset;
+        size_t numRowsPerBlock;
+        size_t numColsPerBlock;
+        size_t numBlocksPerRow;
+    };
+
+    bool getRawLayout(nitf::ImageSegment& segment,
+                      const NITFImageInfo& info,
+                      RawSegmentLayout& layout) const;
+
+    void readRawRows(const RawSegmentLayout& layout,
+                     size_t firstRow,
+                     size_t numRows,
+                     size_t startCol,
+                     size_t numCols,
+                     size_t numBytesPerPixel,
+                     UByte* buffer);
+
+    // Where one image segment's pixels live in the mapped file
+    struct MappedSegment
+    {
+        const UByte* data;
+        size_t rowStride;
+        size_t elementSize;
+    };
+
+    void mapImages(const std::string& fromFile);
+
+    bool mapSegment(nitf::ImageSegment& segment,
+                    const NITFImageInfo& info,
+                    MappedSegment& mapped) const;
+
     static
     bool isLegend(nitf::ImageSubheader& subheader)
     {
@@ -247,6 +354,12 @@ private:
     // The issue occurs from the explicit destructor of
     // IOControl
     mem::SharedPtr<nitf::IOInterface> mInterface;
+
+    bool mUseMemoryMap;
+    mem::SharedPtr<const MemoryMappedFile> mMappedFile;
+
+    // Indexed by image.  Empty for images that can't be memory mapped.
+    std::vector<std::vector<MappedSegment> > mMappedSegments;
 };
 
 
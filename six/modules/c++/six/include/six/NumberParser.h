@@ -0,0 +1,115 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_NUMBER_PARSER_H__
+#define __SIX_NUMBER_PARSER_H__
+
+#include <stddef.h>
+#include <limits>
+#include <string>
+
+#include <str/Convert.h>
+#include <sys/Conf.h>
+
+namespace six
+{
+/*!
+ * Parse a plain decimal floating point number such as "-1.234E05" without
+ * going through a std::stringstream.  Leading and trailing whitespace is
+ * skipped.  This only succeeds when the result is guaranteed to be
+ * correctly rounded (at most 19 significant digits whose value fits in a
+ * double's mantissa, and a small enough power of ten), which covers how
+ * SIX writes numbers.  It doesn't depend on the locale.
+ *
+ * \param str Text to parse
+ * \param length Number of characters in 'str'
+ * \param[out] value Parsed value
+ *
+ * \return True if 'value' was set.  False if the text is malformed or is
+ * outside of what the fast path handles exactly.
+ */
+bool parseDoubleFast(const char* str, size_t length, double& value);
+
+/*!
+ * Parse a decimal integer with an optional sign without going through a
+ * std::stringstream.  Leading and trailing whitespace is skipped.
+ *
+ * \param str Text to parse
+ * \param length Number of characters in 'str'
+ * \param[out] value Parsed value
+ * \param[out] negative Whether there was a minus sign
+ *
+ * \return True if 'value' was set.  False if the text is malformed or the
+ * magnitude doesn't fit in 64 bits.
+ */
+bool parseIntegerFast(const char* str,
+                      size_t length,
+                      sys::Uint64_T& value,
+                      bool& negative);
+
+/*!
+ * Drop-in replacement for str::toType<T>() for numeric types.  Common
+ * cases are parsed directly; anything else falls back to str::toType<T>()
+ * so the results (and the exceptions) are the same.
+ *
+ * \param str Text to parse
+ *
+ * \return Parsed value
+ *
+ * \throws except::BadCastException if 'str' can't be converted
+ */
+template <typename T>
+T toNumber(const std::string& str)
+{
+    // str::toType() reads chars as characters and bools as "true"/"false"
+    if (std::numeric_limits<T>::is_integer &&
+        sizeof(T) > 1 && sizeof(T) <= sizeof(sys::Uint64_T))
+    {
+        sys::Uint64_T magnitude;
+        bool negative;
+        if (parseIntegerFast(str.c_str(), str.length(), magnitude, negative))
+        {
+            if (!negative &&
+                magnitude <= static_cast<sys::Uint64_T>(
+                        std::numeric_limits<T>::max()))
+            {
+                return static_cast<T>(magnitude);
+            }
+
+            // Negative values are only handled here if they fit; in
+            // particular, unsigned types get str::toType()'s behavior.
+            if (negative && std::numeric_limits<T>::is_signed &&
+                magnitude <= static_cast<sys::Uint64_T>(
+                        std::numeric_limits<T>::max()))
+            {
+                return static_cast<T>(-static_cast<sys::Int64_T>(magnitude));
+            }
+        }
+    }
+
+    return str::toType<T>(str);
+}
+
+template <>
+double toNumber<double>(const std::string& str);
+}
+
+#endif
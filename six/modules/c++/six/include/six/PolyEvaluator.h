@@ -0,0 +1,212 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_POLY_EVALUATOR_H__
+#define __SIX_POLY_EVALUATOR_H__
+
+#include <stddef.h>
+#include <vector>
+
+#include <six/Types.h>
+
+namespace six
+{
+/*!
+ * \class Poly2DEvaluator
+ * \brief Fast evaluation of a Poly2D at many points
+ *
+ * math::poly::TwoD stores a vector of OneD's and evaluates each of them
+ * separately.  This flattens the coefficients into one contiguous array
+ * and evaluates with Horner's scheme.  Grid evaluation is separable: each
+ * grid row collapses the polynomial to a 1-D polynomial in Y, which is
+ * then evaluated across all columns at once so the inner loop vectorizes.
+ *
+ * As with Poly2D, X is the first (row) variable and Y the second (column).
+ */
+class Poly2DEvaluator
+{
+public:
+    /*!
+     * \param poly Polynomial to evaluate.  It is copied.  Rows of
+     *        different lengths are zero-padded to the longest.
+     *
+     * \throws except::Exception if 'poly' is empty
+     */
+    explicit Poly2DEvaluator(const Poly2D& poly);
+
+    //! \return Order in X
+    size_t orderX() const
+    {
+        return mOrderX;
+    }
+
+    //! \return Order in Y of the longest row
+    size_t orderY() const
+    {
+        return mOrderY;
+    }
+
+    /*!
+     * Evaluate at a single point
+     * \param x X value
+     * \param y Y value
+     * \return poly(x, y)
+     */
+    double operator()(double x, double y) const;
+
+    /*!
+     * Evaluate at scattered points
+     * \param x X values
+     * \param y Y values
+     * \param numPoints Number of points in 'x', 'y' and 'output'
+     * \param output poly(x[ii], y[ii])
+     */
+    void evaluate(const double* x,
+                  const double* y,
+                  size_t numPoints,
+                  double* output) const;
+
+    /*!
+     * Evaluate on the grid formed by every pair of 'x' and 'y' values
+     * \param x X values (one per output row)
+     * \param numX Number of X values
+     * \param y Y values (one per output column)
+     * \param numY Number of Y values
+     * \param output Row-major numX x numY output:
+     *        output[ii * numY + jj] = poly(x[ii], y[jj])
+     * \param numThreads Number of threads to split the rows across
+     */
+    void evaluateGrid(const double* x,
+                      size_t numX,
+                      const double* y,
+                      size_t numY,
+                      double* output,
+                      size_t numThreads = 1) const;
+
+    /*!
+     * Evaluate on a regular grid where
+     *     x[ii] = x0 + ii * deltaX
+     *     y[jj] = y0 + jj * deltaY
+     * This is the common case of evaluating a polynomial in meters from
+     * the SCP over a block of pixels.
+     *
+     * \param x0 First X value
+     * \param deltaX X spacing
+     * \param numX Number of X values
+     * \param y0 First Y value
+     * \param deltaY Y spacing
+     * \param numY Number of Y values
+     * \param output Row-major numX x numY output
+     * \param numThreads Number of threads to split the rows across
+     */
+    void evaluateGrid(double x0,
+                      double deltaX,
+                      size_t numX,
+                      double y0,
+                      double deltaY,
+                      size_t numY,
+                      double* output,
+                      size_t numThreads = 1) const;
+
+    /*!
+     * Collapse the polynomial at a given X into the coefficients of a
+     * polynomial in Y
+     * \param x X value
+     * \param coeffsY orderY() + 1 output coefficients, lowest order first
+     */
+    void collapseX(double x, double* coeffsY) const;
+
+private:
+    size_t mOrderX;
+    size_t mOrderY;
+
+    // Coefficient of x^i y^j is at mCoeffs[i * (mOrderY + 1) + j]
+    std::vector<double> mCoeffs;
+};
+
+/*!
+ * \class PolyXYZEvaluator
+ * \brief Fast evaluation of a PolyXYZ (e.g. ARP position vs. time) at many
+ * times
+ *
+ * The X, Y and Z coefficients are stored as separate contiguous arrays and
+ * evaluated with Horner's scheme across all of the requested times at once.
+ */
+class PolyXYZEvaluator
+{
+public:
+    /*!
+     * \param poly Polynomial to evaluate.  It is copied.  Rows of
+     *        different lengths are zero-padded to the longest.
+     *
+     * \throws except::Exception if 'poly' is empty
+     */
+    explicit PolyXYZEvaluator(const PolyXYZ& poly);
+
+    //! \return Polynomial order
+    size_t order() const
+    {
+        return mX.size() - 1;
+    }
+
+    /*!
+     * Evaluate at a single time
+     * \param t Time
+     * \return poly(t)
+     */
+    Vector3 operator()(double t) const;
+
+    /*!
+     * Evaluate at many times, storing each component separately
+     * \param t Times
+     * \param numTimes Number of times
+     * \param x X component of poly(t[ii])
+     * \param y Y component of poly(t[ii])
+     * \param z Z component of poly(t[ii])
+     * \param numThreads Number of threads to split the times across
+     */
+    void evaluate(const double* t,
+                  size_t numTimes,
+                  double* x,
+                  double* y,
+                  double* z,
+                  size_t numThreads = 1) const;
+
+    /*!
+     * Evaluate at many times
+     * \param t Times
+     * \param numTimes Number of times
+     * \param output poly(t[ii])
+     * \param numThreads Number of threads to split the times across
+     */
+    void evaluate(const double* t,
+                  size_t numTimes,
+                  Vector3* output,
+                  size_t numThreads = 1) const;
+
+private:
+    std::vector<double> mX;
+    std::vector<double> mY;
+    std::vector<double> mZ;
+};
+}
+
+#endif
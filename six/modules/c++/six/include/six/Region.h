@@ -42,6 +42,10 @@ namespace six
  *
  *  Returned data is always component-interleaved.
  *
+ *  The region can also be decimated by a row and/or column skip factor to
+ *  read an overview without reading every pixel.  The start and number of
+ *  rows and columns are still in full-resolution pixels; the buffer holds
+ *  getNumDecimatedRows() x getNumDecimatedCols() pixels.
  *
  */
 class Region
@@ -51,10 +55,15 @@ class Region
     sys::SSize_T numRows;
     sys::SSize_T startCol;
     sys::SSize_T numCols;
+    size_t rowSkip;
+    size_t colSkip;
+    DecimationMethod decimationMethod;
 public:
     //!  Constructor.  Sets params for full window size, and buffer is NULL
     Region() :
-        mBuffer(NULL), startRow(0), numRows(-1), startCol(0), numCols(-1)
+        mBuffer(NULL), startRow(0), numRows(-1), startCol(0), numCols(-1),
+        rowSkip(1), colSkip(1),
+        decimationMethod(DecimationMethod::NEAREST_NEIGHBOR)
     {
     }
 
@@ -141,6 +150,73 @@ public:
         return numCols;
     }
 
+    /*!
+     *  Set the decimation factors.  Every rowSkip'th row and colSkip'th
+     *  column (starting with the first) is returned.  The default of 1
+     *  reads every pixel.  Throws if either factor is 0.
+     */
+    void setSkip(size_t rows, size_t cols)
+    {
+        if (rows == 0 || cols == 0)
+        {
+            throw except::Exception(Ctxt(
+                    "Decimation factors must be at least 1"));
+        }
+        rowSkip = rows;
+        colSkip = cols;
+    }
+
+    size_t getRowSkip() const
+    {
+        return rowSkip;
+    }
+
+    size_t getColSkip() const
+    {
+        return colSkip;
+    }
+
+    //!  Whether either skip factor is more than 1
+    bool isDecimated() const
+    {
+        return rowSkip > 1 || colSkip > 1;
+    }
+
+    /*!
+     *  Set how each rowSkip x colSkip box of pixels is reduced to one.
+     *  NEAREST_NEIGHBOR (the default) keeps the first pixel of the box
+     *  and skips reading the rest.  BRIGHTEST_PIXEL keeps the pixel with
+     *  the largest magnitude, which requires reading the whole box.
+     */
+    void setDecimationMethod(DecimationMethod method)
+    {
+        decimationMethod = method;
+    }
+
+    DecimationMethod getDecimationMethod() const
+    {
+        return decimationMethod;
+    }
+
+    /*!
+     *  Get the number of rows that will be returned, taking the row skip
+     *  into account.  Like getNumRows(), this is only meaningful once the
+     *  number of rows is known.
+     */
+    size_t getNumDecimatedRows() const
+    {
+        return (static_cast<size_t>(numRows) + rowSkip - 1) / rowSkip;
+    }
+
+    /*!
+     *  Get the number of columns that will be returned, taking the column
+     *  skip into account.
+     */
+    size_t getNumDecimatedCols() const
+    {
+        return (static_cast<size_t>(numCols) + colSkip - 1) / colSkip;
+    }
+
     /*!
      *  Get the buffer.  Before a read has been done, this may be NULL,
      *  depending on if the user has initialized the buffer using the
@@ -0,0 +1,146 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_ROW_BAND_ITERATOR_H__
+#define __SIX_ROW_BAND_ITERATOR_H__
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+#include <mt/RequestQueue.h>
+#include <mt/ThreadGroup.h>
+#include <sys/Mutex.h>
+#include <six/ImageView.h>
+#include <six/ReadControl.h>
+#include <six/Region.h>
+
+namespace six
+{
+/*!
+ *  \class RowBandIterator
+ *  \brief Sequential reader of an image in bands of rows, with read-ahead
+ *
+ *  A background thread reads the next few bands of rows through
+ *  ReadControl::interleaved() while the caller is processing the current
+ *  one, so sequential scans over slow (e.g. network) storage aren't bound
+ *  by the latency of each read.  Bands that cross image segments are
+ *  handled by the ReadControl.  The buffers are allocated once and reused.
+ *
+ *  While the iterator exists, it is the only thing that may use the
+ *  ReadControl.
+ *
+ *  This class is not copyable.
+ */
+class RowBandIterator
+{
+public:
+    /*!
+     * Starts reading the first bands in the background
+     *
+     * \param reader Loaded ReadControl to read from
+     * \param imageNumber Index of the image
+     * \param region Rows and columns to iterate over.  A number of rows
+     * and/or columns of -1 means the rest of the image in that dimension.
+     * The region's buffer is ignored.
+     * \param bandHeight Number of rows in each band (the last band may have
+     * fewer)
+     * \param numReadAhead Number of bands that may be read ahead of the one
+     * the caller is holding
+     */
+    RowBandIterator(ReadControl& reader,
+                    size_t imageNumber,
+                    const Region& region = Region(),
+                    size_t bandHeight = DEFAULT_BAND_HEIGHT,
+                    size_t numReadAhead = DEFAULT_READ_AHEAD);
+
+    //! Stops the background thread
+    ~RowBandIterator();
+
+    /*!
+     * Get the next band of rows.  The previous band's buffer is handed back
+     * to the background thread, so its view must no longer be used.
+     *
+     * \param[out] band View of the band in native byte order.  startRow
+     * and startCol are with respect to the whole image.
+     *
+     * \return False once every band has been returned
+     *
+     * \throws except::Exception if reading the band failed
+     */
+    bool next(ImageView& band);
+
+    //! \return Total number of bands
+    size_t getNumBands() const
+    {
+        return mNumBands;
+    }
+
+    static const size_t DEFAULT_BAND_HEIGHT;
+    static const size_t DEFAULT_READ_AHEAD;
+
+private:
+    // Unimplemented - RowBandIterator is not copyable
+    RowBandIterator(const RowBandIterator& other);
+    RowBandIterator& operator=(const RowBandIterator& other);
+
+private:
+    class ReadAheadRunnable;
+
+    void readBands();
+
+    size_t getBandRows(size_t band) const;
+
+    void stop();
+
+    bool isStopped();
+
+private:
+    ReadControl& mReader;
+    const size_t mImageNumber;
+    size_t mStartRow;
+    size_t mStartCol;
+    size_t mNumRows;
+    size_t mNumCols;
+    size_t mNumBytesPerPixel;
+    size_t mElementSize;
+    const size_t mBandHeight;
+    size_t mNumBands;
+
+    std::vector<std::vector<UByte> > mBuffers;
+
+    // Indices into mBuffers that the background thread may fill, and ones
+    // that have been filled (in band order)
+    mt::RequestQueue<size_t> mFreeBuffers;
+    mt::RequestQueue<size_t> mFilledBuffers;
+
+    size_t mCurrentBuffer;
+    size_t mNextBand;
+
+    sys::Mutex mMutex;
+    bool mStopped;
+    std::string mError;
+
+    mt::ThreadGroup mThreads;
+};
+}
+
+#endif
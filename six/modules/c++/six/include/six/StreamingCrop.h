@@ -0,0 +1,65 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_STREAMING_CROP_H__
+#define __SIX_STREAMING_CROP_H__
+
+#include <stddef.h>
+
+#include <io/SeekableStreams.h>
+#include <nitf/ByteProvider.hpp>
+#include <types/RowCol.h>
+#include <six/Data.h>
+#include <six/NITFReadControl.h>
+
+namespace six
+{
+//! Default number of pixel bytes streamCrop() holds at once
+const size_t DEFAULT_CROP_BAND_BYTES = 32 * 1024 * 1024;
+
+/*!
+ * Writes an AOI of an image to a new NITF one band of rows at a time, so
+ * the whole AOI is never in memory.  Pixels are copied exactly as they're
+ * stored in the input (see NITFReadControl::readRaw()), so nothing is byte
+ * swapped or converted.  'byteProvider' supplies the output's headers and
+ * image segment layout; the output is blocked the way it says.
+ *
+ * \param reader Loaded reader for the input
+ * \param imageNumber Index of the image to crop
+ * \param aoiOffset Upper left corner of the AOI in the input
+ * \param aoiData Metadata of the output.  Its size is the size of the AOI.
+ * \param byteProvider Byte provider created from 'aoiData'
+ * \param isBlocked Whether 'byteProvider' blocks the image
+ * \param outStream Stream to write the output to
+ * \param maxBandBytes Approximate number of pixel bytes to read at once.
+ * Bands are always at least one row (or one row of blocks).
+ */
+void streamCrop(NITFReadControl& reader,
+                size_t imageNumber,
+                const types::RowCol<size_t>& aoiOffset,
+                const Data& aoiData,
+                const nitf::ByteProvider& byteProvider,
+                bool isBlocked,
+                io::SeekableOutputStream& outStream,
+                size_t maxBandBytes = DEFAULT_CROP_BAND_BYTES);
+}
+
+#endif
@@ -0,0 +1,178 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_VALID_DATA_MASK_H__
+#define __SIX_VALID_DATA_MASK_H__
+
+#include <stddef.h>
+#include <vector>
+
+#include <types/RowCol.h>
+#include <six/Types.h>
+
+namespace six
+{
+/*!
+ * \class ValidDataMask
+ * \brief Rasterized valid data polygon
+ *
+ * The polygon is scanline-converted once into the columns that are valid
+ * on each row, so checking or masking a tile costs a few span comparisons
+ * per row rather than a point-in-polygon test per pixel.  A pixel is valid
+ * if its center is inside the polygon or on its boundary.
+ */
+class ValidDataMask
+{
+public:
+    //! Half-open range of valid columns [begin, end) on one row
+    struct Span
+    {
+        Span(size_t begin_ = 0, size_t end_ = 0) :
+            begin(begin_),
+            end(end_)
+        {
+        }
+
+        bool operator==(const Span& rhs) const
+        {
+            return begin == rhs.begin && end == rhs.end;
+        }
+
+        bool operator!=(const Span& rhs) const
+        {
+            return !(*this == rhs);
+        }
+
+        size_t begin;
+        size_t end;
+    };
+
+    //! How much of a tile is valid
+    enum TileClass
+    {
+        EMPTY,
+        PARTIAL,
+        FULL
+    };
+
+    /*!
+     * Every pixel of the image is valid.  This is what an image without a
+     * valid data polygon means.
+     *
+     * \param dims Number of rows and columns in the image
+     */
+    explicit ValidDataMask(const types::RowCol<size_t>& dims);
+
+    /*!
+     * \param vertices Polygon vertices in pixels.  The polygon must be
+     *        simple but may be in either order and needn't be convex.
+     * \param dims Number of rows and columns in the image.  The polygon
+     *        is clipped to it.
+     * \param offset Pixel location of the first image pixel in the
+     *        vertices' coordinate system (i.e. this is subtracted from
+     *        every vertex)
+     *
+     * \throws except::Exception if there are fewer than three vertices
+     */
+    ValidDataMask(const std::vector<RowColInt>& vertices,
+                  const types::RowCol<size_t>& dims,
+                  const RowColInt& offset = RowColInt(0, 0));
+
+    //! \return Number of rows and columns in the image
+    const types::RowCol<size_t>& getDims() const
+    {
+        return mDims;
+    }
+
+    /*!
+     * \param row Row in the image
+     *
+     * \return Valid columns on this row, in increasing order.  Empty if
+     * nothing on the row is valid.
+     */
+    const std::vector<Span>& getSpans(size_t row) const
+    {
+        return mSpans[row];
+    }
+
+    /*!
+     * \param row Row in the image
+     * \param col Column in the image
+     *
+     * \return Whether the pixel is valid
+     */
+    bool isValid(size_t row, size_t col) const;
+
+    //! \return Total number of valid pixels
+    size_t getNumValid() const;
+
+    /*!
+     * \param offset First row and column of the tile
+     * \param dims Number of rows and columns in the tile
+     *
+     * \return Whether none, some, or all of the tile is valid
+     */
+    TileClass classify(const types::RowCol<size_t>& offset,
+                       const types::RowCol<size_t>& dims) const;
+
+    /*!
+     * Classify every tile of the image.  Tiles on the last row and column
+     * are truncated to the image.
+     *
+     * \param tileDims Number of rows and columns in each tile
+     * \param[out] classes Row-major tile classes
+     *
+     * \return Number of tile rows and columns
+     */
+    types::RowCol<size_t> classifyTiles(const types::RowCol<size_t>& tileDims,
+                                        std::vector<TileClass>& classes) const;
+
+    /*!
+     * Write a mask of a tile: 1 for valid pixels and 0 for invalid ones
+     *
+     * \param offset First row and column of the tile
+     * \param dims Number of rows and columns in the tile
+     * \param[out] mask Row-major mask with dims.area() elements
+     */
+    void getMask(const types::RowCol<size_t>& offset,
+                 const types::RowCol<size_t>& dims,
+                 UByte* mask) const;
+
+    /*!
+     * Zero the invalid pixels of a tile
+     *
+     * \param offset First row and column of the tile
+     * \param dims Number of rows and columns in the tile
+     * \param numBytesPerPixel Number of bytes in each pixel
+     * \param[in,out] pixels Row-major tile
+     */
+    void maskTile(const types::RowCol<size_t>& offset,
+                  const types::RowCol<size_t>& dims,
+                  size_t numBytesPerPixel,
+                  UByte* pixels) const;
+
+private:
+    types::RowCol<size_t> mDims;
+    std::vector<std::vector<Span> > mSpans;
+};
+}
+
+#endif
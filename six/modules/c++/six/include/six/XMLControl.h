@@ -74,6 +74,20 @@ class XMLControl
                          const std::vector<std::string>& schemaPaths,
                          logging::Logger* log);
 
+    /*
+     *  \func validate
+     *  \brief Validate serialized xml and log any errors
+     *
+     *  \param xml XML text
+     *  \param uri Namespace URI of the root element, which picks the schema
+     *  \param schemaPaths  Directories or files of schema locations
+     *  \param log Logs validation errors
+     */
+    static void validate(const std::string& xml,
+                         const std::string& uri,
+                         const std::vector<std::string>& schemaPaths,
+                         logging::Logger* log);
+
     /*!
      * Retrieve the proper schema paths for validation.
      * Schema paths can come from three sources, in
@@ -99,6 +113,17 @@ class XMLControl
     xml::lite::Document* toXML(const Data* data,
                                const std::vector<std::string>& schemaPaths);
 
+    /*!
+     *  Convert the Data model into compact XML text.  The DOM is serialized
+     *  once, and that text is what gets validated, so validation errors
+     *  refer to columns of a single line.
+     *  \param data         Data structure
+     *  \param schemaPaths  Directories or files of schema locations
+     *  \return The XML text
+     */
+    std::string toXMLString(const Data* data,
+                            const std::vector<std::string>& schemaPaths);
+
     /*!
      *  Convert a document from a DOM into a Data model
      *  \param doc          XML Document
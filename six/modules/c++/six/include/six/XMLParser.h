@@ -28,6 +28,7 @@
 #include <logging/Logger.h>
 #include <six/Types.h>
 #include <six/Init.h>
+#include <six/NumberParser.h>
 
 namespace six
 {
@@ -134,7 +135,7 @@ protected:
     {
         try
         {
-            value = str::toType<T>(element->getCharacterData());
+            value = six::toNumber<T>(element->getCharacterData());
         }
         catch (const except::BadCastException& ex)
         {
@@ -178,6 +179,12 @@ protected:
     static XMLElem require(XMLElem element, const std::string& name);
 
 private:
+    //! \return First child of 'parent' named 'tag' (or NULL if there are
+    //!         none), with the total number of such children in 'numMatches'
+    static XMLElem findChild(XMLElem parent,
+                             const std::string& tag,
+                             size_t& numMatches);
+
     const std::string mDefaultURI;
     const bool mAddClassAttributes;
 
@@ -0,0 +1,55 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __SIX_XML_SERIALIZER_H__
+#define __SIX_XML_SERIALIZER_H__
+
+#include <stddef.h>
+#include <string>
+
+#include <xml/lite/Element.h>
+
+namespace six
+{
+/*!
+ * Append the compact (non-pretty-printed) XML for 'element' and all of its
+ * children to 'buffer'.  The output is byte-for-byte what
+ * xml::lite::Element::print() writes, but it goes straight into one
+ * growable buffer instead of building a temporary string per element and
+ * pushing each one through an io::OutputStream.
+ *
+ * \param element Root of the tree to serialize
+ * \param[in,out] buffer String to append to
+ */
+void appendXML(const xml::lite::Element& element, std::string& buffer);
+
+/*!
+ * \param element Root of the tree to serialize
+ * \param sizeHint Number of bytes to reserve up front
+ *
+ * \return The compact XML for 'element', identical to what
+ * xml::lite::Element::print() writes
+ */
+std::string toXMLString(const xml::lite::Element& element,
+                        size_t sizeHint = 16384);
+}
+
+#endif
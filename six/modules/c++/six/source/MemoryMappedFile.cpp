@@ -0,0 +1,159 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <sstream>
+
+#if defined(WIN32) || defined(_WIN32)
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <except/Exception.h>
+#include <six/MemoryMappedFile.h>
+
+namespace
+{
+// Call this before anything that could clobber errno
+std::string getErrorMessage(const std::string& operation,
+                            const std::string& pathname)
+{
+    std::ostringstream ostr;
+    ostr << "Unable to " << operation << " " << pathname;
+#if !defined(WIN32) && !defined(_WIN32)
+    ostr << ": " << strerror(errno);
+#endif
+    return ostr.str();
+}
+
+void throwError(const std::string& operation, const std::string& pathname)
+{
+    throw except::Exception(Ctxt(getErrorMessage(operation, pathname)));
+}
+}
+
+namespace six
+{
+#if defined(WIN32) || defined(_WIN32)
+MemoryMappedFile::MemoryMappedFile(const std::string& pathname) :
+    mData(NULL),
+    mSize(0),
+    mFile(INVALID_HANDLE_VALUE),
+    mMapping(NULL)
+{
+    mFile = CreateFileA(pathname.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                        NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (mFile == INVALID_HANDLE_VALUE)
+    {
+        throwError("open", pathname);
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(mFile, &size))
+    {
+        CloseHandle(mFile);
+        throwError("get the size of", pathname);
+    }
+    mSize = static_cast<sys::Uint64_T>(size.QuadPart);
+
+    if (mSize > 0)
+    {
+        mMapping = CreateFileMappingA(mFile, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mMapping != NULL)
+        {
+            mData = static_cast<const UByte*>(
+                    MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+        }
+        if (mData == NULL)
+        {
+            if (mMapping != NULL)
+            {
+                CloseHandle(mMapping);
+            }
+            CloseHandle(mFile);
+            throwError("map", pathname);
+        }
+    }
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    if (mData != NULL)
+    {
+        UnmapViewOfFile(mData);
+    }
+    if (mMapping != NULL)
+    {
+        CloseHandle(mMapping);
+    }
+    CloseHandle(mFile);
+}
+#else
+MemoryMappedFile::MemoryMappedFile(const std::string& pathname) :
+    mData(NULL),
+    mSize(0),
+    mFile(-1)
+{
+    mFile = ::open(pathname.c_str(), O_RDONLY);
+    if (mFile < 0)
+    {
+        throwError("open", pathname);
+    }
+
+    struct stat info;
+    if (::fstat(mFile, &info) != 0)
+    {
+        const std::string message =
+                getErrorMessage("get the size of", pathname);
+        ::close(mFile);
+        throw except::Exception(Ctxt(message));
+    }
+    mSize = static_cast<sys::Uint64_T>(info.st_size);
+
+    if (mSize > 0)
+    {
+        void* const data = ::mmap(NULL, static_cast<size_t>(mSize), PROT_READ,
+                                  MAP_SHARED, mFile, 0);
+        if (data == MAP_FAILED)
+        {
+            const std::string message = getErrorMessage("map", pathname);
+            ::close(mFile);
+            throw except::Exception(Ctxt(message));
+        }
+        mData = static_cast<const UByte*>(data);
+    }
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    if (mData != NULL)
+    {
+        ::munmap(const_cast<UByte*>(mData), static_cast<size_t>(mSize));
+    }
+    ::close(mFile);
+}
+#endif
+}
@@ -0,0 +1,445 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <memory>
+
+#if !defined(WIN32) && !defined(_WIN32)
+#include <sys/stat.h>
+#endif
+
+#include <except/Exception.h>
+#include <io/ByteStream.h>
+#include <logging/NullLogger.h>
+#include <mem/SharedPtr.h>
+#include <str/Convert.h>
+#include <str/Manip.h>
+#include <sys/File.h>
+#include <sys/Path.h>
+#include <import/nitf.hpp>
+#include <nitf/IOStreamWriter.hpp>
+#include <six/MetadataRewriter.h>
+#include <six/NITFHeaderCreator.h>
+#include <six/NITFReadControl.h>
+#include <six/Utilities.h>
+
+namespace
+{
+const size_t COPY_CHUNK_BYTES = 4 * 1024 * 1024;
+
+// Whether two pathnames name the same existing file, however they're
+// spelled (relative, through a link, etc.)
+bool isSameFile(const std::string& lhs, const std::string& rhs)
+{
+#if defined(WIN32) || defined(_WIN32)
+    std::string lhsPath =
+            sys::Path::normalizePath(sys::Path::absolutePath(lhs));
+    std::string rhsPath =
+            sys::Path::normalizePath(sys::Path::absolutePath(rhs));
+    str::lower(lhsPath);
+    str::lower(rhsPath);
+    return lhsPath == rhsPath;
+#else
+    struct stat lhsInfo;
+    struct stat rhsInfo;
+    return ::stat(lhs.c_str(), &lhsInfo) == 0 &&
+            ::stat(rhs.c_str(), &rhsInfo) == 0 &&
+            lhsInfo.st_dev == rhsInfo.st_dev &&
+            lhsInfo.st_ino == rhsInfo.st_ino;
+#endif
+}
+
+struct DESLayout
+{
+    sys::Off_T subheaderOffset;
+    sys::Off_T subheaderLength;
+    sys::Off_T dataOffset;
+    sys::Off_T dataLength;
+
+    // New subheader and XML for the SICD/SIDD DESs.  Empty for every
+    // other DES.
+    std::vector<sys::byte> subheader;
+    std::string xml;
+
+    bool isSIX() const
+    {
+        return !xml.empty();
+    }
+
+    sys::Off_T newSubheaderLength() const
+    {
+        return isSIX() ? static_cast<sys::Off_T>(subheader.size()) :
+                subheaderLength;
+    }
+
+    sys::Off_T newDataLength() const
+    {
+        return isSIX() ? static_cast<sys::Off_T>(xml.length()) : dataLength;
+    }
+
+    bool changesSize() const
+    {
+        return newSubheaderLength() != subheaderLength ||
+                newDataLength() != dataLength;
+    }
+};
+
+// Where everything is in the original file and what the new file header
+// looks like.  The image, graphic, and text segments are all between the
+// file header and the first DES, so they're one range of bytes.
+struct FileLayout
+{
+    sys::Off_T headerLength;
+    sys::Off_T segmentsLength;
+    sys::Off_T fileLength;
+    std::vector<DESLayout> des;
+    std::vector<sys::byte> newHeader;
+    sys::Off_T newFileLength;
+};
+
+void copyAndClear(io::ByteStream& stream, std::vector<sys::byte>& buffer)
+{
+    buffer.resize(stream.getSize());
+    std::copy(stream.get(), stream.get() + stream.getSize(), buffer.begin());
+    stream.clear();
+}
+
+// The user-defined subheader describes the XML (spec version, namespace,
+// corners, etc.), so refresh those fields from the new metadata.  The
+// fields that come from the producer rather than the data are kept.
+void updateUserDefinedSubheader(const six::Data& data,
+                                nitf::DESubheader& subheader)
+{
+    nitf::TRE fields = subheader.getSubheaderFields();
+    if (!fields.isValid() ||
+        !six::NITFHeaderCreator::needUserDefinedSubheader(data))
+    {
+        return;
+    }
+
+    nitf::DESubheader newSubheader;
+    six::NITFHeaderCreator().addUserDefinedSubheader(data, newSubheader);
+    nitf::TRE newFields = newSubheader.getSubheaderFields();
+
+    const char* const keys[] =
+    {
+        "DESSHDT", "DESSHSV", "DESSHSD", "DESSHTN", "DESSHLPG"
+    };
+    for (size_t ii = 0; ii < sizeof(keys) / sizeof(keys[0]); ++ii)
+    {
+        fields.setField(keys[ii], newFields[keys[ii]].toString());
+    }
+}
+
+FileLayout getLayout(const std::string& pathname,
+                     const six::Container& container,
+                     const std::vector<std::string>& schemaPaths,
+                     const six::XMLControlRegistry* xmlRegistry,
+                     bool padXML)
+{
+    six::loadXmlDataContentHandler();
+
+    nitf::IOHandle handle(pathname);
+    nitf::Reader reader;
+    nitf::Record record = reader.readIO(handle);
+
+    if (record.getNumLabels() > 0 || record.getNumReservedExtensions() > 0)
+    {
+        throw except::Exception(Ctxt(
+                "Can't rewrite the metadata of NITFs with labels or "
+                "reserved extensions"));
+    }
+
+    nitf::FileHeader fileHeader = record.getHeader();
+    const size_t numDES = record.getNumDataExtensions();
+    if (numDES == 0)
+    {
+        throw except::Exception(Ctxt(pathname + " has no DESs"));
+    }
+
+    FileLayout layout;
+    layout.headerLength = static_cast<nitf::Uint64>(
+            fileHeader.getHeaderLength());
+    layout.fileLength = static_cast<nitf::Uint64>(fileHeader.getFileLength());
+    layout.des.resize(numDES);
+
+    mem::SharedPtr<io::ByteStream> byteStream(new io::ByteStream());
+    nitf::IOStreamWriter io(byteStream);
+    nitf::Writer writer;
+    writer.prepareIO(io, record);
+
+    logging::NullLogger log;
+    size_t dataNum = 0;
+    for (size_t ii = 0; ii < numDES; ++ii)
+    {
+        nitf::DESegment segment = record.getDataExtensions()[ii];
+        nitf::ComponentInfo info =
+                fileHeader.getDataExtensionInfo(static_cast<int>(ii));
+
+        DESLayout& des = layout.des[ii];
+        des.subheaderLength = static_cast<nitf::Uint64>(
+                info.getLengthSubheader());
+        des.dataOffset = segment.getOffset();
+        des.dataLength = segment.getEnd() - segment.getOffset();
+        des.subheaderOffset = des.dataOffset - des.subheaderLength;
+
+        if (six::NITFReadControl::getDataType(segment) !=
+            six::DataType::NOT_SET)
+        {
+            if (dataNum >= container.getNumData())
+            {
+                throw except::Exception(Ctxt(
+                        pathname + " has more XML DESs than the container "
+                        "has data"));
+            }
+
+            const six::Data* const data = container.getData(dataNum++);
+            des.xml = six::toValidXMLString(data, schemaPaths, &log,
+                                            xmlRegistry);
+            if (padXML && des.xml.length() < des.dataLength)
+            {
+                des.xml.append(des.dataLength - des.xml.length(), ' ');
+            }
+
+            nitf::DESubheader subheader = segment.getSubheader();
+            updateUserDefinedSubheader(*data, subheader);
+            nitf::Uint32 userSublen;
+            writer.writeDESubheader(subheader, userSublen,
+                                    record.getVersion());
+            copyAndClear(*byteStream, des.subheader);
+
+            info.getLengthSubheader().set(
+                    static_cast<nitf::Uint32>(des.subheader.size()));
+            info.getLengthData().set(
+                    static_cast<nitf::Uint64>(des.xml.length()));
+        }
+    }
+
+    if (dataNum != container.getNumData())
+    {
+        throw except::Exception(Ctxt(
+                "Container has " + str::toString(container.getNumData()) +
+                " data but " + pathname + " has " + str::toString(dataNum) +
+                " XML DESs"));
+    }
+
+    layout.segmentsLength =
+            layout.des[0].subheaderOffset - layout.headerLength;
+
+    // Regenerate the file header with the new DES lengths, then fill in
+    // the file and header lengths the same way the ByteProvider does
+    nitf::Off fileLenOff;
+    nitf::Uint32 headerLength;
+    writer.writeHeader(fileLenOff, headerLength);
+
+    layout.newFileLength = headerLength + layout.segmentsLength;
+    for (size_t ii = 0; ii < numDES; ++ii)
+    {
+        layout.newFileLength += layout.des[ii].newSubheaderLength() +
+                layout.des[ii].newDataLength();
+    }
+
+    byteStream->seek(fileLenOff, io::Seekable::START);
+    writer.writeInt64Field(layout.newFileLength, NITF_FL_SZ, '0',
+                           NITF_WRITER_FILL_LEFT);
+    writer.writeInt64Field(headerLength, NITF_HL_SZ, '0',
+                           NITF_WRITER_FILL_LEFT);
+
+    copyAndClear(*byteStream, layout.newHeader);
+    return layout;
+}
+
+void readBytes(sys::File& file,
+               sys::Off_T offset,
+               sys::Off_T numBytes,
+               std::vector<sys::byte>& buffer)
+{
+    buffer.resize(static_cast<size_t>(numBytes));
+    if (numBytes > 0)
+    {
+        file.seekTo(offset, sys::File::FROM_START);
+        file.readInto(&buffer[0], buffer.size());
+    }
+}
+
+void copyBytes(sys::File& input,
+               sys::Off_T offset,
+               sys::Off_T numBytes,
+               sys::File& output)
+{
+    std::vector<sys::byte> buffer(static_cast<size_t>(
+            std::min<sys::Off_T>(numBytes, COPY_CHUNK_BYTES)));
+
+    input.seekTo(offset, sys::File::FROM_START);
+    while (numBytes > 0)
+    {
+        const size_t numBytesThisChunk = static_cast<size_t>(
+                std::min<sys::Off_T>(numBytes, buffer.size()));
+        input.readInto(&buffer[0], numBytesThisChunk);
+        output.writeFrom(&buffer[0], numBytesThisChunk);
+        numBytes -= numBytesThisChunk;
+    }
+}
+
+void write(sys::File& file, const std::string& str)
+{
+    file.writeFrom(str.c_str(), str.length());
+}
+
+void write(sys::File& file, const std::vector<sys::byte>& buffer)
+{
+    if (!buffer.empty())
+    {
+        file.writeFrom(&buffer[0], buffer.size());
+    }
+}
+}
+
+namespace six
+{
+void rewriteMetadata(const std::string& inPathname,
+                     const Container& container,
+                     const std::vector<std::string>& schemaPaths,
+                     const std::string& outPathname,
+                     const XMLControlRegistry* xmlRegistry)
+{
+    // Opening the output would truncate the input
+    if (isSameFile(inPathname, outPathname))
+    {
+        rewriteMetadataInPlace(inPathname, container, schemaPaths,
+                               xmlRegistry);
+        return;
+    }
+
+    const FileLayout layout = getLayout(inPathname, container, schemaPaths,
+                                        xmlRegistry, false);
+
+    sys::File input(inPathname);
+    sys::File output(outPathname, sys::File::WRITE_ONLY,
+                     sys::File::CREATE | sys::File::TRUNCATE);
+
+    write(output, layout.newHeader);
+    copyBytes(input, layout.headerLength, layout.segmentsLength, output);
+
+    for (size_t ii = 0; ii < layout.des.size(); ++ii)
+    {
+        const DESLayout& des = layout.des[ii];
+        if (des.isSIX())
+        {
+            write(output, des.subheader);
+            write(output, des.xml);
+        }
+        else
+        {
+            copyBytes(input, des.subheaderOffset,
+                      des.subheaderLength + des.dataLength, output);
+        }
+    }
+
+    output.close();
+}
+
+void rewriteMetadataInPlace(const std::string& pathname,
+                            const Container& container,
+                            const std::vector<std::string>& schemaPaths,
+                            const XMLControlRegistry* xmlRegistry)
+{
+    const FileLayout layout = getLayout(pathname, container, schemaPaths,
+                                        xmlRegistry, true);
+
+    if (static_cast<sys::Off_T>(layout.newHeader.size()) !=
+        layout.headerLength)
+    {
+        throw except::Exception(Ctxt(
+                "The file header of " + pathname + " would change from " +
+                str::toString(layout.headerLength) + " to " +
+                str::toString(layout.newHeader.size()) +
+                " bytes, so it can't be rewritten in place"));
+    }
+
+    // Everything after the first DES that changes size has to move, so
+    // read it in before anything is overwritten
+    size_t firstMoved = layout.des.size();
+    for (size_t ii = 0; ii < layout.des.size(); ++ii)
+    {
+        if (layout.des[ii].changesSize())
+        {
+            firstMoved = ii;
+            break;
+        }
+    }
+
+    if (layout.newFileLength < layout.fileLength)
+    {
+        throw except::Exception(Ctxt(
+                pathname + " would shrink, so it can't be rewritten in "
+                "place"));
+    }
+
+    sys::File file(pathname, sys::File::READ_AND_WRITE, sys::File::EXISTING);
+
+    std::vector<std::vector<sys::byte> > segments(layout.des.size());
+    for (size_t ii = firstMoved; ii < layout.des.size(); ++ii)
+    {
+        const DESLayout& des = layout.des[ii];
+        if (!des.isSIX())
+        {
+            readBytes(file, des.subheaderOffset,
+                      des.subheaderLength + des.dataLength, segments[ii]);
+        }
+    }
+
+    // DESs before the first one that moves are rewritten where they are
+    for (size_t ii = 0; ii < firstMoved; ++ii)
+    {
+        const DESLayout& des = layout.des[ii];
+        if (des.isSIX())
+        {
+            file.seekTo(des.subheaderOffset, sys::File::FROM_START);
+            write(file, des.subheader);
+            write(file, des.xml);
+        }
+    }
+
+    if (firstMoved < layout.des.size())
+    {
+        file.seekTo(layout.des[firstMoved].subheaderOffset,
+                    sys::File::FROM_START);
+        for (size_t ii = firstMoved; ii < layout.des.size(); ++ii)
+        {
+            const DESLayout& des = layout.des[ii];
+            if (des.isSIX())
+            {
+                write(file, des.subheader);
+                write(file, des.xml);
+            }
+            else
+            {
+                write(file, segments[ii]);
+            }
+        }
+    }
+
+    file.seekTo(0, sys::File::FROM_START);
+    write(file, layout.newHeader);
+    file.close();
+}
+}
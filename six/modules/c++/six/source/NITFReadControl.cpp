@@ -20,6 +20,8 @@
  *
  */
 
+#include <algorithm>
+#include <cstring>
 #include <sstream>
 
 #include <six/NITFReadControl.h>
@@ -77,11 +79,52 @@ six::PixelType getPixelType(nitf::ImageSubheader& subheader)
                 "Unexpected image representation '" + iRep + "'"));
     }
 }
+
+// Brightness of a native byte order pixel, used to compare pixels of the
+// same type.  Lookup table types compare their indices.
+double getMagnitude(const six::UByte* pixel, six::PixelType pixelType)
+{
+    switch (pixelType)
+    {
+    case six::PixelType::RE32F_IM32F:
+    {
+        float iq[2];
+        std::memcpy(iq, pixel, sizeof(iq));
+        return static_cast<double>(iq[0]) * iq[0] +
+                static_cast<double>(iq[1]) * iq[1];
+    }
+    case six::PixelType::RE16I_IM16I:
+    {
+        sys::Int16_T iq[2];
+        std::memcpy(iq, pixel, sizeof(iq));
+        return static_cast<double>(iq[0]) * iq[0] +
+                static_cast<double>(iq[1]) * iq[1];
+    }
+    case six::PixelType::MONO16I:
+    {
+        sys::Uint16_T value;
+        std::memcpy(&value, pixel, sizeof(value));
+        return value;
+    }
+    case six::PixelType::RGB24I:
+        return static_cast<double>(pixel[0]) + pixel[1] + pixel[2];
+    case six::PixelType::AMP8I_PHS8I:
+    case six::PixelType::MONO8I:
+    case six::PixelType::MONO8LU:
+    case six::PixelType::RGB8LU:
+        return pixel[0];
+    default:
+        throw except::NotImplementedException(Ctxt(
+                "Can't find the brightest pixel for pixel type " +
+                pixelType.toString()));
+    }
+}
 }
 
 namespace six
 {
-NITFReadControl::NITFReadControl()
+NITFReadControl::NITFReadControl() :
+    mUseMemoryMap(false)
 {
     // Make sure that if we use XML_DATA_CONTENT that we've loaded it into the
     // singleton PluginRegistry
@@ -241,6 +284,11 @@ void NITFReadControl::load(const std::string& fromFile,
 {
     mem::SharedPtr<nitf::IOInterface> handle(new nitf::IOHandle(fromFile));
     load(handle, schemaPaths);
+
+    if (mUseMemoryMap)
+    {
+        mapImages(fromFile);
+    }
 }
 
 void NITFReadControl::load(io::SeekableInputStream& stream,
@@ -632,13 +680,19 @@ UByte* NITFReadControl::interleaved(Region& region, size_t imageNumber)
         throw except::Exception(Ctxt(FmtX("Too many cols requested [%d]",
                                           numColsReq)));
 
+    if (region.getRowSkip() == 0 || region.getColSkip() == 0)
+    {
+        throw except::Exception(Ctxt("Skip factors must be positive"));
+    }
+
     // Allocate one band
     nitf::Uint32 bandList(0);
 
     nitf::Uint8* buffer = region.getBuffer();
 
-    size_t subWindowSize = numRowsReq * numColsReq
-            * thisImage->getData()->getNumBytesPerPixel();
+    size_t subWindowSize = region.getNumDecimatedRows() *
+            region.getNumDecimatedCols() *
+            thisImage->getData()->getNumBytesPerPixel();
 
     if (buffer == NULL)
     {
@@ -646,6 +700,27 @@ UByte* NITFReadControl::interleaved(Region& region, size_t imageNumber)
         region.setBuffer(buffer);
     }
 
+    if (region.isDecimated())
+    {
+        if (region.getDecimationMethod() ==
+            DecimationMethod::BRIGHTEST_PIXEL)
+        {
+            readBrightestPixels(region, imageNumber, buffer);
+        }
+        else if (region.getDecimationMethod() ==
+                 DecimationMethod::NEAREST_NEIGHBOR)
+        {
+            readSkippedPixels(region, imageNumber, buffer);
+        }
+        else
+        {
+            throw except::NotImplementedException(Ctxt(
+                    "Unsupported decimation method " +
+                    region.getDecimationMethod().toString()));
+        }
+        return buffer;
+    }
+
     // Do segmenting here
     nitf::SubWindow sw;
     sw.setStartCol(static_cast<nitf::Uint32>(startCol));
@@ -711,6 +786,542 @@ UByte* NITFReadControl::interleaved(Region& region, size_t imageNumber)
     return buffer;
 }
 
+void NITFReadControl::readSkippedPixels(const Region& region,
+                                        size_t imageNumber,
+                                        UByte* buffer)
+{
+    const NITFImageInfo& info = *mInfos[imageNumber];
+    const size_t nbpp = info.getData()->getNumBytesPerPixel();
+    const size_t startRow = region.getStartRow();
+    const size_t startCol = region.getStartCol();
+    const size_t numRows = region.getNumRows();
+    const size_t numCols = region.getNumCols();
+    const size_t rowSkip = region.getRowSkip();
+    const size_t colSkip = region.getColSkip();
+    const size_t numRowsOut = region.getNumDecimatedRows();
+    const size_t numColsOut = region.getNumDecimatedCols();
+
+    const std::vector<NITFSegmentInfo> imageSegments =
+            info.getImageSegments();
+    nitf::List images = mRecord.getImages();
+    nitf::Uint32 bandList(0);
+    createCompressionOptions(mCompressionOptions);
+
+    size_t rowOut = 0;
+    for (size_t seg = 0;
+         seg < imageSegments.size() && rowOut < numRowsOut;
+         ++seg)
+    {
+        const NITFSegmentInfo& segmentInfo = imageSegments[seg];
+        const size_t firstRow = startRow + rowOut * rowSkip;
+        const size_t endRow =
+                std::min(segmentInfo.endRow(), startRow + numRows);
+        if (firstRow >= endRow)
+        {
+            continue;
+        }
+        const size_t numRowsSeg = (endRow - 1 - firstRow) / rowSkip + 1;
+
+        const size_t nitfIndex = info.getStartIndex() + seg;
+        nitf::ImageSegment segment = (nitf::ImageSegment) images[nitfIndex];
+        nitf::ImageSubheader subheader = segment.getSubheader();
+        size_t numRowsPerBlock = static_cast<nitf::Uint32>(
+                subheader.getNumPixelsPerVertBlock());
+        size_t numColsPerBlock = static_cast<nitf::Uint32>(
+                subheader.getNumPixelsPerHorizBlock());
+        if (numRowsPerBlock == 0)
+        {
+            numRowsPerBlock = segmentInfo.numRows;
+        }
+        if (numColsPerBlock == 0)
+        {
+            numColsPerBlock = info.getData()->getNumCols();
+        }
+
+        nitf::ImageReader imageReader = mReader.newImageReader(
+                static_cast<int>(nitfIndex), mCompressionOptions);
+        nitf::SubWindow sw;
+        sw.setStartCol(static_cast<nitf::Uint32>(startCol));
+        sw.setNumBands(1);
+        sw.setBandList(&bandList);
+
+        UByte* output = buffer + rowOut * numColsOut * nbpp;
+        int padded;
+        if (rowSkip <= numRowsPerBlock && colSkip <= numColsPerBlock)
+        {
+            // Let NITRO skip the rows and columns as it decodes
+            nitf::PixelSkip pixelSkip(static_cast<nitf::Uint32>(rowSkip),
+                                      static_cast<nitf::Uint32>(colSkip));
+            sw.setDownSampler(&pixelSkip);
+            sw.setStartRow(
+                    static_cast<nitf::Uint32>(firstRow - segmentInfo.firstRow));
+            sw.setNumRows(static_cast<nitf::Uint32>(numRowsSeg));
+            sw.setNumCols(static_cast<nitf::Uint32>(numColsOut));
+            imageReader.read(sw, &output, &padded);
+        }
+        else
+        {
+            // NITRO can't skip by more than a block, so read just the rows
+            // we need and pick out the columns
+            std::vector<UByte> row(numCols * nbpp);
+            sw.setNumRows(1);
+            sw.setNumCols(static_cast<nitf::Uint32>(numCols));
+            for (size_t ii = 0; ii < numRowsSeg; ++ii)
+            {
+                sw.setStartRow(static_cast<nitf::Uint32>(
+                        firstRow + ii * rowSkip - segmentInfo.firstRow));
+                UByte* rowPtr = &row[0];
+                imageReader.read(sw, &rowPtr, &padded);
+                for (size_t col = 0; col < numColsOut; ++col)
+                {
+                    std::copy(&row[col * colSkip * nbpp],
+                              &row[col * colSkip * nbpp] + nbpp,
+                              output + (ii * numColsOut + col) * nbpp);
+                }
+            }
+        }
+        rowOut += numRowsSeg;
+    }
+}
+
+void NITFReadControl::readBrightestPixels(const Region& region,
+                                          size_t imageNumber,
+                                          UByte* buffer)
+{
+    const Data& data = *mInfos[imageNumber]->getData();
+    const PixelType pixelType = data.getPixelType();
+    const size_t nbpp = data.getNumBytesPerPixel();
+    const size_t startRow = region.getStartRow();
+    const size_t numRows = region.getNumRows();
+    const size_t numCols = region.getNumCols();
+    const size_t rowSkip = region.getRowSkip();
+    const size_t colSkip = region.getColSkip();
+    const size_t numRowsOut = region.getNumDecimatedRows();
+    const size_t numColsOut = region.getNumDecimatedCols();
+
+    // Read one row of boxes at a time
+    std::vector<UByte> boxRows(rowSkip * numCols * nbpp);
+    Region boxRegion;
+    boxRegion.setStartCol(region.getStartCol());
+    boxRegion.setNumCols(numCols);
+
+    for (size_t rowOut = 0; rowOut < numRowsOut; ++rowOut)
+    {
+        const size_t firstRow = startRow + rowOut * rowSkip;
+        const size_t numBoxRows =
+                std::min(rowSkip, startRow + numRows - firstRow);
+        boxRegion.setStartRow(firstRow);
+        boxRegion.setNumRows(numBoxRows);
+        boxRegion.setBuffer(&boxRows[0]);
+        interleaved(boxRegion, imageNumber);
+
+        for (size_t colOut = 0; colOut < numColsOut; ++colOut)
+        {
+            const size_t firstCol = colOut * colSkip;
+            const size_t numBoxCols = std::min(colSkip, numCols - firstCol);
+
+            const UByte* brightest = NULL;
+            double maxMagnitude = -1.0;
+            for (size_t row = 0; row < numBoxRows; ++row)
+            {
+                const UByte* pixel = &boxRows[(row * numCols + firstCol) * nbpp];
+                for (size_t col = 0; col < numBoxCols; ++col, pixel += nbpp)
+                {
+                    const double magnitude = getMagnitude(pixel, pixelType);
+                    if (magnitude > maxMagnitude)
+                    {
+                        maxMagnitude = magnitude;
+                        brightest = pixel;
+                    }
+                }
+            }
+
+            std::copy(brightest, brightest + nbpp,
+                      buffer + (rowOut * numColsOut + colOut) * nbpp);
+        }
+    }
+}
+
+void NITFReadControl::mapImages(const std::string& fromFile)
+{
+    mMappedFile.reset(new MemoryMappedFile(fromFile));
+    mMappedSegments.resize(mInfos.size());
+
+    nitf::List images = mRecord.getImages();
+    for (size_t ii = 0; ii < mInfos.size(); ++ii)
+    {
+        const NITFImageInfo& info = *mInfos[ii];
+        const size_t numSegments = info.getImageSegments().size();
+
+        std::vector<MappedSegment>& mappedSegments(mMappedSegments[ii]);
+        mappedSegments.resize(numSegments);
+        for (size_t seg = 0; seg < numSegments; ++seg)
+        {
+            nitf::ImageSegment segment =
+                    (nitf::ImageSegment) images[info.getStartIndex() + seg];
+            if (!mapSegment(segment, info, mappedSegments[seg]))
+            {
+                // Fall back to reading the whole image through NITRO
+                mappedSegments.clear();
+                break;
+            }
+        }
+    }
+}
+
+bool NITFReadControl::getRawLayout(nitf::ImageSegment& segment,
+                                   const NITFImageInfo& info,
+                                   RawSegmentLayout& layout) const
+{
+    nitf::ImageSubheader subheader = segment.getSubheader();
+
+    if (subheader.getImageCompression().toString() != "NC")
+    {
+        return false;
+    }
+
+    const size_t numBits =
+            static_cast<nitf::Uint32>(subheader.getNumBitsPerPixel());
+    const size_t numBands = subheader.getBandCount();
+    if (numBits % 8 != 0 ||
+        (numBands > 1 && subheader.getImageMode().toString() != "P"))
+    {
+        return false;
+    }
+
+    const size_t numRows = static_cast<nitf::Uint32>(subheader.getNumRows());
+    const size_t numCols = info.getData()->getNumCols();
+    layout.numRowsPerBlock = static_cast<nitf::Uint32>(
+            subheader.getNumPixelsPerVertBlock());
+    if (layout.numRowsPerBlock == 0)
+    {
+        layout.numRowsPerBlock = numRows;
+    }
+    layout.numColsPerBlock = static_cast<nitf::Uint32>(
+            subheader.getNumPixelsPerHorizBlock());
+    if (layout.numColsPerBlock == 0)
+    {
+        layout.numColsPerBlock = numCols;
+    }
+    layout.numBlocksPerRow =
+            static_cast<nitf::Uint32>(subheader.getNumBlocksPerRow());
+    const size_t numBlocksPerCol =
+            static_cast<nitf::Uint32>(subheader.getNumBlocksPerCol());
+    if (layout.numBlocksPerRow * layout.numColsPerBlock < numCols ||
+        numBlocksPerCol * layout.numRowsPerBlock < numRows)
+    {
+        return false;
+    }
+
+    // Every block has to actually be in the segment
+    const sys::Uint64_T numBytesPerBlock =
+            static_cast<sys::Uint64_T>(layout.numRowsPerBlock) *
+            layout.numColsPerBlock * info.getData()->getNumBytesPerPixel();
+    layout.offset = segment.getImageOffset();
+    return layout.offset + layout.numBlocksPerRow * numBlocksPerCol *
+            numBytesPerBlock <= segment.getImageEnd();
+}
+
+void NITFReadControl::readRawRows(const RawSegmentLayout& layout,
+                                  size_t firstRow,
+                                  size_t numRows,
+                                  size_t startCol,
+                                  size_t numCols,
+                                  size_t numBytesPerPixel,
+                                  UByte* buffer)
+{
+    const size_t numBytesPerBlockRow =
+            layout.numColsPerBlock * numBytesPerPixel;
+    const sys::Uint64_T numBytesPerBlock =
+            static_cast<sys::Uint64_T>(layout.numRowsPerBlock) *
+            numBytesPerBlockRow;
+
+    // With one block across, consecutive rows are consecutive in the file
+    // (only the last row of blocks is padded), so a full-width read is one
+    // contiguous read
+    if (layout.numBlocksPerRow == 1 && startCol == 0 &&
+        numCols == layout.numColsPerBlock)
+    {
+        mInterface->seek(static_cast<nitf::Off>(
+                layout.offset + firstRow * numBytesPerBlockRow),
+                NITF_SEEK_SET);
+        mInterface->read(buffer, numRows * numBytesPerBlockRow);
+        return;
+    }
+
+    const size_t endCol = startCol + numCols;
+    for (size_t row = firstRow; row < firstRow + numRows; ++row)
+    {
+        const size_t blockRow = row / layout.numRowsPerBlock;
+        const size_t rowInBlock = row % layout.numRowsPerBlock;
+        for (size_t col = startCol; col < endCol;)
+        {
+            const size_t blockCol = col / layout.numColsPerBlock;
+            const size_t colInBlock = col % layout.numColsPerBlock;
+            const size_t numColsThisBlock = std::min(
+                    endCol - col, layout.numColsPerBlock - colInBlock);
+
+            const sys::Uint64_T offset = layout.offset +
+                    (blockRow * layout.numBlocksPerRow + blockCol) *
+                            numBytesPerBlock +
+                    rowInBlock * numBytesPerBlockRow +
+                    colInBlock * numBytesPerPixel;
+            mInterface->seek(static_cast<nitf::Off>(offset), NITF_SEEK_SET);
+            mInterface->read(buffer, numColsThisBlock * numBytesPerPixel);
+
+            buffer += numColsThisBlock * numBytesPerPixel;
+            col += numColsThisBlock;
+        }
+    }
+}
+
+UByte* NITFReadControl::readRaw(Region& region, size_t imageNumber)
+{
+    if (imageNumber >= mInfos.size())
+    {
+        throw except::Exception(Ctxt(
+                "Image " + str::toString(imageNumber) + " is out of bounds"));
+    }
+    if (region.isDecimated())
+    {
+        throw except::Exception(Ctxt("Raw reads can't be decimated"));
+    }
+
+    const NITFImageInfo& info = *mInfos[imageNumber];
+    const size_t numBytesPerPixel = info.getData()->getNumBytesPerPixel();
+    const std::vector<NITFSegmentInfo> segments = info.getImageSegments();
+
+    std::vector<RawSegmentLayout> layouts(segments.size());
+    nitf::List images = mRecord.getImages();
+    bool isRaw = true;
+    for (size_t seg = 0; seg < segments.size() && isRaw; ++seg)
+    {
+        nitf::ImageSegment segment =
+                (nitf::ImageSegment) images[info.getStartIndex() + seg];
+        isRaw = getRawLayout(segment, info, layouts[seg]);
+    }
+
+    if (!isRaw)
+    {
+        // Let NITRO decode it and put the bytes back in file order
+        UByte* const buffer = interleaved(region, imageNumber);
+        if (!sys::isBigEndianSystem())
+        {
+            const size_t elementSize = numBytesPerPixel /
+                    std::max<size_t>(info.getData()->getNumChannels(), 1);
+            sys::byteSwap(buffer,
+                          static_cast<unsigned short>(elementSize),
+                          region.getNumRows() * region.getNumCols() *
+                                  numBytesPerPixel / elementSize);
+        }
+        return buffer;
+    }
+
+    const size_t numRowsTotal = info.getData()->getNumRows();
+    const size_t numColsTotal = info.getData()->getNumCols();
+    if (region.getNumRows() == -1)
+    {
+        region.setNumRows(numRowsTotal);
+    }
+    if (region.getNumCols() == -1)
+    {
+        region.setNumCols(numColsTotal);
+    }
+
+    const size_t startRow = region.getStartRow();
+    const size_t startCol = region.getStartCol();
+    const size_t numRowsReq = region.getNumRows();
+    const size_t numColsReq = region.getNumCols();
+
+    if (startRow + numRowsReq > numRowsTotal || startRow > numRowsTotal)
+    {
+        throw except::Exception(Ctxt(FmtX("Too many rows requested [%d]",
+                                          numRowsReq)));
+    }
+    if (startCol + numColsReq > numColsTotal || startCol > numColsTotal)
+    {
+        throw except::Exception(Ctxt(FmtX("Too many cols requested [%d]",
+                                          numColsReq)));
+    }
+
+    UByte* buffer = region.getBuffer();
+    if (buffer == NULL)
+    {
+        buffer = new UByte[numRowsReq * numColsReq * numBytesPerPixel];
+        region.setBuffer(buffer);
+    }
+
+    UByte* bufferPtr = buffer;
+    for (size_t seg = 0; seg < segments.size(); ++seg)
+    {
+        size_t firstRow;
+        size_t numRows;
+        if (!segments[seg].isInRange(startRow, numRowsReq, firstRow, numRows))
+        {
+            continue;
+        }
+
+        readRawRows(layouts[seg], firstRow - segments[seg].firstRow, numRows,
+                    startCol, numColsReq, numBytesPerPixel, bufferPtr);
+        bufferPtr += numRows * numColsReq * numBytesPerPixel;
+    }
+
+    return buffer;
+}
+
+bool NITFReadControl::mapSegment(nitf::ImageSegment& segment,
+                                 const NITFImageInfo& info,
+                                 MappedSegment& mapped) const
+{
+    RawSegmentLayout layout;
+    if (!getRawLayout(segment, info, layout))
+    {
+        return false;
+    }
+
+    // Rows are only contiguous if each row of blocks is a single block.
+    // Blocks may be padded past the last column, and the last row of blocks
+    // past the last row, but that doesn't change where the real rows are.
+    if (layout.numBlocksPerRow != 1 ||
+        layout.numColsPerBlock < info.getData()->getNumCols())
+    {
+        return false;
+    }
+
+    nitf::ImageSubheader subheader = segment.getSubheader();
+    const size_t numBits =
+            static_cast<nitf::Uint32>(subheader.getNumBitsPerPixel());
+    const size_t numBytesPerPixel = info.getData()->getNumBytesPerPixel();
+    const size_t numRows = static_cast<nitf::Uint32>(subheader.getNumRows());
+
+    mapped.rowStride = layout.numColsPerBlock * numBytesPerPixel;
+    mapped.elementSize = numBits / 8;
+    if (layout.offset + static_cast<sys::Uint64_T>(numRows) *
+            mapped.rowStride > mMappedFile->size())
+    {
+        return false;
+    }
+
+    mapped.data = mMappedFile->data() + layout.offset;
+    return true;
+}
+
+bool NITFReadControl::isMemoryMapped(size_t imageNumber) const
+{
+    return imageNumber < mMappedSegments.size() &&
+            !mMappedSegments[imageNumber].empty();
+}
+
+std::vector<ImageView> NITFReadControl::getImageViews(Region& region,
+                                                      size_t imageNumber)
+{
+    if (imageNumber >= mInfos.size())
+    {
+        throw except::Exception(Ctxt(
+                "Image " + str::toString(imageNumber) + " is out of bounds"));
+    }
+
+    const NITFImageInfo& info = *mInfos[imageNumber];
+    const size_t numRowsTotal = info.getData()->getNumRows();
+    const size_t numColsTotal = info.getData()->getNumCols();
+    const size_t numBytesPerPixel = info.getData()->getNumBytesPerPixel();
+
+    std::vector<ImageView> views;
+    if (!isMemoryMapped(imageNumber))
+    {
+        const size_t numRows = (region.getNumRows() == -1) ?
+                numRowsTotal : region.getNumRows();
+        const size_t numCols = (region.getNumCols() == -1) ?
+                numColsTotal : region.getNumCols();
+        mem::SharedPtr<std::vector<UByte> > buffer(new std::vector<UByte>(
+                std::max<size_t>(numRows * numCols * numBytesPerPixel, 1)));
+
+        UByte* const originalBuffer = region.getBuffer();
+        region.setBuffer(&(*buffer)[0]);
+        try
+        {
+            interleaved(region, imageNumber);
+        }
+        catch (...)
+        {
+            region.setBuffer(originalBuffer);
+            throw;
+        }
+        region.setBuffer(originalBuffer);
+
+        ImageView view;
+        view.startRow = region.getStartRow();
+        view.startCol = region.getStartCol();
+        view.numRows = region.getNumRows();
+        view.numCols = region.getNumCols();
+        view.numBytesPerPixel = numBytesPerPixel;
+        view.elementSize = numBytesPerPixel /
+                std::max<size_t>(info.getData()->getNumChannels(), 1);
+        view.rowStride = view.numCols * numBytesPerPixel;
+        view.isBigEndian = sys::isBigEndianSystem();
+        view.data = &(*buffer)[0];
+        view.buffer = buffer;
+        views.push_back(view);
+        return views;
+    }
+
+    if (region.getNumRows() == -1)
+    {
+        region.setNumRows(numRowsTotal);
+    }
+    if (region.getNumCols() == -1)
+    {
+        region.setNumCols(numColsTotal);
+    }
+
+    const size_t startRow = region.getStartRow();
+    const size_t startCol = region.getStartCol();
+    const size_t numRowsReq = region.getNumRows();
+    const size_t numColsReq = region.getNumCols();
+
+    if (startRow + numRowsReq > numRowsTotal || startRow > numRowsTotal)
+    {
+        throw except::Exception(Ctxt(FmtX("Too many rows requested [%d]",
+                                          numRowsReq)));
+    }
+    if (startCol + numColsReq > numColsTotal || startCol > numColsTotal)
+    {
+        throw except::Exception(Ctxt(FmtX("Too many cols requested [%d]",
+                                          numColsReq)));
+    }
+
+    const std::vector<NITFSegmentInfo> segments = info.getImageSegments();
+    const std::vector<MappedSegment>& mappedSegments =
+            mMappedSegments[imageNumber];
+    for (size_t seg = 0; seg < segments.size(); ++seg)
+    {
+        size_t firstRow;
+        size_t numRows;
+        if (!segments[seg].isInRange(startRow, numRowsReq, firstRow, numRows))
+        {
+            continue;
+        }
+
+        const MappedSegment& mapped = mappedSegments[seg];
+        ImageView view;
+        view.startRow = firstRow;
+        view.startCol = startCol;
+        view.numRows = numRows;
+        view.numCols = numColsReq;
+        view.numBytesPerPixel = numBytesPerPixel;
+        view.elementSize = mapped.elementSize;
+        view.rowStride = mapped.rowStride;
+        view.isBigEndian = true;
+        view.data = mapped.data +
+                (firstRow - segments[seg].firstRow) * mapped.rowStride +
+                startCol * numBytesPerPixel;
+        view.mappedFile = mMappedFile;
+        views.push_back(view);
+    }
+
+    return views;
+}
+
 std::auto_ptr<Legend> NITFReadControl::findLegend(size_t productNum)
 {
     std::auto_ptr<Legend> legend;
@@ -789,6 +1400,8 @@ void NITFReadControl::reset()
     }
     mInfos.clear();
     mInterface.reset();
+    mMappedFile.reset();
+    mMappedSegments.clear();
 }
 
 
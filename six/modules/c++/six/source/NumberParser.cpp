@@ -0,0 +1,248 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <six/NumberParser.h>
+
+namespace
+{
+// Every power of ten up to this is exactly representable as a double
+const int MAX_EXACT_POW10 = 22;
+
+const double POW10[MAX_EXACT_POW10 + 1] =
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Integers up to 2^53 are exactly representable as a double
+const sys::Uint64_T MAX_EXACT_INTEGER = 9007199254740992ULL;
+
+const size_t MAX_DIGITS = 19;
+
+inline
+bool isSpace(char ch)
+{
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r' ||
+           ch == '\v' || ch == '\f';
+}
+
+inline
+bool isDigit(char ch)
+{
+    return ch >= '0' && ch <= '9';
+}
+
+inline
+void skipSpace(const char*& str, const char* end)
+{
+    while (str != end && isSpace(*str))
+    {
+        ++str;
+    }
+}
+
+// Only trailing whitespace is allowed.  str::toType() would ignore
+// anything else, but it's left to handle those oddballs.
+inline
+bool atEnd(const char* str, const char* end)
+{
+    skipSpace(str, end);
+    return str == end;
+}
+
+inline
+bool parseSign(const char*& str, const char* end)
+{
+    if (str != end && (*str == '-' || *str == '+'))
+    {
+        return *str++ == '-';
+    }
+    return false;
+}
+}
+
+namespace six
+{
+bool parseDoubleFast(const char* str, size_t length, double& value)
+{
+    const char* const end = str + length;
+    skipSpace(str, end);
+    const bool negative = parseSign(str, end);
+
+    sys::Uint64_T mantissa = 0;
+    size_t numSignificant = 0;
+    bool sawDigit = false;
+    int exponent = 0;
+
+    for (; str != end && isDigit(*str); ++str)
+    {
+        sawDigit = true;
+        if (mantissa != 0 || *str != '0')
+        {
+            if (++numSignificant > MAX_DIGITS)
+            {
+                return false;
+            }
+            mantissa = mantissa * 10 + (*str - '0');
+        }
+    }
+
+    if (str != end && *str == '.')
+    {
+        for (++str; str != end && isDigit(*str); ++str)
+        {
+            sawDigit = true;
+            --exponent;
+            if (mantissa != 0 || *str != '0')
+            {
+                if (++numSignificant > MAX_DIGITS)
+                {
+                    return false;
+                }
+                mantissa = mantissa * 10 + (*str - '0');
+            }
+        }
+    }
+
+    if (!sawDigit)
+    {
+        return false;
+    }
+
+    if (str != end && (*str == 'e' || *str == 'E'))
+    {
+        ++str;
+        const bool negativeExponent = parseSign(str, end);
+        if (str == end || !isDigit(*str))
+        {
+            return false;
+        }
+
+        int explicitExponent = 0;
+        for (; str != end && isDigit(*str); ++str)
+        {
+            // Anything this big is outside the fast path anyway
+            if (explicitExponent > 1000)
+            {
+                return false;
+            }
+            explicitExponent = explicitExponent * 10 + (*str - '0');
+        }
+        exponent += negativeExponent ? -explicitExponent : explicitExponent;
+    }
+
+    if (!atEnd(str, end))
+    {
+        return false;
+    }
+
+    if (mantissa == 0)
+    {
+        value = negative ? -0.0 : 0.0;
+        return true;
+    }
+
+    // Clinger's fast path: when both the mantissa and the power of ten are
+    // exact doubles, a single multiply or divide is correctly rounded
+    if (mantissa > MAX_EXACT_INTEGER)
+    {
+        return false;
+    }
+
+    if (exponent > MAX_EXACT_POW10)
+    {
+        // Move some of the exponent into the mantissa if that stays exact
+        // (e.g. 12E25 = 12000E22)
+        while (exponent > MAX_EXACT_POW10 && mantissa <= MAX_EXACT_INTEGER / 10)
+        {
+            mantissa *= 10;
+            --exponent;
+        }
+        if (exponent > MAX_EXACT_POW10)
+        {
+            return false;
+        }
+    }
+    else if (exponent < -MAX_EXACT_POW10)
+    {
+        return false;
+    }
+
+    double result = static_cast<double>(mantissa);
+    if (exponent < 0)
+    {
+        result /= POW10[-exponent];
+    }
+    else
+    {
+        result *= POW10[exponent];
+    }
+
+    value = negative ? -result : result;
+    return true;
+}
+
+bool parseIntegerFast(const char* str,
+                      size_t length,
+                      sys::Uint64_T& value,
+                      bool& negative)
+{
+    const char* const end = str + length;
+    skipSpace(str, end);
+    negative = parseSign(str, end);
+
+    if (str == end || !isDigit(*str))
+    {
+        return false;
+    }
+
+    const sys::Uint64_T maxValue = std::numeric_limits<sys::Uint64_T>::max();
+    sys::Uint64_T result = 0;
+    for (; str != end && isDigit(*str); ++str)
+    {
+        const unsigned int digit = *str - '0';
+        if (result > (maxValue - digit) / 10)
+        {
+            return false;
+        }
+        result = result * 10 + digit;
+    }
+
+    if (!atEnd(str, end))
+    {
+        return false;
+    }
+
+    value = result;
+    return true;
+}
+
+template <>
+double toNumber<double>(const std::string& str)
+{
+    double value;
+    if (parseDoubleFast(str.c_str(), str.length(), value))
+    {
+        return value;
+    }
+    return str::toType<double>(str);
+}
+}
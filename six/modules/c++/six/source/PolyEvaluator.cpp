@@ -0,0 +1,291 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+
+#include <except/Exception.h>
+#include <scene/RangeRunnable.h>
+#include <six/PolyEvaluator.h>
+
+namespace
+{
+// Evaluates a 1-D polynomial at every point in 'y' with Horner's scheme.
+// The loop over points is innermost so it vectorizes.
+inline
+void hornerAcross(const double* coeffs,
+                  size_t order,
+                  const double* y,
+                  size_t numPoints,
+                  double* output)
+{
+    const double highest = coeffs[order];
+    for (size_t jj = 0; jj < numPoints; ++jj)
+    {
+        output[jj] = highest;
+    }
+    for (size_t kk = order; kk-- > 0;)
+    {
+        const double coeff = coeffs[kk];
+        for (size_t jj = 0; jj < numPoints; ++jj)
+        {
+            output[jj] = output[jj] * y[jj] + coeff;
+        }
+    }
+}
+
+struct GridJob
+{
+    const six::Poly2DEvaluator* poly;
+    const double* x;
+    const double* y;
+    size_t numY;
+    double* output;
+
+    void operator()(size_t startX, size_t numX) const
+    {
+        std::vector<double> coeffsY(poly->orderY() + 1);
+        for (size_t ii = startX; ii < startX + numX; ++ii)
+        {
+            poly->collapseX(x[ii], &coeffsY[0]);
+            hornerAcross(&coeffsY[0], poly->orderY(), y, numY,
+                         output + ii * numY);
+        }
+    }
+};
+
+struct XYZJob
+{
+    const six::PolyXYZEvaluator* poly;
+    const double* t;
+    double* x;
+    double* y;
+    double* z;
+
+    void operator()(size_t start, size_t numTimes) const
+    {
+        poly->evaluate(t + start, numTimes, x + start, y + start, z + start,
+                       1);
+    }
+};
+}
+
+namespace six
+{
+Poly2DEvaluator::Poly2DEvaluator(const Poly2D& poly)
+{
+    if (poly.empty())
+    {
+        throw except::Exception(Ctxt("Cannot evaluate an empty polynomial"));
+    }
+
+    // Poly2D only looks at the first row for orderY(), but it evaluates
+    // each row with however many coefficients that row has.  Rows shorter
+    // than the longest are padded with zeros so the result is the same.
+    mOrderX = poly.orderX();
+    size_t numY = 0;
+    for (size_t ii = 0; ii <= mOrderX; ++ii)
+    {
+        numY = std::max(numY, poly[ii].size());
+    }
+    if (numY == 0)
+    {
+        throw except::Exception(Ctxt("Cannot evaluate an empty polynomial"));
+    }
+    mOrderY = numY - 1;
+
+    mCoeffs.assign((mOrderX + 1) * numY, 0.0);
+    for (size_t ii = 0; ii <= mOrderX; ++ii)
+    {
+        const Poly1D polyY = poly[ii];
+        for (size_t jj = 0; jj < polyY.size(); ++jj)
+        {
+            mCoeffs[ii * numY + jj] = polyY[jj];
+        }
+    }
+}
+
+void Poly2DEvaluator::collapseX(double x, double* coeffsY) const
+{
+    const size_t numY = mOrderY + 1;
+    const double* const highest = &mCoeffs[mOrderX * numY];
+    for (size_t jj = 0; jj < numY; ++jj)
+    {
+        coeffsY[jj] = highest[jj];
+    }
+    for (size_t ii = mOrderX; ii-- > 0;)
+    {
+        const double* const coeffsX = &mCoeffs[ii * numY];
+        for (size_t jj = 0; jj < numY; ++jj)
+        {
+            coeffsY[jj] = coeffsY[jj] * x + coeffsX[jj];
+        }
+    }
+}
+
+double Poly2DEvaluator::operator()(double x, double y) const
+{
+    const size_t numY = mOrderY + 1;
+    double value = 0.0;
+    for (size_t ii = mOrderX + 1; ii-- > 0;)
+    {
+        const double* const coeffsY = &mCoeffs[ii * numY];
+        double valueY = coeffsY[mOrderY];
+        for (size_t jj = mOrderY; jj-- > 0;)
+        {
+            valueY = valueY * y + coeffsY[jj];
+        }
+        value = value * x + valueY;
+    }
+    return value;
+}
+
+void Poly2DEvaluator::evaluate(const double* x,
+                               const double* y,
+                               size_t numPoints,
+                               double* output) const
+{
+    for (size_t ii = 0; ii < numPoints; ++ii)
+    {
+        output[ii] = (*this)(x[ii], y[ii]);
+    }
+}
+
+void Poly2DEvaluator::evaluateGrid(const double* x,
+                                   size_t numX,
+                                   const double* y,
+                                   size_t numY,
+                                   double* output,
+                                   size_t numThreads) const
+{
+    if (numX == 0 || numY == 0)
+    {
+        return;
+    }
+
+    const GridJob job = { this, x, y, numY, output };
+    scene::runInParallel(job, numX, numThreads);
+}
+
+void Poly2DEvaluator::evaluateGrid(double x0,
+                                   double deltaX,
+                                   size_t numX,
+                                   double y0,
+                                   double deltaY,
+                                   size_t numY,
+                                   double* output,
+                                   size_t numThreads) const
+{
+    std::vector<double> x(numX);
+    for (size_t ii = 0; ii < numX; ++ii)
+    {
+        x[ii] = x0 + ii * deltaX;
+    }
+
+    std::vector<double> y(numY);
+    for (size_t jj = 0; jj < numY; ++jj)
+    {
+        y[jj] = y0 + jj * deltaY;
+    }
+
+    if (numX != 0 && numY != 0)
+    {
+        evaluateGrid(&x[0], numX, &y[0], numY, output, numThreads);
+    }
+}
+
+PolyXYZEvaluator::PolyXYZEvaluator(const PolyXYZ& poly)
+{
+    if (poly.empty())
+    {
+        throw except::Exception(Ctxt("Cannot evaluate an empty polynomial"));
+    }
+
+    const size_t numCoeffs = poly.size();
+    mX.resize(numCoeffs);
+    mY.resize(numCoeffs);
+    mZ.resize(numCoeffs);
+    for (size_t ii = 0; ii < numCoeffs; ++ii)
+    {
+        const Vector3 coeff = poly[ii];
+        mX[ii] = coeff[0];
+        mY[ii] = coeff[1];
+        mZ[ii] = coeff[2];
+    }
+}
+
+Vector3 PolyXYZEvaluator::operator()(double t) const
+{
+    const size_t highest = order();
+    Vector3 value;
+    value[0] = mX[highest];
+    value[1] = mY[highest];
+    value[2] = mZ[highest];
+    for (size_t ii = highest; ii-- > 0;)
+    {
+        value[0] = value[0] * t + mX[ii];
+        value[1] = value[1] * t + mY[ii];
+        value[2] = value[2] * t + mZ[ii];
+    }
+    return value;
+}
+
+void PolyXYZEvaluator::evaluate(const double* t,
+                                size_t numTimes,
+                                double* x,
+                                double* y,
+                                double* z,
+                                size_t numThreads) const
+{
+    if (numThreads > 1 && numTimes > 1)
+    {
+        const XYZJob job = { this, t, x, y, z };
+        scene::runInParallel(job, numTimes, numThreads);
+        return;
+    }
+
+    hornerAcross(&mX[0], order(), t, numTimes, x);
+    hornerAcross(&mY[0], order(), t, numTimes, y);
+    hornerAcross(&mZ[0], order(), t, numTimes, z);
+}
+
+void PolyXYZEvaluator::evaluate(const double* t,
+                                size_t numTimes,
+                                Vector3* output,
+                                size_t numThreads) const
+{
+    if (numTimes == 0)
+    {
+        return;
+    }
+
+    std::vector<double> x(numTimes);
+    std::vector<double> y(numTimes);
+    std::vector<double> z(numTimes);
+    evaluate(t, numTimes, &x[0], &y[0], &z[0], numThreads);
+
+    for (size_t ii = 0; ii < numTimes; ++ii)
+    {
+        output[ii][0] = x[ii];
+        output[ii][1] = y[ii];
+        output[ii][2] = z[ii];
+    }
+}
+}
@@ -0,0 +1,235 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <limits>
+#include <memory>
+
+#include <except/Exception.h>
+#include <mt/CriticalSection.h>
+#include <str/Convert.h>
+#include <sys/Runnable.h>
+#include <six/RowBandIterator.h>
+
+namespace
+{
+// Placed in the queues instead of a buffer index
+const size_t NO_BUFFER = std::numeric_limits<size_t>::max();
+const size_t READ_FAILED = NO_BUFFER - 1;
+}
+
+namespace six
+{
+const size_t RowBandIterator::DEFAULT_BAND_HEIGHT = 256;
+const size_t RowBandIterator::DEFAULT_READ_AHEAD = 2;
+
+class RowBandIterator::ReadAheadRunnable : public sys::Runnable
+{
+public:
+    ReadAheadRunnable(RowBandIterator& iterator) :
+        mIterator(iterator)
+    {
+    }
+
+    virtual void run()
+    {
+        mIterator.readBands();
+    }
+
+private:
+    RowBandIterator& mIterator;
+};
+
+RowBandIterator::RowBandIterator(ReadControl& reader,
+                                 size_t imageNumber,
+                                 const Region& region,
+                                 size_t bandHeight,
+                                 size_t numReadAhead) :
+    mReader(reader),
+    mImageNumber(imageNumber),
+    mBandHeight(bandHeight),
+    mCurrentBuffer(NO_BUFFER),
+    mNextBand(0),
+    mStopped(false)
+{
+    mem::SharedPtr<const Container> container = reader.getContainer();
+    if (container.get() == NULL || imageNumber >= container->getNumData())
+    {
+        throw except::Exception(Ctxt("Image " + str::toString(imageNumber) +
+                                     " is out of bounds"));
+    }
+    if (bandHeight == 0)
+    {
+        throw except::Exception(Ctxt("Band height must be positive"));
+    }
+
+    const Data* const data = container->getData(imageNumber);
+    mStartRow = region.getStartRow();
+    mStartCol = region.getStartCol();
+    if (mStartRow > data->getNumRows() || mStartCol > data->getNumCols())
+    {
+        throw except::Exception(Ctxt("Region starts outside of the image"));
+    }
+    mNumRows = (region.getNumRows() == -1) ?
+            data->getNumRows() - mStartRow : region.getNumRows();
+    mNumCols = (region.getNumCols() == -1) ?
+            data->getNumCols() - mStartCol : region.getNumCols();
+    if (mStartRow + mNumRows > data->getNumRows() ||
+        mStartCol + mNumCols > data->getNumCols())
+    {
+        throw except::Exception(Ctxt("Region extends outside of the image"));
+    }
+
+    mNumBytesPerPixel = data->getNumBytesPerPixel();
+    mElementSize = mNumBytesPerPixel /
+            std::max<size_t>(data->getNumChannels(), 1);
+    mNumBands = (mNumRows + mBandHeight - 1) / mBandHeight;
+    if (mNumBands == 0 || mNumCols == 0)
+    {
+        mNumBands = 0;
+        return;
+    }
+
+    // One extra for the band the caller is holding
+    const size_t numBuffers =
+            std::min(std::max<size_t>(numReadAhead, 1), mNumBands) + 1;
+    mBuffers.resize(numBuffers);
+    for (size_t ii = 0; ii < numBuffers; ++ii)
+    {
+        mBuffers[ii].resize(
+                std::min(mBandHeight, mNumRows) * mNumCols * mNumBytesPerPixel);
+        mFreeBuffers.enqueue(ii);
+    }
+
+    mThreads.createThread(
+            std::auto_ptr<sys::Runnable>(new ReadAheadRunnable(*this)));
+}
+
+RowBandIterator::~RowBandIterator()
+{
+    try
+    {
+        stop();
+    }
+    catch (...)
+    {
+    }
+}
+
+bool RowBandIterator::next(ImageView& band)
+{
+    if (mCurrentBuffer != NO_BUFFER)
+    {
+        mFreeBuffers.enqueue(mCurrentBuffer);
+        mCurrentBuffer = NO_BUFFER;
+    }
+
+    if (mNextBand >= mNumBands)
+    {
+        return false;
+    }
+
+    size_t buffer;
+    mFilledBuffers.dequeue(buffer);
+    if (buffer == READ_FAILED)
+    {
+        // Leave it there so every later call fails the same way
+        mFilledBuffers.enqueue(READ_FAILED);
+        throw except::Exception(Ctxt(mError));
+    }
+    mCurrentBuffer = buffer;
+
+    band = ImageView();
+    band.startRow = mStartRow + mNextBand * mBandHeight;
+    band.startCol = mStartCol;
+    band.numRows = getBandRows(mNextBand);
+    band.numCols = mNumCols;
+    band.numBytesPerPixel = mNumBytesPerPixel;
+    band.elementSize = mElementSize;
+    band.rowStride = mNumCols * mNumBytesPerPixel;
+    band.isBigEndian = sys::isBigEndianSystem();
+    band.data = &mBuffers[buffer][0];
+
+    ++mNextBand;
+    return true;
+}
+
+void RowBandIterator::readBands()
+{
+    for (size_t band = 0; band < mNumBands; ++band)
+    {
+        size_t buffer;
+        mFreeBuffers.dequeue(buffer);
+        if (buffer == NO_BUFFER || isStopped())
+        {
+            return;
+        }
+
+        try
+        {
+            Region region;
+            region.setStartRow(mStartRow + band * mBandHeight);
+            region.setNumRows(getBandRows(band));
+            region.setStartCol(mStartCol);
+            region.setNumCols(mNumCols);
+            region.setBuffer(&mBuffers[buffer][0]);
+            mReader.interleaved(region, mImageNumber);
+        }
+        catch (const except::Exception& ex)
+        {
+            mError = ex.getMessage();
+            mFilledBuffers.enqueue(READ_FAILED);
+            return;
+        }
+        catch (const std::exception& ex)
+        {
+            mError = ex.what();
+            mFilledBuffers.enqueue(READ_FAILED);
+            return;
+        }
+
+        mFilledBuffers.enqueue(buffer);
+    }
+}
+
+size_t RowBandIterator::getBandRows(size_t band) const
+{
+    return std::min(mBandHeight, mNumRows - band * mBandHeight);
+}
+
+void RowBandIterator::stop()
+{
+    {
+        mt::CriticalSection<sys::Mutex> lock(&mMutex);
+        mStopped = true;
+    }
+
+    // Wake the background thread up if it's waiting for a buffer
+    mFreeBuffers.enqueue(NO_BUFFER);
+    mThreads.joinAll();
+}
+
+bool RowBandIterator::isStopped()
+{
+    mt::CriticalSection<sys::Mutex> lock(&mMutex);
+    return mStopped;
+}
+}
@@ -145,11 +145,11 @@ void SICommonXMLParser::parsePolyXYZ(XMLElem polyXML, PolyXYZ& polyXYZ) const
     // initialize all the coefficients to 0, so we'll get the right behavior
     // if one of these polynomials is lower-order.
     const size_t xOrder =
-            str::toType<size_t>(xXML->getAttributes().getValue("order1"));
+            six::toNumber<size_t>(xXML->getAttributes().getValue("order1"));
     const size_t yOrder =
-            str::toType<size_t>(yXML->getAttributes().getValue("order1"));
+            six::toNumber<size_t>(yXML->getAttributes().getValue("order1"));
     const size_t zOrder =
-            str::toType<size_t>(zXML->getAttributes().getValue("order1"));
+            six::toNumber<size_t>(zXML->getAttributes().getValue("order1"));
     const size_t order =
             std::max<size_t>(std::max<size_t>(xOrder, yOrder), zOrder);
 
@@ -170,7 +170,7 @@ void SICommonXMLParser::parsePoly(XMLElem polyXML,
     for (size_t ii = 0; ii < coeffsXML.size(); ++ii)
     {
         // Check the order attr, and use that index
-        const size_t orderIdx = str::toType<size_t>(
+        const size_t orderIdx = six::toNumber<size_t>(
             coeffsXML[ii]->getAttributes().getValue("exponent1"));
         if (orderIdx > polyXYZ.order())
         {
@@ -337,7 +337,7 @@ XMLElem SICommonXMLParser::createLatLonFootprint(const std::string& name,
 
 void SICommonXMLParser::parsePoly1D(XMLElem polyXML, Poly1D& poly1D) const
 {
-    int order1 = str::toType<int>(polyXML->getAttributes().getValue("order1"));
+    int order1 = six::toNumber<int>(polyXML->getAttributes().getValue("order1"));
     Poly1D p1D(order1);
 
     std::vector < XMLElem > coeffsXML;
@@ -347,7 +347,7 @@ void SICommonXMLParser::parsePoly1D(XMLElem polyXML, Poly1D& poly1D) const
     for (size_t ii = 0, size = coeffsXML.size(); ii < size; ++ii)
     {
         XMLElem element = coeffsXML[ii];
-        exp1 = str::toType<int>(element->getAttributes().getValue("exponent1"));
+        exp1 = six::toNumber<int>(element->getAttributes().getValue("exponent1"));
         parseDouble(element, p1D[exp1]);
     }
     poly1D = p1D;
@@ -355,8 +355,8 @@ void SICommonXMLParser::parsePoly1D(XMLElem polyXML, Poly1D& poly1D) const
 
 void SICommonXMLParser::parsePoly2D(XMLElem polyXML, Poly2D& poly2D) const
 {
-    int order1 = str::toType<int>(polyXML->getAttributes().getValue("order1"));
-    int order2 = str::toType<int>(polyXML->getAttributes().getValue("order2"));
+    int order1 = six::toNumber<int>(polyXML->getAttributes().getValue("order1"));
+    int order2 = six::toNumber<int>(polyXML->getAttributes().getValue("order2"));
     Poly2D p2D(order1, order2);
 
     std::vector < XMLElem > coeffsXML;
@@ -366,8 +366,8 @@ void SICommonXMLParser::parsePoly2D(XMLElem polyXML, Poly2D& poly2D) const
     for (size_t ii = 0, size = coeffsXML.size(); ii < size; ++ii)
     {
         XMLElem element = coeffsXML[ii];
-        exp1 = str::toType<int>(element->getAttributes().getValue("exponent1"));
-        exp2 = str::toType<int>(element->getAttributes().getValue("exponent2"));
+        exp1 = six::toNumber<int>(element->getAttributes().getValue("exponent1"));
+        exp2 = six::toNumber<int>(element->getAttributes().getValue("exponent2"));
         parseDouble(element, p2D[exp1][exp2]);
     }
     poly2D = p2D;
@@ -622,7 +622,7 @@ void SICommonXMLParser::parseLatLons(XMLElem pointsXML,
 
         //! Temporarily store the indices and LatLons in vector, so
         //  validation can be performed
-        size_t index =  str::toType<size_t>((*it)->attribute("index"));
+        size_t index =  six::toNumber<size_t>((*it)->attribute("index"));
         tmpll.push_back(ll);
         tmpIndxs.push_back(index);
 
@@ -727,7 +727,7 @@ void SICommonXMLParser::parseRowColInts(
 
         //! Temporarily store the indices and rowCol in vector, so
         //  validation can be performed
-        size_t index =  str::toType<size_t>((*it)->attribute("index"));
+        size_t index =  six::toNumber<size_t>((*it)->attribute("index"));
         tmprc.push_back(rc);
         tmpIndxs.push_back(index);
 
@@ -1132,7 +1132,7 @@ void SICommonXMLParser::parseFootprint(XMLElem footprint,
         // Check the index attr to know which corner it is
         // This is 1-based
         const size_t idx =
-            str::toType<size_t>(vertex->getAttributes().getValue("index"));
+            six::toNumber<size_t>(vertex->getAttributes().getValue("index"));
         indices.insert(idx);
 
         parseLatLon(vertices[ii], corners.getCorner(idx - 1));
@@ -1160,7 +1160,7 @@ void SICommonXMLParser::parseFootprint(XMLElem footprint,
         // Check the index attr to know which corner it is
         // This is 1-based
         const size_t idx =
-            str::toType<size_t>(vertex->getAttributes().getValue("index"));
+            six::toNumber<size_t>(vertex->getAttributes().getValue("index"));
         indices.insert(idx);
 
         parseLatLonAlt(vertices[ii], corners.getCorner(idx - 1));
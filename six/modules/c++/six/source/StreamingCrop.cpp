@@ -0,0 +1,130 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <nitf/ImageBlocker.hpp>
+#include <six/StreamingCrop.h>
+
+namespace
+{
+void writeBand(const nitf::ByteProvider& byteProvider,
+               const six::UByte* imageData,
+               size_t startRow,
+               size_t numRows,
+               io::SeekableOutputStream& outStream)
+{
+    nitf::Off fileOffset;
+    nitf::NITFBufferList buffers;
+    byteProvider.getBytes(imageData, startRow, numRows, fileOffset, buffers);
+
+    outStream.seek(fileOffset, io::Seekable::START);
+    for (size_t ii = 0; ii < buffers.mBuffers.size(); ++ii)
+    {
+        outStream.write(
+                static_cast<const sys::byte*>(buffers.mBuffers[ii].mData),
+                buffers.mBuffers[ii].mNumBytes);
+    }
+}
+}
+
+namespace six
+{
+void streamCrop(NITFReadControl& reader,
+                size_t imageNumber,
+                const types::RowCol<size_t>& aoiOffset,
+                const Data& aoiData,
+                const nitf::ByteProvider& byteProvider,
+                bool isBlocked,
+                io::SeekableOutputStream& outStream,
+                size_t maxBandBytes)
+{
+    const size_t numRows = aoiData.getNumRows();
+    const size_t numCols = aoiData.getNumCols();
+    const size_t numBytesPerPixel = aoiData.getNumBytesPerPixel();
+    const size_t numBytesPerRow = numCols * numBytesPerPixel;
+
+    // Bands have to start and end on block boundaries, and blocks can't
+    // span image segments, so a blocked image is done a segment at a time.
+    // Unblocked, any band of rows will do.
+    std::auto_ptr<const nitf::ImageBlocker> blocker;
+    std::vector<size_t> segmentStartRows(1, 0);
+    std::vector<size_t> segmentNumRows(1, numRows);
+    std::vector<size_t> numRowsPerBlock(1, 1);
+    if (isBlocked)
+    {
+        blocker.reset(byteProvider.getImageBlocker().release());
+        numRowsPerBlock = blocker->getNumRowsPerBlock();
+        segmentStartRows.resize(blocker->getNumSegments());
+        segmentNumRows.resize(blocker->getNumSegments());
+        for (size_t seg = 0; seg < blocker->getNumSegments(); ++seg)
+        {
+            segmentStartRows[seg] = blocker->getStartRow(seg);
+            segmentNumRows[seg] = blocker->getNumRows(seg);
+        }
+    }
+
+    std::vector<UByte> band;
+    std::vector<UByte> blocked;
+    for (size_t seg = 0; seg < segmentStartRows.size(); ++seg)
+    {
+        const size_t numBytesPerBlockRow =
+                numRowsPerBlock[seg] * numBytesPerRow;
+        const size_t numRowsPerBand = numRowsPerBlock[seg] *
+                std::max<size_t>(maxBandBytes / numBytesPerBlockRow, 1);
+        const size_t endRow = segmentStartRows[seg] + segmentNumRows[seg];
+
+        for (size_t startRow = segmentStartRows[seg]; startRow < endRow;)
+        {
+            const size_t numRowsThisBand =
+                    std::min(numRowsPerBand, endRow - startRow);
+            band.resize(numRowsThisBand * numBytesPerRow);
+
+            Region region;
+            region.setStartRow(aoiOffset.row + startRow);
+            region.setNumRows(numRowsThisBand);
+            region.setStartCol(aoiOffset.col);
+            region.setNumCols(numCols);
+            region.setBuffer(&band[0]);
+            reader.readRaw(region, imageNumber);
+
+            if (blocker.get())
+            {
+                blocked.resize(blocker->getNumBytesRequired(
+                        startRow, numRowsThisBand, numBytesPerPixel));
+                blocker->block(&band[0], startRow, numRowsThisBand,
+                               numBytesPerPixel, &blocked[0]);
+                writeBand(byteProvider, &blocked[0], startRow,
+                          numRowsThisBand, outStream);
+            }
+            else
+            {
+                writeBand(byteProvider, &band[0], startRow,
+                          numRowsThisBand, outStream);
+            }
+
+            startRow += numRowsThisBand;
+        }
+    }
+}
+}
@@ -20,6 +20,9 @@
  *
  */
 
+#include <stdio.h>
+#include <cctype>
+#include <cstring>
 #include <iomanip>
 #include <sstream>
 
@@ -33,6 +36,36 @@ namespace
 {
 NITF_TRE_STATIC_HANDLER_REF(XML_DATA_CONTENT);
 
+// Same text as streaming 'value' with std::uppercase, std::scientific and
+// std::setprecision(precision), minus any '+' in the exponent (the SICD XML
+// standard doesn't allow it), but without constructing a std::ostringstream
+// for every number
+std::string formatScientific(double value, int precision)
+{
+    char buffer[64];
+    int length = snprintf(buffer, sizeof(buffer), "%.*E", precision, value);
+    if (length < 0 || static_cast<size_t>(length) >= sizeof(buffer))
+    {
+        throw except::Exception(Ctxt("Unable to format floating point value"));
+    }
+
+    // snprintf() writes the radix character of the C locale's LC_NUMERIC,
+    // which setlocale() can change.  XML always wants '.'.
+    char* const radix = buffer + ((buffer[0] == '-') ? 2 : 1);
+    if (precision > 0 && std::isdigit(radix[-1]) && !std::isdigit(*radix))
+    {
+        *radix = '.';
+    }
+
+    char* const exponent = std::strchr(buffer, '+');
+    if (exponent != NULL)
+    {
+        std::memmove(exponent, exponent + 1, buffer + length - exponent);
+        --length;
+    }
+    return std::string(buffer, length);
+}
+
 void assign(math::linear::MatrixMxN<7, 7>& sensorCovar,
             size_t row,
             size_t col,
@@ -106,19 +139,7 @@ std::string six::toString<float>(const float& value)
                 Ctxt("Attempted use of uninitialized float value"));
     }
 
-    std::ostringstream os;
-    size_t precision = std::numeric_limits<float>::max_digits10;
-    os << std::uppercase << std::scientific << std::setprecision(precision)
-       << value;
-    std::string strValue = os.str();
-
-    // remove any + in scientific notation to meet SICD XML standard
-    size_t plusPos = strValue.find("+");
-    if (plusPos != std::string::npos)
-    {
-        strValue.erase(plusPos, 1);
-    }
-    return strValue;
+    return formatScientific(value, std::numeric_limits<float>::max_digits10);
 }
 
 template <>
@@ -130,19 +151,7 @@ std::string six::toString<double>(const double& value)
                 Ctxt("Attempted use of uninitialized double value"));
     }
 
-    std::ostringstream os;
-    size_t precision = std::numeric_limits<double>::max_digits10;
-    os << std::uppercase << std::scientific << std::setprecision(precision)
-       << value;
-    std::string strValue = os.str();
-
-    // remove any + in scientific notation to meet SICD XML standard
-    size_t plusPos = strValue.find("+");
-    if (plusPos != std::string::npos)
-    {
-        strValue.erase(plusPos, 1);
-    }
-    return strValue;
+    return formatScientific(value, std::numeric_limits<double>::max_digits10);
 }
 
 template <>
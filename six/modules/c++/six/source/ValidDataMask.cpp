@@ -0,0 +1,297 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <string.h>
+#include <algorithm>
+#include <cmath>
+
+#include <except/Exception.h>
+#include <six/ValidDataMask.h>
+
+namespace
+{
+// Vertices are whole pixels, so crossings are exact rationals.  This only
+// absorbs rounding in computing them.
+const double EPSILON = 1e-9;
+
+// Closed range of columns
+typedef std::pair<sys::SSize_T, sys::SSize_T> ColumnRange;
+
+void addRange(double begin,
+              double end,
+              std::vector<ColumnRange>& ranges)
+{
+    const sys::SSize_T first =
+            static_cast<sys::SSize_T>(std::ceil(begin - EPSILON));
+    const sys::SSize_T last =
+            static_cast<sys::SSize_T>(std::floor(end + EPSILON));
+    if (first <= last)
+    {
+        ranges.push_back(ColumnRange(first, last));
+    }
+}
+
+// Clips the ranges to the image and merges the ones that overlap or touch
+void toSpans(std::vector<ColumnRange>& ranges,
+             size_t numCols,
+             std::vector<six::ValidDataMask::Span>& spans)
+{
+    std::sort(ranges.begin(), ranges.end());
+
+    const sys::SSize_T lastCol = static_cast<sys::SSize_T>(numCols) - 1;
+    for (size_t ii = 0; ii < ranges.size(); ++ii)
+    {
+        const sys::SSize_T first = std::max<sys::SSize_T>(ranges[ii].first, 0);
+        const sys::SSize_T last = std::min(ranges[ii].second, lastCol);
+        if (first > last)
+        {
+            continue;
+        }
+
+        const size_t begin = static_cast<size_t>(first);
+        const size_t end = static_cast<size_t>(last) + 1;
+        if (!spans.empty() && begin <= spans.back().end)
+        {
+            spans.back().end = std::max(spans.back().end, end);
+        }
+        else
+        {
+            spans.push_back(six::ValidDataMask::Span(begin, end));
+        }
+    }
+}
+
+size_t getOverlap(const six::ValidDataMask::Span& span,
+                  size_t begin,
+                  size_t end)
+{
+    const size_t overlapBegin = std::max(span.begin, begin);
+    const size_t overlapEnd = std::min(span.end, end);
+    return (overlapBegin < overlapEnd) ? overlapEnd - overlapBegin : 0;
+}
+}
+
+namespace six
+{
+ValidDataMask::ValidDataMask(const types::RowCol<size_t>& dims) :
+    mDims(dims),
+    mSpans(dims.row, std::vector<Span>(dims.col ? 1 : 0, Span(0, dims.col)))
+{
+}
+
+ValidDataMask::ValidDataMask(const std::vector<RowColInt>& vertices,
+                             const types::RowCol<size_t>& dims,
+                             const RowColInt& offset) :
+    mDims(dims),
+    mSpans(dims.row)
+{
+    if (vertices.size() < 3)
+    {
+        throw except::Exception(Ctxt(
+                "A valid data polygon needs at least three vertices"));
+    }
+
+    // Each edge only visits the rows it covers.  Crossings use a
+    // half-open rule in rows so a vertex shared by two edges is counted
+    // once (or twice at a local extremum), which keeps the even-odd pairing
+    // right.  Pixels exactly on the boundary are added separately.
+    const sys::SSize_T numRows = static_cast<sys::SSize_T>(dims.row);
+    std::vector<std::vector<double> > crossings(dims.row);
+    std::vector<std::vector<ColumnRange> > ranges(dims.row);
+    for (size_t ii = 0; ii < vertices.size(); ++ii)
+    {
+        const RowColInt start = vertices[ii] - offset;
+        const RowColInt end = vertices[(ii + 1) % vertices.size()] - offset;
+
+        if (start.row == end.row)
+        {
+            if (start.row >= 0 && start.row < numRows)
+            {
+                addRange(static_cast<double>(std::min(start.col, end.col)),
+                         static_cast<double>(std::max(start.col, end.col)),
+                         ranges[start.row]);
+            }
+            continue;
+        }
+
+        const sys::SSize_T minRow = std::min(start.row, end.row);
+        const sys::SSize_T maxRow = std::max(start.row, end.row);
+        const double slope = static_cast<double>(end.col - start.col) /
+                static_cast<double>(end.row - start.row);
+
+        const sys::SSize_T firstRow = std::max<sys::SSize_T>(minRow, 0);
+        const sys::SSize_T lastRow = std::min(maxRow, numRows - 1);
+        for (sys::SSize_T row = firstRow; row <= lastRow; ++row)
+        {
+            const double col = start.col + (row - start.row) * slope;
+            if (row < maxRow)
+            {
+                crossings[row].push_back(col);
+            }
+            addRange(col, col, ranges[row]);
+        }
+    }
+
+    for (size_t row = 0; row < dims.row; ++row)
+    {
+        std::vector<double>& rowCrossings = crossings[row];
+        std::sort(rowCrossings.begin(), rowCrossings.end());
+        for (size_t ii = 0; ii + 1 < rowCrossings.size(); ii += 2)
+        {
+            addRange(rowCrossings[ii], rowCrossings[ii + 1], ranges[row]);
+        }
+        toSpans(ranges[row], dims.col, mSpans[row]);
+    }
+}
+
+bool ValidDataMask::isValid(size_t row, size_t col) const
+{
+    const std::vector<Span>& spans = mSpans[row];
+    for (size_t ii = 0; ii < spans.size(); ++ii)
+    {
+        if (col < spans[ii].begin)
+        {
+            return false;
+        }
+        if (col < spans[ii].end)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t ValidDataMask::getNumValid() const
+{
+    size_t numValid = 0;
+    for (size_t row = 0; row < mSpans.size(); ++row)
+    {
+        for (size_t ii = 0; ii < mSpans[row].size(); ++ii)
+        {
+            numValid += mSpans[row][ii].end - mSpans[row][ii].begin;
+        }
+    }
+    return numValid;
+}
+
+ValidDataMask::TileClass
+ValidDataMask::classify(const types::RowCol<size_t>& offset,
+                        const types::RowCol<size_t>& dims) const
+{
+    if (offset.row + dims.row > mDims.row ||
+        offset.col + dims.col > mDims.col)
+    {
+        throw except::Exception(Ctxt("Tile is outside of the image"));
+    }
+
+    const size_t endCol = offset.col + dims.col;
+    bool anyValid = false;
+    bool anyInvalid = false;
+    for (size_t row = offset.row; row < offset.row + dims.row; ++row)
+    {
+        size_t numValid = 0;
+        const std::vector<Span>& spans = mSpans[row];
+        for (size_t ii = 0; ii < spans.size(); ++ii)
+        {
+            numValid += getOverlap(spans[ii], offset.col, endCol);
+        }
+
+        anyValid = anyValid || numValid > 0;
+        anyInvalid = anyInvalid || numValid < dims.col;
+        if (anyValid && anyInvalid)
+        {
+            return PARTIAL;
+        }
+    }
+
+    return anyValid ? FULL : EMPTY;
+}
+
+types::RowCol<size_t>
+ValidDataMask::classifyTiles(const types::RowCol<size_t>& tileDims,
+                             std::vector<TileClass>& classes) const
+{
+    if (tileDims.row == 0 || tileDims.col == 0)
+    {
+        throw except::Exception(Ctxt("Tile dimensions must be positive"));
+    }
+
+    const types::RowCol<size_t> numTiles(
+            (mDims.row + tileDims.row - 1) / tileDims.row,
+            (mDims.col + tileDims.col - 1) / tileDims.col);
+
+    classes.resize(numTiles.area());
+    for (size_t tileRow = 0, idx = 0; tileRow < numTiles.row; ++tileRow)
+    {
+        for (size_t tileCol = 0; tileCol < numTiles.col; ++tileCol, ++idx)
+        {
+            const types::RowCol<size_t> offset(tileRow * tileDims.row,
+                                               tileCol * tileDims.col);
+            const types::RowCol<size_t> dims(
+                    std::min(tileDims.row, mDims.row - offset.row),
+                    std::min(tileDims.col, mDims.col - offset.col));
+            classes[idx] = classify(offset, dims);
+        }
+    }
+    return numTiles;
+}
+
+void ValidDataMask::getMask(const types::RowCol<size_t>& offset,
+                            const types::RowCol<size_t>& dims,
+                            UByte* mask) const
+{
+    ::memset(mask, 1, dims.area());
+    maskTile(offset, dims, 1, mask);
+}
+
+void ValidDataMask::maskTile(const types::RowCol<size_t>& offset,
+                             const types::RowCol<size_t>& dims,
+                             size_t numBytesPerPixel,
+                             UByte* pixels) const
+{
+    if (offset.row + dims.row > mDims.row ||
+        offset.col + dims.col > mDims.col)
+    {
+        throw except::Exception(Ctxt("Tile is outside of the image"));
+    }
+
+    const size_t endCol = offset.col + dims.col;
+    const size_t numBytesPerRow = dims.col * numBytesPerPixel;
+    for (size_t row = 0; row < dims.row; ++row)
+    {
+        UByte* const rowPixels = pixels + row * numBytesPerRow;
+
+        // Zero the gaps between the spans that overlap the tile
+        size_t col = offset.col;
+        const std::vector<Span>& spans = mSpans[offset.row + row];
+        for (size_t ii = 0; ii < spans.size() && col < endCol; ++ii)
+        {
+            const size_t begin = std::min(std::max(spans[ii].begin, col),
+                                          endCol);
+            ::memset(rowPixels + (col - offset.col) * numBytesPerPixel, 0,
+                     (begin - col) * numBytesPerPixel);
+            col = std::max(col, std::min(spans[ii].end, endCol));
+        }
+        ::memset(rowPixels + (col - offset.col) * numBytesPerPixel, 0,
+                 (endCol - col) * numBytesPerPixel);
+    }
+}
+}
@@ -22,6 +22,7 @@
 
 #include <logging/NullLogger.h>
 #include <six/XMLControl.h>
+#include <six/XMLSerializer.h>
 
 namespace six
 {
@@ -58,9 +59,21 @@ void XMLControl::loadSchemaPaths(std::vector<std::string>& schemaPaths)
     }
 }
 
+void XMLControl::validate(const xml::lite::Document* doc,
+                          const std::vector<std::string>& schemaPaths,
+                          logging::Logger* log)
+{
+    // Pretty-print so that lines numbers are useful
+    io::StringStream xmlStream;
+    doc->getRootElement()->prettyPrint(xmlStream);
+    validate(xmlStream.stream().str(), doc->getRootElement()->getUri(),
+             schemaPaths, log);
+}
+
 //  NOTE: Errors are treated as detriments to valid processing
 //        and fail accordingly
-void XMLControl::validate(const xml::lite::Document* doc,
+void XMLControl::validate(const std::string& xml,
+                          const std::string& uri,
                           const std::vector<std::string>& schemaPaths,
                           logging::Logger* log)
 {
@@ -88,18 +101,14 @@ void XMLControl::validate(const xml::lite::Document* doc,
 
         std::vector<xml::lite::ValidationInfo> errors;
 
-        if (doc->getRootElement()->getUri().empty())
+        if (uri.empty())
         {
             throw six::DESValidationException(Ctxt(
                     "INVALID XML: URI is empty so document version cannot be "
                     "determined to use for validation"));
         }
 
-        // Pretty-print so that lines numbers are useful
-        io::StringStream xmlStream;
-        doc->getRootElement()->prettyPrint(xmlStream);
-
-        validator.validate(xmlStream, doc->getRootElement()->getUri(), errors);
+        validator.validate(xml, uri, errors);
 
         // log any error found and throw
         if (!errors.empty())
@@ -187,6 +196,15 @@ xml::lite::Document* XMLControl::toXML(
     return doc;
 }
 
+std::string XMLControl::toXMLString(
+        const Data* data, const std::vector<std::string>& schemaPaths)
+{
+    const std::auto_ptr<xml::lite::Document> doc(toXMLImpl(data));
+    const std::string xml = six::toXMLString(*doc->getRootElement());
+    validate(xml, doc->getRootElement()->getUri(), schemaPaths, mLog);
+    return xml;
+}
+
 Data* XMLControl::fromXML(const xml::lite::Document* doc,
                           const std::vector<std::string>& schemaPaths)
 {
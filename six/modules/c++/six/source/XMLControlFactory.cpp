@@ -92,12 +92,6 @@ std::string six::toValidXMLString(const Data* data,
         xmlControl(xmlRegistry->newXMLControl(data->getDataType(), log));
 
     // this will validate if SIX_SCHEMA_PATH EnvVar is set
-    const std::auto_ptr<xml::lite::Document> doc(
-        xmlControl->toXML(data, schemaPaths));
-
-    io::StringStream oss;
-    doc->getRootElement()->print(oss);
-
-    return oss.stream().str();
+    return xmlControl->toXMLString(data, schemaPaths);
 }
 
@@ -284,23 +284,47 @@ XMLElem XMLParser::createDate(const std::string& name, const DateTime& p,
 
 XMLElem XMLParser::getFirstAndOnly(XMLElem parent, const std::string& tag)
 {
-    std::vector < XMLElem > children;
-    parent->getElementsByTagName(tag, children);
-    if (children.size() != 1)
+    size_t numMatches;
+    XMLElem const child = findChild(parent, tag, numMatches);
+    if (numMatches != 1)
     {
         throw except::Exception(Ctxt(
                  "Expected exactly one " + tag + " but got " +
-                    str::toString(children.size())));
+                    str::toString(numMatches)));
     }
-    return children[0];
+    return child;
 }
 XMLElem XMLParser::getOptional(XMLElem parent, const std::string& tag)
 {
-    std::vector < XMLElem > children;
-    parent->getElementsByTagName(tag, children);
-    if (children.size() != 1)
+    size_t numMatches;
+    XMLElem const child = findChild(parent, tag, numMatches);
+    if (numMatches != 1)
         return NULL;
-    return children[0];
+    return child;
+}
+
+XMLElem XMLParser::findChild(XMLElem parent,
+                             const std::string& tag,
+                             size_t& numMatches)
+{
+    // Equivalent to getElementsByTagName() without building up a vector
+    // of the matches.  These are called for nearly every field so it adds
+    // up.
+    XMLElem match = NULL;
+    numMatches = 0;
+
+    const std::vector<XMLElem>& children = parent->getChildren();
+    for (size_t ii = 0; ii < children.size(); ++ii)
+    {
+        if (children[ii]->getLocalName() == tag)
+        {
+            if (numMatches++ == 0)
+            {
+                match = children[ii];
+            }
+        }
+    }
+    return match;
 }
 
 XMLElem XMLParser::require(XMLElem element, const std::string& name)
@@ -327,7 +351,7 @@ void XMLParser::parseDouble(XMLElem element, double& value) const
 {
     try
     {
-        value = str::toType<double>(element->getCharacterData());
+        value = six::toNumber<double>(element->getCharacterData());
     }
     catch (const except::BadCastException& ex)
     {
@@ -0,0 +1,70 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <vector>
+
+#include <six/XMLSerializer.h>
+
+namespace six
+{
+void appendXML(const xml::lite::Element& element, std::string& buffer)
+{
+    const std::string name = element.getQName();
+    buffer += '<';
+    buffer += name;
+
+    const xml::lite::Attributes& attributes = element.getAttributes();
+    for (int ii = 0; ii < attributes.getLength(); ++ii)
+    {
+        buffer += ' ';
+        buffer += attributes.getQName(ii);
+        buffer += "=\"";
+        buffer += attributes.getValue(ii);
+        buffer += '"';
+    }
+
+    const std::vector<xml::lite::Element*>& children = element.getChildren();
+    const std::string characterData = element.getCharacterData();
+    if (characterData.empty() && children.empty())
+    {
+        buffer += "/>";
+        return;
+    }
+
+    buffer += '>';
+    buffer += characterData;
+    for (size_t ii = 0; ii < children.size(); ++ii)
+    {
+        appendXML(*children[ii], buffer);
+    }
+    buffer += "</";
+    buffer += name;
+    buffer += '>';
+}
+
+std::string toXMLString(const xml::lite::Element& element, size_t sizeHint)
+{
+    std::string buffer;
+    buffer.reserve(sizeHint);
+    appendXML(element, buffer);
+    return buffer;
+}
+}
@@ -0,0 +1,36 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __SIX_UNITTEST_UTILITIES_H__
+#define __SIX_UNITTEST_UTILITIES_H__
+
+#include <algorithm>
+#include <cmath>
+
+// Compares with a relative tolerance, or an absolute one for values
+// smaller than 1
+inline bool almostEqual(double lhs, double rhs, double tolerance)
+{
+    return std::abs(lhs - rhs) <= tolerance * std::max(1.0, std::abs(rhs));
+}
+
+#endif
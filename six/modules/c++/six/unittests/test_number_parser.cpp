@@ -0,0 +1,124 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <cmath>
+#include <string>
+
+#include "TestCase.h"
+#include <six/NumberParser.h>
+
+namespace
+{
+// The fast path must agree exactly with str::toType()
+bool matchesToType(const std::string& str)
+{
+    return six::toNumber<double>(str) == str::toType<double>(str);
+}
+
+TEST_CASE(testFastPathDoubles)
+{
+    const char* const values[] =
+    {
+        "0", "-0", "1", "+1", "-1.5", "100", "0.5", ".25", "3.",
+        "5.165293843888324E05", "-4.698512226124156E06",
+        "4.227080000000000E01", "0.000000000000000E00",
+        "1.560574314284600e+07", "  42.125  ", "7e-22", "12E25",
+        "9007199254740992"
+    };
+
+    for (size_t ii = 0; ii < sizeof(values) / sizeof(values[0]); ++ii)
+    {
+        const std::string str(values[ii]);
+        double value;
+        TEST_ASSERT(six::parseDoubleFast(str.c_str(), str.length(), value));
+        TEST_ASSERT(matchesToType(str));
+    }
+
+    double value;
+    TEST_ASSERT(six::parseDoubleFast("-0", 2, value));
+    TEST_ASSERT(value == 0.0);
+    TEST_ASSERT(1.0 / value < 0.0);
+}
+
+TEST_CASE(testRandomDoubles)
+{
+    char buffer[64];
+    for (size_t ii = 0; ii < 20000; ++ii)
+    {
+        const double value = (2.0 * rand() / RAND_MAX - 1.0) *
+                std::pow(10.0, rand() % 30 - 15);
+        sprintf(buffer, "%.15E", value);
+        TEST_ASSERT(matchesToType(buffer));
+        sprintf(buffer, "%.17g", value);
+        TEST_ASSERT(matchesToType(buffer));
+    }
+}
+
+TEST_CASE(testFallback)
+{
+    // These aren't handled by the fast path but still have to work
+    const char* const values[] =
+    {
+        "1.2345678901234567890123", "1e300", "2.5e-300",
+        "12345678901234567", "1.5abc"
+    };
+
+    for (size_t ii = 0; ii < sizeof(values) / sizeof(values[0]); ++ii)
+    {
+        const std::string str(values[ii]);
+        double value;
+        TEST_ASSERT(!six::parseDoubleFast(str.c_str(), str.length(), value));
+        TEST_ASSERT(matchesToType(str));
+    }
+
+    TEST_EXCEPTION(six::toNumber<double>(""));
+    TEST_EXCEPTION(six::toNumber<double>("abc"));
+}
+
+TEST_CASE(testIntegers)
+{
+    TEST_ASSERT_EQ(six::toNumber<int>("42"), 42);
+    TEST_ASSERT_EQ(six::toNumber<int>(" -17 "), -17);
+    TEST_ASSERT_EQ(six::toNumber<int>("+8"), 8);
+    TEST_ASSERT_EQ(six::toNumber<size_t>("007"), 7);
+    TEST_ASSERT_EQ(six::toNumber<short>("-32768"), -32768);
+    TEST_ASSERT_EQ(six::toNumber<sys::Int64_T>("-9223372036854775807"),
+                   -9223372036854775807LL);
+    TEST_ASSERT_EQ(six::toNumber<sys::Uint64_T>("18446744073709551615"),
+                   18446744073709551615ULL);
+
+    // Out of range values are left to str::toType()
+    TEST_EXCEPTION(six::toNumber<int>("3000000000"));
+    TEST_EXCEPTION(six::toNumber<int>("x"));
+    TEST_ASSERT_EQ(six::toNumber<size_t>("-1"), str::toType<size_t>("-1"));
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testFastPathDoubles);
+    TEST_CHECK(testRandomDoubles);
+    TEST_CHECK(testFallback);
+    TEST_CHECK(testIntegers);
+    return 0;
+}
@@ -0,0 +1,215 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <stdlib.h>
+#include <cmath>
+#include <vector>
+
+#include "TestCase.h"
+#include "TestUtilities.h"
+#include <six/PolyEvaluator.h>
+
+namespace
+{
+const double TOLERANCE = 1e-12;
+
+double getRandom()
+{
+    return 2.0 * rand() / RAND_MAX - 1.0;
+}
+
+six::Poly2D getRandomPoly(size_t orderX, size_t orderY)
+{
+    six::Poly2D poly(orderX, orderY);
+    for (size_t ii = 0; ii <= orderX; ++ii)
+    {
+        for (size_t jj = 0; jj <= orderY; ++jj)
+        {
+            poly[ii][jj] = getRandom();
+        }
+    }
+    return poly;
+}
+
+TEST_CASE(testPointEvaluation)
+{
+    const six::Poly2D poly = getRandomPoly(4, 3);
+    const six::Poly2DEvaluator evaluator(poly);
+    TEST_ASSERT_EQ(evaluator.orderX(), 4);
+    TEST_ASSERT_EQ(evaluator.orderY(), 3);
+
+    std::vector<double> x(50);
+    std::vector<double> y(50);
+    for (size_t ii = 0; ii < x.size(); ++ii)
+    {
+        x[ii] = 2.0 * getRandom();
+        y[ii] = 2.0 * getRandom();
+        TEST_ASSERT(almostEqual(evaluator(x[ii], y[ii]), poly(x[ii], y[ii]),
+                                TOLERANCE));
+    }
+
+    std::vector<double> output(x.size());
+    evaluator.evaluate(&x[0], &y[0], x.size(), &output[0]);
+    for (size_t ii = 0; ii < x.size(); ++ii)
+    {
+        TEST_ASSERT(almostEqual(output[ii], poly(x[ii], y[ii]), TOLERANCE));
+    }
+}
+
+TEST_CASE(testGridEvaluation)
+{
+    const six::Poly2D poly = getRandomPoly(3, 5);
+    const six::Poly2DEvaluator evaluator(poly);
+
+    const size_t numX = 17;
+    const size_t numY = 33;
+    const double x0 = -1.5;
+    const double dx = 0.1;
+    const double y0 = -0.75;
+    const double dy = 0.05;
+
+    for (size_t numThreads = 1; numThreads <= 4; numThreads += 3)
+    {
+        std::vector<double> output(numX * numY);
+        evaluator.evaluateGrid(x0, dx, numX, y0, dy, numY, &output[0],
+                               numThreads);
+        for (size_t ii = 0; ii < numX; ++ii)
+        {
+            for (size_t jj = 0; jj < numY; ++jj)
+            {
+                TEST_ASSERT(almostEqual(output[ii * numY + jj],
+                                        poly(x0 + ii * dx, y0 + jj * dy),
+                                        TOLERANCE));
+            }
+        }
+    }
+}
+
+TEST_CASE(testConstantPoly)
+{
+    six::Poly2D poly(0, 0);
+    poly[0][0] = 3.5;
+    const six::Poly2DEvaluator evaluator(poly);
+
+    const double x[] = { 1.0, 2.0 };
+    const double y[] = { 3.0, 4.0, 5.0 };
+    std::vector<double> output(6);
+    evaluator.evaluateGrid(x, 2, y, 3, &output[0]);
+    for (size_t ii = 0; ii < output.size(); ++ii)
+    {
+        TEST_ASSERT_EQ(output[ii], 3.5);
+    }
+}
+
+TEST_CASE(testPolyXYZ)
+{
+    six::PolyXYZ poly(3);
+    for (size_t ii = 0; ii <= poly.order(); ++ii)
+    {
+        for (size_t jj = 0; jj < 3; ++jj)
+        {
+            poly[ii][jj] = getRandom() * 1000.0;
+        }
+    }
+    const six::PolyXYZEvaluator evaluator(poly);
+    TEST_ASSERT_EQ(evaluator.order(), 3);
+
+    std::vector<double> times(101);
+    for (size_t ii = 0; ii < times.size(); ++ii)
+    {
+        times[ii] = -5.0 + 0.1 * ii;
+    }
+
+    for (size_t numThreads = 1; numThreads <= 3; numThreads += 2)
+    {
+        std::vector<six::Vector3> output(times.size());
+        evaluator.evaluate(&times[0], times.size(), &output[0], numThreads);
+        for (size_t ii = 0; ii < times.size(); ++ii)
+        {
+            const six::Vector3 expected = poly(times[ii]);
+            const six::Vector3 single = evaluator(times[ii]);
+            for (size_t jj = 0; jj < 3; ++jj)
+            {
+                TEST_ASSERT(almostEqual(output[ii][jj], expected[jj],
+                                        TOLERANCE));
+                TEST_ASSERT(almostEqual(single[jj], expected[jj], TOLERANCE));
+            }
+        }
+    }
+}
+
+TEST_CASE(testRaggedPoly)
+{
+    // Rows of different lengths, as parsed from XML that lists only the
+    // nonzero terms
+    std::vector<six::Poly1D> rows;
+    rows.push_back(six::Poly1D(1));
+    rows.push_back(six::Poly1D(3));
+    rows.push_back(six::Poly1D(0));
+    for (size_t ii = 0; ii < rows.size(); ++ii)
+    {
+        for (size_t jj = 0; jj <= rows[ii].order(); ++jj)
+        {
+            rows[ii][jj] = getRandom();
+        }
+    }
+    const six::Poly2D poly(rows);
+    const six::Poly2DEvaluator evaluator(poly);
+    TEST_ASSERT_EQ(evaluator.orderX(), 2);
+    TEST_ASSERT_EQ(evaluator.orderY(), 3);
+
+    const double x[] = { -1.5, 0.0, 0.25, 2.0 };
+    const double y[] = { 0.5, -2.0, 1.0, 3.0 };
+    for (size_t ii = 0; ii < 4; ++ii)
+    {
+        TEST_ASSERT(almostEqual(evaluator(x[ii], y[ii]), poly(x[ii], y[ii]),
+                                TOLERANCE));
+    }
+
+    std::vector<double> output(16);
+    evaluator.evaluateGrid(x, 4, y, 4, &output[0]);
+    for (size_t ii = 0; ii < 4; ++ii)
+    {
+        for (size_t jj = 0; jj < 4; ++jj)
+        {
+            TEST_ASSERT(almostEqual(output[ii * 4 + jj],
+                                    poly(x[ii], y[jj]), TOLERANCE));
+        }
+    }
+}
+
+TEST_CASE(testEmptyPolyThrows)
+{
+    TEST_EXCEPTION(six::Poly2DEvaluator(six::Poly2D()));
+    TEST_EXCEPTION(six::PolyXYZEvaluator(six::PolyXYZ()));
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testPointEvaluation);
+    TEST_CHECK(testGridEvaluation);
+    TEST_CHECK(testConstantPoly);
+    TEST_CHECK(testPolyXYZ);
+    TEST_CHECK(testRaggedPoly);
+    TEST_CHECK(testEmptyPolyThrows);
+    return 0;
+}
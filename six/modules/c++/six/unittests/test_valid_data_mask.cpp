@@ -0,0 +1,220 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <vector>
+
+#include "TestCase.h"
+#include <six/ValidDataMask.h>
+
+namespace
+{
+typedef six::RowColInt Vertex;
+
+// Reference point-in-polygon test: on an edge, or an odd number of
+// crossings to the right
+bool isInside(const std::vector<Vertex>& polygon,
+              sys::SSize_T row,
+              sys::SSize_T col)
+{
+    bool inside = false;
+    for (size_t ii = 0; ii < polygon.size(); ++ii)
+    {
+        const Vertex& a = polygon[ii];
+        const Vertex& b = polygon[(ii + 1) % polygon.size()];
+
+        const sys::SSize_T cross = (b.row - a.row) * (col - a.col) -
+                (b.col - a.col) * (row - a.row);
+        if (cross == 0 &&
+            row >= std::min(a.row, b.row) && row <= std::max(a.row, b.row) &&
+            col >= std::min(a.col, b.col) && col <= std::max(a.col, b.col))
+        {
+            return true;
+        }
+
+        if ((a.row <= row) != (b.row <= row))
+        {
+            // Crossing column is a.col + (row - a.row) * dc / dr; compare
+            // without dividing
+            const sys::SSize_T dr = b.row - a.row;
+            const sys::SSize_T lhs = (col - a.col) * dr;
+            const sys::SSize_T rhs = (row - a.row) * (b.col - a.col);
+            if (dr > 0 ? lhs < rhs : lhs > rhs)
+            {
+                inside = !inside;
+            }
+        }
+    }
+    return inside;
+}
+
+bool matchesReference(const std::vector<Vertex>& polygon,
+                      const types::RowCol<size_t>& dims)
+{
+    const six::ValidDataMask mask(polygon, dims);
+    size_t numValid = 0;
+    for (size_t row = 0; row < dims.row; ++row)
+    {
+        for (size_t col = 0; col < dims.col; ++col)
+        {
+            const bool expected = isInside(polygon,
+                                           static_cast<sys::SSize_T>(row),
+                                           static_cast<sys::SSize_T>(col));
+            if (mask.isValid(row, col) != expected)
+            {
+                return false;
+            }
+            numValid += expected ? 1 : 0;
+        }
+    }
+    return mask.getNumValid() == numValid;
+}
+
+std::vector<Vertex> makePolygon(const sys::SSize_T* coords, size_t numVertices)
+{
+    std::vector<Vertex> polygon;
+    for (size_t ii = 0; ii < numVertices; ++ii)
+    {
+        polygon.push_back(Vertex(coords[2 * ii], coords[2 * ii + 1]));
+    }
+    return polygon;
+}
+
+TEST_CASE(testRectangle)
+{
+    const sys::SSize_T coords[] = { 2, 3, 2, 8, 6, 8, 6, 3 };
+    const six::ValidDataMask mask(makePolygon(coords, 4),
+                                  types::RowCol<size_t>(10, 12));
+
+    TEST_ASSERT(mask.getSpans(0).empty());
+    TEST_ASSERT(mask.getSpans(1).empty());
+    for (size_t row = 2; row <= 6; ++row)
+    {
+        TEST_ASSERT_EQ(mask.getSpans(row).size(), 1);
+        TEST_ASSERT(mask.getSpans(row)[0] == six::ValidDataMask::Span(3, 9));
+    }
+    TEST_ASSERT(mask.getSpans(7).empty());
+    TEST_ASSERT_EQ(mask.getNumValid(), 30);
+}
+
+TEST_CASE(testAgainstReference)
+{
+    const types::RowCol<size_t> dims(40, 35);
+
+    // Squinted wedge
+    const sys::SSize_T wedge[] = { 0, 10, 0, 34, 39, 24, 39, 0 };
+    TEST_ASSERT(matchesReference(makePolygon(wedge, 4), dims));
+
+    // Counterclockwise, non-convex, with a horizontal edge and a spike
+    const sys::SSize_T concave[] =
+            { 5, 5, 30, 3, 30, 20, 12, 12, 20, 30, 3, 25 };
+    TEST_ASSERT(matchesReference(makePolygon(concave, 6), dims));
+
+    // Extends past the image on every side
+    const sys::SSize_T clipped[] = { -10, 17, 17, 50, 55, 17, 17, -20 };
+    TEST_ASSERT(matchesReference(makePolygon(clipped, 4), dims));
+
+    // Thin sliver
+    const sys::SSize_T sliver[] = { 0, 0, 39, 1, 39, 2 };
+    TEST_ASSERT(matchesReference(makePolygon(sliver, 3), dims));
+}
+
+TEST_CASE(testOffset)
+{
+    const sys::SSize_T coords[] = { 12, 13, 12, 18, 16, 18, 16, 13 };
+    const six::ValidDataMask mask(makePolygon(coords, 4),
+                                  types::RowCol<size_t>(10, 12),
+                                  six::RowColInt(10, 10));
+    TEST_ASSERT(mask.getSpans(2)[0] == six::ValidDataMask::Span(3, 9));
+    TEST_ASSERT_EQ(mask.getNumValid(), 30);
+}
+
+TEST_CASE(testClassifyTiles)
+{
+    const sys::SSize_T coords[] = { 0, 0, 0, 15, 15, 0 };
+    const six::ValidDataMask mask(makePolygon(coords, 3),
+                                  types::RowCol<size_t>(20, 20));
+
+    std::vector<six::ValidDataMask::TileClass> classes;
+    const types::RowCol<size_t> numTiles =
+            mask.classifyTiles(types::RowCol<size_t>(8, 8), classes);
+    TEST_ASSERT_EQ(numTiles.row, 3);
+    TEST_ASSERT_EQ(numTiles.col, 3);
+
+    TEST_ASSERT_EQ(classes[0], six::ValidDataMask::FULL);
+    TEST_ASSERT_EQ(classes[1], six::ValidDataMask::PARTIAL);
+    TEST_ASSERT_EQ(classes[2], six::ValidDataMask::EMPTY);
+    TEST_ASSERT_EQ(classes[3], six::ValidDataMask::PARTIAL);
+    TEST_ASSERT_EQ(classes[4], six::ValidDataMask::EMPTY);
+    TEST_ASSERT_EQ(classes[8], six::ValidDataMask::EMPTY);
+
+    const six::ValidDataMask all(types::RowCol<size_t>(20, 20));
+    TEST_ASSERT_EQ(all.classify(types::RowCol<size_t>(16, 16),
+                                types::RowCol<size_t>(4, 4)),
+                   six::ValidDataMask::FULL);
+    TEST_ASSERT_EQ(all.getNumValid(), 400);
+}
+
+TEST_CASE(testMaskTile)
+{
+    const sys::SSize_T coords[] = { 0, 4, 0, 10, 11, 15, 11, 0 };
+    const std::vector<Vertex> polygon = makePolygon(coords, 4);
+    const types::RowCol<size_t> dims(12, 16);
+    const six::ValidDataMask mask(polygon, dims);
+
+    const types::RowCol<size_t> offset(3, 2);
+    const types::RowCol<size_t> tileDims(7, 11);
+    std::vector<sys::Uint32_T> pixels(tileDims.area(), 0xFFFFFFFF);
+    mask.maskTile(offset, tileDims, sizeof(sys::Uint32_T),
+                  reinterpret_cast<six::UByte*>(&pixels[0]));
+
+    std::vector<six::UByte> bytes(tileDims.area());
+    mask.getMask(offset, tileDims, &bytes[0]);
+
+    for (size_t row = 0, idx = 0; row < tileDims.row; ++row)
+    {
+        for (size_t col = 0; col < tileDims.col; ++col, ++idx)
+        {
+            const bool valid = mask.isValid(offset.row + row,
+                                            offset.col + col);
+            TEST_ASSERT_EQ(pixels[idx], valid ? 0xFFFFFFFF : 0);
+            TEST_ASSERT_EQ(bytes[idx], valid ? 1 : 0);
+        }
+    }
+}
+
+TEST_CASE(testTooFewVertices)
+{
+    const sys::SSize_T coords[] = { 0, 0, 5, 5 };
+    TEST_EXCEPTION(six::ValidDataMask(makePolygon(coords, 2),
+                                      types::RowCol<size_t>(10, 10)));
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testRectangle);
+    TEST_CHECK(testAgainstReference);
+    TEST_CHECK(testOffset);
+    TEST_CHECK(testClassifyTiles);
+    TEST_CHECK(testMaskTile);
+    TEST_CHECK(testTooFewVertices);
+    return 0;
+}
@@ -0,0 +1,112 @@
+/* =========================================================================
+ * This file is part of six-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * six-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <stdlib.h>
+#include <cmath>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <string>
+
+#include <io/StringStream.h>
+#include <xml/lite/Element.h>
+#include <six/Utilities.h>
+#include <six/XMLSerializer.h>
+#include "TestCase.h"
+
+namespace
+{
+// What six::toString<double>() used to do
+std::string streamDouble(double value)
+{
+    std::ostringstream os;
+    os << std::uppercase << std::scientific
+       << std::setprecision(std::numeric_limits<double>::max_digits10)
+       << value;
+    std::string strValue = os.str();
+    const size_t plusPos = strValue.find("+");
+    if (plusPos != std::string::npos)
+    {
+        strValue.erase(plusPos, 1);
+    }
+    return strValue;
+}
+
+std::string print(const xml::lite::Element& element)
+{
+    io::StringStream stream;
+    element.print(stream);
+    return stream.stream().str();
+}
+
+TEST_CASE(testDoubleFormatting)
+{
+    const double values[] = { 0.0, -0.0, 1.0, -1.0, 0.1, 1.0e-300, 1.0e300,
+                              123456.789, -9.87654321e-7, 5e-324 };
+    for (size_t ii = 0; ii < sizeof(values) / sizeof(values[0]); ++ii)
+    {
+        TEST_ASSERT_EQ(six::toString(values[ii]), streamDouble(values[ii]));
+    }
+
+    for (size_t ii = 0; ii < 1000; ++ii)
+    {
+        const double value = (2.0 * rand() / RAND_MAX - 1.0) *
+                std::pow(10.0, rand() % 40 - 20);
+        TEST_ASSERT_EQ(six::toString(value), streamDouble(value));
+    }
+
+    TEST_ASSERT_EQ(six::toString(1.5f), "1.500000000E00");
+}
+
+TEST_CASE(testMatchesPrint)
+{
+    xml::lite::Element root("SICD", "urn:SICD:1.2.1");
+    root.attribute("xmlns") = "urn:SICD:1.2.1";
+
+    std::auto_ptr<xml::lite::Element> info(
+            new xml::lite::Element("CollectionInfo", "urn:SICD:1.2.1"));
+    info->addChild(new xml::lite::Element("CollectorName", "", "Sensor"));
+    info->addChild(new xml::lite::Element("Empty", ""));
+    xml::lite::Element* const value =
+            new xml::lite::Element("Value", "", six::toString(0.25));
+    value->attribute("name") = "x";
+    value->attribute("units") = "m";
+    info->addChild(value);
+    root.addChild(info);
+    root.addChild(new xml::lite::Element("Text", "", "a < b & c"));
+
+    const std::string expected = print(root);
+    TEST_ASSERT_EQ(six::toXMLString(root), expected);
+    TEST_ASSERT_EQ(six::toXMLString(root, 0), expected);
+
+    std::string buffer("prefix");
+    six::appendXML(root, buffer);
+    TEST_ASSERT_EQ(buffer, "prefix" + expected);
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testDoubleFormatting);
+    TEST_CHECK(testMatchesPrint);
+    return 0;
+}
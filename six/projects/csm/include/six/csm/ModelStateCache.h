@@ -0,0 +1,196 @@
+/* =========================================================================
+ * This file is part of the CSM SIX Plugin
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2020, MDA Information Systems LLC
+ *
+ * The CSM SIX Plugin is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __SIX_CSM_MODEL_STATE_CACHE_H__
+#define __SIX_CSM_MODEL_STATE_CACHE_H__
+
+#include <stddef.h>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <mem/SharedPtr.h>
+#include <mt/CriticalSection.h>
+#include <sys/Conf.h>
+#include <sys/Mutex.h>
+
+namespace six
+{
+namespace CSM
+{
+/**
+ * @class ModelStateCache
+ *
+ * @brief Thread-safe cache of whatever a sensor model builds from a model
+ * state string and the schema directories it was validated against, keyed
+ * by a hash of both
+ *
+ * Reconstructing a model from its state normally means parsing and
+ * validating XML.  Workflows such as bundle adjustment reconstruct the same
+ * handful of models over and over, so the parsed result is kept here and
+ * shared (read-only) between every model built from the same state.  A
+ * state that passed validation against one set of schemas says nothing
+ * about another, so the schema directories are part of the key.  The full
+ * key is stored alongside each entry so a hash collision can never return
+ * the wrong value.  Once 'maxEntries' states are cached, the oldest is
+ * evicted.
+ */
+template <typename ValueT>
+class ModelStateCache
+{
+public:
+    typedef mem::SharedPtr<const ValueT> ValuePtr;
+
+    /**
+     * \param maxEntries Maximum number of states to keep
+     */
+    explicit ModelStateCache(size_t maxEntries = 32) :
+        mMaxEntries(maxEntries)
+    {
+    }
+
+    /**
+     * \param state Model state string
+     * \param schemaDirs Schema directories the state is validated against
+     *
+     * \return The value cached for this state, or a NULL pointer if there
+     * isn't one
+     */
+    ValuePtr find(const std::string& state,
+                  const std::vector<std::string>& schemaDirs) const
+    {
+        const sys::Uint64_T key = hash(state, schemaDirs);
+
+        mt::CriticalSection<sys::Mutex> lock(&mMutex);
+        const typename EntryMap::const_iterator iter = mEntries.find(key);
+        if (iter != mEntries.end() && iter->second.state == state &&
+            iter->second.schemaDirs == schemaDirs)
+        {
+            return iter->second.value;
+        }
+        return ValuePtr();
+    }
+
+    /**
+     * Cache a value.  If the state is already cached, its value is replaced.
+     *
+     * \param state Model state string
+     * \param schemaDirs Schema directories 'state' was validated against
+     * \param value Value built from 'state'
+     */
+    void insert(const std::string& state,
+                const std::vector<std::string>& schemaDirs,
+                const ValuePtr& value)
+    {
+        if (mMaxEntries == 0)
+        {
+            return;
+        }
+
+        const sys::Uint64_T key = hash(state, schemaDirs);
+
+        mt::CriticalSection<sys::Mutex> lock(&mMutex);
+        typename EntryMap::iterator iter = mEntries.find(key);
+        if (iter == mEntries.end())
+        {
+            if (mEntries.size() >= mMaxEntries)
+            {
+                mEntries.erase(mInsertionOrder.front());
+                mInsertionOrder.pop_front();
+            }
+            iter = mEntries.insert(std::make_pair(key, Entry())).first;
+            mInsertionOrder.push_back(key);
+        }
+
+        iter->second.state = state;
+        iter->second.schemaDirs = schemaDirs;
+        iter->second.value = value;
+    }
+
+    //! Remove all cached states
+    void clear()
+    {
+        mt::CriticalSection<sys::Mutex> lock(&mMutex);
+        mEntries.clear();
+        mInsertionOrder.clear();
+    }
+
+    //! \return Number of cached states
+    size_t size() const
+    {
+        mt::CriticalSection<sys::Mutex> lock(&mMutex);
+        return mEntries.size();
+    }
+
+    /**
+     * 64-bit FNV-1a hash of the state and each schema directory, with a NUL
+     * after each so that moving characters between them changes the hash
+     *
+     * \param state Model state string
+     * \param schemaDirs Schema directories
+     *
+     * \return Hash of 'state' and 'schemaDirs'
+     */
+    static
+    sys::Uint64_T hash(const std::string& state,
+                       const std::vector<std::string>& schemaDirs)
+    {
+        sys::Uint64_T value = hash(state, 14695981039346656037ULL);
+        for (size_t ii = 0; ii < schemaDirs.size(); ++ii)
+        {
+            value = hash(schemaDirs[ii], value);
+        }
+        return value;
+    }
+
+private:
+    struct Entry
+    {
+        std::string state;
+        std::vector<std::string> schemaDirs;
+        ValuePtr value;
+    };
+
+    static
+    sys::Uint64_T hash(const std::string& str, sys::Uint64_T value)
+    {
+        for (size_t ii = 0; ii < str.length(); ++ii)
+        {
+            value ^= static_cast<unsigned char>(str[ii]);
+            value *= 1099511628211ULL;
+        }
+        value *= 1099511628211ULL;
+        return value;
+    }
+
+    typedef std::map<sys::Uint64_T, Entry> EntryMap;
+
+    const size_t mMaxEntries;
+    mutable sys::Mutex mMutex;
+    EntryMap mEntries;
+    std::deque<sys::Uint64_T> mInsertionOrder;
+};
+}
+}
+
+#endif
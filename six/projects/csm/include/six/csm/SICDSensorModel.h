@@ -143,6 +143,20 @@ public: // Model methods
      */
     virtual std::string getSensorMode() const;
 
+    /**
+     * Returns a string representing the state of the sensor model.  This is
+     * the sensor model name, followed by a space, then "SIXB1:" and the
+     * hex-encoded adjustable parameters, their types, and the sensor
+     * covariance, followed by a space and the SICD XML.  The digit after
+     * "SIXB" is the version of the adjustments' layout.  Unlike the SICD XML
+     * alone, this round-trips any adjustments made to the model.  States
+     * holding just the model name and the SICD XML are still accepted by
+     * the constructor and replaceModelState().
+     *
+     * \return State of the sensor model
+     */
+    virtual std::string getModelState() const;
+
 public: // GeometricModel methods
 
 
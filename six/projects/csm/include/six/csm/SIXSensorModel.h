@@ -24,6 +24,8 @@
 #define __SIX_CSM_SIX_SENSOR_MODEL_H__
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "RasterGM.h"
 #include "CorrelationModel.h"
@@ -32,6 +34,7 @@
 #include <scene/SceneGeometry.h>
 #include <scene/ProjectionModel.h>
 #include <scene/ECEFToLLATransform.h>
+#include <sys/OS.h>
 #include <six/Enums.h>
 #include <six/Types.h>
 
@@ -593,6 +596,111 @@ public: // RasterGM methods
     double getCorrelationCoefficient(size_t cpGroupIndex,
                                      double deltaTime) const;
 
+public: // Batch methods
+    // These are virtual so that callers holding a model constructed by the
+    // plugin can reach them without linking against the plugin itself
+    /*
+     * Outcome of projecting one point in a batch call.  Batch calls never
+     * throw for an individual point; a point that fails is flagged here
+     * with the error message and the remaining points are still projected.
+     */
+    struct PointStatus
+    {
+        PointStatus() :
+            success(true)
+        {
+        }
+
+        bool success;
+        std::string message;
+    };
+
+    /*
+     * Converts many ground points (ECEF meters) to image coordinates
+     * (pixels), splitting the points across threads.
+     *
+     * \param[in] groundPts Ground coordinates in meters
+     * \param[out] imagePts Image coordinates in pixels.  Resized to match
+     *     groundPts.  Points that failed are left at (0, 0).
+     * \param[out] status Per-point status.  Resized to match groundPts.
+     * \param[in] numThreads Number of threads to use
+     *
+     * \return Number of points that failed
+     */
+    virtual size_t groundToImage(
+            const std::vector<csm::EcefCoord>& groundPts,
+            std::vector<csm::ImageCoord>& imagePts,
+            std::vector<PointStatus>& status,
+            size_t numThreads = sys::OS().getNumCPUsAvailable()) const;
+
+    /*
+     * Converts many image points (pixels) to ground coordinates (ECEF
+     * meters), splitting the points across threads.
+     *
+     * \param[in] imagePts Image line and sample in pixels
+     * \param[in] heights Height in meters above the WGS-84 ellipsoid for
+     *     each point.  May instead contain a single height that is used for
+     *     every point.
+     * \param[out] groundPts Ground coordinates in meters.  Resized to match
+     *     imagePts.  Points that failed are left at (0, 0, 0).
+     * \param[out] status Per-point status.  Resized to match imagePts.
+     * \param[in] numThreads Number of threads to use
+     *
+     * \return Number of points that failed
+     *
+     * \throws csm::Error if the number of heights doesn't match
+     */
+    virtual size_t imageToGround(
+            const std::vector<csm::ImageCoord>& imagePts,
+            const std::vector<double>& heights,
+            std::vector<csm::EcefCoord>& groundPts,
+            std::vector<PointStatus>& status,
+            size_t numThreads = sys::OS().getNumCPUsAvailable()) const;
+
+    /*
+     * Computes the partial derivatives of line and sample (in pixels per
+     * the applicable model parameter units) with respect to every model
+     * parameter at many ground points, splitting the points across threads.
+     * This is the batch equivalent of computeAllSensorPartials().
+     *
+     * \param[in] imagePts The image point corresponding to each ground
+     *     point.  Results are unpredictable if these do not correspond to
+     *     calling groundToImage() with groundPts.
+     * \param[in] groundPts Ground coordinates in meters
+     * \param[out] partials Partials for point ii and parameter jj are at
+     *     partials[ii * getNumSensorModelParameters() + jj].  Resized to
+     *     match.  Points that failed are left at (0, 0).
+     * \param[out] status Per-point status.  Resized to match groundPts.
+     * \param[in] numThreads Number of threads to use
+     *
+     * \return Number of points that failed
+     *
+     * \throws csm::Error if imagePts and groundPts differ in size
+     */
+    virtual size_t computeAllSensorPartials(
+            const std::vector<csm::ImageCoord>& imagePts,
+            const std::vector<csm::EcefCoord>& groundPts,
+            std::vector<SensorPartials>& partials,
+            std::vector<PointStatus>& status,
+            size_t numThreads = sys::OS().getNumCPUsAvailable()) const;
+
+    /*
+     * Same as above, but first projects each ground point into the image
+     *
+     * \param[in] groundPts Ground coordinates in meters
+     * \param[out] partials Partials for point ii and parameter jj are at
+     *     partials[ii * getNumSensorModelParameters() + jj]
+     * \param[out] status Per-point status.  Resized to match groundPts.
+     * \param[in] numThreads Number of threads to use
+     *
+     * \return Number of points that failed
+     */
+    virtual size_t computeAllSensorPartials(
+            const std::vector<csm::EcefCoord>& groundPts,
+            std::vector<SensorPartials>& partials,
+            std::vector<PointStatus>& status,
+            size_t numThreads = sys::OS().getNumCPUsAvailable()) const;
+
 public:
     // All remaining public methods throw csm::Error's that they're not
     // implemented
@@ -675,6 +783,23 @@ protected:
     static
     DataType getDataType(const csm::Des& des);
 
+    // Shared by the single point and batch methods.  These throw
+    // except::Exception on failure rather than csm::Error.
+    csm::EcefCoord imageToGroundImpl(const csm::ImageCoord& imagePt,
+                                     double height) const;
+
+    void computeAllSensorPartialsImpl(const csm::ImageCoord& imagePt,
+                                      const csm::EcefCoord& groundPt,
+                                      SensorPartials* partials) const;
+
+private:
+    // Workers for the batch methods.  Each handles a contiguous range of
+    // points; they're defined in the source file.
+    class BatchJob;
+    class GroundToImageJob;
+    class ImageToGroundJob;
+    class SensorPartialsJob;
+
 protected:
     const scene::ECEFToLLATransform mECEFToLLA;
     const csm::NoCorrelationModel mCorrelationModel;
@@ -20,17 +20,309 @@
 *
 */
 
+#include <string.h>
+
 #include "Error.h"
+#include <sys/Conf.h>
 #include <sys/OS.h>
 #include <sys/Path.h>
+#include <six/csm/ModelStateCache.h>
 #include <six/csm/SICDSensorModel.h>
 #include <io/StringStream.h>
 #include <logging/NullLogger.h>
+#include <six/Serialize.h>
 #include <six/XMLControlFactory.h>
 #include <six/NITFReadControl.h>
 #include <six/sicd/ComplexXMLControl.h>
 #include <six/sicd/Utilities.h>
 
+namespace
+{
+// Marks a state whose SICD XML is preceded by the model's adjustments.  The
+// digits following the prefix are the version of the adjustments' layout.
+const char ADJUSTED_STATE_PREFIX[] = "SIXB";
+const sys::Uint32_T ADJUSTED_STATE_VERSION = 1;
+
+const size_t NUM_PARAMS = scene::AdjustableParams::NUM_PARAMS;
+
+// Tagged states carry the adjustable parameters, their types, and the
+// covariance.  Plain XML states don't; those come from reinitialize().
+struct ModelAdjustments
+{
+    ModelAdjustments() :
+        present(false)
+    {
+    }
+
+    bool present;
+    scene::Errors errors;
+    double params[NUM_PARAMS];
+    csm::param::Type types[NUM_PARAMS];
+    math::linear::MatrixMxN<7, 7> covariance;
+};
+
+// Keyed on the SICD XML only, so states that differ just in their
+// adjustments (e.g. every iteration of a bundle adjustment) share an entry
+six::CSM::ModelStateCache<six::sicd::ComplexData> modelStateCache;
+
+// Big-endian, like the other binary formats in SIX
+bool swapBytes()
+{
+    return !sys::isBigEndianSystem();
+}
+
+class StateWriter
+{
+public:
+    StateWriter() :
+        mSwapBytes(swapBytes())
+    {
+    }
+
+    template <typename T>
+    void write(const T& value)
+    {
+        six::serialize(value, mSwapBytes, mBuffer);
+    }
+
+    template <size_t M, size_t N>
+    void write(const math::linear::MatrixMxN<M, N>& matrix)
+    {
+        for (size_t ii = 0; ii < M; ++ii)
+        {
+            for (size_t jj = 0; jj < N; ++jj)
+            {
+                write(matrix(ii, jj));
+            }
+        }
+    }
+
+    // Hex keeps the state printable so it can be stored like the XML is
+    std::string toHex() const
+    {
+        static const char DIGITS[] = "0123456789abcdef";
+
+        std::string hex(mBuffer.size() * 2, '0');
+        for (size_t ii = 0; ii < mBuffer.size(); ++ii)
+        {
+            const unsigned char byte = static_cast<unsigned char>(mBuffer[ii]);
+            hex[2 * ii] = DIGITS[byte >> 4];
+            hex[2 * ii + 1] = DIGITS[byte & 0xF];
+        }
+        return hex;
+    }
+
+private:
+    const bool mSwapBytes;
+    std::vector<sys::byte> mBuffer;
+};
+
+class StateReader
+{
+public:
+    StateReader(const char* hex, size_t length) :
+        mSwapBytes(swapBytes())
+    {
+        if (length % 2 != 0)
+        {
+            throw except::Exception(Ctxt("Truncated sensor model state"));
+        }
+
+        mBuffer.resize(length / 2);
+        for (size_t ii = 0; ii < mBuffer.size(); ++ii)
+        {
+            mBuffer[ii] = static_cast<sys::byte>(
+                    (fromHex(hex[2 * ii]) << 4) | fromHex(hex[2 * ii + 1]));
+        }
+        mPosition = mBuffer.empty() ? NULL : &mBuffer[0];
+        mRemaining = mBuffer.size();
+    }
+
+    template <typename T>
+    void read(T& value)
+    {
+        if (sizeof(T) > mRemaining)
+        {
+            throw except::Exception(Ctxt("Truncated sensor model state"));
+        }
+        six::deserialize(mPosition, mSwapBytes, value);
+        mRemaining -= sizeof(T);
+    }
+
+    template <size_t M, size_t N>
+    void read(math::linear::MatrixMxN<M, N>& matrix)
+    {
+        for (size_t ii = 0; ii < M; ++ii)
+        {
+            for (size_t jj = 0; jj < N; ++jj)
+            {
+                read(matrix(ii, jj));
+            }
+        }
+    }
+
+    // Enums are stored as 32-bit integers; anything outside [0, maxValue]
+    // didn't come from writeAdjustments()
+    sys::Int32_T readEnum(sys::Int32_T maxValue)
+    {
+        sys::Int32_T value;
+        read(value);
+        if (value < 0 || value > maxValue)
+        {
+            throw except::Exception(Ctxt("Corrupt sensor model state"));
+        }
+        return value;
+    }
+
+    size_t remaining() const
+    {
+        return mRemaining;
+    }
+
+private:
+    static
+    unsigned char fromHex(char digit)
+    {
+        if (digit >= '0' && digit <= '9')
+        {
+            return static_cast<unsigned char>(digit - '0');
+        }
+        if (digit >= 'a' && digit <= 'f')
+        {
+            return static_cast<unsigned char>(digit - 'a' + 10);
+        }
+        if (digit >= 'A' && digit <= 'F')
+        {
+            return static_cast<unsigned char>(digit - 'A' + 10);
+        }
+        throw except::Exception(Ctxt("Invalid character in sensor model state"));
+    }
+
+    const bool mSwapBytes;
+    std::vector<sys::byte> mBuffer;
+    const sys::byte* mPosition;
+    size_t mRemaining;
+};
+
+// Keep this in sync with readAdjustments()
+void writeAdjustments(const scene::ProjectionModel& projection,
+                      const csm::param::Type* types,
+                      const math::linear::MatrixMxN<7, 7>& covariance,
+                      StateWriter& writer)
+{
+    const scene::Errors& errors = projection.getErrors();
+    writer.write(static_cast<sys::Int32_T>(errors.mFrameType.mValue));
+    writer.write(errors.mSensorErrorCovar);
+    writer.write(errors.mUnmodeledErrorCovar);
+    writer.write(errors.mIonoErrorCovar);
+    writer.write(errors.mTropoErrorCovar);
+    writer.write(errors.mPositionCorrCoefZero);
+    writer.write(errors.mPositionDecorrRate);
+    writer.write(errors.mRangeCorrCoefZero);
+    writer.write(errors.mRangeDecorrRate);
+
+    const scene::AdjustableParams& params = projection.getAdjustableParams();
+    for (size_t ii = 0; ii < NUM_PARAMS; ++ii)
+    {
+        writer.write(params.mParams[ii]);
+        writer.write(static_cast<sys::Int32_T>(types[ii]));
+    }
+    writer.write(covariance);
+}
+
+void readAdjustments(StateReader& reader, ModelAdjustments& adjustments)
+{
+    scene::Errors& errors = adjustments.errors;
+    errors.mFrameType = scene::FrameType(
+            static_cast<scene::FrameType::FrameTypesEnum>(
+                    reader.readEnum(scene::FrameType::NOT_SET)));
+    reader.read(errors.mSensorErrorCovar);
+    reader.read(errors.mUnmodeledErrorCovar);
+    reader.read(errors.mIonoErrorCovar);
+    reader.read(errors.mTropoErrorCovar);
+    reader.read(errors.mPositionCorrCoefZero);
+    reader.read(errors.mPositionDecorrRate);
+    reader.read(errors.mRangeCorrCoefZero);
+    reader.read(errors.mRangeDecorrRate);
+
+    for (size_t ii = 0; ii < NUM_PARAMS; ++ii)
+    {
+        reader.read(adjustments.params[ii]);
+        adjustments.types[ii] = static_cast<csm::param::Type>(
+                reader.readEnum(csm::param::FIXED));
+    }
+    reader.read(adjustments.covariance);
+
+    if (reader.remaining() != 0)
+    {
+        throw except::Exception(Ctxt("Corrupt sensor model state"));
+    }
+    adjustments.present = true;
+}
+
+// A state is either
+//     <model name> <SICD XML>
+// or
+//     <model name> SIXB<version>:<hex adjustments> <SICD XML>
+// Returns the offset of the XML, reading the adjustments into 'adjustments'
+// if there are any
+size_t readAdjustedState(const std::string& sensorModelState,
+                         size_t offset,
+                         ModelAdjustments& adjustments)
+{
+    const size_t prefixLength = strlen(ADJUSTED_STATE_PREFIX);
+    if (sensorModelState.compare(
+            offset, prefixLength, ADJUSTED_STATE_PREFIX) != 0)
+    {
+        return offset;
+    }
+
+    const size_t colon = sensorModelState.find(':', offset);
+    const size_t space = sensorModelState.find(' ', offset);
+    if (colon == std::string::npos || space == std::string::npos ||
+        colon > space)
+    {
+        throw except::Exception(Ctxt("Invalid sensor model state"));
+    }
+
+    const std::string versionStr = sensorModelState.substr(
+            offset + prefixLength, colon - offset - prefixLength);
+    if (versionStr != str::toString(ADJUSTED_STATE_VERSION))
+    {
+        throw except::Exception(Ctxt(
+                "Unsupported sensor model state version " + versionStr));
+    }
+
+    StateReader reader(sensorModelState.c_str() + colon + 1,
+                       space - colon - 1);
+    readAdjustments(reader, adjustments);
+    return space + 1;
+}
+
+std::auto_ptr<const six::sicd::ComplexData> readXMLState(
+        const std::string& xml,
+        const std::vector<std::string>& schemaDirs)
+{
+    io::StringStream stream;
+    stream.write(xml.c_str(), xml.length());
+
+    xml::lite::MinidomParser domParser;
+    domParser.parse(stream);
+
+    six::XMLControlRegistry xmlRegistry;
+    xmlRegistry.addCreator(six::DataType::COMPLEX,
+            new six::XMLControlCreatorT<six::sicd::ComplexXMLControl>());
+
+    logging::NullLogger logger;
+    std::auto_ptr<six::XMLControl> control(
+            xmlRegistry.newXMLControl(six::DataType::COMPLEX, &logger));
+
+    return std::auto_ptr<const six::sicd::ComplexData>(
+            reinterpret_cast<six::sicd::ComplexData*>(
+                    control->fromXML(domParser.getDocument(), schemaDirs)));
+}
+}
+
 namespace six
 {
 namespace CSM
@@ -102,11 +394,11 @@ void SICDSensorModel::initializeFromFile(const std::string& pathname)
         // Cast it and grab a copy
         mData.reset(reinterpret_cast<six::sicd::ComplexData*>(
                 container->getData(0)->clone()));
+        reinitialize();
 
         // get xml as string for sensor model state
         const std::string xmlStr = six::toXMLString(mData.get(), &xmlRegistry);
         mSensorModelState = NAME + std::string(" ") + xmlStr;
-        reinitialize();
     }
     catch (const except::Exception& ex)
     {
@@ -181,11 +473,6 @@ void SICDSensorModel::initializeFromISD(const csm::Nitf21Isd& isd)
                                "SICDSensorModel::SICDSensorModel");
         }
 
-        // get xml as string for sensor model state
-        io::StringStream stringStream;
-        sicdXML->getRootElement()->print(stringStream);
-        mSensorModelState = NAME + std::string(" ") + stringStream.stream().str();
-
         six::XMLControlRegistry xmlRegistry;
         xmlRegistry.addCreator(six::DataType::COMPLEX,
                 new six::XMLControlCreatorT<six::sicd::ComplexXMLControl>());
@@ -197,6 +484,11 @@ void SICDSensorModel::initializeFromISD(const csm::Nitf21Isd& isd)
         mData.reset(reinterpret_cast<six::sicd::ComplexData*>(control->fromXML(
                 sicdXML, mSchemaDirs)));
         reinitialize();
+
+        // get xml as string for sensor model state
+        io::StringStream stringStream;
+        sicdXML->getRootElement()->print(stringStream);
+        mSensorModelState = NAME + std::string(" ") + stringStream.stream().str();
     }
     catch (const except::Exception& ex)
     {
@@ -396,6 +688,27 @@ csm::ImageCoord SICDSensorModel::getImageStart() const
                            mData->imageData->firstCol);
 }
 
+std::string SICDSensorModel::getModelState() const
+{
+    try
+    {
+        StateWriter writer;
+        writeAdjustments(*mProjection, mAdjustableTypes, mSensorCovariance,
+                         writer);
+
+        // mSensorModelState is always the model name followed by the XML
+        return NAME + std::string(" ") + ADJUSTED_STATE_PREFIX +
+                str::toString(ADJUSTED_STATE_VERSION) + ":" + writer.toHex() +
+                mSensorModelState.substr(strlen(NAME));
+    }
+    catch (const except::Exception& ex)
+    {
+        throw csm::Error(csm::Error::UNKNOWN_ERROR,
+                           ex.getMessage(),
+                           "SICDSensorModel::getModelState");
+    }
+}
+
 void SICDSensorModel::replaceModelStateImpl(const std::string& sensorModelState)
 {
     const size_t idx = sensorModelState.find(' ');
@@ -414,30 +727,41 @@ void SICDSensorModel::replaceModelStateImpl(const std::string& sensorModelState)
                            "SICDSensorModel::replaceModelStateImpl");
     }
 
-    const std::string sensorModelXML = sensorModelState.substr(idx + 1);
-
     try
     {
-        io::StringStream stream;
-        stream.write(sensorModelXML.c_str(), sensorModelXML.length());
-
-        xml::lite::MinidomParser domParser;
-        domParser.parse(stream);
-
-        six::XMLControlRegistry xmlRegistry;
-        xmlRegistry.addCreator(six::DataType::COMPLEX,
-                new six::XMLControlCreatorT<six::sicd::ComplexXMLControl>());
-
-        logging::NullLogger logger;
-        std::auto_ptr<six::XMLControl> control(
-                xmlRegistry.newXMLControl(six::DataType::COMPLEX, &logger));
+        ModelAdjustments adjustments;
+        const size_t xmlOffset =
+                readAdjustedState(sensorModelState, idx + 1, adjustments);
+        const std::string xml = sensorModelState.substr(xmlOffset);
+
+        // Reconstructing from the same XML over and over is common (e.g.
+        // during bundle adjustment), so skip the parsing if we've seen it
+        // before
+        ModelStateCache<six::sicd::ComplexData>::ValuePtr data =
+                modelStateCache.find(xml, mSchemaDirs);
+        if (!data.get())
+        {
+            data.reset(readXMLState(xml, mSchemaDirs).release());
+            modelStateCache.insert(xml, mSchemaDirs, data);
+        }
 
         // get xml as string for sensor model state
-        mSensorModelState = sensorModelState;
+        mSensorModelState = NAME + std::string(" ") + xml;
 
-        mData.reset(reinterpret_cast<six::sicd::ComplexData*>(control->fromXML(
-                domParser.getDocument(), mSchemaDirs)));
+        mData.reset(new six::sicd::ComplexData(*data));
         reinitialize();
+
+        if (adjustments.present)
+        {
+            mProjection->getErrors() = adjustments.errors;
+            for (size_t ii = 0; ii < NUM_PARAMS; ++ii)
+            {
+                mProjection->getAdjustableParams().mParams[ii] =
+                        adjustments.params[ii];
+                mAdjustableTypes[ii] = adjustments.types[ii];
+            }
+            mSensorCovariance = adjustments.covariance;
+        }
     }
     catch (const except::Exception& ex)
     {
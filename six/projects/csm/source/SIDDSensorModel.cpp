@@ -23,14 +23,23 @@
 #include "Error.h"
 #include <sys/OS.h>
 #include <sys/Path.h>
+#include <six/csm/ModelStateCache.h>
 #include <six/csm/SIDDSensorModel.h>
 #include <io/StringStream.h>
 #include <logging/NullLogger.h>
 #include <six/XMLControlFactory.h>
+#include <six/XMLSerializer.h>
 #include <six/NITFReadControl.h>
 #include <six/sidd/DerivedXMLControl.h>
 #include <six/sidd/Utilities.h>
 
+namespace
+{
+// Parsed SIDDs, so reconstructing a model from the same state doesn't
+// re-parse and re-validate the XML
+six::CSM::ModelStateCache<six::sidd::DerivedData> modelStateCache;
+}
+
 namespace six
 {
 namespace CSM
@@ -213,9 +222,8 @@ void SIDDSensorModel::initializeFromISD(const csm::Nitf21Isd& isd,
         }
 
         // get xml as string for sensor model state
-        io::StringStream stringStream;
-        siddXML->getRootElement()->print(stringStream);
-        mSensorModelState = NAME + std::string(" ") + stringStream.stream().str();
+        mSensorModelState = NAME + std::string(" ") +
+                six::toXMLString(*siddXML->getRootElement());
 
         six::XMLControlRegistry xmlRegistry;
         xmlRegistry.addCreator(six::DataType::DERIVED,
@@ -404,29 +412,36 @@ void SIDDSensorModel::replaceModelStateImpl(const std::string& sensorModelState)
                            "SIDDSensorModel::replaceModelStateImpl");
     }
 
-    const std::string sensorModelXML = sensorModelState.substr(idx + 1);
-
     try
     {
-        io::StringStream stream;
-        stream.write(sensorModelXML.c_str(), sensorModelXML.length());
+        ModelStateCache<six::sidd::DerivedData>::ValuePtr data =
+                modelStateCache.find(sensorModelState, mSchemaDirs);
+        if (!data.get())
+        {
+            io::StringStream stream;
+            stream.write(sensorModelState.c_str() + idx + 1,
+                         sensorModelState.length() - idx - 1);
 
-        xml::lite::MinidomParser domParser;
-        domParser.parse(stream);
+            xml::lite::MinidomParser domParser;
+            domParser.parse(stream);
 
-        six::XMLControlRegistry xmlRegistry;
-        xmlRegistry.addCreator(six::DataType::DERIVED,
-                new six::XMLControlCreatorT<six::sidd::DerivedXMLControl>());
+            six::XMLControlRegistry xmlRegistry;
+            xmlRegistry.addCreator(six::DataType::DERIVED,
+                    new six::XMLControlCreatorT<six::sidd::DerivedXMLControl>());
 
-        logging::NullLogger logger;
-        std::auto_ptr<six::XMLControl> control(xmlRegistry.newXMLControl(
-                six::DataType::DERIVED, &logger));
+            logging::NullLogger logger;
+            std::auto_ptr<six::XMLControl> control(xmlRegistry.newXMLControl(
+                    six::DataType::DERIVED, &logger));
+
+            data.reset(reinterpret_cast<six::sidd::DerivedData*>(
+                    control->fromXML(domParser.getDocument(), mSchemaDirs)));
+            modelStateCache.insert(sensorModelState, mSchemaDirs, data);
+        }
 
         // get xml as string for sensor model state
         mSensorModelState = sensorModelState;
 
-        mData.reset(reinterpret_cast<six::sidd::DerivedData*>(control->fromXML(
-                domParser.getDocument(), mSchemaDirs)));
+        mData.reset(new six::sidd::DerivedData(*data));
         reinitialize();
     }
     catch (const except::Exception& ex)
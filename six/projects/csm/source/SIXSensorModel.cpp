@@ -22,8 +22,10 @@
 
 #include <cmath>
 #include <limits>
+#include <memory>
 
 #include "Error.h"
+#include <scene/RangeRunnable.h>
 #include <six/NITFReadControl.h>
 #include <six/csm/SIXSensorModel.h>
 
@@ -121,12 +123,169 @@ math::linear::Matrix2D<T> matrixSqrt(const math::linear::Matrix2D<T>& m)
     const math::linear::Matrix2D<T> eigenVec = eig.getV();
     return (eigenVec * diag * eigenVec.transpose());
 }
+
+template <typename StatusT>
+size_t countFailures(const std::vector<StatusT>& status)
+{
+    size_t numFailed(0);
+    for (size_t ii = 0; ii < status.size(); ++ii)
+    {
+        if (!status[ii].success)
+        {
+            ++numFailed;
+        }
+    }
+    return numFailed;
+}
 }
 
 namespace six
 {
 namespace CSM
 {
+class SIXSensorModel::BatchJob
+{
+public:
+    BatchJob(const SIXSensorModel& model, PointStatus* status) :
+        mModel(model),
+        mStatus(status)
+    {
+    }
+
+    virtual ~BatchJob()
+    {
+    }
+
+    void operator()(size_t start, size_t numPoints) const
+    {
+        for (size_t ii = start; ii < start + numPoints; ++ii)
+        {
+            try
+            {
+                processPoint(ii);
+            }
+            catch (const except::Exception& ex)
+            {
+                fail(ii, ex.getMessage());
+            }
+            catch (const csm::Error& ex)
+            {
+                fail(ii, ex.getMessage());
+            }
+            catch (const std::exception& ex)
+            {
+                fail(ii, ex.what());
+            }
+        }
+    }
+
+protected:
+    // Throws on failure
+    virtual void processPoint(size_t index) const = 0;
+
+    const SIXSensorModel& mModel;
+
+private:
+    void fail(size_t index, const std::string& message) const
+    {
+        mStatus[index].success = false;
+        mStatus[index].message = message;
+    }
+
+    PointStatus* const mStatus;
+};
+
+class SIXSensorModel::GroundToImageJob : public BatchJob
+{
+public:
+    GroundToImageJob(const SIXSensorModel& model,
+                     const csm::EcefCoord* groundPts,
+                     csm::ImageCoord* imagePts,
+                     PointStatus* status) :
+        BatchJob(model, status),
+        mGroundPts(groundPts),
+        mImagePts(imagePts)
+    {
+    }
+
+protected:
+    virtual void processPoint(size_t index) const
+    {
+        mImagePts[index] =
+                mModel.groundToImageImpl(mGroundPts[index], 0.0, NULL);
+    }
+
+private:
+    const csm::EcefCoord* const mGroundPts;
+    csm::ImageCoord* const mImagePts;
+};
+
+class SIXSensorModel::ImageToGroundJob : public BatchJob
+{
+public:
+    ImageToGroundJob(const SIXSensorModel& model,
+                     const csm::ImageCoord* imagePts,
+                     const double* heights,
+                     bool singleHeight,
+                     csm::EcefCoord* groundPts,
+                     PointStatus* status) :
+        BatchJob(model, status),
+        mImagePts(imagePts),
+        mHeights(heights),
+        mSingleHeight(singleHeight),
+        mGroundPts(groundPts)
+    {
+    }
+
+protected:
+    virtual void processPoint(size_t index) const
+    {
+        const double height = mHeights[mSingleHeight ? 0 : index];
+        mGroundPts[index] = mModel.imageToGroundImpl(mImagePts[index], height);
+    }
+
+private:
+    const csm::ImageCoord* const mImagePts;
+    const double* const mHeights;
+    const bool mSingleHeight;
+    csm::EcefCoord* const mGroundPts;
+};
+
+class SIXSensorModel::SensorPartialsJob : public BatchJob
+{
+public:
+    // If 'imagePts' is NULL, the ground points are projected first
+    SensorPartialsJob(const SIXSensorModel& model,
+                      const csm::ImageCoord* imagePts,
+                      const csm::EcefCoord* groundPts,
+                      SensorPartials* partials,
+                      PointStatus* status) :
+        BatchJob(model, status),
+        mImagePts(imagePts),
+        mGroundPts(groundPts),
+        mPartials(partials)
+    {
+    }
+
+protected:
+    virtual void processPoint(size_t index) const
+    {
+        const csm::ImageCoord imagePt = mImagePts ?
+                mImagePts[index] :
+                mModel.groundToImageImpl(mGroundPts[index], 0.0, NULL);
+
+        mModel.computeAllSensorPartialsImpl(
+                imagePt,
+                mGroundPts[index],
+                mPartials + index * getNumSensorModelParameters());
+    }
+
+private:
+    const csm::ImageCoord* const mImagePts;
+    const csm::EcefCoord* const mGroundPts;
+    SensorPartials* const mPartials;
+};
+
 const char SIXSensorModel::FAMILY[] = CSM_GEOMETRIC_MODEL_FAMILY CSM_RASTER_FAMILY;
 
 SIXSensorModel::SIXSensorModel()
@@ -515,12 +674,9 @@ SIXSensorModel::computeAllSensorPartials(
 {
     try
     {
-        const scene::Vector3 sceneGroundPt(toVector3(groundPt));
-
-        const types::RowCol<double> pixelPt = fromPixel(imagePt);
-        const math::linear::MatrixMxN<2, 7> sensorPartials =
-                mProjection->sceneToImageSensorPartials(sceneGroundPt,
-                                                        pixelPt);
+        std::vector<SensorPartials> sensorPartialsVec(
+                getNumSensorModelParameters(), SensorPartials(0, 0));
+        computeAllSensorPartialsImpl(imagePt, groundPt, &sensorPartialsVec[0]);
 
         // TODO: Currently no way to determine the actual precision that was
         //       achieved, so setting it to the desired precision
@@ -529,16 +685,6 @@ SIXSensorModel::computeAllSensorPartials(
             *achievedPrecision = desiredPrecision;
         }
 
-        // Return value is in pixels/sensor units
-        std::vector<SensorPartials> sensorPartialsVec(7, SensorPartials(0,0));
-        types::RowCol<double> ss = getSampleSpacing();
-        for (size_t idx = 0; idx < 7; ++idx)
-        {
-            sensorPartialsVec[idx].first =
-                    sensorPartials[0][idx] / ss.row;
-            sensorPartialsVec[idx].second =
-                    sensorPartials[1][idx] / ss.col;
-        }
         return sensorPartialsVec;
     }
     catch (const except::Exception& ex)
@@ -549,6 +695,26 @@ SIXSensorModel::computeAllSensorPartials(
     }
 }
 
+void SIXSensorModel::computeAllSensorPartialsImpl(
+        const csm::ImageCoord& imagePt,
+        const csm::EcefCoord& groundPt,
+        SensorPartials* partials) const
+{
+    const scene::Vector3 sceneGroundPt(toVector3(groundPt));
+
+    const types::RowCol<double> pixelPt = fromPixel(imagePt);
+    const math::linear::MatrixMxN<2, 7> sensorPartials =
+            mProjection->sceneToImageSensorPartials(sceneGroundPt, pixelPt);
+
+    // Output is in pixels/sensor units
+    const types::RowCol<double> ss = getSampleSpacing();
+    for (size_t idx = 0; idx < getNumSensorModelParameters(); ++idx)
+    {
+        partials[idx].first = sensorPartials[0][idx] / ss.row;
+        partials[idx].second = sensorPartials[1][idx] / ss.col;
+    }
+}
+
 csm::EcefCoord SIXSensorModel::getReferencePoint() const
 {
     return toEcefCoord(mGeometry->getReferencePosition());
@@ -713,6 +879,19 @@ csm::ImageCoordCovar SIXSensorModel::groundToImage(
     }
 }
 
+csm::EcefCoord SIXSensorModel::imageToGroundImpl(
+        const csm::ImageCoord& imagePt,
+        double height) const
+{
+    const types::RowCol<double> imagePtMeters = fromPixel(imagePt);
+
+    // TODO: imageToScene() supports specifying a height threshold in
+    //       meters but it's not obvious how to convert that to a desired
+    //       precision in pixels.  Likewise, not clear how to determine
+    //       the achieved precision in pixels afterwards.
+    return toEcefCoord(mProjection->imageToScene(imagePtMeters, height));
+}
+
 csm::EcefCoord SIXSensorModel::imageToGround(
         const csm::ImageCoord& imagePt,
         double height,
@@ -722,21 +901,14 @@ csm::EcefCoord SIXSensorModel::imageToGround(
 {
     try
     {
-        const types::RowCol<double> imagePtMeters = fromPixel(imagePt);
-
-        // TODO: imageToScene() supports specifying a height threshold in
-        //       meters but it's not obvious how to convert that to a desired
-        //       precision in pixels.  Likewise, not clear how to determine
-        //       the achieved precision in pixels afterwards.
-        const scene::Vector3 groundPt =
-                mProjection->imageToScene(imagePtMeters, height);
+        const csm::EcefCoord groundPt = imageToGroundImpl(imagePt, height);
 
         if (achievedPrecision)
         {
             *achievedPrecision = desiredPrecision;
         }
 
-        return toEcefCoord(groundPt);
+        return groundPt;
     }
     catch (const except::Exception& ex)
     {
@@ -1148,5 +1320,112 @@ DataType SIXSensorModel::getDataType(const csm::Des& des)
 
     return NITFReadControl::getDataType(desid, desshl, desshsi, desid);
 }
+
+size_t SIXSensorModel::groundToImage(
+        const std::vector<csm::EcefCoord>& groundPts,
+        std::vector<csm::ImageCoord>& imagePts,
+        std::vector<PointStatus>& status,
+        size_t numThreads) const
+{
+    imagePts.assign(groundPts.size(), csm::ImageCoord());
+    status.assign(groundPts.size(), PointStatus());
+    if (groundPts.empty())
+    {
+        return 0;
+    }
+
+    const GroundToImageJob job(*this,
+                               &groundPts[0],
+                               &imagePts[0],
+                               &status[0]);
+    scene::runInParallel(job, groundPts.size(), numThreads);
+    return countFailures(status);
+}
+
+size_t SIXSensorModel::imageToGround(
+        const std::vector<csm::ImageCoord>& imagePts,
+        const std::vector<double>& heights,
+        std::vector<csm::EcefCoord>& groundPts,
+        std::vector<PointStatus>& status,
+        size_t numThreads) const
+{
+    const bool singleHeight = (heights.size() == 1);
+    if (!singleHeight && heights.size() != imagePts.size())
+    {
+        throw csm::Error(csm::Error::BOUNDS,
+                         "Need one height per image point or a single height",
+                         "SIXSensorModel::imageToGround");
+    }
+
+    groundPts.assign(imagePts.size(), csm::EcefCoord());
+    status.assign(imagePts.size(), PointStatus());
+    if (imagePts.empty())
+    {
+        return 0;
+    }
+
+    const ImageToGroundJob job(*this,
+                               &imagePts[0],
+                               &heights[0],
+                               singleHeight,
+                               &groundPts[0],
+                               &status[0]);
+    scene::runInParallel(job, imagePts.size(), numThreads);
+    return countFailures(status);
+}
+
+size_t SIXSensorModel::computeAllSensorPartials(
+        const std::vector<csm::ImageCoord>& imagePts,
+        const std::vector<csm::EcefCoord>& groundPts,
+        std::vector<SensorPartials>& partials,
+        std::vector<PointStatus>& status,
+        size_t numThreads) const
+{
+    if (imagePts.size() != groundPts.size())
+    {
+        throw csm::Error(csm::Error::BOUNDS,
+                         "Need one image point per ground point",
+                         "SIXSensorModel::computeAllSensorPartials");
+    }
+
+    partials.assign(groundPts.size() * getNumSensorModelParameters(),
+                    SensorPartials(0, 0));
+    status.assign(groundPts.size(), PointStatus());
+    if (groundPts.empty())
+    {
+        return 0;
+    }
+
+    const SensorPartialsJob job(*this,
+                                &imagePts[0],
+                                &groundPts[0],
+                                &partials[0],
+                                &status[0]);
+    scene::runInParallel(job, groundPts.size(), numThreads);
+    return countFailures(status);
+}
+
+size_t SIXSensorModel::computeAllSensorPartials(
+        const std::vector<csm::EcefCoord>& groundPts,
+        std::vector<SensorPartials>& partials,
+        std::vector<PointStatus>& status,
+        size_t numThreads) const
+{
+    partials.assign(groundPts.size() * getNumSensorModelParameters(),
+                    SensorPartials(0, 0));
+    status.assign(groundPts.size(), PointStatus());
+    if (groundPts.empty())
+    {
+        return 0;
+    }
+
+    const SensorPartialsJob job(*this,
+                                NULL,
+                                &groundPts[0],
+                                &partials[0],
+                                &status[0]);
+    scene::runInParallel(job, groundPts.size(), numThreads);
+    return countFailures(status);
+}
 }
 }
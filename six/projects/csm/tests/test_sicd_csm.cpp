@@ -70,7 +70,98 @@ public:
                 mComplexData.get(), mXmlRegistry));
     }
 
+    bool testModelState()
+    {
+        bool testPassed = true;
+
+        std::auto_ptr<csm::RasterGM> model(reinterpret_cast<csm::RasterGM*>(
+                mPlugin.constructModelFromISD(csm::Isd(mSicdPathname),
+                                              MODEL_NAME)));
+
+        // States holding just the SICD XML must still be accepted
+        const std::string xmlState = std::string(MODEL_NAME) + " " +
+                six::toXMLString(mComplexData.get(), &mXmlRegistry);
+        std::auto_ptr<csm::RasterGM> xmlModel(reinterpret_cast<csm::RasterGM*>(
+                mPlugin.constructModelFromState(xmlState)));
+        if (!sameProjection(*model, *xmlModel))
+        {
+            std::cerr << "Model from XML state projects differently\n";
+            testPassed = false;
+        }
+
+        // Adjustments made to the model have to survive the round trip.
+        // Without error statistics in the SICD, there's nothing to adjust.
+        if (model->getNumParameters() > 2)
+        {
+            model->setParameterValue(0, 1.5);
+            model->setParameterType(1, csm::param::FIXED);
+            model->setParameterCovariance(2, 2, 4.0);
+        }
+
+        const std::string state = model->getModelState();
+        std::auto_ptr<csm::RasterGM> restored(reinterpret_cast<csm::RasterGM*>(
+                mPlugin.constructModelFromState(state)));
+        if (restored->getModelState() != state)
+        {
+            std::cerr << "Model state doesn't round trip\n";
+            testPassed = false;
+        }
+
+        for (int ii = 0; ii < model->getNumParameters(); ++ii)
+        {
+            if (restored->getParameterValue(ii) !=
+                        model->getParameterValue(ii) ||
+                restored->getParameterType(ii) !=
+                        model->getParameterType(ii))
+            {
+                std::cerr << "Parameter " << ii << " wasn't restored\n";
+                testPassed = false;
+            }
+            for (int jj = 0; jj < model->getNumParameters(); ++jj)
+            {
+                if (restored->getParameterCovariance(ii, jj) !=
+                    model->getParameterCovariance(ii, jj))
+                {
+                    std::cerr << "Covariance (" << ii << ", " << jj
+                              << ") wasn't restored\n";
+                    testPassed = false;
+                }
+            }
+        }
+
+        if (!sameProjection(*model, *restored))
+        {
+            std::cerr << "Restored model projects differently\n";
+            testPassed = false;
+        }
+
+        // A layout this version doesn't know about must be rejected
+        std::string futureState = state;
+        futureState.replace(futureState.find("SIXB1:"), 6, "SIXB2:");
+        try
+        {
+            delete mPlugin.constructModelFromState(futureState);
+            std::cerr << "Unsupported model state version was accepted\n";
+            testPassed = false;
+        }
+        catch (const csm::Error& )
+        {
+        }
+
+        return testPassed;
+    }
+
 private:
+    bool sameProjection(const csm::RasterGM& lhs, const csm::RasterGM& rhs)
+    {
+        const six::SCP& scp = mComplexData->geoData->scp;
+        const csm::EcefCoord groundPt(scp.ecf[0], scp.ecf[1], scp.ecf[2]);
+        const csm::ImageCoord lhsImagePt = lhs.groundToImage(groundPt, 0);
+        const csm::ImageCoord rhsImagePt = rhs.groundToImage(groundPt, 0);
+        return lhsImagePt.line == rhsImagePt.line &&
+               lhsImagePt.samp == rhsImagePt.samp;
+    }
+
     scene::Vector3 imageToGround(const csm::RasterGM& model,
             const six::RowColInt& scpPixel, double height, double offset)
     {
@@ -176,6 +267,11 @@ private:
                     " away from scpPixel\n";
             testPassed = false;
         }
+
+        if (!testBatchProjection(*model, height))
+        {
+            testPassed = false;
+        }
         return testPassed;
     }
 
@@ -246,7 +342,8 @@ int main(int argc, char** argv)
         }
 
         Test test(sicdPathname, confDir, plugin);
-        const bool testPassed = test.testFileISD() && test.testNitfISD();
+        const bool testPassed = test.testFileISD() && test.testNitfISD() &&
+                test.testModelState();
         return testPassed ? 0 : 1;
     }
 
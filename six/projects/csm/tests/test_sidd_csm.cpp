@@ -199,6 +199,11 @@ private:
                     " away from scpPixel\n";
             testPassed = false;
         }
+
+        if (!testBatchProjection(*model, height))
+        {
+            testPassed = false;
+        }
         return testPassed;
     }
 
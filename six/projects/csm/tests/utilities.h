@@ -21,6 +21,7 @@
  */
 
 #include <six/Utilities.h>
+#include <six/csm/SIXSensorModel.h>
 #include <NitfIsd.h>
 
 /**
@@ -169,3 +170,100 @@ six::RowColDouble absoluteDifference(const six::RowColDouble& lhs,
     return difference;
 }
 
+/**
+ * Compare the batch groundToImage(), imageToGround() and
+ * computeAllSensorPartials() against calling the single-point versions on
+ * a grid of points spanning the image, both on one thread and on several
+ *
+ * \param model A model constructed by the SIX plugin
+ * \param height Height in meters above the ellipsoid to project to
+ *
+ * \return true if every batch result matches the single-point one exactly
+ */
+bool testBatchProjection(const csm::RasterGM& model, double height)
+{
+    // The batch methods are virtual, so we can call them without linking
+    // against the plugin
+    const six::CSM::SIXSensorModel& sixModel =
+            static_cast<const six::CSM::SIXSensorModel&>(model);
+
+    const size_t gridSize = 10;
+    const csm::ImageCoord start = model.getImageStart();
+    const csm::ImageVector size = model.getImageSize();
+
+    std::vector<csm::ImageCoord> imagePts;
+    std::vector<csm::EcefCoord> groundPts;
+    std::vector<csm::ImageCoord> projectedPts;
+    std::vector<std::vector<csm::RasterGM::SensorPartials> > partials;
+    for (size_t ii = 0; ii < gridSize; ++ii)
+    {
+        for (size_t jj = 0; jj < gridSize; ++jj)
+        {
+            const csm::ImageCoord imagePt(
+                    start.line + size.line * (ii + 0.5) / gridSize,
+                    start.samp + size.samp * (jj + 0.5) / gridSize);
+            const csm::EcefCoord groundPt =
+                    model.imageToGround(imagePt, height);
+            imagePts.push_back(imagePt);
+            groundPts.push_back(groundPt);
+            projectedPts.push_back(model.groundToImage(groundPt));
+            partials.push_back(model.computeAllSensorPartials(groundPt));
+        }
+    }
+
+    bool testPassed = true;
+    const size_t threadCounts[] = { 1, 4 };
+    for (size_t tt = 0; tt < 2; ++tt)
+    {
+        const size_t numThreads = threadCounts[tt];
+        std::vector<six::CSM::SIXSensorModel::PointStatus> status;
+
+        std::vector<csm::EcefCoord> batchGroundPts;
+        size_t numFailed = sixModel.imageToGround(
+                imagePts, std::vector<double>(1, height), batchGroundPts,
+                status, numThreads);
+
+        std::vector<csm::ImageCoord> batchImagePts;
+        numFailed += sixModel.groundToImage(
+                groundPts, batchImagePts, status, numThreads);
+
+        std::vector<csm::RasterGM::SensorPartials> batchPartials;
+        numFailed += sixModel.computeAllSensorPartials(
+                groundPts, batchPartials, status, numThreads);
+
+        if (numFailed != 0)
+        {
+            std::cerr << numFailed << " batch projections failed on "
+                      << numThreads << " thread(s)\n";
+            testPassed = false;
+        }
+
+        for (size_t ii = 0; ii < imagePts.size(); ++ii)
+        {
+            if (batchGroundPts[ii].x != groundPts[ii].x ||
+                batchGroundPts[ii].y != groundPts[ii].y ||
+                batchGroundPts[ii].z != groundPts[ii].z ||
+                batchImagePts[ii].line != projectedPts[ii].line ||
+                batchImagePts[ii].samp != projectedPts[ii].samp)
+            {
+                std::cerr << "Batch projection of point " << ii
+                          << " differs on " << numThreads << " thread(s)\n";
+                testPassed = false;
+            }
+
+            const size_t numParams = partials[ii].size();
+            for (size_t jj = 0; jj < numParams; ++jj)
+            {
+                if (batchPartials[ii * numParams + jj] != partials[ii][jj])
+                {
+                    std::cerr << "Batch partial " << jj << " of point " << ii
+                              << " differs on " << numThreads
+                              << " thread(s)\n";
+                    testPassed = false;
+                }
+            }
+        }
+    }
+
+    return testPassed;
+}